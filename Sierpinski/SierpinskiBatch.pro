@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Command line tool running the Mesh algorithms
+# over many files, without Qt nor GL.
+#
+#-------------------------------------------------
+
+QT      -= core gui
+CONFIG  += console
+CONFIG  -= qt app_bundle
+
+TARGET = SierpinskiBatch
+TEMPLATE = app
+
+include(mesh.pri)
+
+SOURCES += sources/batch/main.cpp
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Benchmarks of the Mesh algorithms over synthetic
+# point sets, without Qt nor GL.
+#
+#-------------------------------------------------
+
+QT      -= core gui
+CONFIG  += console
+CONFIG  -= qt app_bundle
+
+TARGET = SierpinskiBench
+TEMPLATE = app
+
+include(mesh.pri)
+
+# The measures are done without the counters.
+DEFINES -= MESH_STATS
+
+INCLUDEPATH += sources/bench
+
+SOURCES += sources/bench/main.cpp \
+           sources/bench/generators.cpp
+
+HEADERS += sources/bench/generators.hpp
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Regression tests of the Mesh algorithms over
+# degenerate point sets, without Qt nor GL.
+#
+#-------------------------------------------------
+
+QT      -= core gui
+CONFIG  += console
+CONFIG  -= qt app_bundle
+
+TARGET = SierpinskiTests
+TEMPLATE = app
+
+include(mesh.pri)
+
+INCLUDEPATH += sources/bench
+
+SOURCES += sources/tests/main.cpp \
+           sources/bench/generators.cpp
+
+HEADERS += sources/bench/generators.hpp
@@ -6,6 +6,7 @@
 typedef enum {
     MESH,
     CURVE,
+    NN_CURVE,
     TRIANGULATION,
 	CONSTRAINTS
 } WhatIs_e;
@@ -33,14 +34,95 @@ struct DrawConfiguration final
 	}
 };
 
+/**
+ * @brief The copy of a Mesh inside the graphic card, as a vertex buffer and an index buffer.
+ * They are only uploaded again when the generation of the Mesh changed, so a paint
+ * doesn't cost more than a draw call.
+ * The buffers belong to a single MeshBuffers : it can be moved, not copied, and deletes them when destroyed.
+ * @warning Every method (but pack()) requires a current GL context, the destructor and the move assignment too
+ * once something is uploaded.
+ */
+class MeshBuffers final
+{
+	public:
+		MeshBuffers(void);
+		MeshBuffers(MeshBuffers&& other);
+		MeshBuffers& operator=(MeshBuffers&& other);
+		~MeshBuffers(void);
+		/**
+		 * @brief Upload \p mesh if it changed since the last upload.
+		 * @param[in] mesh The mesh to draw.
+		 */
+		void update(const Mesh& mesh);
+		/**
+		 * @brief Draw every triangle of the last uploaded mesh.
+		 */
+		void drawTriangles(void) const;
+		/**
+		 * @brief Draw the vertices [\p begin, \p end[ of the last uploaded mesh.
+		 * @param[in] begin The first vertex to draw.
+		 * @param[in] end   The index after the last vertex to draw.
+		 */
+		void drawPoints(uint32_t begin, uint32_t end) const;
+		/**
+		 * @brief Pack \p mesh into flat arrays, as it is sent to the graphic card.
+		 * @param[in]  mesh    The mesh to pack.
+		 * @param[out] coords  The x, y, z of each vertex.
+		 * @param[out] indexes The 3 vertex indexes of each triangle.
+		 */
+		static void pack(const Mesh& mesh, std::vector<float>& coords, std::vector<uint32_t>& indexes);
+		
+		//! @brief These functions are forbidden
+		MeshBuffers(const MeshBuffers& other)            = delete;
+		MeshBuffers& operator=(const MeshBuffers& other) = delete;
+		
+	private:
+		unsigned int vbo;        //!< The GL name of the vertex buffer, 0 before the first upload.
+		unsigned int ibo;        //!< The GL name of the index  buffer, 0 before the first upload.
+		uint64_t     generation; //!< The generation of the uploaded Mesh.
+		uint32_t     nbIndexes;  //!< How many indexes the index buffer has.
+		
+		//! @brief Delete the buffers, if any, back to the state before the first upload.
+		void release(void);
+};
+
 class Gasket
 {
     public:
         Gasket();
         Mesh mesh;
         void draw();
+		/**
+		 * @brief Allow \p count coarser versions of mesh, each one with half the triangles of the previous,
+		 * so a MESH can be displayed with less details. None is built yet, see switchLevelOfDetail().
+		 * @param[in] count The number of levels, 0 to only keep mesh.
+		 * @warning Requires a current GL context, to delete the buffers of the previous levels.
+		 */
+		void resetLevelsOfDetail(uint32_t count);
+		/**
+		 * @brief Display a coarser level of detail if \p step > 0, a finer one if \p step < 0.
+		 * The coarser levels are simplified the first time they're displayed.
+		 * @param[in] step How many levels to move.
+		 * @warning Requires a current GL context if mesh changed, to delete the buffers of the previous levels.
+		 */
+		void switchLevelOfDetail(int32_t step);
+		/**
+		 * @brief Replace mesh by a Sierpinski gasket, see Mesh::loadGasket(), without any level of detail.
+		 * @param[in] depth       The number of subdivisions.
+		 * @param[in] tetrahedral true for the 3D gasket, false for the 2D one.
+		 * @warning Requires a current GL context, to delete the buffers of the levels of detail.
+		 */
+		void generate(uint32_t depth, bool tetrahedral);
         
 		DrawConfiguration config;
+		
+	private:
+		MeshBuffers              buffers;
+		std::vector<Mesh>        details;           //!< The coarser versions of mesh, the finest first.
+		std::vector<MeshBuffers> detailBuffers;     //!< The buffers of each level of detail.
+		uint64_t                 detailsGeneration; //!< The generation of mesh the levels come from.
+		uint32_t                 maxDetails;        //!< The number of levels allowed, details has the ones built.
+		uint32_t                 detail;            //!< The displayed level, 0 for mesh itself.
 };
 
 #endif
@@ -23,6 +23,10 @@ protected:
 
 private:
     void drawSierpinski();
+	/**
+	 * @brief Log the triangle of the mesh under the pixel \p position, by a ray through the view.
+	 */
+	void pick(const QPoint& position);
 	double ZOOM;
     float _angle;
     QPoint _position;
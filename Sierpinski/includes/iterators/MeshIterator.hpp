@@ -2,14 +2,20 @@
  * @file MeshIterator.hpp
  * @brief Defines a template for a Mesh iterator (not circulator)
  * @author MLTCRBN
- * @version 0.2
+ * @version 0.3
+ *
+ * It's a random access iterator, usable with every algorithm of <algorithm> and with parallel::transform().
+ * It holds an index inside the container of the Mesh, not an address, so it stays valid when the container grows.
+ * A read only iterator and a read/write one over the same container can be compared and subtracted.
+ * A MeshSentinel is the end of a container whatever its size, for the loops which add elements to it.
  */
 #ifndef MESHITERATOR_HPP_INCLUDED
 #define MESHITERATOR_HPP_INCLUDED
 
 #include <vector>
-#include <exception>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <type_traits>
 
 #include "common.hpp"
@@ -18,127 +24,245 @@
 //! Previous declaration for friendship.
 class Mesh;
 class TopoTriangle;
+template<typename Content> class MeshSentinel;
 
 /**
  * @class MeshIterator
  * @brief This is a template to avoid code copy
  * It's all fine, I'll just have to typedef some of them :D
+ * \b Content is Vertex or TopoTriangle, const for a read only iterator.
  */
 template<typename Content>
 class MeshIterator final
 {
 	private:
-		static_assert(std::is_same<Content, Vertex>::value || std::is_same<Content, TopoTriangle>::value, "Content must be Vertex3Df or TopoTriangle");
+		typedef typename std::remove_const<Content>::type Value_t; //!< The content, without its const.
+		static_assert(std::is_same<Value_t, Vertex>::value || std::is_same<Value_t, TopoTriangle>::value, "Content must be Vertex3Df or TopoTriangle");
 		friend class Mesh;
-		typedef std::vector<Content>* Data_ptr; //!< To simplify rewrite of cod eif this type change.
-		
-		Data_ptr data;    //!< A pointer to the vector of data.
-		int32_t  counter; //!< A counter to know where you are on the vector.
-		
+		template<typename Other> friend class MeshIterator;
+		friend class MeshSentinel<Value_t>;
+		//! Enables a function for the iterators over the same content as this one, const or not.
+		template<typename Other, typename Result>
+		using IfSame_t = typename std::enable_if<std::is_same<typename std::remove_const<Other>::type, Value_t>::value, Result>::type;
+		//! To simplify rewrite of code if this type change.
+		typedef typename std::conditional<std::is_const<Content>::value, const std::vector<Value_t>*, std::vector<Value_t>*>::type Data_ptr;
+
+		Data_ptr       data;    //!< A pointer to the vector of data.
+		std::ptrdiff_t counter; //!< A counter to know where you are on the vector.
+
 		/**
 		 * @brief A private constructor for the class Mesh
 		 * @param[in] container An address of the data vector.
 		 * @param[in] where     The point where you wanna start.
 		 */
-		MeshIterator(Data_ptr container, int32_t where) : data(container), counter(where){}
-	
+		MeshIterator(Data_ptr container, std::ptrdiff_t where) : data(container), counter(where){}
+
 	public:
+		// ## std::iterator_traits ###############################################
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef Value_t                         value_type;
+		typedef std::ptrdiff_t                  difference_type;
+		typedef Content*                        pointer;
+		typedef Content&                        reference;
+		// #######################################################################
+
 		//! @brief Create an invalid iterator.
 		MeshIterator(void) : MeshIterator(nullptr, 0){}
 		/**
-		 * @brief Create an iterator by copying \p other.
-		 * @param[in] other the iterator to copy.
+		 * @brief Create a read only iterator from a read/write one.
+		 * @param[in] other the iterator to convert.
 		 */
-		MeshIterator(const MeshIterator<Content>& other) : MeshIterator(other.data, other.counter){}
+		template<typename Other, typename = typename std::enable_if<std::is_same<const Other, Content>::value && !std::is_same<Other, Content>::value>::type>
+		MeshIterator(const MeshIterator<Other>& other) : MeshIterator(other.data, other.counter){}
+
+		/**
+		 * @brief Compare equality between \b this and \p other, read only or not.
+		 * @param[in] other the iterator to compare with.
+		 * @return true if they're equal, false otherwise.
+		 */
+		template<typename Other>
+		IfSame_t<Other, bool> operator==(const MeshIterator<Other>& other) const
+		{
+			return this->data == other.data && this->counter == other.counter;
+		}
 		/**
-		 * @brief Create an iterator by moving \p other.
-		 * @param[in] other the iterator to move.
+		 * @brief Compare inequality between \b this and \p other, read only or not.
+		 * @param[in] other the iterator to compare with.
+		 * @return false if they're equal, true otherwise.
 		 */
-		MeshIterator(MeshIterator&& other) : MeshIterator(other.data, other.counter)
+		template<typename Other>
+		IfSame_t<Other, bool> operator!=(const MeshIterator<Other>& other) const
+		{
+			return !(*this == other);
+		}
+		//! @brief Check if \b this is before \p other, both over the same container.
+		template<typename Other>
+		IfSame_t<Other, bool> operator<(const MeshIterator<Other>& other) const
 		{
-			other.data    = nullptr;
-			other.counter = -1;
+			return this->counter < other.counter;
 		}
-		
-		//! @brief Destroy this iterator.
-		~MeshIterator(void)
+		template<typename Other>
+		IfSame_t<Other, bool> operator>(const MeshIterator<Other>& other) const
 		{
-			this->data    = nullptr;
-			this->counter = 0;
+			return other < *this;
+		}
+		template<typename Other>
+		IfSame_t<Other, bool> operator<=(const MeshIterator<Other>& other) const
+		{
+			return !(other < *this);
+		}
+		template<typename Other>
+		IfSame_t<Other, bool> operator>=(const MeshIterator<Other>& other) const
+		{
+			return !(*this < other);
 		}
-		
 		/**
-		 * @brief Affect \p other to \b this by copy.
-		 * @param[in] other the iterator to copy.
-		 * @return A reference to \b this.
+		 * @brief PreIncrement this iterator
+		 * @return The current iterator.
 		 */
-		MeshIterator& operator=(const MeshIterator<Content>& other)
+		MeshIterator& operator++(void)
 		{
-			this->data    = other.data;
-			this->counter = other.counter;
+			++this->counter;
 			return *this;
 		}
 		/**
-		 * @brief Affect \p other to \b this by move.
-		 * @param[in] other the iterator to move.
-		 * @return A reference to \b this.
+		 * @brief PostIncrement this iterator
+		 * @return A copy before increment of this iterator.
 		 */
-		MeshIterator& operator=(MeshIterator<Content>&& other)
+		MeshIterator operator++(int)
 		{
-			*this = other;
-			other.data    = nullptr;
-			other.counter = -1;
-			return *this;
+			MeshIterator<Content> copy = *this;
+			++this->counter;
+			return copy;
 		}
 		/**
-		 * @brief Compare equality between \b this and \p other.
-		 * @param[in] other the iterator to compare with.
-		 * @return true if they're equal, false otherwise.
+		 * @brief PreDecrement this iterator
+		 * @return The current iterator.
 		 */
-		bool operator==(const MeshIterator<Content>& other)
+		MeshIterator& operator--(void)
 		{
-			return this->data == other.data && this->counter == other.counter;
+			--this->counter;
+			return *this;
 		}
 		/**
-		 * @brief Compare inequality between \b this and \p other.
-		 * @param[in] other the iterator to compare with.
-		 * @return false if they're equal, true otherwise.
+		 * @brief PostDecrement this iterator
+		 * @return A copy before decrement of this iterator.
 		 */
-		bool operator!=(const MeshIterator<Content>& other)
+		MeshIterator operator--(int)
 		{
-			return !(*this == other);
+			MeshIterator<Content> copy = *this;
+			--this->counter;
+			return copy;
 		}
 		/**
-		 * @brief PreIncrement this iterator
+		 * @brief Move this iterator \p n elements forward (backward if \p n < 0).
 		 * @return The current iterator.
 		 */
-		MeshIterator& operator++(void)
+		MeshIterator& operator+=(difference_type n)
 		{
-			++this->counter;
+			this->counter += n;
 			return *this;
 		}
+		MeshIterator& operator-=(difference_type n)
+		{
+			this->counter -= n;
+			return *this;
+		}
+		MeshIterator operator+(difference_type n) const
+		{
+			return MeshIterator<Content>(this->data, this->counter + n);
+		}
+		friend MeshIterator operator+(difference_type n, const MeshIterator<Content>& it)
+		{
+			return it + n;
+		}
+		MeshIterator operator-(difference_type n) const
+		{
+			return MeshIterator<Content>(this->data, this->counter - n);
+		}
 		/**
-		 * @brief PostIncrement this iterator
-		 * @return A copy before increment of this iterator.
+		 * @brief Get the number of elements between \p other and \b this.
+		 * @param[in] other An iterator over the same container.
 		 */
-		MeshIterator operator++(int i)
+		template<typename Other>
+		IfSame_t<Other, difference_type> operator-(const MeshIterator<Other>& other) const
 		{
-			MeshIterator<Content> copy = *this;
-			++this->counter;
-			return copy;
+			return this->counter - other.counter;
 		}
 		/**
 		 * @brief Dereference this iterator
 		 * @return The value this iterator is working with
-		 * @throw std::range_error if you're using a bad iterator.
+		 * @pre This iterator is between the beginning and the end (excluded) of its container,
+		 * it isn't checked, like for the iterators of std::vector.
+		 */
+		reference operator*(void) const
+		{
+			return (*this->data)[this->counter];
+		}
+		pointer operator->(void) const
+		{
+			return &(*this->data)[this->counter];
+		}
+		/**
+		 * @brief Dereference the element \p n elements after this one.
+		 * @pre Same as operator*().
+		 */
+		reference operator[](difference_type n) const
+		{
+			return (*this->data)[this->counter + n];
+		}
+};
+
+/**
+ * @class MeshSentinel
+ * @brief The end of the vertices or of the triangles of a Mesh, whatever their number when it's compared :
+ * a loop up to it also visits the elements added by the loop itself, which an end iterator would stop before.
+ * \b Content is Vertex or TopoTriangle, it compares with the read only iterators and the read/write ones.
+ */
+template<typename Content>
+class MeshSentinel final
+{
+	private:
+		static_assert(!std::is_const<Content>::value, "A sentinel only reads the size, it has no const variant");
+		friend class Mesh;
+		//! Enables a function for the iterators over the content of this sentinel, const or not.
+		template<typename Other, typename Result>
+		using IfSame_t = typename std::enable_if<std::is_same<typename std::remove_const<Other>::type, Content>::value, Result>::type;
+
+		const std::vector<Content>* data; //!< A pointer to the vector of data.
+
+		//! @brief A private constructor for the class Mesh.
+		explicit MeshSentinel(const std::vector<Content>* container) : data(container){}
+		/**
+		 * @brief Check if \p it reached the current end of its container.
+		 * @pre \p it is over the container of this sentinel.
 		 */
-		Content& operator*(void)
+		template<typename Other>
+		bool reachedBy(const MeshIterator<Other>& it) const
+		{
+			return it.counter >= static_cast<std::ptrdiff_t>(this->data->size());
+		}
+
+	public:
+		template<typename Other>
+		friend IfSame_t<Other, bool> operator==(const MeshIterator<Other>& it, const MeshSentinel<Content>& end)
+		{
+			return end.reachedBy(it);
+		}
+		template<typename Other>
+		friend IfSame_t<Other, bool> operator!=(const MeshIterator<Other>& it, const MeshSentinel<Content>& end)
+		{
+			return !end.reachedBy(it);
+		}
+		template<typename Other>
+		friend IfSame_t<Other, bool> operator==(const MeshSentinel<Content>& end, const MeshIterator<Other>& it)
+		{
+			return end.reachedBy(it);
+		}
+		template<typename Other>
+		friend IfSame_t<Other, bool> operator!=(const MeshSentinel<Content>& end, const MeshIterator<Other>& it)
 		{
-			if (this->data == nullptr || this->counter < 0 || this->counter >= (int32_t)this->data->size())
-			{
-				throw std::range_error("Bad iterator");
-			}
-			return this->data->at(this->counter);
+			return !end.reachedBy(it);
 		}
 };
 
@@ -0,0 +1,72 @@
+/**
+ * @file MeshRange.hpp
+ * @brief Defines a view over the vertices or the triangles of a Mesh, to give them to an algorithm at once.
+ * @author MTLCRBN
+ * @version 1.0
+ */
+#ifndef MESHRANGE_HPP_INCLUDED
+#define MESHRANGE_HPP_INCLUDED
+
+#include <cstddef>
+#include "MeshIterator.hpp"
+
+/**
+ * @class MeshRange
+ * @brief A pair of MeshIterator, usable by a range based for, or by parallel::transform().
+ * Like its iterators, it stays valid when the container grows, but keeps its old end.
+ */
+template<typename Content>
+class MeshRange final
+{
+	public:
+		typedef MeshIterator<Content>              iterator;       //!< The iterators of this range.
+		typedef typename iterator::value_type      value_type;     //!< Vertex or TopoTriangle.
+		typedef MeshIterator<const value_type>     const_iterator; //!< The read only iterators of this range.
+		typedef typename iterator::difference_type difference_type;
+		typedef typename iterator::reference       reference;
+		typedef std::size_t                        size_type;
+
+		/**
+		 * @brief Create the range [\p first, \p last[.
+		 */
+		MeshRange(iterator first, iterator last) : first(first), last(last){}
+
+		iterator begin(void) const
+		{
+			return this->first;
+		}
+		iterator end(void) const
+		{
+			return this->last;
+		}
+		const_iterator cbegin(void) const
+		{
+			return this->first;
+		}
+		const_iterator cend(void) const
+		{
+			return this->last;
+		}
+		//! @return The number of elements inside this range.
+		size_type size(void) const
+		{
+			return this->last - this->first;
+		}
+		bool empty(void) const
+		{
+			return this->first == this->last;
+		}
+		/**
+		 * @brief Access the element \p i of this range, without any check.
+		 */
+		reference operator[](size_type i) const
+		{
+			return this->first[i];
+		}
+
+	private:
+		iterator first; //!< The first element.
+		iterator last;  //!< After the last element.
+};
+
+#endif
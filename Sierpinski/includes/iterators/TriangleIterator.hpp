@@ -2,7 +2,7 @@
  * @file TriangleIterator.hpp
  * @brief Offers an iterator to iterate through the triangles of a Mesh
  * @author MTLCRBN
- * @version 2.0
+ * @version 2.1
  */
 #ifndef TRIANGLEITERATOR_HPP_INCLUDED
 #define TRIANGLEITERATOR_HPP_INCLUDED
@@ -12,5 +12,7 @@
 
 //! Defines an iterator on triangles :D
 typedef MeshIterator<TopoTriangle> _TriangleIterator;
+//! Defines a read only iterator on triangles.
+typedef MeshIterator<const TopoTriangle> _ConstTriangleIterator;
 
 #endif
@@ -2,7 +2,7 @@
  * @file VertexIterator.hpp
  * @brief Offers an iterator to iterate through the vertices of a Mesh
  * @author MTLCRBN
- * @version 2.0
+ * @version 2.1
  */
 #ifndef VERTEXITERATOR_HPP_INCLUDED
 #define VERTEXITERATOR_HPP_INCLUDED
@@ -12,5 +12,7 @@
 
 //! Defines an iterator on vertices :D
 typedef MeshIterator<Vertex> _VertexIterator;
+//! Defines a read only iterator on vertices.
+typedef MeshIterator<const Vertex> _ConstVertexIterator;
 
 #endif
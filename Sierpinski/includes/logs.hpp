@@ -2,13 +2,14 @@
  * @file logs.hpp
  * @brief This file provides some functions to log some information.
  * 
- * It requires -std=c++11, or any further standard version, in order to compile.<br />
+ * It requires -std=c++11, or any further standard version, in order to compile, and -pthread to link.<br />
+ * The lines are formatted by the calling thread, then written by a background one, so any thread can log.<br />
  * To build up documentation, just run :
  * @code
  * doxygen Doxyfile
  * @endcode
  * @author MTLCRBN
- * @version 1.2
+ * @version 1.3
  * @date The 12th of December 2016
  */
 #ifndef LOGS_HPP_INCLUDED
@@ -19,6 +20,14 @@
 #include <ctime>       // For ctime(), time_t
 #include <string>      // For std::string
 #include <cassert>     // For assert() statement
+#include <atomic>      // For std::atomic
+#include <condition_variable> // For std::condition_variable
+#include <cstdint>     // For uint64_t, intptr_t
+#include <cstdlib>     // For std::atexit()
+#include <memory>      // For std::unique_ptr
+#include <mutex>       // For std::mutex
+#include <sstream>     // For std::ostringstream
+#include <thread>      // For std::thread
 
 #ifndef DECLSPEC
 	#if defined(__WIN32__) || defined(__WINRT__)
@@ -34,6 +43,19 @@
 	#endif
 #endif
 
+/*
+ * The lowest level which is logged, the calls of the levels below it are compiled out : their arguments are
+ * still evaluated by the caller (see defer()), but nothing else remains.
+ * Define MTL_LOG_LEVEL before including this file, or with -DMTL_LOG_LEVEL=2 for instance.
+ */
+#define MTL_LOG_LEVEL_INFO    0 //!< Everything is logged.
+#define MTL_LOG_LEVEL_WARNING 1 //!< Only warning() and error().
+#define MTL_LOG_LEVEL_ERROR   2 //!< Only error().
+#define MTL_LOG_LEVEL_NONE    3 //!< Nothing at all.
+#ifndef MTL_LOG_LEVEL
+	#define MTL_LOG_LEVEL MTL_LOG_LEVEL_INFO
+#endif
+
 #ifndef UNUSED
 	#ifdef __GNUC__
 		#define UNUSED(var) __attribute__((unused)) var
@@ -103,25 +125,33 @@ namespace mtl
 		template<typename... Args>
 		DECLSPEC void warning(const Args&... args) noexcept;
 		
+		/**
+		 * @brief Wait until every log line already asked is written into its std::ostream, and flushed.<br />
+		 * Call it before destroying, or reading, a std::ostream given to \b OUT.
+		 */
+		DECLSPEC inline void flush(void) noexcept;
+		
 		namespace __details
 		{
 			class _Logger;
+			class _Writer;
 			
 			/*
 			 * This class allow to instanciate static variable member directly on the header, by playing with templates.
 			 * You don't have to mess with this class.
 			 * No doxygen commentary block, because I don't want to parse this class for the documentation.
+			 * The parameters are atomic, so any thread can read them while another one changes them.
 			 */
 			template<typename T>
 			class __Static_declarer
 			{
 				public:
-					static bool          ENABLE_HORODATING; //!< If you want the date with every line of log,   \b false      by default.
-					static bool          ENABLE_LOG;        //!< If you want to switch on the logs,             \b true       by default.
-					static bool          ENABLE_COLOR;      //!< If you want some colors with the tags,         \b false      by default.
-					static bool          ENABLE_SPACING;    //!< If you want a space between each argument,     \b true       by default.
-					static std::ostream* OUT;               //!< The std::ostream use to put logs,              \b &std::cout by default.
-					static bool          ALPHA_BOOL;        //!< If you want the boolean to be display as text, \b true       by default.
+					static std::atomic<bool>          ENABLE_HORODATING; //!< If you want the date with every line of log,   \b false      by default.
+					static std::atomic<bool>          ENABLE_LOG;        //!< If you want to switch on the logs,             \b true       by default.
+					static std::atomic<bool>          ENABLE_COLOR;      //!< If you want some colors with the tags,         \b false      by default.
+					static std::atomic<bool>          ENABLE_SPACING;    //!< If you want a space between each argument,     \b true       by default.
+					static std::atomic<std::ostream*> OUT;               //!< The std::ostream use to put logs,              \b &std::cout by default.
+					static std::atomic<bool>          ALPHA_BOOL;        //!< If you want the boolean to be display as text, \b true       by default.
 				
 				private:
 					static const char* C_YELLOW; //!< The code for "yellow + bold"   with xterm.
@@ -130,6 +160,7 @@ namespace mtl
 					static const char* C_BLANK;  //!< The code for "normal settings" with xterm.
 					
 					friend class _Logger;
+					friend class _Writer;
 					template<typename... Args> friend void mtl::log::error  (const Args&... args) noexcept;
 					template<typename... Args> friend void mtl::log::info   (const Args&... args) noexcept;
 					template<typename... Args> friend void mtl::log::warning(const Args&... args) noexcept;
@@ -137,16 +168,16 @@ namespace mtl
 				
 			};
 			// Set every parameter to there default values.
-			template<typename T> bool          __Static_declarer<T>::ENABLE_HORODATING = false;
-			template<typename T> bool          __Static_declarer<T>::ENABLE_LOG        = true;
-			template<typename T> bool          __Static_declarer<T>::ENABLE_COLOR      = false;
-			template<typename T> bool          __Static_declarer<T>::ENABLE_SPACING    = true;
-			template<typename T> bool          __Static_declarer<T>::ALPHA_BOOL        = true;
-			template<typename T> std::ostream* __Static_declarer<T>::OUT               = &std::cout;
-			template<typename T> const char*   __Static_declarer<T>::C_YELLOW          = "\033[1;33m";
-			template<typename T> const char*   __Static_declarer<T>::C_RED             = "\033[1;31m";
-			template<typename T> const char*   __Static_declarer<T>::C_GREEN           = "\033[1;32m";
-			template<typename T> const char*   __Static_declarer<T>::C_BLANK           = "\033[0m";
+			template<typename T> std::atomic<bool>          __Static_declarer<T>::ENABLE_HORODATING(false);
+			template<typename T> std::atomic<bool>          __Static_declarer<T>::ENABLE_LOG(true);
+			template<typename T> std::atomic<bool>          __Static_declarer<T>::ENABLE_COLOR(false);
+			template<typename T> std::atomic<bool>          __Static_declarer<T>::ENABLE_SPACING(true);
+			template<typename T> std::atomic<bool>          __Static_declarer<T>::ALPHA_BOOL(true);
+			template<typename T> std::atomic<std::ostream*> __Static_declarer<T>::OUT(&std::cout);
+			template<typename T> const char*                __Static_declarer<T>::C_YELLOW = "\033[1;33m";
+			template<typename T> const char*                __Static_declarer<T>::C_RED    = "\033[1;31m";
+			template<typename T> const char*                __Static_declarer<T>::C_GREEN  = "\033[1;32m";
+			template<typename T> const char*                __Static_declarer<T>::C_BLANK  = "\033[0m";
 		}
 		
 		/**
@@ -155,6 +186,7 @@ namespace mtl
 		 * because it may causes issues while parsing these files later.
 		 * @warning \b Colors are provide by using \b xterm standards, it may not work for other shells.
 		 * @warning \b OUT may be an usable and valid \b std::ostream, there is no warranty if you mess up with that.
+		 * The lines are written later by another thread : call flush() before destroying it.
 		 * 
 		 * Some examples :
 		 * @code
@@ -196,6 +228,19 @@ namespace mtl
 				_HoldOn& operator=(const _HoldOn& other) = delete;
 				_HoldOn& operator=(_HoldOn&& other)      = delete;
 			};
+			/*
+			 * Wraps a function whose result is only computed if the line is really logged, see defer().
+			 */
+			template<typename Function>
+			struct _Deferred final
+			{
+				Function function;
+			};
+			template<typename Function>
+			std::ostream& operator<<(std::ostream& out, const _Deferred<Function>& deferred)
+			{
+				return out << deferred.function();
+			}
 			//! @cond HIDE_THIS_DOXYGEN
 			// All different states for a log channel such as info, error, warning.
 			typedef enum
@@ -215,204 +260,453 @@ namespace mtl
 			//! @endcond
 			
 			/*
-			 * Embeds the channels states.
-			 * As usual, don't even try to use it raw, this is pointless.
+			 * A call to error(), warning() or info(), with its arguments already formatted, and the options of the moment.
+			 * No doxygen commentary block, because I don't want to parse this class for the documentation.
 			 */
-			template<typename Foo>
-			struct __States_declarer
+			struct _Record final
 			{
-				protected:
-					static _flags_e   info_f;    //!< The state of the info    channel.
-					static _flags_e   warning_f; //!< The state of the warning channel.
-					static _flags_e   error_f;   //!< The state of the error   channel.
-					static _current_e curr_c;    //!< Which channel is used.
-					static bool       isHolding; //!< To indicate if the current input beg for holding on.
-					__States_declarer(void) = delete;
+				_current_e    channel = INFO;
+				bool          enabled = false;   //!< ENABLE_LOG, at the time of the call.
+				bool          color   = false;   //!< ENABLE_COLOR.
+				bool          spacing = true;    //!< ENABLE_SPACING.
+				bool          holding = false;   //!< If a hold_on tag was among the arguments.
+				std::ostream* out     = nullptr; //!< OUT.
+				std::string   date;              //!< Empty without ENABLE_HORODATING.
+				std::string   text;              //!< Every argument, with their spaces.
 			};
 			
-			// States initialisation.
-			template<typename Foo> _flags_e   __States_declarer<Foo>::info_f    = NOTHING;
-			template<typename Foo> _flags_e   __States_declarer<Foo>::error_f   = NOTHING;
-			template<typename Foo> _flags_e   __States_declarer<Foo>::warning_f = NOTHING;
-			template<typename Foo> _current_e __States_declarer<Foo>::curr_c    = INFO;
-			template<typename Foo> bool       __States_declarer<Foo>::isHolding = false;
+			/*
+			 * A bounded queue, where any thread pushes and any thread pops without lock (Dmitry Vyukov's algorithm) :
+			 * each cell has a sequence number which says if it is ready to be written, or to be read.
+			 * No doxygen commentary block, because I don't want to parse this class for the documentation.
+			 */
+			template<typename T, std::size_t N>
+			class _Ring final
+			{
+				static_assert((N & (N - 1)) == 0, "The size of a _Ring must be a power of 2");
+				public:
+					_Ring(void) : cells(new Cell[N]), head(0), tail(0)
+					{
+						for(std::size_t i=0;i<N;++i)
+						{
+							this->cells[i].sequence.store(i, std::memory_order_relaxed);
+						}
+					}
+					//! @return false if the queue is full.
+					bool push(T&& value) noexcept
+					{
+						std::size_t position = this->head.load(std::memory_order_relaxed);
+						while(true)
+						{
+							Cell&    cell     = this->cells[position & (N - 1)];
+							intptr_t sequence = cell.sequence.load(std::memory_order_acquire);
+							intptr_t diff     = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+							if (diff == 0)
+							{
+								if (this->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+								{
+									cell.value = std::move(value);
+									cell.sequence.store(position + 1, std::memory_order_release);
+									return true;
+								}
+							}
+							else if (diff < 0)
+							{
+								return false;
+							}
+							else
+							{
+								position = this->head.load(std::memory_order_relaxed);
+							}
+						}
+					}
+					//! @return false if the queue is empty.
+					bool pop(T& value) noexcept
+					{
+						std::size_t position = this->tail.load(std::memory_order_relaxed);
+						while(true)
+						{
+							Cell&    cell     = this->cells[position & (N - 1)];
+							intptr_t sequence = cell.sequence.load(std::memory_order_acquire);
+							intptr_t diff     = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+							if (diff == 0)
+							{
+								if (this->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+								{
+									value = std::move(cell.value);
+									cell.sequence.store(position + N, std::memory_order_release);
+									return true;
+								}
+							}
+							else if (diff < 0)
+							{
+								return false;
+							}
+							else
+							{
+								position = this->tail.load(std::memory_order_relaxed);
+							}
+						}
+					}
+				private:
+					struct Cell final
+					{
+						std::atomic<std::size_t> sequence;
+						T                        value;
+					};
+					// The producers and the consumer don't share a cache line (without alignas, so new stays valid in c++11).
+					std::unique_ptr<Cell[]>  cells;
+					char                     padding1[64];
+					std::atomic<std::size_t> head; //!< Where the next push goes.
+					char                     padding2[64];
+					std::atomic<std::size_t> tail; //!< Where the next pop  comes from.
+			};
 			
 			/*
-			 * This class protects the common part of error(), warning() and info().
+			 * The thread which writes the records, in the order they were pushed.
+			 * It's the only one to know the states of the channels, so hold_on() behaves as if every call was written at once.
+			 * It lives until the end of the program : at exit, the remaining records are written, and the further
+			 * ones are written by their caller.
 			 * You cannot mess with this class, sorry.
 			 * No doxygen commentary block, because I don't want to parse this class for the documentation.
 			 */
-			class _Logger final : public __States_declarer<_Logger>
+			class _Writer final
 			{
+				public:
+					static _Writer& instance(void) noexcept
+					{
+						// Never destroyed : some static objects may log from their destructor, after stop().
+						static _Writer* writer = new _Writer();
+						return *writer;
+					}
+					void push(_Record&& record) noexcept
+					{
+						if (this->stopped.load())
+						{
+							std::lock_guard<std::mutex> lock(this->mutex);
+							this->drain();
+							this->write(record);
+							record.out->flush();
+							return;
+						}
+						while(!this->ring.push(std::move(record)))
+						{
+							if (this->stopped.load())
+							{
+								// Full, and nobody left to empty it.
+								std::lock_guard<std::mutex> lock(this->mutex);
+								this->drain();
+								continue;
+							}
+							this->wake();
+							std::this_thread::yield(); // Full, the writer is late.
+						}
+						this->pushed.fetch_add(1);
+						if (this->stopped.load())
+						{
+							// The writer may have ended before this record was there.
+							std::lock_guard<std::mutex> lock(this->mutex);
+							this->drain();
+							return;
+						}
+						if (this->sleeping.load())
+						{
+							this->wake();
+						}
+					}
+					void flush(void) noexcept
+					{
+						uint64_t target = this->pushed.load();
+						while(this->written.load() < target && !this->stopped.load())
+						{
+							this->wake();
+							std::this_thread::yield();
+						}
+					}
 				private:
-					_Logger(void) = delete;
-					template<typename... Args> friend void mtl::log::error  (const Args&... args) noexcept;
-					template<typename... Args> friend void mtl::log::info   (const Args&... args) noexcept;
-					template<typename... Args> friend void mtl::log::warning(const Args&... args) noexcept;
+					static const std::size_t CAPACITY = 4096; //!< The records waiting at most, before the callers wait.
 					
-					/**
-					 * @brief Terminal case, this function is call when there is no more arguments.<br />
-					 * So, at the end, it displays a newline.
-					 */
-					static void _print_(void) noexcept
+					_Ring<_Record, CAPACITY> ring;
+					std::atomic<uint64_t>    pushed;
+					std::atomic<uint64_t>    written;
+					std::atomic<bool>        sleeping;
+					std::atomic<bool>        stopping;
+					std::atomic<bool>        stopped;
+					std::mutex               mutex;
+					std::condition_variable  condition;
+					_flags_e                 info_f    = NOTHING; //!< The state of the info    channel.
+					_flags_e                 warning_f = NOTHING; //!< The state of the warning channel.
+					_flags_e                 error_f   = NOTHING; //!< The state of the error   channel.
+					_current_e               curr_c    = INFO;    //!< Which channel is used.
+					std::thread              thread;
+					
+					_Writer(void) : pushed(0), written(0), sleeping(false), stopping(false), stopped(false)
 					{
-						if (_Logger::isHolding)
+						this->thread = std::thread(&_Writer::run, this);
+						std::atexit([](){_Writer::instance().stop();});
+					}
+					void wake(void) noexcept
+					{
+						std::lock_guard<std::mutex> lock(this->mutex);
+						this->condition.notify_one();
+					}
+					void stop(void) noexcept
+					{
+						this->stopping.store(true);
+						this->wake();
+						if (this->thread.joinable())
 						{
-							_Logger::isHolding = false;
-							*mtl::log::Options::OUT << std::flush;
+							this->thread.join();
 						}
-						else
+						this->stopped.store(true);
+						// The records pushed after the last check of the writer.
+						std::lock_guard<std::mutex> lock(this->mutex);
+						this->drain();
+					}
+					//! @brief Write every record left inside the ring, once the writer stopped, under the mutex.
+					void drain(void) noexcept
+					{
+						_Record record;
+						while(this->ring.pop(record))
+						{
+							this->write(record);
+							record.out->flush();
+						}
+					}
+					void run(void) noexcept
+					{
+						uint64_t popped = 0;
+						_Record  record;
+						while(true)
+						{
+							std::ostream* last  = nullptr;
+							uint64_t      batch = 0;
+							while(this->ring.pop(record))
+							{
+								if (last != nullptr && last != record.out)
+								{
+									last->flush();
+								}
+								this->write(record);
+								last = record.out;
+								++batch;
+							}
+							// A single flush for every line available, instead of one std::endl per line.
+							if (last != nullptr)
+							{
+								last->flush();
+							}
+							popped += batch;
+							this->written.store(popped);
+							if (batch != 0)
+							{
+								continue;
+							}
+							if (this->stopping.load() && this->pushed.load() == popped)
+							{
+								return;
+							}
+							std::unique_lock<std::mutex> lock(this->mutex);
+							this->sleeping.store(true);
+							this->condition.wait_for(lock, std::chrono::milliseconds(100), [&](){
+								return this->pushed.load() != popped || this->stopping.load();
+							});
+							this->sleeping.store(false);
+						}
+					}
+					_flags_e& flag(_current_e c) noexcept
+					{
+						switch(c)
 						{
-							*mtl::log::Options::OUT << std::endl;
+							case WARNING:
+								return this->warning_f;
+							case ERROR:
+								return this->error_f;
+							default:
+								return this->info_f;
 						}
 					}
 					/**
 					 * @brief Changes the state of \b f if the current value is HOLD.
-					 * @param[in,out] f The current flag to check.
+					 * @param[in,out] f   The current flag to check.
+					 * @param[in]     out Where the held line is.
 					 */
-					static void changeState(_flags_e& f) noexcept
+					static void changeState(_flags_e& f, std::ostream& out) noexcept
 					{
 						if (f == HOLD)
 						{
-							*mtl::log::Options::OUT << std::endl;
+							out << '\n';
 							f = SKIP;
 						}
 					}
 					/**
 					 * @brief Change the curr_c parameter and manage flags.
-					 * @param c The new channel you're using.
+					 * @param c   The new channel you're using.
+					 * @param out Where the held lines are.
 					 */
-					static void setCurrent(const _current_e c) noexcept
+					void setCurrent(const _current_e c, std::ostream& out) noexcept
 					{
-						if (c != _Logger::curr_c)
+						if (c != this->curr_c)
 						{
-							_Logger::changeState(info_f);
-							_Logger::changeState(error_f);
-							_Logger::changeState(warning_f);
-							_Logger::curr_c = c;
+							_Writer::changeState(this->info_f,    out);
+							_Writer::changeState(this->error_f,   out);
+							_Writer::changeState(this->warning_f, out);
+							this->curr_c = c;
 						}
 					}
+					//! @brief Write the arguments of \b record, then a newline unless a hold_on tag was among them.
+					void body(const _Record& record) noexcept
+					{
+						*record.out << record.text;
+						if (record.holding)
+						{
+							this->flag(this->curr_c) = HOLD;
+						}
+						else
+						{
+							*record.out << '\n';
+						}
+					}
+					//! @brief Write the tag of \b record at the beginning of the line, with the color \b color.
+					static void header(const _Record& record) noexcept
+					{
+						static const char* const tags[]   = {"ERROR  ", "WARNING", "INFO   "};
+						static const char* const colors[] = {Options::C_RED, Options::C_YELLOW, Options::C_GREEN};
+						std::ostream&            out      = *record.out;
+						out << '[';
+						if (record.color)
+						{
+							out << colors[record.channel];
+						}
+						out << tags[record.channel];
+						if (record.color)
+						{
+							out << Options::C_BLANK;
+						}
+						if (!record.date.empty())
+						{
+							out << ", " << record.date;
+						}
+						out << "] :";
+						if (!record.spacing)
+						{
+							out << ' ';
+						}
+					}
+					void write(const _Record& record) noexcept
+					{
+						_flags_e& f = this->flag(record.channel);
+						if (f == NOTHING)
+						{
+							this->setCurrent(record.channel, *record.out);
+							if (record.enabled)
+							{
+								_Writer::header(record);
+								this->body(record);
+							}
+						}
+						else if(f == HOLD)
+						{
+							f = NOTHING;
+							this->body(record);
+						}
+						else
+						{
+							f = NOTHING;
+						}
+					}
+			};
+			
+			/*
+			 * This class protects the common part of error(), warning() and info() : it formats the arguments
+			 * on the calling thread, then gives them to the _Writer.
+			 * You cannot mess with this class, sorry.
+			 * No doxygen commentary block, because I don't want to parse this class for the documentation.
+			 */
+			class _Logger final
+			{
+				private:
+					_Logger(void) = delete;
+					template<typename... Args> friend void mtl::log::error  (const Args&... args) noexcept;
+					template<typename... Args> friend void mtl::log::info   (const Args&... args) noexcept;
+					template<typename... Args> friend void mtl::log::warning(const Args&... args) noexcept;
+					
+					//! @brief Terminal case, this function is call when there is no more arguments.
+					static void _print_(UNUSED(std::ostream& out), UNUSED(_Record& record)) noexcept
+					{
+					}
 					/**
-					 * @brief General case, it will display the head of the \b args list \b a, and make a recursive call
+					 * @brief General case, it will format the head of the \b args list \b a, and make a recursive call
 					 * with the rest of the list.
 					 * @param[in] a    The current argument to display, of any type.
 					 * @param[in] args The rest of the argument list.
 					 */
 					template<typename Actual, typename... Args>
-					static void _print_(const Actual& a, const Args&... args) noexcept
+					static void _print_(std::ostream& out, _Record& record, const Actual& a, const Args&... args) noexcept
 					{
-						if (mtl::log::Options::ENABLE_SPACING)
+						if (record.spacing)
 						{
-							*mtl::log::Options::OUT << ' ';
+							out << ' ';
 						}
-						*mtl::log::Options::OUT << a;
-						_Logger::_print_(args...);
+						out << a;
+						_Logger::_print_(out, record, args...);
 					}
 					/**
-					 * @brief Specific case, encountering the hold_on tag end the recursion prematuraly.
+					 * @brief Specific case, encountering the hold_on tag : the line will wait for the next call.
 					 * @param[in] tag  The hold_on tag, just here to catch this case (unused actually).
 					 * @param[in] args The rest of the argument list.
 					 */
 					template<typename... Args>
-					static void _print_(UNUSED(const _HoldOn& tag), const Args&... args) noexcept
+					static void _print_(std::ostream& out, _Record& record, UNUSED(const _HoldOn& tag), const Args&... args) noexcept
 					{
 						#ifndef __GNUC__
 							// Nah, I'm such a nice guy, you won't get any warning.
 							(void)tag;
 						#endif
-						_Logger::isHolding = true;
-						switch(_Logger::curr_c)
-						{
-							case WARNING:
-								_Logger::warning_f = HOLD;
-								break;
-							case ERROR:
-								_Logger::error_f = HOLD;
-								break;
-							default:
-								_Logger::info_f = HOLD;
-						}
-						_Logger::_print_(args...);
+						record.holding = true;
+						_Logger::_print_(out, record, args...);
 					}
 					//! @brief Ensures the validity of \b OUT.
-					static void assertValidity(void) noexcept
+					static void assertValidity(UNUSED(std::ostream* out)) noexcept
 					{
-						assert(mtl::log::Options::OUT != nullptr && "OUT must not be nullptr !");
-						assert(mtl::log::Options::OUT->good()    && "OUT must be a \"good()\" std::ostream* !");
+						assert(out != nullptr && "OUT must not be nullptr !");
+						assert(out->good()    && "OUT must be a \"good()\" std::ostream* !");
 					}
 					/**
-					 * @brief Start to read the argument list \b args, displays the tag \b tag with the specified color \b color.
-					 * The color appears only if \b ENABLE_COLOR is set to true.
-					 * @param[in] tag   The text to display inside the tag at the beginning of the line.
-					 * @param[in] color The color code to use when the tag is display.
-					 * @param[in] args  The argument list.
+					 * @brief Format the argument list \b args with the options of the moment, and queue them.
+					 * When the logs are disabled, nothing is formatted, but the call still counts for hold_on().
+					 * @param[in] c    The channel of this call.
+					 * @param[in] args The argument list.
 					 * @pre \b OUT must not be nullptr.
 					 * @pre \b OUT must be a valid std::ostream (OUT->good() must return true).
 					 */
 					template<typename... Args>
-					static void _start_print(const char *const tag, const char *const color, const Args&... args) noexcept
+					static void call(_current_e c, const Args&... args) noexcept
 					{
-						_Logger::assertValidity();
-						if (mtl::log::Options::ENABLE_LOG)
+						_Record record;
+						record.channel = c;
+						record.out     = mtl::log::Options::OUT.load();
+						record.enabled = mtl::log::Options::ENABLE_LOG.load();
+						_Logger::assertValidity(record.out);
+						if (record.enabled)
 						{
-							if (mtl::log::Options::ALPHA_BOOL)
-							{
-								*mtl::log::Options::OUT << std::boolalpha;
-							}
-							else
-							{
-								*mtl::log::Options::OUT << std::noboolalpha;
-							}
-							*mtl::log::Options::OUT << '[';
-							if (mtl::log::Options::ENABLE_COLOR)
-							{
-								*mtl::log::Options::OUT << color;
-							}
-							*mtl::log::Options::OUT << tag;
-							if (mtl::log::Options::ENABLE_COLOR)
-							{
-								*mtl::log::Options::OUT << ::mtl::log::Options::C_BLANK;
-							}
+							record.color   = mtl::log::Options::ENABLE_COLOR.load();
+							record.spacing = mtl::log::Options::ENABLE_SPACING.load();
 							if (mtl::log::Options::ENABLE_HORODATING)
 							{
 								time_t tt = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-								std::string date(ctime(&tt));
-								date.pop_back();
-								*mtl::log::Options::OUT << ", " << date;
+								record.date = ctime(&tt);
+								record.date.pop_back();
 							}
-							*mtl::log::Options::OUT << "] :";
-							if (!mtl::log::Options::ENABLE_SPACING)
-							{
-								*mtl::log::Options::OUT << ' ';
-							}
-							_Logger::_print_(args...);
-						}
-					}
-					/**
-					 * @brief Encapsulates a call to generalize this part.
-					 * @param[in]     v     The current value to affect at \b _Logger.
-					 * @param[in,out] f     The flag to manage.
-					 * @param[in]     tag   The tag you wanna display.
-					 * @param[in]     color The color of the tag.
-					 * @param[in]     args  Every argument to display.
-					 */
-					template<typename... Args>
-					static void call(_current_e v, _flags_e& f, const char *const tag, const char *const color, const Args&... args)
-					{
-						if (f == NOTHING)
-						{
-							_Logger::setCurrent(v);
-							_Logger::_start_print(tag, color, args...);
-						}
-						else if(f == HOLD)
-						{
-							f = NOTHING;
-							_Logger::_print_(args...);
-						}
-						else
-						{
-							f = NOTHING;
+							// Each thread reuses its own stream.
+							static thread_local std::ostringstream out;
+							out.str("");
+							out.clear();
+							out << (mtl::log::Options::ALPHA_BOOL ? std::boolalpha : std::noboolalpha);
+							_Logger::_print_(out, record, args...);
+							record.text = out.str();
 						}
+						_Writer::instance().push(std::move(record));
 					}
 			};
 			
@@ -435,20 +729,43 @@ namespace mtl
 		{
 			return __details::_HoldOn();
 		}
+		/**
+		 * @brief Wrap \b function, so it is only called if the line is really logged (\b ENABLE_LOG, and \b MTL_LOG_LEVEL).
+		 * @code
+		 * mtl::log::info("Smallest angle :", mtl::log::defer([&](){return mesh.computeQuality().smallestAngle;}));
+		 * @endcode
+		 * @param[in] function Any function without parameter, whose result accepts the \b << operator.
+		 * @return An argument for info(), warning() or error().
+		 */
+		template<typename Function>
+		DECLSPEC __details::_Deferred<Function> defer(Function function) noexcept
+		{
+			return __details::_Deferred<Function>{function};
+		}
 		template<typename... Args>
-		DECLSPEC void error(const Args&... args) noexcept
+		DECLSPEC void error(UNUSED(const Args&... args)) noexcept
 		{
-			__details::_Logger::call(__details::ERROR, __details::_Logger::error_f, "ERROR  ", Options::C_RED, args...);
+		#if MTL_LOG_LEVEL <= MTL_LOG_LEVEL_ERROR
+			__details::_Logger::call(__details::ERROR, args...);
+		#endif
 		}
 		template<typename... Args>
-		DECLSPEC void info(const Args&... args) noexcept
+		DECLSPEC void info(UNUSED(const Args&... args)) noexcept
 		{
-			__details::_Logger::call(__details::INFO, __details::_Logger::info_f, "INFO   ", Options::C_GREEN, args...);
+		#if MTL_LOG_LEVEL <= MTL_LOG_LEVEL_INFO
+			__details::_Logger::call(__details::INFO, args...);
+		#endif
 		}
 		template<typename... Args>
-		DECLSPEC void warning(const Args&... args) noexcept
+		DECLSPEC void warning(UNUSED(const Args&... args)) noexcept
+		{
+		#if MTL_LOG_LEVEL <= MTL_LOG_LEVEL_WARNING
+			__details::_Logger::call(__details::WARNING, args...);
+		#endif
+		}
+		DECLSPEC inline void flush(void) noexcept
 		{
-			__details::_Logger::call(__details::WARNING, __details::_Logger::warning_f, "WARNING", Options::C_YELLOW, args...);
+			__details::_Writer::instance().flush();
 		}
 	}
 }
@@ -456,7 +773,7 @@ namespace mtl
 #endif
 
 /**
- * @mainpage Logs 1.2
+ * @mainpage Logs 1.3
  * 
  * @section id_intro Synopsis
  * This Header-only library provides logging configurable functions that allows you to customize output format.<br/>
@@ -627,6 +944,32 @@ namespace mtl
  * mtl::log::info(mtl::log::hold_on(), "whatever"); // It will work
  * @endcode
  * 
+ * @subsection id_threads Threads
+ * Since the 1.3 version, any thread can log at the same time.<br />
+ * Each call formats its arguments on its own thread, then pushes the line into a lock-free queue, and a background
+ * thread writes the lines in this order, with a single flush for every line available. So a call doesn't wait for
+ * the std::ostream anymore, and the options (which are atomic now) are the ones of the moment of the call.<br />
+ * hold_on() works the same way, as long as the held line and its end come from the same thread without any other
+ * thread logging in between.<br />
+ * Because of this delay, the lines may not be written yet when a call returns, flush() waits for them :
+ * @code
+ * std::ostringstream os;
+ * log::Options::OUT = &os;
+ * log::info("Something");
+ * log::flush();
+ * std::string text = os.str(); // Contains "Something".
+ * @endcode
+ * The remaining lines are written at the end of the program.
+ * 
+ * @subsection id_level Levels
+ * Defining \b MTL_LOG_LEVEL (to \b MTL_LOG_LEVEL_WARNING, \b MTL_LOG_LEVEL_ERROR or \b MTL_LOG_LEVEL_NONE) before
+ * including the file removes the calls of the lower levels at compile time : they cost nothing, not even a test.<br />
+ * Only their arguments are still evaluated, so the costly ones could be wrapped by defer(), which is only called if
+ * the line is logged :
+ * @code
+ * log::info("Smallest angle :", log::defer([&](){return mesh.computeQuality().smallestAngle;}));
+ * @endcode
+ * 
  * @subsection id_sum   Summary
  * There is a full code to demonstrate the usage :
  * @code
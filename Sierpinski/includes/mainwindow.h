@@ -20,6 +20,7 @@ class MainWindow : public QMainWindow
         
     private slots:
         void on_actionPTS_curve_triggered();
+        void on_actionPTS_nn_curve_triggered();
         void on_actionPTS_triangulation_triggered();
         void on_actionOFF_mesh_triggered();
 
@@ -35,6 +36,8 @@ class MainWindow : public QMainWindow
 		
 		void on_CheckPoints_stateChanged(int arg1);
 		
+		void on_CheckCells_stateChanged(int arg1);
+		
 		void on_CheckCircles_stateChanged(int arg1);
 		
 		void on_ReloadButton_released();
@@ -44,6 +47,10 @@ class MainWindow : public QMainWindow
 private:
         Ui::MainWindow *ui;
 		void switchCheckBoxes(bool value);
+		/**
+		 * @brief Display the counters of the last loading into the status bar (and all of them on the standard output).
+		 */
+		void showStatistics(void);
 		std::string loaded;
 };
 
@@ -17,16 +17,38 @@
 
 // Topology
 #include "common.hpp"
+#include "voronoi.hpp"
+#include "normals.hpp"
+#include "kdtree.hpp"
+#include "bvh.hpp"
+#include "sierpinski.hpp"
+#include "outofcore.hpp"
+#include "codec.hpp"
+#include "quality.hpp"
+#include "validation.hpp"
+#include "components.hpp"
+#include "adjacency.hpp"
+#include "laplacian.hpp"
+#include "simplify.hpp"
+#include "smooth.hpp"
+#include "stats.hpp"
 #include "Vertex3D.hpp"
 #include "TopoTriangle.hpp"
 
 // Iterators
 #include "TriangleIterator.hpp"
 #include "VertexIterator.hpp"
+#include "MeshRange.hpp"
 #include "TriangleCirculator.hpp"
 #include "VertexCirculator.hpp"
 
 
+//! @brief The way the constraint segments are recovered by Mesh::loadConstraints().
+typedef enum {
+	SPLIT_SEGMENTS, //!< Only recover them with Ruppert's midpoint splits.
+	INSERT_SEGMENTS //!< Insert them directly (constrained Delaunay), then refine.
+} ConstraintMode_e;
+
 /**
  * @class Mesh
  * @brief Defines a multifunction mesh.
@@ -38,7 +60,7 @@ class Mesh final
 		/**
 		 * @brief Load a 3D mesh from a well formated OFF file named \p fname.
 		 * @param[in] fname The file name of your off.
-		 * @pre \p fname must refers to a valid file.
+		 * @throw std::runtime_error If \p fname can't be read or is truncated, this Mesh being left empty.
 		 */
 		void loadMeshFromOff(const std::string& fname);
 		/**
@@ -60,6 +82,35 @@ class Mesh final
 		 * @param[in] fname The name of the PTS file you wanna load.
 		 */
 		void load2DCurve(const std::string& fname);
+		/**
+		 * @brief Replace this Mesh by a Sierpinski gasket, see sierpinski::generate().
+		 * @param[in] depth       The number of subdivisions.
+		 * @param[in] tetrahedral true for the 3D gasket (tetrahedra), false for the 2D one (triangles).
+		 * @throw std::invalid_argument If \p depth is too deep for the indexes, the mesh is left empty then.
+		 */
+		void loadGasket(uint32_t depth, bool tetrahedral);
+		/**
+		 * @brief Replace this Mesh by the simplification of a mesh kept on the disk, see outofcore::cluster().
+		 * @param[in] store      The mesh on the disk, from outofcore::convert().
+		 * @param[in] resolution The number of cells along the biggest extent of its bounding box.
+		 * @throw std::runtime_error If the files of \p store can't be read, the mesh is left empty then.
+		 */
+		void loadClustered(const outofcore::Store& store, uint32_t resolution);
+		/**
+		 * @brief Write this Mesh into a compressed file named \p fname, see codec::encode().
+		 * @param[in] fname The name of the file you wanna write.
+		 * @param[in] bits  The bits of the quantization of each coordinate.
+		 * @return What has been written.
+		 * @throw std::invalid_argument If this Mesh isn't a consistently oriented manifold.
+		 * @throw std::runtime_error    If \p fname can't be written.
+		 */
+		codec::Report dumpCompressed(const std::string& fname, uint32_t bits = codec::DEFAULT_BITS) const;
+		/**
+		 * @brief Replace this Mesh by the one of a compressed file named \p fname, see codec::decode().
+		 * @param[in] fname The name of the file written by dumpCompressed().
+		 * @throw std::runtime_error If \p fname can't be read or is corrupted, the mesh is left empty then.
+		 */
+		void loadCompressed(const std::string& fname);
 		
 		
 		// #######################################################################
@@ -72,10 +123,14 @@ class Mesh final
 		void flip(IndexFace_t f1, IndexFace_t f2);
 		
 		// ## Iterators ##########################################################
-		typedef _TriangleIterator   triangle_iterator;   //!< To offer a simple name for this iterator over triangles.
-		typedef _VertexIterator     vertex_iterator;     //!< To offer a simple name for this iterator over vertices.
-		typedef _TriangleCirculator triangle_circulator; //!< To offer a simple name for this circulator over triangles.
-		typedef _VertexCirculator   vertex_circulator;   //!< To offer a simple name for this circulator over vertices.
+		typedef _TriangleIterator          triangle_iterator;       //!< To offer a simple name for this iterator over triangles.
+		typedef _VertexIterator            vertex_iterator;         //!< To offer a simple name for this iterator over vertices.
+		typedef _ConstTriangleIterator     const_triangle_iterator; //!< The read only triangle_iterator.
+		typedef _ConstVertexIterator       const_vertex_iterator;   //!< The read only vertex_iterator.
+		typedef MeshSentinel<TopoTriangle> triangle_sentinel;       //!< The end of the triangles, whatever their number.
+		typedef MeshSentinel<Vertex>       vertex_sentinel;         //!< The end of the vertices, whatever their number.
+		typedef _TriangleCirculator        triangle_circulator;     //!< To offer a simple name for this circulator over triangles.
+		typedef _VertexCirculator          vertex_circulator;       //!< To offer a simple name for this circulator over vertices.
 		
 		/**
 		 * @brief Create an iterator through triangle ( \b T for triangle !).
@@ -99,6 +154,34 @@ class Mesh final
 		 * @warning Don't dereference this iterator !
 		 */
 		vertex_iterator endV(void);
+		const_triangle_iterator beginT(void) const;
+		const_triangle_iterator endT(void) const;
+		const_vertex_iterator   beginV(void) const;
+		const_vertex_iterator   endV(void) const;
+		/**
+		 * @brief Get every triangle as a range, like for parallel::transform().
+		 * @return The range [beginT(), endT()[.
+		 */
+		MeshRange<TopoTriangle>       rangeT(void);
+		MeshRange<const TopoTriangle> rangeT(void) const;
+		/**
+		 * @brief Get every vertex as a range, like for parallel::transform().
+		 * @return The range [beginV(), endV()[.
+		 */
+		MeshRange<Vertex>       rangeV(void);
+		MeshRange<const Vertex> rangeV(void) const;
+		/**
+		 * @brief Get the end of the triangles, which follows the triangles added after it's created,
+		 * unlike endT() : a loop up to it also visits the triangles it adds.
+		 * @return The end of the triangles, compared with any triangle_iterator or const_triangle_iterator.
+		 * @warning Don't dereference the iterators which reached it !
+		 */
+		triangle_sentinel sentinelT(void) const;
+		/**
+		 * @brief Get the end of the vertices, which follows the vertices added after it's created, see sentinelT().
+		 * @return The end of the vertices, compared with any vertex_iterator or const_vertex_iterator.
+		 */
+		vertex_sentinel sentinelV(void) const;
 		/**
 		 * @brief Create a circulator through vertex ( \b V for vertex !).
 		 * @param[in] center The index of the vertex you wanna use as an anchor
@@ -130,14 +213,142 @@ class Mesh final
 		const Curve_c& getConstraints(void) const;
 		
 		inline int32_t getIndexBeforeVoronoi(void) const{return this->indexBeforeVoronoi;}
+		/**
+		 * @brief Get a counter which changes each time the vertices or the triangles change.
+		 * @return The current generation of this Mesh.
+		 */
+		inline uint64_t getGeneration(void) const{return this->generation;}
+		/**
+		 * @brief Signal that the vertices or the triangles have been modified from outside,
+		 * through the non const getters, so every cached data will be rebuilt.
+		 */
+		void touch(void);
+		/**
+		 * @brief Get the voronoi diagram of this 2D triangulation. It is only computed again if the
+		 * triangulation changed since the last call.
+		 * @return The diagram, valid until the next modification.
+		 */
+		const voronoi::Diagram& getVoronoi(void);
+		/**
+		 * @brief Get the normals of the triangles and of the vertices. After some flips or insertions,
+		 * only the triangles they rewrote or created are computed again, the others are kept.
+		 * @param[in] weighting How the triangles are weighted around a vertex.
+		 * @return The normals, valid until the next modification.
+		 */
+		const normals::Normals& getNormals(normals::Weighting_e weighting = normals::AREA);
+		/**
+		 * @brief Get a kd-tree over the vertices, for kdtree::nearest() and kdtree::withinRadius().
+		 * It is only built again if the mesh changed since the last call.
+		 * @return The tree, valid until the next modification.
+		 */
+		const kdtree::Tree& getKdTree(void);
+		/**
+		 * @brief Get a bounding volume hierarchy over the triangles, for bvh::intersect().
+		 * It is only built again if the mesh changed since the last call.
+		 * @return The hierarchy, valid until the next modification.
+		 */
+		const bvh::Tree& getBvh(void);
+		/**
+		 * @brief Measure the quality of every triangle (angles, radius-edge ratio, area and aspect ratio).
+		 * @param[in] bins The number of bins of the histograms.
+		 * @param[in] k    The number of worst triangles to keep.
+		 * @return The full report.
+		 */
+		quality::Report computeQuality(uint32_t bins = 12, uint32_t k = 10) const;
+		/**
+		 * @brief Check the neighbors, the common edges, the faces of the vertices and, for a 2D triangulation,
+		 * the orientation and the Delaunay property of every triangle (the constrained edges excepted).
+		 * @param[in] planar true for a 2D triangulation, false for a 3D mesh (only its topology is checked then).
+		 * @return The report, see validation::valid().
+		 */
+		validation::Report validate(bool planar = true) const;
+		/**
+		 * @brief Find the connected components of this Mesh, its borders and its non manifold edges and vertices,
+		 * quick enough to reject a broken mesh right after its loading.
+		 * @return The report, see components::manifold().
+		 */
+		components::Report analyzeComponents(void) const;
+		/**
+		 * @brief Build the triangles and the vertices around every vertex, in contiguous arrays,
+		 * for the kernels which go through every one-ring (see adjacency::Vertices).
+		 * @return The adjacency, valid until the next modification of this Mesh.
+		 */
+		adjacency::Vertices buildVertexAdjacency(void) const;
+		/**
+		 * @brief Build the cotangent laplacian of this mesh, as a sparse matrix whose values can be
+		 * computed again by laplacian::update() while the triangles don't change.
+		 * @param[in] adjacency The one-rings of this mesh, see buildVertexAdjacency().
+		 * @return The matrix.
+		 */
+		laplacian::Matrix buildLaplacian(const adjacency::Vertices& adjacency) const;
+		/**
+		 * @brief Compute the mean and the gaussian curvatures of every vertex of this 3D mesh.
+		 * @return The curvatures, 0 for a flat 2D triangulation.
+		 */
+		laplacian::Curvatures computeCurvatures(void) const;
+		/**
+		 * @brief Simplify this 3D mesh by quadric error edge collapses, until it has \b targetFaces
+		 * triangles or less (less may not be reachable without folding a triangle).
+		 * @param[in] targetFaces The number of triangles wanted.
+		 * @post The mesh is a plain one, like a loaded OFF : the borders, curve and constraints are removed.
+		 */
+		void simplify(uint32_t targetFaces);
+		/**
+		 * @brief Build a chain of coarser and coarser copies of this mesh, each one simplified from the previous.
+		 * @param[in] levels The number of levels wanted, this mesh excluded.
+		 * @param[in] ratio  The part of the triangles kept from one level to the next.
+		 * @return The levels, the finest first. It stops early if a level can't be simplified anymore.
+		 */
+		std::vector<Mesh> levelsOfDetail(uint32_t levels, double ratio = 0.5) const;
+		/**
+		 * @brief Remove the noise of this mesh by Taubin smoothing (see smooth::taubin()), without changing its triangles.
+		 * @param[in] iterations  The number of lambda|mu steps.
+		 * @param[in] lambda      The shrinking factor, between ]0, 1[.
+		 * @param[in] mu          The inflating factor, negative and a bit bigger than \p lambda.
+		 * @param[in] fixedBorder true to keep the border vertices where they are.
+		 * @return The throughput of the steps, in vertex moves per second (2 per iteration for each moving vertex).
+		 * @post A 2D triangulation may no longer be a Delaunay one.
+		 */
+		double smooth(uint32_t iterations, double lambda = 0.5, double mu = -0.53, bool fixedBorder = true);
+		/**
+		 * @brief Get the counters and timers of every algorithm since the last resetStatistics(),
+		 * summed over every Mesh and every thread.
+		 * @return The report, empty if MESH_STATS isn't defined.
+		 */
+		static stats::Report getStatistics(void);
+		/**
+		 * @brief Set every counter and timer back to 0, like before measuring a single algorithm.
+		 */
+		static void resetStatistics(void);
+		/**
+		 * @brief Start recording a timeline of every algorithm, for chrome://tracing or https://ui.perfetto.dev.
+		 * @param[in] fname The JSON file written by stopTrace().
+		 */
+		static void startTrace(const std::string& fname);
+		/**
+		 * @brief Stop the timeline started by startTrace(), and write it.
+		 * @throw std::runtime_error If the file can't be written.
+		 */
+		static void stopTrace(void);
 		// #######################################################################
-		void incrementalDelaunay(const std::vector<IndexFace_t>& newTriangles);
+		/**
+		 * @brief Flip the edges of \b newTriangles and of their neighbors, until every one is locally Delaunay.
+		 * @param[in] newTriangles The triangles to start from, -1 are ignored.
+		 * @return The number of flips.
+		 */
+		uint32_t incrementalDelaunay(const std::vector<IndexFace_t>& newTriangles);
 
 		/**
 		 * @brief Apply crust algorithm, and return a bunch of edges.
 		 * @pre The mesh must contains some triangles at this point, of Delaunay.
 		 */
 		void Crust(void);
+		/**
+		 * @brief Apply the NN-crust algorithm : links each vertex to its nearest neighbor and to the nearest
+		 * one in the opposite direction, among its Delaunay neighbors. Nothing is inserted.
+		 * @pre The mesh must contains some triangles at this point, of Delaunay.
+		 */
+		void NNCrust(void);
 		
 		/**
 		 * @brief Load a .ctri file \b fname with this format :
@@ -145,20 +356,50 @@ class Mesh final
 		 * 2D vertices .... x number_of_vertex
 		 * a b ... x number_of_vertex
 		 * @param[in] fname The name of the file
+		 * @param[in] mode  How the segments are recovered before the refinement.
 		 * @pre \b fname must de a valid file.
 		 * @post The constraint delaunay is up to be shown.
 		 */
-		void loadConstraints(const std::string& fname);
+		void loadConstraints(const std::string& fname, ConstraintMode_e mode = INSERT_SEGMENTS);
+		/**
+		 * @brief Insert the segment \b segment into the triangulation, and mark it (and its parts
+		 * if it goes through some vertices) as constrained, so no flip will remove it.
+		 * @param[in] segment The segment to insert, with indexes of existing vertices.
+		 * @pre The mesh must be a 2D triangulation, and \b segment inside of it.
+		 */
+		void insertConstraint(const TopoTriangle::Edge& segment);
+		/**
+		 * @brief Check if the edge \b a --> \b b is a constrained one.
+		 * @param[in] a One     vertex index of the edge.
+		 * @param[in] b Another vertex index of the edge.
+		 * @return true if no flip is allowed on this edge, false otherwise.
+		 */
+		bool isConstrained(IndexVertex_t a, IndexVertex_t b) const;
 		
 		
 		
 	private:
-		VertexContainer   vertices;           //!< Every vertices  of this mesh.
-		TriangleContainer triangles;          //!< Every triangles of this mesh.
-		Border_c          borders;            //!< Every indexes of the vertices on the edges of the triangulation.
-		Curve_c           curve;              //!< The edges for the curve.
-		Curve_c           constraints;        //!< The edges for the curve.
-		int32_t           indexBeforeVoronoi; //!< The index where the voronoi centers are store.
+		VertexContainer    vertices;           //!< Every vertices  of this mesh.
+		TriangleContainer  triangles;          //!< Every triangles of this mesh.
+		Border_c           borders;            //!< Every indexes of the vertices on the edges of the triangulation.
+		Curve_c            curve;              //!< The edges for the curve.
+		Curve_c            constraints;        //!< The edges for the curve.
+		ConstrainedEdges_c constrained;        //!< The edges that can't be flipped.
+		int32_t            indexBeforeVoronoi; //!< The index where the voronoi centers are store.
+		uint64_t           generation = 0;     //!< Incremented on each modification of the vertices or triangles.
+		voronoi::Diagram   diagram;            //!< The cached voronoi diagram, see getVoronoi().
+		normals::Normals   cachedNormals;      //!< The cached normals, see getNormals().
+		kdtree::Tree       tree;               //!< The cached kd-tree, see getKdTree().
+		bvh::Tree          hierarchy;          //!< The cached bounding volume hierarchy, see getBvh().
+		std::vector<IndexFace_t> changes;      //!< The triangles rewritten since cachedNormals, see logChange().
+		bool               changesLost = true; //!< true if changes misses some of them, so cachedNormals can't be updated.
+		
+		/**
+		 * @brief Record that the triangle \b f has been rewritten, for the next update of the normals.
+		 * The new triangles don't need to be recorded, nor does anything before a first getNormals().
+		 * @param[in] f The index of the triangle.
+		 */
+		void logChange(IndexFace_t f);
 		
 		/**
 		 * @brief Read \b nb vertex from \b file, and insert them into an incremental delaunay triangulation.
@@ -168,13 +409,21 @@ class Mesh final
 		void readVerticesFromPts(InputFile& file, uint32_t nb);
 		/**
 		 * @brief Insert \b v with \b index as vertex' index into the triangulation.
-		 * @param v     The vertex to insert.
+		 * A vertex already there stays out of the triangles, without any face.
+		 * @param v     The vertex to insert, its face is the one it was inserted in at the end.
 		 * @param index It index.
+		 * @param hint  A triangle near \b v to start the location from, -1 to search every triangle.
 		 */
-		void insertVertexIntoTriangulation(Vertex& v, IndexVertex_t index);
+		void insertVertexIntoTriangulation(Vertex& v, IndexVertex_t index, IndexFace_t hint = -1);
 		/**
-		 * @brief Create the first triangle and initialize the border.
-		 * It's the start point of the 2D triangulation.
+		 * @brief Insert every vertex of \b batch into the triangulation, in a Hilbert curve order,
+		 * each location starting from the previous inserted vertex.
+		 * @param[in] batch The vertices to insert, they get the indexes after the current ones.
+		 */
+		void insertVerticesIntoTriangulation(const VertexContainer& batch);
+		/**
+		 * @brief Create the first triangles and initialize the border, once the last vertex isn't aligned
+		 * with the previous ones. It's the start point of the 2D triangulation.
 		 */
 		void createInitialTriangle(void);
 		/**
@@ -183,6 +432,21 @@ class Mesh final
 		 * @return A value between [0, triangles.size()[ if \b v belongs to a triangle, -1 otherwise.
 		 */
 		IndexFace_t isInOneTriangle(const Vertex& v);
+		/**
+		 * @brief Walk from the triangle \b start to the one which contains \b v.
+		 * @param[in] v     The vertex to locate.
+		 * @param[in] start The triangle to start the walk from.
+		 * @return A value between [0, triangles.size()[ if \b v belongs to a triangle, -1 otherwise.
+		 */
+		IndexFace_t walkToTriangle(const Vertex& v, IndexFace_t start);
+		/**
+		 * @brief Check if \b v is (almost) one of the vertices of \b face, like the voronoi centers
+		 * of two cocircular triangles.
+		 * @param[in] v    The vertex to check.
+		 * @param[in] face The triangle which contains \b v.
+		 * @return true if \b v is already inserted, false otherwise.
+		 */
+		bool isAlreadyInserted(const Vertex& v, IndexFace_t face) const;
 		/**
 		 * @brief Prepare a triangle \b t to be use with predicats
 		 * @param[in] t The triangle to convert into a predicat' triangle.
@@ -203,6 +467,14 @@ class Mesh final
 		 * @param[in]     v_index          v's index.
 		 */
 		void insertPointIntoTriangle(Vertex& v, IndexFace_t indexCurrentFace, IndexVertex_t v_index);
+		/**
+		 * @brief Case when you need to insert a vertex on an existing edge, splitting the 2 triangles around it.
+		 * @param[in,out] v       The vertex to insert, already pushed into the vertices.
+		 * @param[in]     edge    The edge where we'll insert \b v.
+		 * @param[in]     v_index v's index.
+		 * @param[in]     face    A triangle with \b edge, -1 to search it.
+		 */
+		void insertPointOnEdge(Vertex& v, const TopoTriangle::Edge& edge, IndexVertex_t v_index, IndexFace_t face = -1);
 		/**
 		 * @brief Manage neighborhood for an insertion inside a triangle.
 		 * @param[in]     news      The newly created triangles indexes.
@@ -272,6 +544,24 @@ class Mesh final
 		 * @return true if a segment is encroach (filling up \b edge), false otherwise.
 		 */
 		bool encroachSegment(const Vertex& v, Curve_c& segments, TopoTriangle::Edge& edge);
+		/**
+		 * @brief Find the triangle around \b a crossed by the segment \b a --> \b b.
+		 * @param[in]  a     The start of the segment.
+		 * @param[in]  b     The end   of the segment.
+		 * @param[out] right The vertex of the crossed edge on the right of the segment.
+		 * @param[out] left  The vertex of the crossed edge on the left  of the segment.
+		 * @return The index of this triangle, -1 if there is none.
+		 * If a vertex linked to \b a lies on the segment, it returns -1 with \b right == \b left == this vertex.
+		 */
+		IndexFace_t findCrossedFace(IndexVertex_t a, IndexVertex_t b, IndexVertex_t& right, IndexVertex_t& left) const;
+		/**
+		 * @brief Triangulate the pseudo-polygon \b a, \b polygon, \b b in a Delaunay way.
+		 * @param[in]  polygon The vertices on the left of \b a --> \b b, from \b a to \b b.
+		 * @param[in]  a       The first  vertex of the base edge.
+		 * @param[in]  b       The second vertex of the base edge.
+		 * @param[out] out     The container to fill with the new triangles.
+		 */
+		void triangulatePseudoPolygon(const std::vector<IndexVertex_t>& polygon, IndexVertex_t a, IndexVertex_t b, TriangleContainer& out) const;
 
 };
 
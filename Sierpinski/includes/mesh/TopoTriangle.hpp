@@ -129,6 +129,13 @@ class TopoTriangle final : public Triangle
 		 * @return A reference to \b this.
 		 */
 		TopoTriangle& removeNeighbor(IndexFace_t i);
+		/**
+		 * @brief Replace the neighbor \p old by \p neighbor, through the same edge.
+		 * @param[in] old      The index of the current neighbor.
+		 * @param[in] neighbor The index of the new one, -1 for none.
+		 * @return A reference to \b this.
+		 */
+		TopoTriangle& replaceNeighbor(IndexFace_t old, IndexFace_t neighbor);
 		/**
 		 * @snippet TopoTriangle.hpp getNeighbors
 		 * @brief Grant access to the container of neighbors.
@@ -0,0 +1,70 @@
+/**
+ * @file adjacency.hpp
+ * @brief Offers the one-ring of every vertex at once, stored contiguously (compressed sparse rows).
+ *
+ * Unlike a circulator, it knows where each one-ring ends, the border ones included,
+ * so the kernels over every vertex (valence, smoothing, laplacian) just scan two arrays.
+ * @author MTLCRBN
+ */
+#ifndef ADJACENCY_HPP_INCLUDED
+#define ADJACENCY_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include "common.hpp"
+
+namespace adjacency
+{
+	//! @brief What the one-ring of a vertex looks like.
+	typedef enum {
+		INTERIOR,     //!< A closed fan of triangles.
+		BORDER,       //!< An open fan, from the border triangle clockwise to the one counter-clockwise.
+		NON_MANIFOLD, //!< Several fans, or broken neighbors : the triangles and vertices aren't ordered.
+		ISOLATED      //!< No triangle at all.
+	} Kind_e;
+
+	/**
+	 * @struct Vertices
+	 * @brief The triangles and the vertices around each vertex. The triangles around v are
+	 * triangles[triangleOffsets[v]] ... triangles[triangleOffsets[v+1]-1], counter-clockwise, and its
+	 * neighbors are vertices[vertexOffsets[v]] ... vertices[vertexOffsets[v+1]-1], in the same order :
+	 * the i-th neighbor is the first one met after v in the i-th triangle, counter-clockwise.
+	 * On the border, there is one neighbor more than triangles, the last one.
+	 */
+	struct Vertices final
+	{
+		std::vector<uint32_t>      triangleOffsets; //!< Where each fan begins in triangles, one more than the number of vertices.
+		std::vector<IndexFace_t>   triangles;       //!< The triangles around each vertex.
+		std::vector<uint32_t>      vertexOffsets;   //!< Where each one-ring begins in vertices, one more than the number of vertices.
+		std::vector<IndexVertex_t> vertices;        //!< The neighbors of each vertex.
+		std::vector<uint8_t>       kinds;           //!< The Kind_e of each vertex.
+	};
+
+	/**
+	 * @brief Build the one-ring of every vertex.
+	 * @param[in] vertices  The vertices  of the mesh.
+	 * @param[in] triangles The triangles of the mesh, with their neighbors.
+	 * @return The adjacency, valid until the next modification of the mesh.
+	 */
+	Vertices build(const VertexContainer& vertices, const TriangleContainer& triangles);
+
+	/**
+	 * @brief Get the number of neighbors of \p v.
+	 * @param[in] adjacency The adjacency.
+	 * @param[in] v         The index of the vertex.
+	 * @return The valence.
+	 */
+	inline uint32_t valence(const Vertices& adjacency, IndexVertex_t v)
+	{
+		return adjacency.vertexOffsets[v+1] - adjacency.vertexOffsets[v];
+	}
+	/**
+	 * @brief Get the number of triangles around \p v.
+	 */
+	inline uint32_t degree(const Vertices& adjacency, IndexVertex_t v)
+	{
+		return adjacency.triangleOffsets[v+1] - adjacency.triangleOffsets[v];
+	}
+}
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file bvh.hpp
+ * @brief Offers a bounding volume hierarchy over the triangles of a mesh, for the ray queries (picking).
+ *
+ * The hierarchy is built top-down with the surface area heuristic, evaluated on a few bins of the
+ * centroids instead of every possible split, the big subtrees as OpenMP tasks. The nodes are a single
+ * flat array, the 2 children of a node side by side, and the coordinates of the triangles are copied in
+ * the order of the leaves, so a leaf is a contiguous range of them.
+ * The ray-triangle test is the watertight one of Woop, Benthin and Wald : a ray going through a vertex
+ * or an edge shared by several triangles hits one of them, never none.
+ * @author MTLCRBN
+ */
+#ifndef BVH_HPP_INCLUDED
+#define BVH_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "common.hpp"
+
+namespace bvh
+{
+	const uint32_t LEAF   = 4;  //!< The number of triangles under which a node is always a leaf.
+	const uint32_t PACKET = 8;  //!< The number of rays of a Packet.
+
+	/**
+	 * @struct Node
+	 * @brief A node of the hierarchy, its box and either its children or its triangles.
+	 */
+	struct Node final
+	{
+		VertexType low[3];  //!< The lowest corner of the box.
+		VertexType high[3]; //!< The highest corner of the box.
+		uint32_t   offset;  //!< The first triangle of a leaf, the first child (the second one is next) otherwise.
+		uint32_t   count;   //!< The number of triangles of a leaf, 0 otherwise.
+	};
+
+	/**
+	 * @struct Tree
+	 * @brief The hierarchy, its root is nodes[0].
+	 */
+	struct Tree final
+	{
+		std::vector<Node>        nodes;      //!< Every node.
+		std::vector<IndexFace_t> indexes;    //!< The triangles, sorted by leaf.
+		std::vector<VertexType>  corners;    //!< The 3 x y z of each triangle of indexes, in the same order.
+		uint64_t                 generation; //!< The Mesh generation this hierarchy has been built for.
+	};
+
+	/**
+	 * @struct Ray
+	 * @brief A ray, the points origin + t*direction for t in [near, far].
+	 */
+	struct Ray final
+	{
+		Vertex     origin;                                       //!< Where it starts.
+		Vertex     direction;                                    //!< Where it goes, not necessarily of length 1.
+		VertexType near = 0.0;                                   //!< The closest t.
+		VertexType far  = std::numeric_limits<VertexType>::max(); //!< The farthest t.
+	};
+
+	/**
+	 * @struct Hit
+	 * @brief The closest triangle hit by a ray, at origin + distance*direction = (1-u-v)*a + u*b + v*c,
+	 * a, b and c being the vertices of the triangle in its order.
+	 */
+	struct Hit final
+	{
+		IndexFace_t triangle = -1;  //!< The triangle hit, -1 if the ray hits nothing.
+		VertexType  distance = 0.0; //!< The t of the hit, in lengths of direction.
+		VertexType  u        = 0.0; //!< The barycentric coordinate of the second vertex.
+		VertexType  v        = 0.0; //!< The barycentric coordinate of the third  vertex.
+	};
+
+	/**
+	 * @struct Packet
+	 * @brief PACKET rays, coordinate by coordinate, so a test runs over every ray at once (omp simd).
+	 * A ray is disabled by a far < near.
+	 */
+	struct Packet final
+	{
+		VertexType ox[PACKET], oy[PACKET], oz[PACKET]; //!< The origins.
+		VertexType dx[PACKET], dy[PACKET], dz[PACKET]; //!< The directions.
+		VertexType near[PACKET], far[PACKET];          //!< The intervals of t.
+	};
+
+	/**
+	 * @brief Build the hierarchy of a mesh.
+	 * @param[in] vertices  The vertices  of the mesh.
+	 * @param[in] triangles The triangles of the mesh.
+	 * @return The hierarchy, its generation is left to the caller.
+	 */
+	Tree build(const VertexContainer& vertices, const TriangleContainer& triangles);
+
+	/**
+	 * @brief Find the closest triangle hit by \p ray.
+	 * @param[in] tree The hierarchy.
+	 * @param[in] ray  The ray.
+	 * @return The hit, with a triangle -1 if there is none.
+	 */
+	Hit intersect(const Tree& tree, const Ray& ray);
+	/**
+	 * @brief Find the closest triangle hit by each ray of \p packet, traversing the hierarchy once for all of them.
+	 * @param[in]  tree   The hierarchy.
+	 * @param[in]  packet The rays, coherent ones (like the pixels of a tile) share most of their nodes.
+	 * @param[out] hits   The PACKET hits.
+	 */
+	void intersect(const Tree& tree, const Packet& packet, Hit* hits);
+	/**
+	 * @brief Find the closest triangle hit by each ray of \p rays, by packets of PACKET consecutive rays, in parallel.
+	 * The consecutive rays should be coherent, incoherent ones are faster one by one.
+	 * @return A hit per ray.
+	 */
+	std::vector<Hit> intersect(const Tree& tree, const std::vector<Ray>& rays);
+}
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file codec.hpp
+ * @brief Offers a compressed binary format for the meshes, about 20 times smaller than OFF.
+ *
+ * The connectivity is coded Edgebreaker style : the triangles are visited one after the other
+ * across the loops of edges which separate the visited ones from the others, and each triangle
+ * only tells how its third vertex is reached : a new vertex (C), the next one along the loop (R),
+ * the previous one (L), both (E), or one further along this loop (S) or along another one (M, once
+ * per handle), with its position. These symbols are coded by an adaptive range coder, in the context
+ * of the previous one, for about 2 bits per triangle. The holes are closed before by a fan around
+ * a virtual vertex (H), and opened again after.
+ * The vertices are quantized on a regular grid, and each new one is predicted by the parallelogram
+ * of the triangle it is reached from : only the differences are coded, by their number of bits.
+ * The decoder reads the stream once, in order, and rebuilds the neighbors on the way.
+ * @author MTLCRBN
+ */
+#ifndef CODEC_HPP_INCLUDED
+#define CODEC_HPP_INCLUDED
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "common.hpp"
+
+namespace codec
+{
+	const uint32_t DEFAULT_BITS = 16; //!< The default bits of the quantization, for each coordinate.
+	const uint32_t MAX_BITS     = 24; //!< The most bits of the quantization.
+
+	/**
+	 * @struct Report
+	 * @brief What an encoding has written.
+	 */
+	struct Report final
+	{
+		uint64_t bytes;        //!< The size of the whole stream.
+		double   connectivity; //!< The bits spent by the symbols and their positions.
+		double   geometry;     //!< The bits spent by the vertices.
+		uint32_t components;   //!< The connected components.
+		uint32_t holes;        //!< The border loops closed by a virtual vertex.
+		uint32_t handles;      //!< The M symbols, one per handle of the surface.
+	};
+
+	/**
+	 * @brief Write a mesh into \p out. The vertices and the triangles are written in the order of the
+	 * traversal, so the mesh read back is the same up to their indexes.
+	 * @param[in]  vertices  The vertices  of the mesh.
+	 * @param[in]  triangles The triangles of the mesh, consistently oriented.
+	 * @param[out] out       The stream, opened in binary mode.
+	 * @param[in]  bits      The bits of the quantization, in [1, MAX_BITS].
+	 * @return What has been written.
+	 * @throw std::invalid_argument If the mesh isn't a consistently oriented manifold, or if \p bits is out of range.
+	 * @throw std::runtime_error    If \p out fails.
+	 */
+	Report encode(const VertexContainer& vertices, const TriangleContainer& triangles, std::ostream& out, uint32_t bits = DEFAULT_BITS);
+	/**
+	 * @brief Read a mesh written by encode() from \p in.
+	 * @param[in]  in        The stream, opened in binary mode.
+	 * @param[out] vertices  The vertices  read.
+	 * @param[out] triangles The triangles read, with their neighbors.
+	 * @throw std::runtime_error If the stream is truncated or corrupted.
+	 */
+	void decode(std::istream& in, VertexContainer& vertices, TriangleContainer& triangles);
+}
+
+#endif
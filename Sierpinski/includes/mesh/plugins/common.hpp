@@ -9,6 +9,8 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <set>
+#include <utility>
 #include "Vertex3D.hpp"
 #include "TopoTriangle.hpp"
 
@@ -18,6 +20,7 @@ typedef std::vector<Vertex>           VertexContainer;
 typedef std::vector<TopoTriangle>     TriangleContainer;
 typedef std::list<IndexVertex_t>      Border_c;
 typedef std::list<TopoTriangle::Edge> Curve_c;
+typedef std::set<std::pair<IndexVertex_t, IndexVertex_t>> ConstrainedEdges_c;
 
 
 #endif
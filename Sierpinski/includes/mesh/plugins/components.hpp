@@ -0,0 +1,61 @@
+/**
+ * @file components.hpp
+ * @brief Offers the connected components of a mesh, with the problems which make it non manifold.
+ *
+ * The triangles are joined to their neighbors inside a lock-free union-find : every thread links its
+ * triangles at once, a root being only replaced by a compare and swap, and always under a smaller index.
+ * So the root of a component is its smallest triangle, and the components are numbered in this order.
+ * The same pass checks each neighbor link, and joins the vertices of the border edges into loops.
+ * @author MTLCRBN
+ */
+#ifndef COMPONENTS_HPP_INCLUDED
+#define COMPONENTS_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include "common.hpp"
+
+namespace components
+{
+	/**
+	 * @struct Report
+	 * @brief The components of a mesh, as a list of triangles each, and its defects.
+	 */
+	struct Report final
+	{
+		std::vector<uint32_t>    labels;              //!< The component of each triangle.
+		std::vector<uint32_t>    offsets;             //!< Where each component begins inside triangles, one more for the end.
+		std::vector<IndexFace_t> triangles;           //!< The triangles of every component, one after the other, in increasing order.
+		uint64_t                 borderEdges;         //!< The edges with a single triangle.
+		uint64_t                 boundaryLoops;       //!< The borders, the ones touching by a vertex counted once.
+		uint64_t                 nonManifoldEdges;    //!< The edges of more than 2 triangles (seen as neighbors which don't link back).
+		uint64_t                 nonManifoldVertices; //!< The vertices whose triangles aren't a single fan.
+		uint64_t                 isolatedVertices;    //!< The vertices without any triangle.
+	};
+
+	/**
+	 * @brief Find the connected components of a mesh, through the neighbors of its triangles.
+	 * @param[in] vertices  The vertices  of the mesh.
+	 * @param[in] triangles The triangles of the mesh.
+	 * @return The report.
+	 */
+	Report analyze(const VertexContainer& vertices, const TriangleContainer& triangles);
+	/**
+	 * @brief Get the number of components of \p report.
+	 */
+	inline uint32_t count(const Report& report)
+	{
+		return report.offsets.empty() ? 0 : report.offsets.size() - 1;
+	}
+	/**
+	 * @brief Check if \p report has neither non manifold edges nor non manifold vertices.
+	 */
+	bool manifold(const Report& report);
+	/**
+	 * @brief Write \p report as a readable line, without its lists.
+	 */
+	std::string format(const Report& report);
+}
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file kdtree.hpp
+ * @brief Offers a kd-tree over the vertices of a mesh, for the nearest neighbors and the radius queries.
+ *
+ * The tree is balanced and implicit : the node i covers a range of the sorted vertices, and its
+ * children are the nodes 2i+1 and 2i+2, each one with a half of the range, split at the median of the
+ * axis of its biggest extent. So the nodes are a single flat array, without any pointer, and the
+ * coordinates are copied in the order of the leaves, which are scanned contiguously.
+ * @author MTLCRBN
+ */
+#ifndef KDTREE_HPP_INCLUDED
+#define KDTREE_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include "common.hpp"
+
+namespace kdtree
+{
+	const uint32_t LEAF = 8; //!< The biggest number of vertices in a leaf.
+
+	//! @brief A node of the tree.
+	struct Node final
+	{
+		VertexType split; //!< The coordinate on axis which splits the range, the left child being below.
+		int32_t    axis;  //!< 0, 1 or 2 for x, y or z, -1 for a leaf.
+	};
+
+	/**
+	 * @struct Tree
+	 * @brief The tree. The range of the root is [0, indexes.size()[, then each node splits its range
+	 * [begin, end[ at (begin + end)/2.
+	 */
+	struct Tree final
+	{
+		std::vector<Node>          nodes;      //!< Every node, the root first.
+		std::vector<IndexVertex_t> indexes;    //!< The vertices, sorted by leaf.
+		std::vector<VertexType>    points;     //!< The x y z of each vertex of indexes, in the same order.
+		uint64_t                   generation; //!< The Mesh generation this tree has been built for.
+	};
+
+	/**
+	 * @struct Neighborhoods
+	 * @brief The answers of several radius queries : the vertices of the query q are
+	 * indexes[offsets[q]] ... indexes[offsets[q+1]-1].
+	 */
+	struct Neighborhoods final
+	{
+		std::vector<uint32_t>      offsets; //!< Where each answer begins, one more than the number of queries.
+		std::vector<IndexVertex_t> indexes; //!< The vertices of every answer.
+	};
+
+	/**
+	 * @brief Build the tree of \p vertices, in O(n log(n)), the top levels in parallel.
+	 * @param[in] vertices The vertices.
+	 * @return The tree, its generation is left to the caller.
+	 */
+	Tree build(const VertexContainer& vertices);
+
+	/**
+	 * @brief Find the \p k nearest vertices of \p point.
+	 * @param[in] tree  The tree.
+	 * @param[in] point Any point, not necessarily a vertex.
+	 * @param[in] k     The number of vertices wanted.
+	 * @return The vertices, the nearest first, less than \p k if there isn't enough.
+	 */
+	std::vector<IndexVertex_t> nearest(const Tree& tree, const Vertex& point, uint32_t k);
+	/**
+	 * @brief Find the \p k nearest vertices of every point of \p points, in parallel.
+	 * @return \p k vertices per point, the nearest first, completed by -1 if there isn't enough.
+	 */
+	std::vector<IndexVertex_t> nearest(const Tree& tree, const VertexContainer& points, uint32_t k);
+
+	/**
+	 * @brief Find every vertex at a distance of \p radius or less from \p point.
+	 * @param[in] tree   The tree.
+	 * @param[in] point  Any point, not necessarily a vertex.
+	 * @param[in] radius The distance.
+	 * @return The vertices, in the order of the tree.
+	 */
+	std::vector<IndexVertex_t> withinRadius(const Tree& tree, const Vertex& point, VertexType radius);
+	/**
+	 * @brief Find every vertex at a distance of \p radius or less from each point of \p points, in parallel.
+	 */
+	Neighborhoods withinRadius(const Tree& tree, const VertexContainer& points, VertexType radius);
+}
+
+#endif
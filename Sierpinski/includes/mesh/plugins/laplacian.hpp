@@ -0,0 +1,75 @@
+/**
+ * @file laplacian.hpp
+ * @brief Offers the cotangent laplacian of a mesh, as a sparse matrix, and the curvatures of its vertices.
+ *
+ * The rows are the one-rings of adjacency::Vertices, so the matrix is built row by row, in parallel,
+ * each row only written by its own thread : there is no triplet to sort. Each entry also keeps the
+ * vertices opposite to its edge, so when only the coordinates change, the values are computed again
+ * entry by entry, without going through the triangles.
+ * @author MTLCRBN
+ */
+#ifndef LAPLACIAN_HPP_INCLUDED
+#define LAPLACIAN_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include "common.hpp"
+#include "adjacency.hpp"
+
+namespace laplacian
+{
+	/**
+	 * @struct Matrix
+	 * @brief The cotangent laplacian, in compressed sparse rows : the row v is made of the entries
+	 * offsets[v] ... offsets[v+1]-1, the diagonal first, then the neighbors of v in the order of the adjacency.
+	 * The entry (v, w) is (cot(alpha) + cot(beta))/2, alpha and beta being the angles opposite to v-->w,
+	 * and the diagonal is minus the sum of its row : (L*p)(v) = sum of L(v, w)*(p(w) - p(v)).
+	 */
+	struct Matrix final
+	{
+		std::vector<uint32_t>      offsets;   //!< Where each row begins, one more than the number of vertices.
+		std::vector<IndexVertex_t> columns;   //!< The column of each entry.
+		std::vector<IndexVertex_t> opposites; //!< The 2 vertices opposite to the edge of each entry, -1 if there is none.
+		std::vector<VertexType>    values;    //!< The value of each entry.
+	};
+
+	/**
+	 * @struct Curvatures
+	 * @brief The discrete curvatures of each vertex (Meyer et al.), over its mixed voronoi area.
+	 * They're 0 for an isolated or a non-manifold vertex.
+	 */
+	struct Curvatures final
+	{
+		std::vector<VertexType> mean;     //!< The mean curvature, > 0 where the surface bends away from its normals.
+		std::vector<VertexType> gaussian; //!< The gaussian curvature, its angle defect is against pi on the border.
+		std::vector<VertexType> areas;    //!< The mixed voronoi area of each vertex.
+	};
+
+	/**
+	 * @brief Build the laplacian of a mesh.
+	 * @param[in] vertices  The vertices  of the mesh.
+	 * @param[in] triangles The triangles of the mesh.
+	 * @param[in] adjacency Their one-rings, see adjacency::build().
+	 * @return The matrix, symmetric.
+	 */
+	Matrix build(const VertexContainer& vertices, const TriangleContainer& triangles, const adjacency::Vertices& adjacency);
+
+	/**
+	 * @brief Compute the values of \p matrix again, after the vertices moved (like by smooth::taubin()).
+	 * @param[in]    vertices The vertices, with the same triangles as when \p matrix was built.
+	 * @param[inout] matrix   The matrix, only its values change.
+	 */
+	void update(const VertexContainer& vertices, Matrix& matrix);
+
+	/**
+	 * @brief Compute the mean and the gaussian curvatures of every vertex.
+	 * @param[in] vertices  The vertices  of the mesh.
+	 * @param[in] triangles The triangles of the mesh.
+	 * @param[in] adjacency Their one-rings.
+	 * @param[in] matrix    Their laplacian, up to date.
+	 * @return The curvatures.
+	 */
+	Curvatures curvatures(const VertexContainer& vertices, const TriangleContainer& triangles, const adjacency::Vertices& adjacency, const Matrix& matrix);
+}
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file normals.hpp
+ * @brief Offers the normals of the triangles and of the vertices, for the shading or any processing
+ * which needs to know where a surface faces.
+ *
+ * The normal of a vertex is the sum of the normals of its triangles, each one weighted by its area
+ * or by its angle at this vertex. The sums and the weights are kept, so when a few triangles change
+ * (flips, insertions), only their contributions are removed from and added to their vertices.
+ * @author MTLCRBN
+ */
+#ifndef NORMALS_HPP_INCLUDED
+#define NORMALS_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include "common.hpp"
+
+namespace normals
+{
+	//! @brief How the triangles around a vertex are weighted.
+	typedef enum {
+		AREA, //!< By their area, the big triangles count more.
+		ANGLE //!< By their angle at the vertex, so a fan cut into thin triangles counts the same.
+	} Weighting_e;
+
+	/**
+	 * @struct Normals
+	 * @brief The unit normals, as x y z triplets : the one of the triangle f is faces[3*f] ... faces[3*f+2],
+	 * the one of the vertex v is vertices[3*v] ... vertices[3*v+2]. A degenerate triangle, or a vertex
+	 * without any triangle, gets (0, 0, 0).
+	 */
+	struct Normals final
+	{
+		std::vector<VertexType>    faces;      //!< The normal of each triangle.
+		std::vector<VertexType>    vertices;   //!< The normal of each vertex.
+		std::vector<VertexType>    sums;       //!< The weighted sum of each vertex, before normalization.
+		std::vector<VertexType>    weights;    //!< The weight of each corner of each triangle, 3 per triangle.
+		std::vector<IndexVertex_t> corners;    //!< The vertices of each triangle when its normal was computed.
+		Weighting_e                weighting;  //!< How the vertex normals are weighted.
+		uint64_t                   generation; //!< The Mesh generation these normals have been computed for.
+	};
+
+	/**
+	 * @brief Compute the normal of every triangle and of every vertex.
+	 * @param[in] vertices  The vertices  of the mesh.
+	 * @param[in] triangles The triangles of the mesh.
+	 * @param[in] weighting How the triangles are weighted around a vertex.
+	 * @return The normals, their generation is left to the caller.
+	 */
+	Normals build(const VertexContainer& vertices, const TriangleContainer& triangles, Weighting_e weighting);
+
+	/**
+	 * @brief Update \p normals after some triangles changed, without moving any existing vertex.
+	 * The triangles after the ones of \p normals are the new ones, they don't need to be in \p changed.
+	 * @param[in]    vertices  The vertices  of the mesh, the new ones after the previous ones.
+	 * @param[in]    triangles The triangles of the mesh, the new ones after the previous ones.
+	 * @param[in]    changed   The indexes of the previous triangles which have been rewritten, repeated or not.
+	 * @param[inout] normals   The normals to update.
+	 */
+	void update(const VertexContainer& vertices, const TriangleContainer& triangles, const std::vector<IndexFace_t>& changed, Normals& normals);
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ * @file outofcore.hpp
+ * @brief Offers the processing of meshes bigger than the memory, kept on the disk.
+ *
+ * An OFF file is read by chunks and converted into binary files of fixed size records (a Store),
+ * so any range of vertices or triangles is read back by a single seek. The adjacency is built by
+ * external sorts : the edges of every triangle are sorted by runs which fit in the memory, then the
+ * runs are merged, which brings the 2 sides of each edge next to each other. The passes then go
+ * through the triangles by windows of a bounded size, each one with only the vertices it uses.
+ * @author MTLCRBN
+ */
+#ifndef OUTOFCORE_HPP_INCLUDED
+#define OUTOFCORE_HPP_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "common.hpp"
+
+namespace outofcore
+{
+	const size_t DEFAULT_MEMORY = 256u << 20; //!< The default bound of the buffers, in bytes.
+
+	/**
+	 * @struct Store
+	 * @brief A mesh on the disk. Its files are prefix + ".vertices" (x y z as VertexType), ".triangles"
+	 * (3 IndexVertex_t) and ".neighbors" (3 IndexFace_t, the one opposite to each vertex, -1 for none),
+	 * plus ".normals" (x y z as VertexType) once computeNormals() is done.
+	 */
+	struct Store final
+	{
+		std::string prefix;          //!< The path of the files, without their extension.
+		size_t      memory;          //!< The bound of the buffers of every pass, in bytes.
+		uint64_t    nbVertices  = 0;
+		uint64_t    nbTriangles = 0;
+		uint64_t    borders     = 0; //!< The edges with a single triangle.
+		uint64_t    nonManifold = 0; //!< The edges shared by more than 2 triangles, left without neighbors.
+		VertexType  low[3];          //!< The lowest  corner of the bounding box.
+		VertexType  high[3];         //!< The highest corner of the bounding box.
+	};
+
+	/**
+	 * @struct Window
+	 * @brief Some consecutive triangles of a Store, with the vertices they use.
+	 */
+	struct Window final
+	{
+		uint64_t                   begin;     //!< The index of the first triangle.
+		uint32_t                   size;      //!< The number of triangles.
+		std::vector<uint32_t>      corners;   //!< The 3 vertices of each triangle, as indexes into ids.
+		std::vector<IndexFace_t>   neighbors; //!< The 3 neighbors of each triangle, as indexes of the Store.
+		std::vector<IndexVertex_t> ids;       //!< The vertices used by the window, as indexes of the Store, sorted.
+		std::vector<VertexType>    points;    //!< The x y z of each vertex of ids.
+	};
+
+	/**
+	 * @struct Statistics
+	 * @brief What a pass over every triangle measures.
+	 */
+	struct Statistics final
+	{
+		uint64_t   nbVertices;
+		uint64_t   nbTriangles;
+		uint64_t   borders;     //!< The edges with a single triangle.
+		uint64_t   nonManifold; //!< The edges shared by more than 2 triangles.
+		uint64_t   degenerated; //!< The triangles with an area of 0.
+		VertexType area;        //!< The area of the whole surface.
+		VertexType shortest;    //!< The length of the shortest edge.
+		VertexType longest;     //!< The length of the longest  edge.
+		VertexType mean;        //!< The mean length of the edges, each one counted once.
+	};
+
+	/**
+	 * @brief Convert the OFF file \p fname into a Store, without ever holding more than \p memory bytes.
+	 * The polygons with more than 3 vertices are split in fans of triangles.
+	 * @param[in] fname  The OFF file.
+	 * @param[in] prefix The path of the files of the Store, its directory must exist.
+	 * @param[in] memory The bound of the buffers, in bytes.
+	 * @return The Store.
+	 * @throw std::runtime_error If the file can't be read or written, or isn't a valid OFF.
+	 */
+	Store convert(const std::string& fname, const std::string& prefix, size_t memory = DEFAULT_MEMORY);
+	/**
+	 * @brief Remove the files of \p store.
+	 */
+	void discard(const Store& store);
+
+	/**
+	 * @brief Call \p pass over every triangle of \p store, window by window, in the order of the triangles.
+	 * A window holds about store.memory bytes.
+	 * @throw std::runtime_error If the files can't be read.
+	 */
+	void forEachWindow(const Store& store, const std::function<void(const Window&)>& pass);
+
+	/**
+	 * @brief Measure the triangles and the edges of \p store.
+	 */
+	Statistics statistics(const Store& store);
+	/**
+	 * @brief Compute the normal of every vertex, the normals of its triangles weighted by their areas,
+	 * into the file prefix + ".normals" : the contributions of the triangles are sorted by vertex on the disk,
+	 * then summed. A vertex without any triangle gets 0.
+	 */
+	void computeNormals(const Store& store);
+	/**
+	 * @brief Simplify \p store into a mesh small enough for the memory, by clustering its vertices on
+	 * a grid (Lindstrom) : the vertices of a cell become a single one, at the minimum of the quadric of
+	 * their triangles, and only the triangles over 3 different cells are kept. The copies of a triangle
+	 * going opposite ways cancel each other, the others are all kept, so a closed surface stays closed.
+	 * @param[in]  store      The mesh to simplify.
+	 * @param[in]  resolution The number of cells along the biggest extent of the bounding box.
+	 * @param[out] vertices   The vertices  of the result.
+	 * @param[out] triangles  The triangles of the result, with their neighbors.
+	 */
+	void cluster(const Store& store, uint32_t resolution, VertexContainer& vertices, TriangleContainer& triangles);
+	/**
+	 * @brief Get the resolution for which cluster() gives about \p targetFaces triangles, from the area of the surface.
+	 */
+	uint32_t resolutionFor(const Statistics& statistics, const Store& store, uint32_t targetFaces);
+	/**
+	 * @brief Write \p store as the OFF file \p fname, by windows.
+	 * @throw std::runtime_error If a file can't be read or written.
+	 */
+	void dump(const Store& store, const std::string& fname);
+}
+
+#endif
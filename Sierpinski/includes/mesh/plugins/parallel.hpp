@@ -0,0 +1,87 @@
+/**
+ * @file parallel.hpp
+ * @brief Some small wrappers around OpenMP for Mesh and cie.
+ *
+ * Every parallel loop uses OpenMP pragmas, so without -fopenmp it just
+ * compiles (and runs) sequentially, and these functions behave like a single thread.
+ * @author MTLCRBN
+ */
+#ifndef PARALLEL_HPP_INCLUDED
+#define PARALLEL_HPP_INCLUDED
+
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
+namespace parallel
+{
+	/**
+	 * @brief Get the maximal number of threads a parallel region could use.
+	 * @return 1 without OpenMP, the OpenMP value otherwise.
+	 */
+	inline int32_t maxThreads(void)
+	{
+	#ifdef _OPENMP
+		return omp_get_max_threads();
+	#else
+		return 1;
+	#endif
+	}
+	/**
+	 * @brief Get the index of the calling thread inside the current parallel region.
+	 * @return A value between [0, maxThreads()[, 0 outside of any parallel region.
+	 */
+	inline int32_t threadIndex(void)
+	{
+	#ifdef _OPENMP
+		return omp_get_thread_num();
+	#else
+		return 0;
+	#endif
+	}
+
+	/**
+	 * @brief Store \p op(x) for each \b x of [\p first, \p last[ into \p out, like std::transform(),
+	 * with the elements shared between the threads.
+	 * @param[in]  first The beginning of the input, a random access iterator.
+	 * @param[in]  last  The end of the input.
+	 * @param[out] out   The beginning of the output, a random access iterator, with enough room.
+	 * @param[in]  op    The operation, called from every thread at once.
+	 * @return The end of the output.
+	 */
+	template<typename InputIt, typename OutputIt, typename Operation>
+	OutputIt transform(InputIt first, InputIt last, OutputIt out, Operation op)
+	{
+		static_assert(std::is_same<typename std::iterator_traits<InputIt>::iterator_category, std::random_access_iterator_tag>::value &&
+		              std::is_same<typename std::iterator_traits<OutputIt>::iterator_category, std::random_access_iterator_tag>::value,
+		              "parallel::transform() needs random access iterators");
+		const int64_t nb = last - first;
+		// Private copies, or each access would go through the shared ones and nothing could be kept in registers.
+		#pragma omp parallel for schedule(static) firstprivate(first, out, op)
+		for(int64_t i=0;i<nb;++i)
+		{
+			out[i] = op(first[i]);
+		}
+		return out + nb;
+	}
+	/**
+	 * @brief Call \p op(x) for each \b x of [\p first, \p last[, like std::for_each(), from every thread at once.
+	 */
+	template<typename Iterator, typename Operation>
+	void forEach(Iterator first, Iterator last, Operation op)
+	{
+		static_assert(std::is_same<typename std::iterator_traits<Iterator>::iterator_category, std::random_access_iterator_tag>::value,
+		              "parallel::forEach() needs random access iterators");
+		const int64_t nb = last - first;
+		#pragma omp parallel for schedule(static) firstprivate(first, op)
+		for(int64_t i=0;i<nb;++i)
+		{
+			op(first[i]);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file quality.hpp
+ * @brief Offers a quality analysis of every triangles of a mesh at once.
+ * @author MTLCRBN
+ */
+#ifndef QUALITY_HPP_INCLUDED
+#define QUALITY_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include "common.hpp"
+
+namespace quality
+{
+	/**
+	 * @struct Histogram
+	 * @brief Counts the values inside regular bins between low and high (the outsiders go to the ends).
+	 */
+	struct Histogram final
+	{
+		VertexType            low;    //!< The lower bound of the first bin.
+		VertexType            high;   //!< The upper bound of the last bin.
+		std::vector<uint32_t> counts; //!< The number of values inside each bin.
+	};
+
+	/**
+	 * @struct Report
+	 * @brief The quality measures of each triangle, with the same indexes, and some summaries.
+	 */
+	struct Report final
+	{
+		std::vector<VertexType>  minAngle;      //!< The smallest angle, in degrees.
+		std::vector<VertexType>  maxAngle;      //!< The widest   angle, in degrees.
+		std::vector<VertexType>  radiusEdge;    //!< Circumradius over the shortest edge, 1/sqrt(3) at best.
+		std::vector<VertexType>  area;          //!< The area.
+		std::vector<VertexType>  aspect;        //!< Longest edge over 2*sqrt(3)*inradius, 1 at best.
+		Histogram                minAngles;     //!< The smallest angles, over [0, 60].
+		Histogram                maxAngles;     //!< The widest   angles, over [60, 180].
+		std::vector<IndexFace_t> worst;         //!< The triangles with the smallest angles, the worst first.
+		VertexType               smallestAngle; //!< The smallest angle of the whole mesh.
+		VertexType               largestAngle;  //!< The widest   angle of the whole mesh.
+	};
+
+	/**
+	 * @brief Measure every triangle of a mesh, in 3D.
+	 * @param[in] vertices  The vertices  of the mesh.
+	 * @param[in] triangles The triangles of the mesh.
+	 * @param[in] bins      The number of bins of the histograms.
+	 * @param[in] k         The number of worst triangles to keep.
+	 * @return The full report.
+	 */
+	Report analyze(const VertexContainer& vertices, const TriangleContainer& triangles, uint32_t bins, uint32_t k);
+}
+
+#endif
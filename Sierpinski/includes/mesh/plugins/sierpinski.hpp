@@ -0,0 +1,49 @@
+/**
+ * @file sierpinski.hpp
+ * @brief Offers a generator of Sierpinski gaskets, the triangle one in 2D and the tetrahedral one in 3D.
+ *
+ * A gasket of depth d is a tree : the root is the whole triangle (or tetrahedron), and each node of depth
+ * k < d is split into its 3 (or 4) corner copies of half size, which share the midpoints of its edges.
+ * So every vertex is created by a single node, and its index is computed from the place of this node
+ * in the tree instead of being searched : nothing is merged afterwards, and the subtrees are written
+ * in parallel, straight into arrays sized once.
+ * @author MTLCRBN
+ */
+#ifndef SIERPINSKI_HPP_INCLUDED
+#define SIERPINSKI_HPP_INCLUDED
+
+#include <cstdint>
+#include "common.hpp"
+
+namespace sierpinski
+{
+	const uint32_t MAX_DEPTH_2D = 19; //!< The deepest 2D gasket whose triangles can be indexed by an IndexFace_t.
+	const uint32_t MAX_DEPTH_3D = 14; //!< The deepest 3D gasket whose triangles can be indexed by an IndexFace_t.
+
+	/**
+	 * @brief Get the number of vertices of a gasket.
+	 * @param[in] depth       The number of subdivisions.
+	 * @param[in] tetrahedral true for the 3D gasket, false for the 2D one.
+	 * @return (3^(depth+1) + 3)/2 in 2D, 2*4^depth + 2 in 3D.
+	 */
+	uint64_t nbVertices(uint32_t depth, bool tetrahedral);
+	/**
+	 * @brief Get the number of triangles of a gasket.
+	 * @return 3^depth in 2D, 4^(depth+1) in 3D (the 4 faces of each tetrahedron).
+	 */
+	uint64_t nbTriangles(uint32_t depth, bool tetrahedral);
+
+	/**
+	 * @brief Generate a gasket centered on 0, inside the unit circle (2D) or sphere (3D), counter clockwise.
+	 * The neighbors of the triangles are filled : the 4 faces of a tetrahedron are neighbors of each other,
+	 * whereas the 2D triangles only touch by their corners, so they have none.
+	 * @param[in]  depth       The number of subdivisions.
+	 * @param[in]  tetrahedral true for the 3D gasket, false for the 2D one.
+	 * @param[out] vertices    The vertices, resized to nbVertices().
+	 * @param[out] triangles   The triangles, resized to nbTriangles().
+	 * @throw std::invalid_argument If \p depth is over MAX_DEPTH_2D or MAX_DEPTH_3D.
+	 */
+	void generate(uint32_t depth, bool tetrahedral, VertexContainer& vertices, TriangleContainer& triangles);
+}
+
+#endif
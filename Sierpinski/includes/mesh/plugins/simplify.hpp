@@ -0,0 +1,100 @@
+/**
+ * @file simplify.hpp
+ * @brief Offers a simplification of a 3D mesh, by collapsing the edges which change its shape the least.
+ *
+ * Each vertex sums the planes of its triangles into a quadric (Garland and Heckbert), which gives
+ * the squared distance of any point to these planes. A vertex collapses into the neighbor, and at
+ * the position, with the lowest quadric, the cheapest vertex first, thanks to an indexed heap.
+ * @author MTLCRBN
+ */
+#ifndef SIMPLIFY_HPP_INCLUDED
+#define SIMPLIFY_HPP_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "common.hpp"
+
+namespace simplify
+{
+	const VertexType SINGULAR = 1e-8; //!< Under this determinant (relative), a Quadric has no single minimum.
+
+	/**
+	 * @struct Quadric
+	 * @brief A symmetric 4x4 matrix, summing the squared distances to some planes ax + by + cz + d = 0.
+	 * Only its upper part is stored : a², ab, ac, ad, b², bc, bd, c², cd, d².
+	 */
+	struct Quadric final
+	{
+		VertexType q[10];
+
+		Quadric(void)
+		{
+			std::fill(this->q, this->q+10, 0.0);
+		}
+		/**
+		 * @brief The quadric of the plane ax + by + cz + d = 0, with a unit normal, multiplied by \p w.
+		 */
+		Quadric(VertexType a, VertexType b, VertexType c, VertexType d, VertexType w)
+		{
+			VertexType values[10] = {a*a, a*b, a*c, a*d, b*b, b*c, b*d, c*c, c*d, d*d};
+			std::transform(values, values+10, this->q, [w](VertexType value){return value*w;});
+		}
+		Quadric& operator+=(const Quadric& other)
+		{
+			std::transform(this->q, this->q+10, other.q, this->q, [](VertexType a, VertexType b){return a+b;});
+			return *this;
+		}
+		Quadric operator+(const Quadric& other) const
+		{
+			Quadric result(*this);
+			return result += other;
+		}
+		/**
+		 * @brief Get the sum of the squared distances of \p p to the planes.
+		 */
+		VertexType error(const Vertex& p) const
+		{
+			const VertexType x = p.x(), y = p.y(), z = p.z();
+			return this->q[0]*x*x + 2.0*this->q[1]*x*y + 2.0*this->q[2]*x*z + 2.0*this->q[3]*x
+			     + this->q[4]*y*y + 2.0*this->q[5]*y*z + 2.0*this->q[6]*y
+			     + this->q[7]*z*z + 2.0*this->q[8]*z
+			     + this->q[9];
+		}
+		/**
+		 * @brief Find the point with the lowest error, by solving the 3x3 system with Cramer's rule.
+		 * @param[out] p The point, only set on success.
+		 * @return false if the planes don't meet at a single point (flat or cylindrical area).
+		 */
+		bool minimum(Vertex& p) const
+		{
+			const VertexType* m = this->q;
+			VertexType det   = m[0]*(m[4]*m[7] - m[5]*m[5]) - m[1]*(m[1]*m[7] - m[5]*m[2]) + m[2]*(m[1]*m[5] - m[4]*m[2]);
+			VertexType trace = m[0] + m[4] + m[7];
+			if (std::fabs(det) <= SINGULAR*trace*trace*trace)
+			{
+				return false;
+			}
+			VertexType bx = -m[3], by = -m[6], bz = -m[8];
+			p.x((bx*(m[4]*m[7] - m[5]*m[5]) - m[1]*(by*m[7] - m[5]*bz) + m[2]*(by*m[5] - m[4]*bz))/det);
+			p.y((m[0]*(by*m[7] - m[5]*bz) - bx*(m[1]*m[7] - m[5]*m[2]) + m[2]*(m[1]*bz - by*m[2]))/det);
+			p.z((m[0]*(m[4]*bz - by*m[5]) - m[1]*(m[1]*bz - by*m[2]) + bx*(m[1]*m[5] - m[4]*m[2]))/det);
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Collapse edges of a mesh until it has \p targetFaces triangles or less.
+	 * The adjacency is updated along the collapses, then both containers are compacted.
+	 * A collapse which would fold a triangle or make the mesh non manifold is never done,
+	 * so the target may not be reached.
+	 * @param[inout] vertices    The vertices  of the mesh.
+	 * @param[inout] triangles   The triangles of the mesh, with their neighbors.
+	 * @param[in]    targetFaces The number of triangles wanted.
+	 * @return The number of collapsed edges.
+	 * @post Every vertex has a valid face.
+	 */
+	uint32_t collapse(VertexContainer& vertices, TriangleContainer& triangles, uint32_t targetFaces);
+}
+
+#endif
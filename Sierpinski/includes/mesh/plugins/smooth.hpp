@@ -0,0 +1,32 @@
+/**
+ * @file smooth.hpp
+ * @brief Offers a smoothing of a mesh, which removes the noise of a scan without shrinking it (Taubin).
+ *
+ * Each step moves every vertex toward (\b lambda > 0), then away from (\b mu < -lambda), the centroid
+ * of its neighbors. The coordinates are copied into two sets of arrays, one read and one written by
+ * every step, so the vertices are moved in parallel and nothing is allocated along the iterations.
+ * @author MTLCRBN
+ */
+#ifndef SMOOTH_HPP_INCLUDED
+#define SMOOTH_HPP_INCLUDED
+
+#include <cstdint>
+#include "common.hpp"
+#include "adjacency.hpp"
+
+namespace smooth
+{
+	/**
+	 * @brief Smooth \p vertices by \p iterations steps of lambda and mu.
+	 * @param[inout] vertices    The vertices to move.
+	 * @param[in]    adjacency   Their one-rings, see adjacency::build().
+	 * @param[in]    iterations  The number of lambda|mu pairs.
+	 * @param[in]    lambda      The shrinking factor, between ]0, 1[.
+	 * @param[in]    mu          The inflating factor, negative, a bit bigger than \p lambda (like -0.53 for 0.5).
+	 * @param[in]    fixedBorder true to keep the vertices on the border (and the non-manifold ones) where they are.
+	 * @return The number of vertex moves done, 2 per iteration for each moving vertex.
+	 */
+	uint64_t taubin(VertexContainer& vertices, const adjacency::Vertices& adjacency, uint32_t iterations, double lambda, double mu, bool fixedBorder);
+}
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * @file spatial_sort.hpp
+ * @brief Offers some functions to sort vertices in a spatially coherent order.
+ * @author MTLCRBN
+ */
+#ifndef SPATIAL_SORT_HPP_INCLUDED
+#define SPATIAL_SORT_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include "common.hpp"
+
+namespace spatial
+{
+	/**
+	 * @brief Compute the position of the point (\p x, \p y) along a Hilbert curve of order 16.
+	 * @param[in] x The x coordinate, quantized on [0, 65535].
+	 * @param[in] y The y coordinate, quantized on [0, 65535].
+	 * @return The distance along the curve.
+	 */
+	uint64_t hilbertIndex(uint32_t x, uint32_t y);
+	
+	/**
+	 * @brief Sort the indexes of \p vertices along a Hilbert curve of their bounding box (in xy).
+	 * Two consecutive vertices in this order are close to each other, which helps any
+	 * point location walking from the previous one.
+	 * @param[in] vertices The vertices to sort.
+	 * @return The indexes of \p vertices, in the Hilbert order.
+	 */
+	std::vector<uint32_t> hilbertOrder(const VertexContainer& vertices);
+}
+
+#endif
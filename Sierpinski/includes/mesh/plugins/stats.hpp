@@ -0,0 +1,206 @@
+/**
+ * @file stats.hpp
+ * @brief Offers some counters and scoped timers over the hot paths of Mesh, to see where the time goes.
+ *
+ * Each thread counts into its own slots, without any lock nor atomic read-modify-write, so a counter
+ * costs a single addition. The slots of every thread are only summed when a Report is collected.
+ * Without MESH_STATS defined, STATS_COUNT() and STATS_TIME() expand to nothing, so the instrumented
+ * code is exactly the original one, and the reports stay empty.
+ * @author MTLCRBN
+ */
+#ifndef STATS_HPP_INCLUDED
+#define STATS_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace stats
+{
+	//! @brief What is counted.
+	typedef enum {
+		ORIENTATION,      //!< Calls of orientation2D().
+		WELL_ORIENTED,    //!< Calls of isWellOriented().
+		IN_TRIANGLE,      //!< Calls of isInThisTriangle().
+		IN_CIRCLE,        //!< Calls of isInSurroundingCircle().
+		IN_DIAMETRAL,     //!< Calls of isInCircleOfDiametral().
+		POOR_QUALITY,     //!< Calls of isPoorQuality().
+		LOCATIONS,        //!< Searches of the triangle which contains a vertex.
+		LOCATION_VISITS,  //!< Triangles visited by these searches.
+		LINEAR_SCANS,     //!< Searches done by testing every triangle, without any walk.
+		INSERTIONS,       //!< Vertices inserted into a triangulation.
+		FLIPS,            //!< Edges flipped to restore the Delaunay property.
+		CAVITY_TRIANGLES, //!< Triangles replaced by the insertions (the cavity of each one).
+		COUNTERS_NUMBER
+	} Counter_e;
+
+	//! @brief What is timed.
+	typedef enum {
+		LOAD_PTS,    //!< Mesh::load2DTriangulationFromPts().
+		CRUST,       //!< Mesh::Crust().
+		NN_CRUST,    //!< Mesh::NNCrust().
+		CONSTRAINTS, //!< The insertion of the segments by Mesh::loadConstraints().
+		REFINE,      //!< Ruppert's refinement.
+		LOAD_OFF,    //!< Mesh::loadMeshFromOff().
+		DUMP_OFF,    //!< Mesh::dumpToOff().
+		SIMPLIFY,    //!< Mesh::simplify().
+		QUALITY,     //!< Mesh::computeQuality().
+		VORONOI,     //!< The rebuilds of Mesh::getVoronoi().
+		VALIDATE,    //!< Mesh::validate().
+		ADJACENCY,   //!< Mesh::buildVertexAdjacency().
+		SMOOTH,      //!< Mesh::smooth(), its adjacency included.
+		NORMALS,     //!< The builds and updates of Mesh::getNormals().
+		LAPLACIAN,   //!< Mesh::buildLaplacian().
+		CURVATURES,  //!< Mesh::computeCurvatures(), its adjacency and laplacian included.
+		KDTREE,      //!< The rebuilds of Mesh::getKdTree().
+		BVH,         //!< The rebuilds of Mesh::getBvh().
+		GASKET,      //!< Mesh::loadGasket().
+		CLUSTER,     //!< Mesh::loadClustered().
+		COMPONENTS,  //!< Mesh::analyzeComponents().
+		ENCODE,      //!< Mesh::dumpCompressed().
+		DECODE,      //!< Mesh::loadCompressed().
+		TIMERS_NUMBER
+	} Timer_e;
+
+	/**
+	 * @struct Report
+	 * @brief The sums of every counter and timer.
+	 */
+	struct Report final
+	{
+		uint64_t counters[COUNTERS_NUMBER]; //!< The sum of each counter.
+		uint64_t largest[COUNTERS_NUMBER];  //!< The largest single addition to each counter (the largest cavity, ...).
+		double   seconds[TIMERS_NUMBER];    //!< The time spent inside each stage.
+		uint64_t calls[TIMERS_NUMBER];      //!< The number of times each stage ran.
+	};
+
+	/**
+	 * @brief Check if the counters are compiled in.
+	 * @return true with MESH_STATS defined, false otherwise.
+	 */
+	constexpr bool enabled(void)
+	{
+	#ifdef MESH_STATS
+		return true;
+	#else
+		return false;
+	#endif
+	}
+	std::string name(Counter_e counter);
+	std::string name(Timer_e timer);
+	/**
+	 * @brief Sum the counters and timers of every thread since the last reset().
+	 */
+	Report collect(void);
+	/**
+	 * @brief Get the counters and timers of the calling thread only, like the work of a single file of a batch.
+	 * Its largest values are the ones since the last restartLargest() of this thread.
+	 */
+	Report thisThread(void);
+	/**
+	 * @brief Start the largest values of the calling thread again from 0, as seen by thisThread(),
+	 * collect() still getting the largest ones since the last reset().
+	 */
+	void restartLargest(void);
+	/**
+	 * @brief Set every counter and timer back to 0.
+	 * @pre No instrumented algorithm is running, or its counts may be partially kept.
+	 */
+	void reset(void);
+	/**
+	 * @brief Subtract \p before from \p after, to get what happened between them.
+	 * The largest values can't be subtracted, they are the ones of \p after : restartLargest() when
+	 * \p before is taken gets the ones in between.
+	 */
+	Report difference(const Report& after, const Report& before);
+	/**
+	 * @brief Write \p report as a readable text, one line per non zero value, with the averages
+	 * (visits per location, flips per insertion, ...).
+	 */
+	std::string format(const Report& report);
+
+	/**
+	 * @struct Slots
+	 * @brief The counters of a thread : only this thread writes them, the others only read them.
+	 */
+	struct Slots final
+	{
+		std::atomic<uint64_t> counters[COUNTERS_NUMBER];
+		std::atomic<uint64_t> largest[COUNTERS_NUMBER]; //!< Since the last restartLargest().
+		std::atomic<uint64_t> kept[COUNTERS_NUMBER];    //!< Before the last restartLargest().
+		std::atomic<uint64_t> nanoseconds[TIMERS_NUMBER];
+		std::atomic<uint64_t> calls[TIMERS_NUMBER];
+		bool                  enrolled; //!< true once the slots are known by collect().
+	};
+	extern thread_local Slots local; //!< The slots of the calling thread.
+	/**
+	 * @brief Make the slots of the calling thread known by collect(), until the thread ends.
+	 */
+	void enroll(void);
+
+	/**
+	 * @brief Add \p value to the given slot, without any atomic read-modify-write : only its thread writes it.
+	 */
+	inline void increase(std::atomic<uint64_t>& slot, uint64_t value)
+	{
+		slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+	/**
+	 * @brief Add \p value to \p counter, for the calling thread.
+	 */
+	inline void add(Counter_e counter, uint64_t value = 1)
+	{
+		if (!local.enrolled)
+		{
+			enroll();
+		}
+		increase(local.counters[counter], value);
+		if (value > local.largest[counter].load(std::memory_order_relaxed))
+		{
+			local.largest[counter].store(value, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @class ScopedTimer
+	 * @brief Adds the time between its construction and its destruction to a timer.
+	 */
+	class ScopedTimer final
+	{
+		public:
+			explicit ScopedTimer(Timer_e timer) : timer(timer), start(std::chrono::steady_clock::now())
+			{
+			}
+			~ScopedTimer(void)
+			{
+				std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - this->start;
+				if (!local.enrolled)
+				{
+					enroll();
+				}
+				increase(local.nanoseconds[this->timer], elapsed.count());
+				increase(local.calls[this->timer], 1);
+			}
+			ScopedTimer(const ScopedTimer&)            = delete;
+			ScopedTimer& operator=(const ScopedTimer&) = delete;
+		private:
+			Timer_e                               timer;
+			std::chrono::steady_clock::time_point start;
+	};
+}
+
+#ifdef MESH_STATS
+	#define STATS_CONCAT_(a, b) a##b
+	#define STATS_CONCAT(a, b)  STATS_CONCAT_(a, b)
+	//! @brief Add \p value to the counter \p counter (a stats::Counter_e without its namespace).
+	#define STATS_COUNT(counter, value) stats::add(stats::counter, (value))
+	//! @brief Time the rest of the current scope into \p timer (a stats::Timer_e without its namespace).
+	#define STATS_TIME(timer) stats::ScopedTimer STATS_CONCAT(scopedTimer, __LINE__)(stats::timer)
+#else
+	// sizeof() doesn't evaluate the value, it only keeps a variable counted from being seen as unused.
+	#define STATS_COUNT(counter, value) ((void)sizeof(value))
+	#define STATS_TIME(timer)           ((void)0)
+#endif
+
+#endif
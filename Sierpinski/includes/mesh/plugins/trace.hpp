@@ -0,0 +1,87 @@
+/**
+ * @file trace.hpp
+ * @brief Offers a timeline of the Mesh stages, written in the Chrome trace event format
+ * (to open with chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Each thread appends its events to its own buffer, without any lock, and a thread is a track of
+ * the timeline. The buffers are only written into the file by stop(). While nothing is recorded,
+ * a TRACE_SCOPE() costs a single test, and without MESH_STATS defined it doesn't exist at all.
+ * @author MTLCRBN
+ */
+#ifndef TRACE_HPP_INCLUDED
+#define TRACE_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "stats.hpp"
+
+namespace trace
+{
+	/**
+	 * @brief Start recording the events, every previous one is forgotten.
+	 * @param[in] fname The JSON file which stop() will write.
+	 * @pre No instrumented algorithm is running.
+	 */
+	void start(const std::string& fname);
+	/**
+	 * @brief Stop recording, and write every event into the file given to start().
+	 * Nothing is done if nothing is recorded.
+	 * @throw std::runtime_error If the file can't be written.
+	 * @pre No instrumented algorithm is running, or its unfinished scopes are lost.
+	 */
+	void stop(void);
+
+	extern std::atomic<bool> recording; //!< true between start() and stop().
+	/**
+	 * @brief Begin an event named \p name on the calling thread.
+	 * @param[in] name A string which lives until stop(), like a literal.
+	 * @return The index of the event inside the buffer of this thread.
+	 */
+	int32_t open(const char* name);
+	/**
+	 * @brief End the event \p index of the calling thread.
+	 */
+	void close(int32_t index);
+	/**
+	 * @brief Attach \p value to the innermost unfinished event of the calling thread (2 values at most per event).
+	 * @param[in] key A string which lives until stop(), like a literal.
+	 */
+	void value(const char* key, int64_t value);
+
+	/**
+	 * @class Scope
+	 * @brief An event which lasts from its construction to its destruction.
+	 */
+	class Scope final
+	{
+		public:
+			explicit Scope(const char* name) : index(recording.load(std::memory_order_relaxed) ? open(name) : -1)
+			{
+			}
+			~Scope(void)
+			{
+				if (this->index != -1)
+				{
+					close(this->index);
+				}
+			}
+			Scope(const Scope&)            = delete;
+			Scope& operator=(const Scope&) = delete;
+		private:
+			int32_t index; //!< -1 if nothing was recording at the beginning.
+	};
+}
+
+#ifdef MESH_STATS
+	//! @brief Record the rest of the current scope as an event named \p name (a literal).
+	#define TRACE_SCOPE(name) trace::Scope STATS_CONCAT(traceScope, __LINE__)(name)
+	//! @brief Attach \p number under \p key (a literal) to the innermost TRACE_SCOPE() of this thread.
+	#define TRACE_VALUE(key, number) (trace::recording.load(std::memory_order_relaxed) ? trace::value(key, (number)) : (void)0)
+#else
+	#define TRACE_SCOPE(name)       ((void)0)
+	#define TRACE_VALUE(key, number) ((void)sizeof(number))
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file validation.hpp
+ * @brief Offers a check of the topology and of the Delaunay property of a whole mesh at once.
+ *
+ * Every triangle and every vertex is checked independently, so the checks run in parallel,
+ * and each thread only keeps its counts and a few examples. Nothing is modified.
+ * @author MTLCRBN
+ */
+#ifndef VALIDATION_HPP_INCLUDED
+#define VALIDATION_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include "common.hpp"
+
+namespace validation
+{
+	//! @brief What can be wrong.
+	typedef enum {
+		BAD_INDEX,      //!< A triangle with a vertex or a neighbor out of range, or twice the same vertex.
+		ASYMMETRIC,     //!< A triangle which isn't a neighbor of its own neighbor.
+		COMMON_EDGE,    //!< Two neighbors whose getCommonEdge() aren't the same edge.
+		WINDING,        //!< Two neighbors which go through their common edge in the same direction.
+		FACE_HINT,      //!< A vertex whose face doesn't contain it (the examples are vertices).
+		CLOCKWISE,      //!< A triangle which isn't counterclockwise (or flat), in the xy plane.
+		NOT_DELAUNAY,   //!< An unconstrained edge whose opposite vertex is strictly inside the other circle.
+		PROBLEMS_NUMBER
+	} Problem_e;
+
+	const uint32_t EXAMPLES = 8; //!< The number of examples kept for each problem.
+
+	/**
+	 * @struct Report
+	 * @brief The number of each problem, with the first triangles (or vertices) which have it.
+	 */
+	struct Report final
+	{
+		uint64_t                 counts[PROBLEMS_NUMBER];   //!< The number of each problem.
+		std::vector<int32_t>     examples[PROBLEMS_NUMBER]; //!< The smallest indexes having each problem, EXAMPLES at most.
+		uint32_t                 vertices;                  //!< The number of vertices  checked.
+		uint32_t                 triangles;                 //!< The number of triangles checked.
+		bool                     planar;                    //!< true if CLOCKWISE and NOT_DELAUNAY were checked.
+	};
+
+	/**
+	 * @brief Check every triangle and every vertex of a mesh.
+	 * @param[in] vertices    The vertices  of the mesh.
+	 * @param[in] triangles   The triangles of the mesh.
+	 * @param[in] constrained The edges which don't have to be Delaunay.
+	 * @param[in] planar      true to check the orientation and the Delaunay property in the xy plane,
+	 *                        which only mean something for a 2D triangulation.
+	 * @return The report, without any problem for a valid mesh.
+	 */
+	Report check(const VertexContainer& vertices, const TriangleContainer& triangles, const ConstrainedEdges_c& constrained, bool planar);
+	/**
+	 * @brief Check if \p report has no problem.
+	 */
+	bool valid(const Report& report);
+	std::string name(Problem_e problem);
+	/**
+	 * @brief Write \p report as a readable text, one line per problem found with its examples.
+	 */
+	std::string format(const Report& report);
+}
+
+#endif
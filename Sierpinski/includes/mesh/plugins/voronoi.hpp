@@ -0,0 +1,58 @@
+/**
+ * @file voronoi.hpp
+ * @brief Offers the voronoi diagram, dual of a 2D triangulation.
+ * @author MTLCRBN
+ */
+#ifndef VORONOI_HPP_INCLUDED
+#define VORONOI_HPP_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include "common.hpp"
+
+namespace voronoi
+{
+	/**
+	 * @struct Diagram
+	 * @brief The voronoi diagram of a 2D triangulation. The cells are stored contiguously :
+	 * the cell of the vertex v is made of the centers cells[offsets[v]] ... cells[offsets[v+1]-1].
+	 * The cell of a vertex whose triangles don't make a single fan (not manifold) is empty and unbounded.
+	 */
+	struct Diagram final
+	{
+		VertexContainer          centers;    //!< The center of the surrounding circle of each triangle, with the same index.
+		std::vector<uint32_t>    offsets;    //!< Where each cell begins in cells, one more than the number of vertices.
+		std::vector<IndexFace_t> cells;      //!< The centers of each cell, counter-clockwise.
+		std::vector<uint8_t>     closed;     //!< 1 if the cell is bounded, 0 if its vertex is on the border (or not manifold).
+		uint64_t                 generation; //!< The Mesh generation this diagram has been built for.
+	};
+
+	/**
+	 * @brief Build the voronoi diagram of a 2D triangulation.
+	 * @param[in] vertices  The vertices  of the triangulation.
+	 * @param[in] triangles The triangles of the triangulation, with their neighbors.
+	 * @return The full diagram, its generation is left to the caller.
+	 */
+	Diagram build(const VertexContainer& vertices, const TriangleContainer& triangles);
+
+	/**
+	 * @brief Compute the area of the cell of \p v.
+	 * @param[in] diagram The diagram.
+	 * @param[in] v       The index of the vertex.
+	 * @return The area, or infinity if the cell is not bounded.
+	 */
+	VertexType area(const Diagram& diagram, IndexVertex_t v);
+
+	/**
+	 * @brief Get the number of centers of the cell of \p v.
+	 * @param[in] diagram The diagram.
+	 * @param[in] v       The index of the vertex.
+	 * @return The size of the cell.
+	 */
+	inline uint32_t size(const Diagram& diagram, IndexVertex_t v)
+	{
+		return diagram.offsets[v+1] - diagram.offsets[v];
+	}
+}
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file indexed_predicats.hpp
+ * @brief Defines the predicats of predicats.hpp over indexes into an array of vertices.
+ *
+ * They read the coordinates straight from the array, without any Pvertex3D built, nor bounds
+ * check : everything is inlined into the caller. Each one computes exactly the same thing as
+ * its predicats.hpp counterpart, in the same order, so they give the same answers. The exact
+ * ones inline their floating point filter too, and only call the expansions out of line when
+ * it can't decide.
+ * \b V is any type with \b x() and \b y() (and \b z() for isInCircleOfDiametral()), like a Vertex3D.
+ * @author MTLCRBN
+ */
+#ifndef INDEXED_PREDICATS_HPP_INCLUDED
+#define INDEXED_PREDICATS_HPP_INCLUDED
+
+#include <cmath>
+#include <cstdint>
+#include "predicats.hpp"
+#include "stats.hpp"
+
+namespace indexed
+{
+	/**
+	 * @brief Compute the signed area (times 2) of the triangle \b a, \b b, \b c in the xy plane, like ::orientation2D().
+	 * @param[in] v The vertices.
+	 * @return > 0 if \b c is on the left of a-->b, < 0 if it's on the right, 0 if they're aligned.
+	 */
+	template<typename V>
+	inline double orientation2D(const V* v, int32_t a, int32_t b, int32_t c)
+	{
+		STATS_COUNT(ORIENTATION, 1);
+		return (v[b].x() - v[a].x())*(v[c].y() - v[a].y()) - (v[b].y() - v[a].y())*(v[c].x() - v[a].x());
+	}
+	/**
+	 * @brief Same as orientation2D(), with \p c outside of the array (a vertex being inserted).
+	 */
+	template<typename V>
+	inline double orientation2D(const V* v, int32_t a, int32_t b, const V& c)
+	{
+		STATS_COUNT(ORIENTATION, 1);
+		return (v[b].x() - v[a].x())*(c.y() - v[a].y()) - (v[b].y() - v[a].y())*(c.x() - v[a].x());
+	}
+	/**
+	 * @brief Get the exact sign of orientation2D(), like ::exactOrientation2D().
+	 * @return 1 if \b c is on the left of a-->b, -1 if it's on the right, 0 if they're aligned.
+	 */
+	template<typename V>
+	inline int32_t exactOrientation2D(const V* v, int32_t a, int32_t b, const V& c)
+	{
+		STATS_COUNT(ORIENTATION, 1);
+		const double ax = v[a].x(), ay = v[a].y();
+		const double bx = v[b].x(), by = v[b].y();
+		double left  = (bx - ax)*(c.y() - ay);
+		double right = (by - ay)*(c.x() - ax);
+		double det   = left - right;
+		if (std::fabs(det) > ORIENT_BOUND*(std::fabs(left) + std::fabs(right)))
+		{
+			return (det > 0.0) ? 1 : -1;
+		}
+		return ::expandedOrientation2D(ax, ay, bx, by, c.x(), c.y());
+	}
+	/**
+	 * @brief Check if the triangle \b a, \b b, \b p is well oriented, like ::isWellOriented().
+	 */
+	template<typename V>
+	inline bool isWellOriented(const V* v, int32_t a, int32_t b, const V& p)
+	{
+		STATS_COUNT(WELL_ORIENTED, 1);
+		return (v[a].x() - v[b].x())*(v[a].y() - p.y()) - (v[a].y() - v[b].y())*(v[a].x() - p.x()) > 0.0;
+	}
+	/**
+	 * @brief Check if \p p is inside the triangle \b a, \b b, \b c, like ::isInThisTriangle().
+	 */
+	template<typename V>
+	inline bool isInThisTriangle(const V* v, const V& p, int32_t a, int32_t b, int32_t c)
+	{
+		STATS_COUNT(IN_TRIANGLE, 1);
+		const double ax = v[a].x(), ay = v[a].y();
+		const double bx = v[b].x(), by = v[b].y();
+		const double cx = v[c].x(), cy = v[c].y();
+		double denominator = ((by - cy)*(ax - cx) + (cx - bx)*(ay - cy));
+		double alpha       = ((by - cy)*(p.x() - cx) + (cx - bx)*(p.y() - cy))/denominator;
+		double beta        = ((cy - ay)*(p.x() - cx) + (ax - cx)*(p.y() - cy))/denominator;
+		double gamma       = 1.0 - alpha - beta;
+		return 0.0 <= alpha && alpha <= 1.0 && 0.0 <= beta && beta <= 1.0 && 0.0 <= gamma && gamma <= 1.0;
+	}
+	/**
+	 * @brief Decide if \b s is inside the surrounding circle of \b p, \b q, \b r, in a counterclockwise
+	 * order, like ::isInSurroundingCircle().
+	 */
+	template<typename V>
+	inline bool isInSurroundingCircle(const V* v, int32_t p, int32_t q, int32_t r, int32_t s)
+	{
+		STATS_COUNT(IN_CIRCLE, 1);
+		const double px = v[p].x(), py = v[p].y();
+		double qxpx = v[q].x()-px;
+		double rxpx = v[r].x()-px;
+		double sxpx = v[s].x()-px;
+		double qypy = v[q].y()-py;
+		double rypy = v[r].y()-py;
+		double sypy = v[s].y()-py;
+		double qlift = qxpx*qxpx + qypy*qypy;
+		double rlift = rxpx*rxpx + rypy*rypy;
+		double slift = sxpx*sxpx + sypy*sypy;
+		double det   = qxpx*(rypy*slift - rlift*sypy) - rxpx*(qypy*slift - qlift*sypy) + sxpx*(qypy*rlift - qlift*rypy);
+		return det < 0.0; // Strict, or cocircular points would be flipped forever.
+	}
+	/**
+	 * @brief Get the exact position of \b s against the surrounding circle of \b p, \b q, \b r, like ::exactInCircle().
+	 * @return 1 if \b s is strictly inside the circle, -1 if it's outside, 0 if it's on it.
+	 */
+	template<typename V>
+	inline int32_t exactInCircle(const V* v, int32_t p, int32_t q, int32_t r, int32_t s)
+	{
+		STATS_COUNT(IN_CIRCLE, 1);
+		const double sx = v[s].x(), sy = v[s].y();
+		double pdx = v[p].x() - sx, pdy = v[p].y() - sy;
+		double qdx = v[q].x() - sx, qdy = v[q].y() - sy;
+		double rdx = v[r].x() - sx, rdy = v[r].y() - sy;
+		double plift = pdx*pdx + pdy*pdy;
+		double qlift = qdx*qdx + qdy*qdy;
+		double rlift = rdx*rdx + rdy*rdy;
+		double qr = qdx*rdy, rq = rdx*qdy;
+		double rp = rdx*pdy, pr = pdx*rdy;
+		double pq = pdx*qdy, qp = qdx*pdy;
+		double det       = plift*(qr - rq) + qlift*(rp - pr) + rlift*(pq - qp);
+		double permanent = (std::fabs(qr) + std::fabs(rq))*plift + (std::fabs(rp) + std::fabs(pr))*qlift + (std::fabs(pq) + std::fabs(qp))*rlift;
+		if (std::fabs(det) > CIRCLE_BOUND*permanent)
+		{
+			return (det > 0.0) ? 1 : -1;
+		}
+		return ::expandedInCircle(v[p].x(), v[p].y(), v[q].x(), v[q].y(), v[r].x(), v[r].y(), sx, sy);
+	}
+	/**
+	 * @brief Check if \p t is inside the circle of diametral \b a-->b, like ::isInCircleOfDiametral().
+	 */
+	template<typename V>
+	inline bool isInCircleOfDiametral(const V* v, int32_t a, int32_t b, const V& t)
+	{
+		STATS_COUNT(IN_DIAMETRAL, 1);
+		double cx = (v[a].x() + v[b].x())/2.0, dx = v[b].x() - v[a].x(), tx = t.x() - cx;
+		double cy = (v[a].y() + v[b].y())/2.0, dy = v[b].y() - v[a].y(), ty = t.y() - cy;
+		double cz = (v[a].z() + v[b].z())/2.0, dz = v[b].z() - v[a].z(), tz = t.z() - cz;
+		return tx*tx + ty*ty + tz*tz < (dx*dx + dy*dy + dz*dz)/4.0;
+	}
+}
+
+#endif
@@ -6,8 +6,14 @@
 #ifndef PREDICATS_HPP_INCLUDED
 #define PREDICATS_HPP_INCLUDED
 
+#include <cfloat>
+#include <cstdint>
 #include "struct_predicats.hpp"
 
+const double PREDICATS_EPSILON = DBL_EPSILON/2.0;                                   //!< The largest relative rounding error.
+const double ORIENT_BOUND      = (3.0 + 16.0*PREDICATS_EPSILON)*PREDICATS_EPSILON;  //!< Relative error bound of the fast orientation.
+const double CIRCLE_BOUND      = (10.0 + 96.0*PREDICATS_EPSILON)*PREDICATS_EPSILON; //!< Relative error bound of the fast in circle.
+
 
 /**
  * @brief Check if \p v in inside \p t.
@@ -44,6 +50,50 @@ Pvertex3D centerSurroundingCircle2D(const Ptriangle3D& t);
  */
 bool isWellOriented(const Pvertex3D& v1, const Pvertex3D& v2, const Pvertex3D& v3);
 
+/**
+ * @brief Compute the signed area (times 2) of the triangle made with <b>v1, v2, v3</b> in the xy plane.
+ * @param v1 The first  vertex to check with.
+ * @param v2 The second vertex to check with.
+ * @param v3 The third  vertex to check with.
+ * @return > 0 if \b v3 is on the left of v1-->v2, < 0 if it's on the right, 0 if they're aligned.
+ */
+double orientation2D(const Pvertex3D& v1, const Pvertex3D& v2, const Pvertex3D& v3);
+
+/**
+ * @brief Get the exact sign of orientation2D(), whatever the rounding errors.
+ * A fast floating point evaluation is used, and only the uncertain cases are computed exactly.
+ * @param v1 The first  vertex to check with.
+ * @param v2 The second vertex to check with.
+ * @param v3 The third  vertex to check with.
+ * @return 1 if \b v3 is on the left of v1-->v2, -1 if it's on the right, 0 if they're aligned.
+ */
+int32_t exactOrientation2D(const Pvertex3D& v1, const Pvertex3D& v2, const Pvertex3D& v3);
+
+/**
+ * @brief Get the exact position of \p s against the surrounding circle of \p p, \p q, \p r, in a
+ * counterclockwise order, whatever the rounding errors (like exactOrientation2D()).
+ * @param[in] p The first  point of the triangle.
+ * @param[in] q The second point of the triangle.
+ * @param[in] r The third  point of the triangle.
+ * @param[in] s The point to test.
+ * @return 1 if \p s is strictly inside the circle, -1 if it's outside, 0 if it's on it.
+ */
+int32_t exactInCircle(const Pvertex3D& p, const Pvertex3D& q, const Pvertex3D& r, const Pvertex3D& s);
+
+/**
+ * @brief The exact part of exactOrientation2D(), without its floating point filter : only called when
+ * the filter (orientation2D() against ORIENT_BOUND) can't decide.
+ * @return 1 if \b c is on the left of a-->b, -1 if it's on the right, 0 if they're aligned.
+ */
+int32_t expandedOrientation2D(double ax, double ay, double bx, double by, double cx, double cy);
+
+/**
+ * @brief The exact part of exactInCircle(), without its floating point filter : only called when
+ * the filter (against CIRCLE_BOUND) can't decide.
+ * @return 1 if \b s is strictly inside the circle of \b p, \b q, \b r, -1 if it's outside, 0 if it's on it.
+ */
+int32_t expandedInCircle(double px, double py, double qx, double qy, double rx, double ry, double sx, double sy);
+
 /**
  * @brief Check if \b tr is considered as a poor quality triangle, that means with an angle inferior to 
  * \b angleThreshold.
@@ -0,0 +1,87 @@
+#-------------------------------------------------
+#
+# The Mesh library part, without Qt nor GL :
+# shared by every target of this directory.
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD/includes/ \
+               $$PWD/sources/ \
+               $$PWD/sources/file_io/ \
+               $$PWD/sources/mesh/ \
+               $$PWD/sources/predicats/ \
+               $$PWD/sources/mesh/plugins \
+               $$PWD/includes/iterators/ \
+               $$PWD/includes/predicats/ \
+               $$PWD/includes/mesh/ \
+               $$PWD/includes/mesh/plugins/ \
+
+
+SOURCES += $$PWD/sources/file_io/file_io.cpp \
+           $$PWD/sources/mesh/Mesh.cpp \
+           $$PWD/sources/mesh/Triangle.cpp \
+           $$PWD/sources/predicats/predicats.cpp \
+           $$PWD/sources/mesh/plugins/OffLoader.cpp \
+           $$PWD/sources/mesh/TopoTriangle.cpp \
+           $$PWD/sources/mesh/plugins/neighbors.cpp \
+           $$PWD/sources/mesh/plugins/spatial_sort.cpp \
+           $$PWD/sources/mesh/plugins/voronoi.cpp \
+           $$PWD/sources/mesh/plugins/quality.cpp \
+           $$PWD/sources/mesh/plugins/simplify.cpp \
+           $$PWD/sources/mesh/plugins/stats.cpp \
+           $$PWD/sources/mesh/plugins/trace.cpp \
+           $$PWD/sources/mesh/plugins/validation.cpp \
+           $$PWD/sources/mesh/plugins/adjacency.cpp \
+           $$PWD/sources/mesh/plugins/smooth.cpp \
+           $$PWD/sources/mesh/plugins/normals.cpp \
+           $$PWD/sources/mesh/plugins/laplacian.cpp \
+           $$PWD/sources/mesh/plugins/kdtree.cpp \
+           $$PWD/sources/mesh/plugins/bvh.cpp \
+           $$PWD/sources/mesh/plugins/sierpinski.cpp \
+           $$PWD/sources/mesh/plugins/outofcore.cpp \
+           $$PWD/sources/mesh/plugins/components.cpp \
+           $$PWD/sources/mesh/plugins/codec.cpp
+
+HEADERS += $$PWD/sources/file_io/file_io.hpp \
+           $$PWD/includes/iterators/MeshCirculator.hpp \
+           $$PWD/includes/iterators/MeshIterator.hpp \
+           $$PWD/includes/iterators/MeshRange.hpp \
+           $$PWD/includes/iterators/TriangleCirculator.hpp \
+           $$PWD/includes/iterators/TriangleIterator.hpp \
+           $$PWD/includes/iterators/VertexCirculator.hpp \
+           $$PWD/includes/iterators/VertexIterator.hpp \
+           $$PWD/includes/mesh/Mesh.hpp \
+           $$PWD/includes/mesh/TopoTriangle.hpp \
+           $$PWD/includes/mesh/Triangle.hpp \
+           $$PWD/includes/mesh/Vertex3D.hpp \
+           $$PWD/includes/predicats/predicats.hpp \
+           $$PWD/includes/predicats/struct_predicats.hpp \
+           $$PWD/includes/predicats/indexed_predicats.hpp \
+           $$PWD/includes/mesh/plugins/OffLoader.hpp \
+           $$PWD/includes/mesh/plugins/neighbors.hpp \
+           $$PWD/includes/mesh/plugins/common.hpp \
+           $$PWD/includes/mesh/plugins/parallel.hpp \
+           $$PWD/includes/mesh/plugins/spatial_sort.hpp \
+           $$PWD/includes/mesh/plugins/voronoi.hpp \
+           $$PWD/includes/mesh/plugins/quality.hpp \
+           $$PWD/includes/mesh/plugins/simplify.hpp \
+           $$PWD/includes/mesh/plugins/stats.hpp \
+           $$PWD/includes/mesh/plugins/trace.hpp \
+           $$PWD/includes/mesh/plugins/validation.hpp \
+           $$PWD/includes/mesh/plugins/adjacency.hpp \
+           $$PWD/includes/mesh/plugins/smooth.hpp \
+           $$PWD/includes/mesh/plugins/normals.hpp \
+           $$PWD/includes/mesh/plugins/laplacian.hpp \
+           $$PWD/includes/mesh/plugins/kdtree.hpp \
+           $$PWD/includes/mesh/plugins/bvh.hpp \
+           $$PWD/includes/mesh/plugins/sierpinski.hpp \
+           $$PWD/includes/mesh/plugins/outofcore.hpp \
+           $$PWD/includes/mesh/plugins/components.hpp \
+           $$PWD/includes/mesh/plugins/codec.hpp \
+           $$PWD/includes/logs.hpp
+
+# The counters and timers of stats.hpp and the timeline of trace.hpp, remove it to compile them out.
+DEFINES += MESH_STATS
+
+QMAKE_CXXFLAGS += -std=c++11 -Wall -Wextra -fopenmp -pthread
+QMAKE_LFLAGS   += -fopenmp -pthread
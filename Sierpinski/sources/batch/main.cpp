@@ -0,0 +1,472 @@
+/**
+ * @file main.cpp
+ * @brief Command line tool to run the Mesh algorithms over many files, without any window.
+ *
+ * Usage :
+ * @code
+ * SierpinskiBatch [-p pipeline] [-o directory] [-j jobs] [-r faces] [-m iterations] [-c megabytes] [-z bits] [-g] [-s] [-q] [-V] [-S] [-T file] [-v] files...
+ * @endcode
+ * Each file goes through load --> algorithm --> dump, and a line with the time of each stage
+ * is printed once it is done. The files are processed in parallel.
+ * With -c, an OFF file is never loaded whole : it is converted into an outofcore::Store, measured and
+ * given its normals by passes bounded by the memory, then clustered down to 4 times the -r target
+ * before the usual simplification (or dumped back by windows without -r). Without -r, nothing is
+ * loaded, so -g, -m, -q, -V and -z are refused along with -c.
+ * With -z, the results are dumped by codec::encode() instead of OFF, and the .mshz files are read back
+ * by codec::decode().
+ * @author MTLCRBN
+ */
+#include <cstdlib>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "Mesh.hpp"
+#include "logs.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
+
+
+namespace
+{
+	//! @brief What is done with a file.
+	typedef enum {
+		AUTO,        //!< Chosen from the extension of the file.
+		MESH,        //!< .off : only load it.
+		TRIANGULATE, //!< .pts, .tri : incremental Delaunay triangulation.
+		CRUST,       //!< Triangulation, then Crust.
+		NNCRUST,     //!< Triangulation, then NN-Crust.
+		CONSTRAINTS, //!< .ctri : constrained triangulation, then Ruppert's refinement.
+		COMPRESSED   //!< .mshz : only decode it.
+	} Pipeline_e;
+
+	struct Options final
+	{
+		Pipeline_e               pipeline = AUTO;  //!< What to do with every file.
+		ConstraintMode_e         mode     = INSERT_SEGMENTS;
+		std::string              output;           //!< Where to dump the results, nothing if empty.
+		int32_t                  jobs     = parallel::maxThreads();
+		uint32_t                 reduce   = 0;     //!< Simplify the result down to this number of triangles, 0 to keep it.
+		uint32_t                 smooth   = 0;     //!< The Taubin iterations over the result, before its simplification.
+		size_t                   outOfCore = 0;    //!< The memory of the out of core passes, in MB, 0 to load the OFF files whole.
+		uint32_t                 compress = 0;     //!< The bits of the quantization of the compressed dumps, 0 to dump OFF files.
+		bool                     quality  = false; //!< Measure the triangles at the end.
+		bool                     validate = false; //!< Check the result, an invalid one is a failure.
+		bool                     gate     = false; //!< Reject the non manifold meshes right after their loading.
+		bool                     stats    = false; //!< Display the counters of each file, and their sums.
+		bool                     verbose  = false; //!< Keep the logs of Mesh.
+		std::string              trace;            //!< Where to write the timeline, nothing if empty.
+		std::vector<std::string> files;
+	};
+
+	void usage(const char* name)
+	{
+		std::cout << "Usage : " << name << " [options] files..." << std::endl
+		          << "  -p, --pipeline <name>  auto (default), mesh, triangulate, crust, nncrust, constraints" << std::endl
+		          << "                         or compressed" << std::endl
+		          << "  -o, --output <dir>     dump every result as an OFF file inside <dir>" << std::endl
+		          << "  -j, --jobs <n>         number of files processed at the same time" << std::endl
+		          << "  -r, --reduce <faces>   simplify the result down to <faces> triangles" << std::endl
+		          << "  -m, --smooth <n>       smooth the result by <n> Taubin iterations, its border fixed" << std::endl
+		          << "  -c, --out-of-core <MB> process the OFF files on the disk, within <MB> of memory" << std::endl
+		          << "                         (the files go into the -o directory, or /tmp)," << std::endl
+		          << "                         -g, -m, -q, -V and -z need -r along with it" << std::endl
+		          << "  -z, --compress <bits>  dump the results compressed (.mshz), each coordinate on <bits> bits" << std::endl
+		          << "  -g, --gate             reject the non manifold meshes once loaded, count their components" << std::endl
+		          << "  -s, --split            recover the constraints by splits only (no insertion)" << std::endl
+		          << "  -q, --quality          measure the triangles once done" << std::endl
+		          << "  -V, --validate         check the topology (and the Delaunay property) of each result" << std::endl
+		          << "  -S, --stats            display the counters and timers of each file, then their sums" << std::endl
+		          << "  -T, --trace <file>     write a timeline of every stage into <file> (chrome://tracing)" << std::endl
+		          << "  -v, --verbose          keep the logs of every algorithm" << std::endl
+		          << "  -h, --help             display this message" << std::endl;
+	}
+
+	Pipeline_e pipelineFromName(const std::string& name)
+	{
+		static const std::vector<std::pair<std::string, Pipeline_e>> names = {
+			{"auto", AUTO}, {"mesh", MESH}, {"triangulate", TRIANGULATE},
+			{"crust", CRUST}, {"nncrust", NNCRUST}, {"constraints", CONSTRAINTS}, {"compressed", COMPRESSED}
+		};
+		for(const auto& pair : names)
+		{
+			if (pair.first == name)
+			{
+				return pair.second;
+			}
+		}
+		throw std::invalid_argument("Unknown pipeline " + name);
+	}
+
+	Pipeline_e pipelineFromExtension(const std::string& fname)
+	{
+		std::string extension = fname.substr(fname.find_last_of('.') + 1);
+		if (extension == "off")
+		{
+			return MESH;
+		}
+		if (extension == "ctri")
+		{
+			return CONSTRAINTS;
+		}
+		if (extension == "mshz")
+		{
+			return COMPRESSED;
+		}
+		return TRIANGULATE;
+	}
+
+	/**
+	 * @brief Read the command line.
+	 * @return The options, with no file if the usage has been asked.
+	 * @throw std::invalid_argument If an option is unknown, misses its value, or can't go with the others.
+	 */
+	Options parse(int argc, char** argv)
+	{
+		Options options;
+		for(int i=1;i<argc;++i)
+		{
+			std::string arg = argv[i];
+			auto value = [&](void) -> std::string {
+				if (i+1 >= argc)
+				{
+					throw std::invalid_argument("Missing value after " + arg);
+				}
+				return argv[++i];
+			};
+			if (arg == "-h" || arg == "--help")
+			{
+				return Options();
+			}
+			else if (arg == "-p" || arg == "--pipeline")
+			{
+				options.pipeline = pipelineFromName(value());
+			}
+			else if (arg == "-o" || arg == "--output")
+			{
+				options.output = value();
+			}
+			else if (arg == "-j" || arg == "--jobs")
+			{
+				options.jobs = std::max(1, std::atoi(value().c_str()));
+			}
+			else if (arg == "-r" || arg == "--reduce")
+			{
+				options.reduce = std::max(0, std::atoi(value().c_str()));
+			}
+			else if (arg == "-m" || arg == "--smooth")
+			{
+				options.smooth = std::max(0, std::atoi(value().c_str()));
+			}
+			else if (arg == "-c" || arg == "--out-of-core")
+			{
+				options.outOfCore = std::max(0, std::atoi(value().c_str()));
+			}
+			else if (arg == "-z" || arg == "--compress")
+			{
+				options.compress = std::max(0, std::atoi(value().c_str()));
+			}
+			else if (arg == "-g" || arg == "--gate")
+			{
+				options.gate = true;
+			}
+			else if (arg == "-s" || arg == "--split")
+			{
+				options.mode = SPLIT_SEGMENTS;
+			}
+			else if (arg == "-q" || arg == "--quality")
+			{
+				options.quality = true;
+			}
+			else if (arg == "-V" || arg == "--validate")
+			{
+				options.validate = true;
+			}
+			else if (arg == "-S" || arg == "--stats")
+			{
+				options.stats = true;
+			}
+			else if (arg == "-T" || arg == "--trace")
+			{
+				options.trace = value();
+			}
+			else if (arg == "-v" || arg == "--verbose")
+			{
+				options.verbose = true;
+			}
+			else if (!arg.empty() && arg[0] == '-')
+			{
+				throw std::invalid_argument("Unknown option " + arg);
+			}
+			else
+			{
+				options.files.push_back(arg);
+			}
+		}
+		// Without a simplification, an OFF file processed out of core is never loaded : nothing to run these on.
+		if (options.outOfCore > 0 && options.reduce == 0 &&
+			(options.gate || options.smooth > 0 || options.quality || options.validate || options.compress > 0))
+		{
+			throw std::invalid_argument("-g, -m, -q, -V and -z need -r along with -c");
+		}
+		return options;
+	}
+
+	/**
+	 * @brief Collects the duration of each stage of a pipeline.
+	 */
+	class Stages final
+	{
+		public:
+			/**
+			 * @brief Run \p stage, and keep its duration under \p name.
+			 */
+			template<typename Stage>
+			void run(const std::string& name, Stage stage)
+			{
+				auto start = std::chrono::steady_clock::now();
+				stage();
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				this->out << "  " << name << " " << std::fixed << std::setprecision(4) << elapsed.count() << "s";
+			}
+			std::ostringstream out; //!< The line being built.
+	};
+
+	//! @brief Get the name of \p fname without its directories, the extension is kept so foo.tri and foo.ctri differ.
+	std::string basename(const std::string& fname)
+	{
+		return fname.substr(fname.find_last_of('/') + 1);
+	}
+
+	//! @brief Remove the files of a Store once its file is processed, even if it fails.
+	struct Discard_t final
+	{
+		const outofcore::Store& store;
+		~Discard_t(void) {outofcore::discard(this->store);}
+	};
+
+	/**
+	 * @brief Run the out of core stages over the OFF file \p fname : the mesh is only loaded
+	 * once clustered, if a simplification is asked.
+	 * @return The part of the line of this file about the Store.
+	 */
+	std::string processOutOfCore(const std::string& fname, const Options& options, Stages& stages, Mesh& mesh)
+	{
+		std::string           directory = options.output.empty() ? "/tmp" : options.output;
+		outofcore::Store      store;
+		outofcore::Statistics statistics = outofcore::Statistics();
+		stages.run("convert", [&](){store = outofcore::convert(fname, directory + "/" + basename(fname), options.outOfCore << 20);});
+		Discard_t discard = {store};
+		stages.run("statistics", [&](){statistics = outofcore::statistics(store);});
+		stages.run("normals",    [&](){outofcore::computeNormals(store);});
+		if (options.reduce > 0)
+		{
+			// The clustering only gets close to a target, the simplification reaches it.
+			uint32_t resolution = outofcore::resolutionFor(statistics, store, 4*options.reduce);
+			stages.run("cluster", [&](){mesh.loadClustered(store, resolution);});
+		}
+		else if (!options.output.empty())
+		{
+			std::string out = options.output + "/" + basename(fname) + ".off";
+			stages.run("dump", [&](){outofcore::dump(store, out);});
+		}
+		std::ostringstream line;
+		line << "  | disk V " << statistics.nbVertices << " T " << statistics.nbTriangles << " borders " << statistics.borders
+		     << " non manifold " << statistics.nonManifold << " area " << statistics.area;
+		return line.str();
+	}
+
+	/**
+	 * @brief Run the whole pipeline over \p fname.
+	 * @return The line to display for this file.
+	 */
+	std::string process(const std::string& fname, const Options& options)
+	{
+		stats::restartLargest(); // The largest values of this file only.
+		Mesh          mesh;
+		Stages        stages;
+		Pipeline_e    pipeline = (options.pipeline == AUTO) ? pipelineFromExtension(fname) : options.pipeline;
+		stats::Report before   = stats::thisThread(); // A file is processed by a single thread.
+		std::string   disk;
+		stages.out << fname;
+		switch(pipeline)
+		{
+			case MESH:
+				if (options.outOfCore > 0)
+				{
+					disk = processOutOfCore(fname, options, stages, mesh);
+				}
+				else
+				{
+					stages.run("load", [&](){mesh.loadMeshFromOff(fname);});
+				}
+				break;
+			case CONSTRAINTS:
+				stages.run("constrain", [&](){mesh.loadConstraints(fname, options.mode);});
+				break;
+			case COMPRESSED:
+				stages.run("decode", [&](){mesh.loadCompressed(fname);});
+				break;
+			default:
+				stages.run("triangulate", [&](){mesh.load2DTriangulationFromPts(fname);});
+				break;
+		}
+		if (pipeline == CRUST)
+		{
+			stages.run("crust", [&](){mesh.Crust();});
+		}
+		else if (pipeline == NNCRUST)
+		{
+			stages.run("nncrust", [&](){mesh.NNCrust();});
+		}
+		components::Report parts = components::Report();
+		if (options.gate)
+		{
+			stages.run("components", [&](){parts = mesh.analyzeComponents();});
+			if (!components::manifold(parts))
+			{
+				throw std::runtime_error(components::format(parts));
+			}
+		}
+		double throughput = 0.0;
+		if (options.smooth > 0)
+		{
+			stages.run("smooth", [&](){throughput = mesh.smooth(options.smooth);});
+		}
+		if (options.reduce > 0)
+		{
+			stages.run("simplify", [&](){mesh.simplify(options.reduce);});
+		}
+		quality::Report report = quality::Report();
+		if (options.quality)
+		{
+			stages.run("quality", [&](){report = mesh.computeQuality();});
+		}
+		if (options.validate)
+		{
+			// A smoothed or simplified triangulation is still a mesh, but no longer a Delaunay one.
+			bool               planar     = pipeline != MESH && pipeline != COMPRESSED && options.reduce == 0 && options.smooth == 0;
+			validation::Report validation = validation::Report();
+			stages.run("validate", [&](){validation = mesh.validate(planar);});
+			if (!validation::valid(validation))
+			{
+				throw std::runtime_error(validation::format(validation));
+			}
+		}
+		codec::Report compressed = codec::Report();
+		if (!options.output.empty() && (disk.empty() || options.reduce > 0))
+		{
+			if (options.compress > 0)
+			{
+				std::string out = options.output + "/" + basename(fname) + ".mshz";
+				stages.run("encode", [&](){compressed = mesh.dumpCompressed(out, options.compress);});
+			}
+			else
+			{
+				std::string out = options.output + "/" + basename(fname) + ".off";
+				stages.run("dump", [&](){mesh.dumpToOff(out);});
+			}
+		}
+		stages.out << disk << "  | V " << mesh.getVertices().size() << " T " << mesh.getTriangles().size();
+		if (pipeline == CRUST || pipeline == NNCRUST)
+		{
+			stages.out << " curve " << mesh.getCurve().size();
+		}
+		if (options.gate)
+		{
+			stages.out << " components " << components::count(parts) << " loops " << parts.boundaryLoops;
+		}
+		if (compressed.bytes > 0)
+		{
+			stages.out << " compressed " << compressed.bytes << " bytes, "
+			           << compressed.connectivity/std::max<size_t>(1, mesh.getTriangles().size()) << " bits/triangle";
+		}
+		if (options.smooth > 0)
+		{
+			stages.out << " smooth " << throughput/1e6 << "M vertex moves/s";
+		}
+		if (options.quality)
+		{
+			stages.out << " min angle " << report.smallestAngle;
+		}
+		if (options.stats)
+		{
+			stages.out << std::endl << stats::format(stats::difference(stats::thisThread(), before));
+		}
+		return stages.out.str();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		options = parse(argc, argv);
+	}
+	catch(const std::invalid_argument& e)
+	{
+		std::cerr << e.what() << std::endl;
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (options.files.empty())
+	{
+		usage(argv[0]);
+		return EXIT_SUCCESS;
+	}
+	mtl::log::Options::ENABLE_LOG = options.verbose;
+	if (!options.trace.empty())
+	{
+		Mesh::startTrace(options.trace);
+	}
+
+	const int32_t nb       = options.files.size();
+	int32_t       failures = 0;
+	auto          start    = std::chrono::steady_clock::now();
+	#pragma omp parallel for schedule(dynamic, 1) num_threads(options.jobs) reduction(+:failures)
+	for(int32_t i=0;i<nb;++i)
+	{
+		std::string line;
+		TRACE_SCOPE(options.files[i].c_str()); // Each job is a track, and each file a block of it.
+		try
+		{
+			line = process(options.files[i], options);
+		}
+		catch(const std::exception& e)
+		{
+			line = options.files[i] + "  FAILED : " + e.what();
+			++failures;
+		}
+		catch(const std::string& e)
+		{
+			line = options.files[i] + "  FAILED : " + e;
+			++failures;
+		}
+		#pragma omp critical
+		{
+			mtl::log::flush(); // The logs of this file are written before its line.
+			std::cout << line << std::endl;
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	try
+	{
+		Mesh::stopTrace();
+	}
+	catch(const std::runtime_error& e)
+	{
+		std::cerr << e.what() << std::endl;
+		++failures;
+	}
+	if (options.stats)
+	{
+		std::cout << "Sums over every file :" << std::endl << stats::format(Mesh::getStatistics());
+	}
+	std::cout << nb << " file(s), " << failures << " failure(s), " << elapsed.count() << "s" << std::endl;
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include "generators.hpp"
+
+
+namespace
+{
+	const uint32_t   CLUSTERS = 10;   //!< The number of clusters of CLUSTERED.
+	const VertexType SIGMA    = 0.05; //!< The standard deviation of a cluster.
+	const uint32_t   PETALS   = 5;    //!< The number of bumps of the LINE curve.
+
+	const std::vector<std::pair<std::string, generators::Generator_e>> NAMES = {
+		{"uniform", generators::UNIFORM}, {"clustered", generators::CLUSTERED}, {"circle", generators::CIRCLE},
+		{"grid", generators::GRID}, {"line", generators::LINE}
+	};
+
+	/**
+	 * @brief Open \p fname to write every digit of the coordinates.
+	 * @throw std::runtime_error If it can't be opened.
+	 */
+	void open(std::ofstream& file, const std::string& fname)
+	{
+		file.open(fname.c_str());
+		if (!file.good())
+		{
+			throw std::runtime_error("Unable to write " + fname);
+		}
+		file << std::setprecision(std::numeric_limits<VertexType>::max_digits10);
+	}
+	void writeVertices(std::ofstream& file, const VertexContainer& points)
+	{
+		file << points.size() << '\n';
+		for(const Vertex& p : points)
+		{
+			file << p.x() << ' ' << p.y() << '\n';
+		}
+	}
+}
+
+std::string generators::name(Generator_e generator)
+{
+	for(const auto& pair : NAMES)
+	{
+		if (pair.second == generator)
+		{
+			return pair.first;
+		}
+	}
+	return "unknown";
+}
+
+generators::Generator_e generators::fromName(const std::string& name)
+{
+	for(const auto& pair : NAMES)
+	{
+		if (pair.first == name)
+		{
+			return pair.second;
+		}
+	}
+	throw std::invalid_argument("Unknown generator " + name);
+}
+
+VertexContainer generators::points(Generator_e generator, uint32_t nb, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<VertexType> unit(-1.0, 1.0);
+	std::uniform_real_distribution<VertexType> angle(0.0, 2.0*M_PI);
+	VertexContainer points;
+	points.reserve(nb);
+	switch(generator)
+	{
+		case UNIFORM:
+			for(uint32_t i=0;i<nb;++i)
+			{
+				VertexType x = unit(random);
+				points.push_back(Vertex(x, unit(random), 0.0));
+			}
+			break;
+		case CLUSTERED:
+		{
+			std::vector<std::pair<VertexType, VertexType>> centers(CLUSTERS);
+			for(auto& center : centers)
+			{
+				center.first  = unit(random);
+				center.second = unit(random);
+			}
+			std::normal_distribution<VertexType> spread(0.0, SIGMA);
+			for(uint32_t i=0;i<nb;++i)
+			{
+				const auto& center = centers[i%CLUSTERS];
+				VertexType  x      = center.first + spread(random);
+				points.push_back(Vertex(x, center.second + spread(random), 0.0));
+			}
+			break;
+		}
+		case CIRCLE:
+			for(uint32_t i=0;i<nb;++i)
+			{
+				VertexType a = angle(random);
+				points.push_back(Vertex(std::cos(a), std::sin(a), 0.0));
+			}
+			break;
+		case GRID:
+		{
+			uint32_t side = std::ceil(std::sqrt(static_cast<double>(nb)));
+			for(uint32_t i=0;i<nb;++i)
+			{
+				points.push_back(Vertex(2.0*(i%side)/side - 1.0, 2.0*(i/side)/side - 1.0, 0.0));
+			}
+			// In order, the first points would be collinear.
+			std::shuffle(points.begin(), points.end(), random);
+			break;
+		}
+		case LINE:
+			for(uint32_t i=0;i<nb;++i)
+			{
+				VertexType a = 2.0*M_PI*i/nb;
+				VertexType r = 1.0 + 0.3*std::sin(PETALS*a);
+				points.push_back(Vertex(r*std::cos(a), r*std::sin(a), 0.0));
+			}
+			break;
+	}
+	return points;
+}
+
+void generators::writePts(const VertexContainer& points, const std::string& fname)
+{
+	std::ofstream file;
+	open(file, fname);
+	writeVertices(file, points);
+}
+
+void generators::writePolygon(const VertexContainer& points, const std::string& fname)
+{
+	std::ofstream file;
+	open(file, fname);
+	writeVertices(file, points);
+	for(uint32_t i=0;i<points.size();++i)
+	{
+		file << i << ' ' << (i+1)%points.size() << '\n';
+	}
+}
@@ -0,0 +1,55 @@
+/**
+ * @file generators.hpp
+ * @brief Synthetic point sets for the benchmarks, from the easy uniform case to the degenerate ones.
+ * Every set is reproducible : it only depends on its size and a seed.
+ * @author MTLCRBN
+ */
+#ifndef GENERATORS_HPP_INCLUDED
+#define GENERATORS_HPP_INCLUDED
+
+#include <string>
+#include <cstdint>
+#include "common.hpp"
+
+namespace generators
+{
+	//! @brief The kinds of point sets.
+	typedef enum {
+		UNIFORM,   //!< Uniform inside [-1, 1]².
+		CLUSTERED, //!< Some gaussian clusters, with empty areas between them.
+		CIRCLE,    //!< Every point on the unit circle (cocircular).
+		GRID,      //!< A regular grid, shuffled (collinear and cocircular).
+		LINE       //!< A closed curve sampled in order, like the crust inputs.
+	} Generator_e;
+
+	/**
+	 * @brief Get the name of \p generator, as used on the command line and inside the results.
+	 */
+	std::string name(Generator_e generator);
+	/**
+	 * @brief Get the generator named \p name.
+	 * @throw std::invalid_argument If there is none.
+	 */
+	Generator_e fromName(const std::string& name);
+	/**
+	 * @brief Generate \p nb 2D points (z = 0).
+	 * @param[in] generator The kind of point set.
+	 * @param[in] nb        The number of points.
+	 * @param[in] seed      The seed of the random generator.
+	 * @return The points, in the order they will be inserted.
+	 */
+	VertexContainer points(Generator_e generator, uint32_t nb, uint32_t seed);
+	/**
+	 * @brief Write \p points as a .pts file named \p fname, with every digit.
+	 * @throw std::runtime_error If the file can't be written.
+	 */
+	void writePts(const VertexContainer& points, const std::string& fname);
+	/**
+	 * @brief Write \p points as a .ctri file named \p fname, the segments linking them in order
+	 * as a closed polygon.
+	 * @throw std::runtime_error If the file can't be written.
+	 */
+	void writePolygon(const VertexContainer& points, const std::string& fname);
+}
+
+#endif
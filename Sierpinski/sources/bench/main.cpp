@@ -0,0 +1,788 @@
+/**
+ * @file main.cpp
+ * @brief Benchmarks of the Mesh algorithms over synthetic point sets, without any window.
+ *
+ * Usage :
+ * @code
+ * SierpinskiBench [-g generators] [-t stages] [-n sizes] [-w warmups] [-r repetitions] [-l limit]
+ *                 [-d directory] [-o results.json] [-b baseline.json] [-x threshold]
+ * @endcode
+ * Each stage runs over each generated point set : first the warm-up runs, then the measured ones.
+ * The sizes are a ladder : a stage which fails, or is slower than the limit, skips the bigger sizes.
+ * The default ladder stops at 1e5 points, the insertion of the line generator being quadratic :
+ * the bigger sizes, up to 1e7, are only run when asked for with -n.
+ * The results are written as JSON, one result per line, so a previous output can be read back as
+ * a baseline : every median slower than the baseline by more than the threshold is a regression.
+ * @author MTLCRBN
+ */
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+
+#include "Mesh.hpp"
+#include "logs.hpp"
+#include "generators.hpp"
+#include "indexed_predicats.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	const uint32_t SEED    = 20170101; //!< Every point set is the same from a run to another.
+	const uint32_t QUERIES = 10000;    //!< The number of nearest neighbors queries.
+	const uint32_t K       = 8;        //!< The number of nearest neighbors of each query.
+	const uint32_t GRID    = 512;      //!< The rays of the rays stage are a GRID x GRID grid.
+
+	//! @brief What is measured.
+	typedef enum {
+		TRIANGULATE,   //!< Mesh::load2DTriangulationFromPts().
+		CRUST,         //!< Mesh::Crust(), from a loaded triangulation.
+		REFINE,        //!< Mesh::loadConstraints() : the triangulation, the segments, then refineDelaunay().
+		REFINE_SPLIT,  //!< The same with SPLIT_SEGMENTS : the segments only recovered by the refinement.
+		DUMP_OFF,      //!< Mesh::dumpToOff() of the triangulation.
+		LOAD_OFF,      //!< Mesh::loadMeshFromOff() of the dumped triangulation.
+		ENCODE,        //!< Mesh::dumpCompressed() of the triangulation.
+		DECODE,        //!< Mesh::loadCompressed() of the compressed triangulation, to compare with LOAD_OFF.
+		PREDICATS,     //!< The predicats of predicats.hpp over every pair of neighbors, through Pvertex3D.
+		INDEXED,       //!< The same predicats from indexed_predicats.hpp, over the indexes.
+		EXACT,         //!< The exact predicats of predicats.hpp over every pair of neighbors, through Pvertex3D.
+		INDEXED_EXACT, //!< The same exact predicats from indexed_predicats.hpp, their filter inlined.
+		AREA_LOOP,     //!< The area of every triangle, by a loop over the indexes.
+		AREA_RANGE,    //!< The same areas, by parallel::transform() over Mesh::rangeT().
+		ADJACENCY,     //!< Mesh::buildVertexAdjacency().
+		RING_WALK,     //!< The centroid of every one-ring, by walking around each vertex through the neighbors.
+		RING_CSR,      //!< The same centroids, from the arrays of Mesh::buildVertexAdjacency() (built once).
+		KDTREE,        //!< kdtree::build() over the vertices.
+		KNN_BRUTE,     //!< The 8 nearest vertices of QUERIES vertices, by a loop over every vertex.
+		KNN_KDTREE,    //!< The same queries, by kdtree::nearest() (the tree built once).
+		BVH,           //!< bvh::build() over the triangles.
+		RAYS           //!< GRID x GRID rays along z over the triangulation, by bvh::intersect() (the hierarchy built once).
+	} Stage_e;
+
+	const std::vector<std::pair<std::string, Stage_e>> STAGES = {
+		{"triangulate", TRIANGULATE}, {"crust", CRUST}, {"refine", REFINE}, {"refine_split", REFINE_SPLIT}, {"dump_off", DUMP_OFF}, {"load_off", LOAD_OFF},
+		{"encode", ENCODE}, {"decode", DECODE},
+		{"predicats", PREDICATS}, {"indexed_predicats", INDEXED}, {"exact_predicats", EXACT}, {"indexed_exact_predicats", INDEXED_EXACT},
+		{"area_loop", AREA_LOOP}, {"area_range", AREA_RANGE},
+		{"adjacency", ADJACENCY}, {"ring_walk", RING_WALK}, {"ring_csr", RING_CSR},
+		{"kdtree", KDTREE}, {"knn_brute", KNN_BRUTE}, {"knn_kdtree", KNN_KDTREE}, {"bvh", BVH}, {"rays", RAYS}
+	};
+
+	struct Options final
+	{
+		std::vector<generators::Generator_e> generators;
+		std::vector<Stage_e>                 stages;
+		std::vector<uint32_t>                sizes       = {1000, 10000, 100000};
+		uint32_t                             warmups     = 1;
+		uint32_t                             repetitions = 5;
+		double                               limit       = 10.0;   //!< Beyond this duration (s), the bigger sizes are skipped.
+		std::string                          directory   = "/tmp"; //!< Where the generated files go.
+		std::string                          output;               //!< The JSON file, stdout if empty.
+		std::string                          baseline;             //!< The JSON file to compare with, none if empty.
+		double                               threshold   = 0.10;   //!< The slowdown over the baseline which is a regression.
+		bool                                 help        = false;
+	};
+
+	//! @brief The measures of a stage over a point set.
+	struct Result final
+	{
+		std::string         generator;
+		uint32_t            size;
+		std::string         stage;
+		std::vector<double> times; //!< The duration of each measured run, sorted.
+		double median(void) const {return this->times[this->times.size()/2];}
+		double mean(void)   const {return std::accumulate(this->times.begin(), this->times.end(), 0.0)/this->times.size();}
+	};
+
+	void usage(const char* name)
+	{
+		std::cout << "Usage : " << name << " [options]" << std::endl
+		          << "  -g, --generators <list>   among uniform, clustered, circle, grid and line (default every one)" << std::endl
+		          << "  -t, --stages <list>       among triangulate, crust, refine, refine_split, dump_off, load_off, encode" << std::endl
+		          << "                            decode, predicats, indexed_predicats, exact_predicats, indexed_exact_predicats" << std::endl
+		          << "                            area_loop, area_range, adjacency" << std::endl
+		          << "                            ring_walk, ring_csr, kdtree, knn_brute, knn_kdtree, bvh and rays (default every one)" << std::endl
+		          << "  -n, --sizes <list>        the numbers of points, up to 1e7 (default 1e3,1e4,1e5, the line" << std::endl
+		          << "                            generator being quadratic to triangulate)" << std::endl
+		          << "  -w, --warmups <n>         runs before the measures (default 1)" << std::endl
+		          << "  -r, --repetitions <n>     measured runs (default 5)" << std::endl
+		          << "  -l, --limit <seconds>     skip the bigger sizes of a stage slower than this (default 10)," << std::endl
+		          << "                            or which failed" << std::endl
+		          << "  -d, --directory <dir>     where the generated files are written (default /tmp)" << std::endl
+		          << "  -o, --output <file>       write the JSON results into <file> instead of stdout" << std::endl
+		          << "  -b, --baseline <file>     compare the medians with a previous JSON output" << std::endl
+		          << "  -x, --threshold <percent> the slowdown reported as a regression (default 10)" << std::endl
+		          << "  -h, --help                display this message" << std::endl;
+	}
+
+	std::vector<std::string> split(const std::string& list)
+	{
+		std::vector<std::string> items;
+		std::stringstream        stream(list);
+		std::string              item;
+		while(std::getline(stream, item, ','))
+		{
+			items.push_back(item);
+		}
+		return items;
+	}
+
+	Stage_e stageFromName(const std::string& name)
+	{
+		for(const auto& pair : STAGES)
+		{
+			if (pair.first == name)
+			{
+				return pair.second;
+			}
+		}
+		throw std::invalid_argument("Unknown stage " + name);
+	}
+
+	std::string stageName(Stage_e stage)
+	{
+		for(const auto& pair : STAGES)
+		{
+			if (pair.second == stage)
+			{
+				return pair.first;
+			}
+		}
+		return "unknown";
+	}
+
+	/**
+	 * @brief Read the command line.
+	 * @throw std::invalid_argument If an option is unknown or misses its value.
+	 */
+	Options parse(int argc, char** argv)
+	{
+		Options options;
+		for(int i=1;i<argc;++i)
+		{
+			std::string arg = argv[i];
+			auto value = [&](void) -> std::string {
+				if (i+1 >= argc)
+				{
+					throw std::invalid_argument("Missing value after " + arg);
+				}
+				return argv[++i];
+			};
+			if (arg == "-h" || arg == "--help")
+			{
+				options.help = true;
+			}
+			else if (arg == "-g" || arg == "--generators")
+			{
+				for(const std::string& name : split(value()))
+				{
+					options.generators.push_back(generators::fromName(name));
+				}
+			}
+			else if (arg == "-t" || arg == "--stages")
+			{
+				for(const std::string& name : split(value()))
+				{
+					options.stages.push_back(stageFromName(name));
+				}
+			}
+			else if (arg == "-n" || arg == "--sizes")
+			{
+				options.sizes.clear();
+				for(const std::string& size : split(value()))
+				{
+					options.sizes.push_back(std::max(3.0, std::atof(size.c_str())));
+				}
+			}
+			else if (arg == "-w" || arg == "--warmups")
+			{
+				options.warmups = std::max(0, std::atoi(value().c_str()));
+			}
+			else if (arg == "-r" || arg == "--repetitions")
+			{
+				options.repetitions = std::max(1, std::atoi(value().c_str()));
+			}
+			else if (arg == "-l" || arg == "--limit")
+			{
+				options.limit = std::atof(value().c_str());
+			}
+			else if (arg == "-d" || arg == "--directory")
+			{
+				options.directory = value();
+			}
+			else if (arg == "-o" || arg == "--output")
+			{
+				options.output = value();
+			}
+			else if (arg == "-b" || arg == "--baseline")
+			{
+				options.baseline = value();
+			}
+			else if (arg == "-x" || arg == "--threshold")
+			{
+				options.threshold = std::atof(value().c_str())/100.0;
+			}
+			else
+			{
+				throw std::invalid_argument("Unknown option " + arg);
+			}
+		}
+		if (options.generators.empty())
+		{
+			options.generators = {generators::UNIFORM, generators::CLUSTERED, generators::CIRCLE, generators::GRID, generators::LINE};
+		}
+		if (options.stages.empty())
+		{
+			options.stages = {TRIANGULATE, CRUST, REFINE, REFINE_SPLIT, DUMP_OFF, LOAD_OFF, ENCODE, DECODE, PREDICATS, INDEXED, EXACT, INDEXED_EXACT, AREA_LOOP, AREA_RANGE, ADJACENCY, RING_WALK, RING_CSR, KDTREE, KNN_BRUTE, KNN_KDTREE, BVH, RAYS};
+		}
+		std::sort(options.sizes.begin(), options.sizes.end());
+		return options;
+	}
+
+	double measure(const std::function<void(void)>& run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		run();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count();
+	}
+
+	/**
+	 * @brief Run \p stage over the files of a point set : \p setup before each run, outside of the measure.
+	 * @param[in] options The warm-ups, repetitions and limit.
+	 * @param[in] setup   What to do before each run.
+	 * @param[in] run     What is measured.
+	 * @return The sorted durations, only one if the first run was over the limit.
+	 */
+	std::vector<double> repeat(const Options& options, const std::function<void(void)>& setup, const std::function<void(void)>& run)
+	{
+		std::vector<double> times;
+		for(uint32_t i=0;i<options.warmups + options.repetitions;++i)
+		{
+			setup();
+			double time = measure(run);
+			if (i >= options.warmups)
+			{
+				times.push_back(time);
+			}
+			if (time > options.limit)
+			{
+				// A slow stage isn't repeated, the measure is already meaningful.
+				times.assign(1, time);
+				break;
+			}
+		}
+		std::sort(times.begin(), times.end());
+		return times;
+	}
+
+	volatile uint64_t sink; //!< Where the predicats answers go, so they can't be optimized away.
+
+	/**
+	 * @brief Test every triangle against the opposite vertex of each of its neighbors, like the flips
+	 * and the walks do : in circle, orientation and inside triangle.
+	 * @param[in] indexes true to use indexed_predicats.hpp, false for predicats.hpp through Pvertex3D.
+	 */
+	void predicats(const Mesh& mesh, bool indexes)
+	{
+		const VertexContainer&   vertices  = mesh.getVertices();
+		const TriangleContainer& triangles = mesh.getTriangles();
+		const Vertex*            coords    = vertices.data();
+		uint64_t                 count     = 0;
+		for(const TopoTriangle& t : triangles)
+		{
+			const IndexVertex_t* ids = t.beginVertice();
+			for(uint32_t i=0;i<3;++i)
+			{
+				IndexFace_t n = t.getNeighbors()[i];
+				if (n == -1)
+				{
+					continue;
+				}
+				IndexVertex_t s = triangles[n].getOppositeVertexOf(&t - triangles.data());
+				if (indexes)
+				{
+					count += indexed::isInSurroundingCircle(coords, ids[0], ids[1], ids[2], s);
+					count += indexed::orientation2D(coords, ids[(i+1)%3], ids[(i+2)%3], s) < 0.0;
+					count += indexed::isInThisTriangle(coords, vertices[s], ids[0], ids[1], ids[2]);
+				}
+				else
+				{
+					const Vertex& a = vertices.at(ids[0]);
+					const Vertex& b = vertices.at(ids[1]);
+					const Vertex& c = vertices.at(ids[2]);
+					count += isInSurroundingCircle(a, b, c, vertices.at(s));
+					count += orientation2D(vertices.at(ids[(i+1)%3]), vertices.at(ids[(i+2)%3]), vertices.at(s)) < 0.0;
+					count += isInThisTriangle(vertices.at(s), Ptriangle3D(a, b, c));
+				}
+			}
+		}
+		sink = count;
+	}
+
+	/**
+	 * @brief Test every triangle against the opposite vertex of each of its neighbors with the exact predicats,
+	 * like Mesh does for its flips and its walks : exact in circle and exact orientation.
+	 * @param[in] indexes true to use indexed_predicats.hpp, false for predicats.hpp through Pvertex3D.
+	 */
+	void exactPredicats(const Mesh& mesh, bool indexes)
+	{
+		const VertexContainer&   vertices  = mesh.getVertices();
+		const TriangleContainer& triangles = mesh.getTriangles();
+		const Vertex*            coords    = vertices.data();
+		uint64_t                 count     = 0;
+		for(const TopoTriangle& t : triangles)
+		{
+			const IndexVertex_t* ids = t.beginVertice();
+			for(uint32_t i=0;i<3;++i)
+			{
+				IndexFace_t n = t.getNeighbors()[i];
+				if (n == -1)
+				{
+					continue;
+				}
+				IndexVertex_t s = triangles[n].getOppositeVertexOf(&t - triangles.data());
+				if (indexes)
+				{
+					count += indexed::exactInCircle(coords, ids[0], ids[1], ids[2], s) > 0;
+					count += indexed::exactOrientation2D(coords, ids[(i+1)%3], ids[(i+2)%3], coords[s]) < 0;
+				}
+				else
+				{
+					count += exactInCircle(vertices.at(ids[0]), vertices.at(ids[1]), vertices.at(ids[2]), vertices.at(s)) > 0;
+					count += exactOrientation2D(vertices.at(ids[(i+1)%3]), vertices.at(ids[(i+2)%3]), vertices.at(s)) < 0;
+				}
+			}
+		}
+		sink = count;
+	}
+
+	/**
+	 * @brief Compute the area of every triangle into \p areas.
+	 * @param[in] range true to use parallel::transform() over Mesh::rangeT(), false for a loop over the indexes.
+	 */
+	void areas(const Mesh& mesh, std::vector<double>& areas, bool range)
+	{
+		const Vertex* coords = mesh.getVertices().data();
+		auto          area   = [coords](const TopoTriangle& t){
+			const IndexVertex_t* ids = t.beginVertice();
+			return indexed::orientation2D(coords, ids[0], ids[1], ids[2])/2.0;
+		};
+		areas.resize(mesh.getTriangles().size());
+		if (range)
+		{
+			MeshRange<const TopoTriangle> triangles = mesh.rangeT();
+			parallel::transform(triangles.begin(), triangles.end(), areas.begin(), area);
+		}
+		else
+		{
+			for(uint32_t i=0;i<mesh.getTriangles().size();++i)
+			{
+				areas[i] = area(mesh.getTriangles().at(i));
+			}
+		}
+		sink = areas.size();
+	}
+
+	/**
+	 * @brief Compute the centroid of the neighbors of every vertex into \p centroids.
+	 * @param[in] adjacency The one-rings to read, nullptr to walk around each vertex instead,
+	 *                      from its face and through the neighbors, like a circulator (but stopping at the border).
+	 */
+	void centroids(const Mesh& mesh, const adjacency::Vertices* adjacency, std::vector<Vertex>& centroids)
+	{
+		const VertexContainer&   vertices  = mesh.getVertices();
+		const TriangleContainer& triangles = mesh.getTriangles();
+		const int32_t            nbV       = vertices.size();
+		centroids.resize(nbV);
+		#pragma omp parallel for schedule(static)
+		for(int32_t v=0;v<nbV;++v)
+		{
+			double   x = 0.0, y = 0.0, z = 0.0;
+			uint32_t n = 0;
+			auto     add = [&](IndexVertex_t w){x += vertices[w].x(); y += vertices[w].y(); z += vertices[w].z(); ++n;};
+			if (adjacency != nullptr)
+			{
+				for(uint32_t i=adjacency->vertexOffsets[v];i<adjacency->vertexOffsets[v+1];++i)
+				{
+					add(adjacency->vertices[i]);
+				}
+			}
+			else if (vertices[v].face() != -1)
+			{
+				// Clockwise to the border, if any, then every triangle counter-clockwise.
+				// Both are bounded, as the degenerate point sets may give broken fans.
+				IndexFace_t start = vertices[v].face();
+				IndexFace_t f     = start;
+				IndexFace_t next  = -1;
+				uint32_t    steps = 0;
+				while((next = triangles[f].getNeighbors()[(triangles[f].findVertexIndex(v)+2)%3]) != -1 && next != start && ++steps < triangles.size())
+				{
+					f = next;
+				}
+				start = f;
+				steps = 0;
+				do
+				{
+					const IndexVertex_t* ids   = triangles[f].beginVertice();
+					int32_t              local = triangles[f].findVertexIndex(v);
+					add(ids[(local+1)%3]);
+					f = triangles[f].getNeighbors()[(local+1)%3];
+					if (f == -1)
+					{
+						add(ids[(local+2)%3]);
+					}
+				} while(f != -1 && f != start && ++steps < triangles.size());
+			}
+			centroids[v] = (n == 0) ? vertices[v] : Vertex(x/n, y/n, z/n);
+		}
+		sink = centroids.size();
+	}
+
+	/**
+	 * @brief Find the K nearest vertices of QUERIES vertices (spread over the whole mesh), into \p result.
+	 * @param[in] tree The tree to use, nullptr for a loop over every vertex.
+	 */
+	void knn(const Mesh& mesh, const kdtree::Tree* tree, std::vector<IndexVertex_t>& result)
+	{
+		const VertexContainer& vertices = mesh.getVertices();
+		const int32_t          nb       = std::min<uint32_t>(QUERIES, vertices.size());
+		VertexContainer        queries(nb);
+		for(int32_t q=0;q<nb;++q)
+		{
+			queries[q] = vertices[static_cast<uint64_t>(q)*vertices.size()/nb];
+		}
+		if (tree != nullptr)
+		{
+			result = kdtree::nearest(*tree, queries, K);
+			sink   = result.size();
+			return;
+		}
+		result.assign(static_cast<size_t>(nb)*K, -1);
+		#pragma omp parallel for schedule(static)
+		for(int32_t q=0;q<nb;++q)
+		{
+			std::vector<std::pair<double, IndexVertex_t>> best;
+			for(uint32_t v=0;v<vertices.size();++v)
+			{
+				double dx = vertices[v].x()-queries[q].x(), dy = vertices[v].y()-queries[q].y(), dz = vertices[v].z()-queries[q].z();
+				best.emplace_back(dx*dx + dy*dy + dz*dz, v);
+				if (best.size() > 4*K)
+				{
+					std::nth_element(best.begin(), best.begin() + K, best.end());
+					best.resize(K);
+				}
+			}
+			std::sort(best.begin(), best.end());
+			for(uint32_t i=0;i<K && i<best.size();++i)
+			{
+				result[static_cast<size_t>(q)*K + i] = best[i].second;
+			}
+		}
+		sink = result.size();
+	}
+
+	/**
+	 * @brief Cast GRID x GRID rays along -z over the bounding box of \p mesh, row by row, so the
+	 * consecutive rays of a packet are neighbors.
+	 */
+	void rays(const Mesh& mesh, const bvh::Tree& tree)
+	{
+		const VertexContainer& vertices = mesh.getVertices();
+		VertexType low[2]  = { std::numeric_limits<VertexType>::max(),  std::numeric_limits<VertexType>::max()};
+		VertexType high[2] = {-std::numeric_limits<VertexType>::max(), -std::numeric_limits<VertexType>::max()};
+		for(const Vertex& v : vertices)
+		{
+			low[0]  = std::min(low[0], v.x());
+			low[1]  = std::min(low[1], v.y());
+			high[0] = std::max(high[0], v.x());
+			high[1] = std::max(high[1], v.y());
+		}
+		std::vector<bvh::Ray> queries(GRID*GRID);
+		for(uint32_t i=0;i<GRID;++i)
+		{
+			for(uint32_t j=0;j<GRID;++j)
+			{
+				bvh::Ray& ray = queries[i*GRID + j];
+				ray.origin    = Vertex(low[0] + (high[0]-low[0])*(j+0.5)/GRID, low[1] + (high[1]-low[1])*(i+0.5)/GRID, 1.0);
+				ray.direction = Vertex(0.0, 0.0, -1.0);
+			}
+		}
+		std::vector<bvh::Hit> hits = bvh::intersect(tree, queries);
+		sink = std::count_if(hits.begin(), hits.end(), [](const bvh::Hit& h){return h.triangle != -1;});
+	}
+
+	/**
+	 * @brief Measure \p stage over the point set \p pts (and \p ctri, \p off, written next to it).
+	 */
+	std::vector<double> benchmark(const Options& options, Stage_e stage, const std::string& pts, const std::string& ctri, const std::string& off)
+	{
+		Mesh mesh;
+		auto nothing = [](){};
+		auto load    = [&](){mesh.load2DTriangulationFromPts(pts);};
+		switch(stage)
+		{
+			case TRIANGULATE:
+				return repeat(options, nothing, load);
+			case CRUST:
+				return repeat(options, load, [&](){mesh.Crust();});
+			case REFINE:
+				return repeat(options, nothing, [&](){mesh.loadConstraints(ctri);});
+			case REFINE_SPLIT:
+				return repeat(options, nothing, [&](){mesh.loadConstraints(ctri, SPLIT_SEGMENTS);});
+			case DUMP_OFF:
+				load();
+				return repeat(options, nothing, [&](){mesh.dumpToOff(off);});
+			case LOAD_OFF:
+				load();
+				mesh.dumpToOff(off);
+				return repeat(options, nothing, [&](){mesh.loadMeshFromOff(off);});
+			case ENCODE:
+				load();
+				return repeat(options, nothing, [&](){sink = mesh.dumpCompressed(off + ".mshz").bytes;});
+			case DECODE:
+				load();
+				mesh.dumpCompressed(off + ".mshz");
+				return repeat(options, nothing, [&](){mesh.loadCompressed(off + ".mshz");});
+			case PREDICATS:
+			case INDEXED:
+				load();
+				return repeat(options, nothing, [&](){predicats(mesh, stage == INDEXED);});
+			case EXACT:
+			case INDEXED_EXACT:
+				load();
+				return repeat(options, nothing, [&](){exactPredicats(mesh, stage == INDEXED_EXACT);});
+			case AREA_LOOP:
+			case AREA_RANGE:
+			{
+				std::vector<double> result;
+				load();
+				return repeat(options, nothing, [&](){areas(mesh, result, stage == AREA_RANGE);});
+			}
+			case ADJACENCY:
+				load();
+				return repeat(options, nothing, [&](){sink = mesh.buildVertexAdjacency().vertices.size();});
+			case RING_WALK:
+			case RING_CSR:
+			{
+				std::vector<Vertex> result;
+				load();
+				adjacency::Vertices adjacency = mesh.buildVertexAdjacency();
+				return repeat(options, nothing, [&](){centroids(mesh, (stage == RING_CSR) ? &adjacency : nullptr, result);});
+			}
+			case KDTREE:
+				load();
+				return repeat(options, nothing, [&](){sink = kdtree::build(mesh.getVertices()).nodes.size();});
+			case KNN_BRUTE:
+			case KNN_KDTREE:
+			{
+				std::vector<IndexVertex_t> result;
+				load();
+				kdtree::Tree tree = kdtree::build(mesh.getVertices());
+				return repeat(options, nothing, [&](){knn(mesh, (stage == KNN_KDTREE) ? &tree : nullptr, result);});
+			}
+			case BVH:
+				load();
+				return repeat(options, nothing, [&](){sink = bvh::build(mesh.getVertices(), mesh.getTriangles()).nodes.size();});
+			case RAYS:
+			{
+				load();
+				bvh::Tree tree = bvh::build(mesh.getVertices(), mesh.getTriangles());
+				return repeat(options, nothing, [&](){rays(mesh, tree);});
+			}
+		}
+		return std::vector<double>();
+	}
+
+	std::string key(const std::string& generator, uint32_t size, const std::string& stage)
+	{
+		return generator + " " + std::to_string(size) + " " + stage;
+	}
+
+	void writeJson(std::ostream& out, const std::vector<Result>& results)
+	{
+		out << "{" << std::endl << "\"results\": [" << std::endl;
+		for(uint32_t i=0;i<results.size();++i)
+		{
+			const Result& r = results[i];
+			out << "{\"generator\": \"" << r.generator << "\", \"size\": " << r.size << ", \"stage\": \"" << r.stage << "\""
+			    << ", \"repetitions\": " << r.times.size() << ", \"min\": " << r.times.front() << ", \"median\": " << r.median()
+			    << ", \"mean\": " << r.mean() << ", \"max\": " << r.times.back() << "}" << ((i+1 < results.size()) ? "," : "") << std::endl;
+		}
+		out << "]" << std::endl << "}" << std::endl;
+	}
+
+	/**
+	 * @brief Get the value of the field \p field inside a JSON \p line written by writeJson().
+	 * @return An empty string if there is no such field.
+	 */
+	std::string field(const std::string& line, const std::string& field)
+	{
+		std::string::size_type start = line.find("\"" + field + "\":");
+		if (start == std::string::npos)
+		{
+			return "";
+		}
+		start = line.find_first_not_of(" \"", start + field.size() + 3);
+		std::string::size_type end = line.find_first_of("\",}", start);
+		return line.substr(start, end - start);
+	}
+
+	/**
+	 * @brief Read the medians of a previous output.
+	 * @throw std::runtime_error If the file can't be read.
+	 */
+	std::map<std::string, double> readBaseline(const std::string& fname)
+	{
+		std::ifstream file(fname.c_str());
+		if (!file.good())
+		{
+			throw std::runtime_error("Unable to read the baseline " + fname);
+		}
+		std::map<std::string, double> medians;
+		std::string line;
+		while(std::getline(file, line))
+		{
+			if (line.find("\"generator\"") != std::string::npos)
+			{
+				uint32_t size = std::atoi(field(line, "size").c_str());
+				medians[key(field(line, "generator"), size, field(line, "stage"))] = std::atof(field(line, "median").c_str());
+			}
+		}
+		return medians;
+	}
+
+	/**
+	 * @brief Compare \p results with \p baseline, and report every one of them on stderr.
+	 * @return The number of regressions.
+	 */
+	uint32_t compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double threshold)
+	{
+		uint32_t regressions = 0;
+		for(const Result& r : results)
+		{
+			auto found = baseline.find(key(r.generator, r.size, r.stage));
+			if (found == baseline.end() || found->second <= 0.0)
+			{
+				continue;
+			}
+			double change     = r.median()/found->second - 1.0;
+			bool   regression = change > threshold;
+			regressions      += regression ? 1 : 0;
+			std::cerr << key(r.generator, r.size, r.stage) << "  " << r.median() << "s  baseline " << found->second << "s  "
+			          << ((change >= 0.0) ? "+" : "") << 100.0*change << "%" << (regression ? "  REGRESSION" : "") << std::endl;
+		}
+		return regressions;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		options = parse(argc, argv);
+	}
+	catch(const std::invalid_argument& e)
+	{
+		std::cerr << e.what() << std::endl;
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (options.help)
+	{
+		usage(argv[0]);
+		return EXIT_SUCCESS;
+	}
+	mtl::log::Options::ENABLE_LOG = false;
+
+	std::vector<Result> results;
+	for(generators::Generator_e generator : options.generators)
+	{
+		std::map<Stage_e, bool> stopped; // The stages which failed or were too slow at a smaller size.
+		for(uint32_t size : options.sizes)
+		{
+			// Only the line generator gives a simple polygon to constrain.
+			auto skipped = [&](Stage_e stage){return stopped[stage] || ((stage == REFINE || stage == REFINE_SPLIT) && generator != generators::LINE);};
+			if (std::all_of(options.stages.begin(), options.stages.end(), skipped))
+			{
+				break;
+			}
+			std::string name = generators::name(generator);
+			std::string base = options.directory + "/bench_" + name + "_" + std::to_string(size);
+			try
+			{
+				VertexContainer points = generators::points(generator, size, SEED);
+				generators::writePts(points, base + ".pts");
+				generators::writePolygon(points, base + ".ctri");
+			}
+			catch(const std::runtime_error& e)
+			{
+				std::cerr << e.what() << std::endl;
+				return EXIT_FAILURE;
+			}
+			for(Stage_e stage : options.stages)
+			{
+				if (skipped(stage))
+				{
+					continue;
+				}
+				Result result = {name, size, stageName(stage), std::vector<double>()};
+				try
+				{
+					result.times = benchmark(options, stage, base + ".pts", base + ".ctri", base + ".off");
+				}
+				catch(const std::exception& e)
+				{
+					std::cerr << key(name, size, result.stage) << "  FAILED : " << e.what() << std::endl;
+					stopped[stage] = true;
+					continue;
+				}
+				catch(const std::string& e)
+				{
+					std::cerr << key(name, size, result.stage) << "  FAILED : " << e << std::endl;
+					stopped[stage] = true;
+					continue;
+				}
+				std::cerr << key(name, size, result.stage) << "  median " << result.median() << "s" << std::endl;
+				stopped[stage] = result.median() > options.limit;
+				results.push_back(std::move(result));
+			}
+		}
+	}
+
+	if (options.output.empty())
+	{
+		writeJson(std::cout, results);
+	}
+	else
+	{
+		std::ofstream out(options.output.c_str());
+		writeJson(out, results);
+	}
+	if (!options.baseline.empty())
+	{
+		try
+		{
+			uint32_t regressions = compare(results, readBaseline(options.baseline), options.threshold);
+			std::cerr << regressions << " regression(s) over " << 100.0*options.threshold << "%" << std::endl;
+			return (regressions == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		catch(const std::runtime_error& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -1,19 +1,180 @@
+#define GL_GLEXT_PROTOTYPES
 #include "gasket.h"
 #include <GL/gl.h>
+#include <GL/glext.h>
 #include <cstdlib>
 #include <time.h>
 #include <string>
 #include <iostream>
+#include <algorithm>
 
 #define _GK_GL3CORE_H
 #include "CallBackglBegin.hpp"
+#include "logs.hpp"
 
 
-Gasket::Gasket()
+Gasket::Gasket() : detailsGeneration(0), maxDetails(0), detail(0)
 {
     
 }
 
+void Gasket::resetLevelsOfDetail(uint32_t count)
+{
+	// The buffers of the previous levels are deleted, the new levels are only simplified when displayed.
+	this->details.clear();
+	this->detailBuffers.clear();
+	this->detailsGeneration = this->mesh.getGeneration();
+	this->maxDetails        = count;
+	this->detail            = 0;
+}
+
+void Gasket::switchLevelOfDetail(int32_t step)
+{
+	if (this->detailsGeneration != this->mesh.getGeneration())
+	{
+		this->resetLevelsOfDetail(this->maxDetails);
+	}
+	int32_t level = static_cast<int32_t>(this->detail) + step;
+	this->detail  = std::max(0, std::min(level, static_cast<int32_t>(this->maxDetails)));
+	while(this->details.size() < this->detail)
+	{
+		const Mesh&       previous = this->details.empty() ? this->mesh : this->details.back();
+		std::vector<Mesh> next     = previous.levelsOfDetail(1);
+		if (next.empty()) // It can't be simplified anymore, the coarsest level is the previous one.
+		{
+			this->maxDetails = this->details.size();
+			this->detail     = this->maxDetails;
+			break;
+		}
+		this->details.push_back(std::move(next.front()));
+		this->detailBuffers.emplace_back();
+	}
+	uint32_t nb   = (this->detail == 0) ? this->mesh.getTriangles().size() : this->details[this->detail-1].getTriangles().size();
+	mtl::log::info("Level of detail", this->detail, "with", nb, "triangles");
+}
+
+void Gasket::generate(uint32_t depth, bool tetrahedral)
+{
+	this->mesh.loadGasket(depth, tetrahedral);
+	this->details.clear();
+	this->detailBuffers.clear();
+	this->maxDetails  = 0;
+	this->detail      = 0;
+	this->config.type = MESH;
+	mtl::log::info("Sierpinski gasket of depth", depth, "with", this->mesh.getTriangles().size(), "triangles");
+}
+
+MeshBuffers::MeshBuffers(void) : vbo(0), ibo(0), generation(0), nbIndexes(0)
+{
+	
+}
+
+MeshBuffers::MeshBuffers(MeshBuffers&& other) : vbo(other.vbo), ibo(other.ibo), generation(other.generation), nbIndexes(other.nbIndexes)
+{
+	other.vbo       = 0;
+	other.ibo       = 0;
+	other.nbIndexes = 0;
+}
+
+MeshBuffers& MeshBuffers::operator=(MeshBuffers&& other)
+{
+	if (this != &other)
+	{
+		this->release();
+		std::swap(this->vbo,        other.vbo);
+		std::swap(this->ibo,        other.ibo);
+		std::swap(this->generation, other.generation);
+		std::swap(this->nbIndexes,  other.nbIndexes);
+	}
+	return *this;
+}
+
+MeshBuffers::~MeshBuffers(void)
+{
+	this->release();
+}
+
+void MeshBuffers::release(void)
+{
+	if (this->vbo != 0)
+	{
+		glDeleteBuffers(1, &this->vbo);
+		glDeleteBuffers(1, &this->ibo);
+	}
+	this->vbo        = 0;
+	this->ibo        = 0;
+	this->generation = 0;
+	this->nbIndexes  = 0;
+}
+
+void MeshBuffers::pack(const Mesh& mesh, std::vector<float>& coords, std::vector<uint32_t>& indexes)
+{
+	const VertexContainer&   vertices  = mesh.getVertices();
+	const TriangleContainer& triangles = mesh.getTriangles();
+	coords.resize(3*vertices.size());
+	indexes.resize(3*triangles.size());
+	for(uint32_t i=0;i<vertices.size();++i)
+	{
+		coords[3*i]   = vertices[i].x();
+		coords[3*i+1] = vertices[i].y();
+		coords[3*i+2] = vertices[i].z();
+	}
+	for(uint32_t i=0;i<triangles.size();++i)
+	{
+		std::copy(triangles[i].beginVertice(), triangles[i].endVertice(), indexes.begin() + 3*i);
+	}
+}
+
+void MeshBuffers::update(const Mesh& mesh)
+{
+	if (this->vbo != 0 && this->generation == mesh.getGeneration())
+	{
+		return;
+	}
+	if (this->vbo == 0)
+	{
+		glGenBuffers(1, &this->vbo);
+		glGenBuffers(1, &this->ibo);
+	}
+	std::vector<float>    coords;
+	std::vector<uint32_t> indexes;
+	MeshBuffers::pack(mesh, coords, indexes);
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+	glBufferData(GL_ARRAY_BUFFER, coords.size()*sizeof(float), coords.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexes.size()*sizeof(uint32_t), indexes.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	this->generation = mesh.getGeneration();
+	this->nbIndexes  = indexes.size();
+}
+
+void MeshBuffers::drawTriangles(void) const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ibo);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, 0);
+	glDrawElements(GL_TRIANGLES, this->nbIndexes, GL_UNSIGNED_INT, 0);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffers::drawPoints(uint32_t begin, uint32_t end) const
+{
+	if (begin >= end)
+	{
+		return;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, 0);
+	glDrawArrays(GL_POINTS, begin, end - begin);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 namespace
 {
 	struct FColor final
@@ -23,21 +184,11 @@ namespace
 		float b;
 	};
 
-	void drawCurrentMesh(const Mesh& mesh, int lineWidth)
+	void drawCurrentMesh(const MeshBuffers& buffers, int lineWidth)
 	{
 		glLineWidth(lineWidth);
 		glColor3f(1.0f, 1.0f, 1.0f);
-		mtl::gl::begin(GL_TRIANGLES, [&mesh](void){
-			auto vertices  = mesh.getVertices();
-			auto triangles = mesh.getTriangles();
-			for(auto tr : triangles)
-			{
-				for(auto index=tr.beginVertice();index!=tr.endVertice();++index)
-				{
-					glVertex3dv(vertices.at(*index));
-				}
-			}
-		});
+		buffers.drawTriangles();
 	}
 	
 	void drawEdges(const Mesh& mesh, const Curve_c& curve, int lineWidth, const FColor& c)
@@ -55,6 +206,27 @@ namespace
 		});
 	}
 	
+	void drawCells(Mesh& mesh, uint32_t end, int lineWidth, const FColor& c)
+	{
+		const voronoi::Diagram& diagram = mesh.getVoronoi();
+		glLineWidth(lineWidth);
+		glColor3f(c.r, c.g, c.b);
+		for(uint32_t v=0;v<end;++v)
+		{
+			if (voronoi::size(diagram, v) < 2)
+			{
+				continue;
+			}
+			mtl::gl::begin((diagram.closed[v]) ? GL_LINE_LOOP : GL_LINE_STRIP, [&diagram, v](void){
+				for(uint32_t i=diagram.offsets[v];i<diagram.offsets[v+1];++i)
+				{
+					Vertex tmp = diagram.centers.at(diagram.cells[i]);
+					glVertex3dv(tmp);
+				}
+			});
+		}
+	}
+	
 	/*
 	void drawCircle(const Vertex& center, double radius, int lineWidth)
 	{
@@ -72,39 +244,46 @@ namespace
 	}
 	*/
 	
-	void drawVertices(const Mesh& mesh, int poinstSize, float r, float g, float b, uint32_t beg, uint32_t end)
+	void drawVertices(const MeshBuffers& buffers, int poinstSize, float r, float g, float b, uint32_t beg, uint32_t end)
 	{
 		glPointSize(poinstSize);
 		glColor3f(r, g, b);
-		mtl::gl::begin(GL_POINTS, [beg, end, &mesh](void){
-			for(uint32_t i=beg;i<end;++i)
-			{
-				Vertex tmp = mesh.getVertices().at(i);
-				glVertex3dv(tmp);
-			}
-		});
+		buffers.drawPoints(beg, end);
 	}
 
 }
 void Gasket::draw()
 {
+	if (this->config.type == MESH && this->detail > 0 && this->detailsGeneration == this->mesh.getGeneration())
+	{
+		MeshBuffers& buffers = this->detailBuffers[this->detail-1];
+		buffers.update(this->details[this->detail-1]);
+		drawCurrentMesh(buffers, 2);
+		return;
+	}
+	this->buffers.update(this->mesh);
 	if (this->config.type == MESH || this->config.type == TRIANGULATION)
 	{
 		if (this->config.type == TRIANGULATION)
 		{
-			drawVertices(this->mesh, 8, 1.0f, 1.0f, 0.0f, 0, this->mesh.getVertices().size());
+			drawVertices(this->buffers, 8, 1.0f, 1.0f, 0.0f, 0, this->mesh.getVertices().size());
+			if (this->config.cells)
+			{
+				FColor c = {0.0f, 1.0f, 0.0f};
+				drawCells(this->mesh, this->mesh.getVertices().size(), 1, c);
+			}
 		}
-		drawCurrentMesh(this->mesh, 2);
+		drawCurrentMesh(this->buffers, 2);
 	}
-	else if (this->config.type == CURVE)
+	else if (this->config.type == CURVE || this->config.type == NN_CURVE)
 	{
 		if (this->config.points)
 		{
-			drawVertices(this->mesh, 8, 1.0f, 1.0f, 0.0f, 0, this->mesh.getIndexBeforeVoronoi());
+			drawVertices(this->buffers, 8, 1.0f, 1.0f, 0.0f, 0, this->mesh.getIndexBeforeVoronoi());
 		}
 		if (this->config.centers)
 		{
-			drawVertices(this->mesh, 8, 0.0f, 0.0f, 1.0f, this->mesh.getIndexBeforeVoronoi(), this->mesh.getVertices().size());
+			drawVertices(this->buffers, 8, 0.0f, 0.0f, 1.0f, this->mesh.getIndexBeforeVoronoi(), this->mesh.getVertices().size());
 		}
 		if (this->config.curve)
 		{
@@ -113,19 +292,24 @@ void Gasket::draw()
 		}
 		if (this->config.triangles)
 		{
-			drawCurrentMesh(this->mesh, 2);
+			drawCurrentMesh(this->buffers, 2);
 		}
 		if (this->config.circles)
 		{
 			
 		}
+		if (this->config.cells)
+		{
+			FColor c = {0.0f, 1.0f, 0.0f};
+			drawCells(this->mesh, this->mesh.getIndexBeforeVoronoi(), 1, c);
+		}
 		
 	}
 	else if (this->config.type == CONSTRAINTS)
 	{
-		drawVertices(this->mesh, 8, 0.0f, 0.5f, 1.0f, 0, this->mesh.getVertices().size());
+		drawVertices(this->buffers, 8, 0.0f, 0.5f, 1.0f, 0, this->mesh.getVertices().size());
 		FColor c = {1.0, 0.0, 0.0};
 		drawEdges(this->mesh, this->mesh.getConstraints(), 4, c);
-		drawCurrentMesh(this->mesh, 2);
+		drawCurrentMesh(this->buffers, 2);
 	}
 }
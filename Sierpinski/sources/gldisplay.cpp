@@ -1,4 +1,6 @@
+#include <cmath>
 #include "gldisplay.h"
+#include "logs.hpp"
 
 #define FRUSTUM_SIZE 1.0f
 
@@ -72,7 +74,34 @@ void GLDisplay::mouseMoveEvent(QMouseEvent *event)
 void GLDisplay::mousePressEvent(QMouseEvent *event)
 {
     if( event != NULL )
+	{
         _position = event->pos();
+		if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ControlModifier))
+		{
+			this->pick(_position);
+		}
+	}
+}
+
+void GLDisplay::pick(const QPoint& position)
+{
+	// The inverse of paintGL() : the pixel in [-1, 1], unscaled, untranslated, then unrotated.
+	const double x = (2.0*position.x()/this->width()  - 1.0)/this->ZOOM - _transx;
+	const double y = (1.0 - 2.0*position.y()/this->height())/this->ZOOM - _transy;
+	const double z = FRUSTUM_SIZE/this->ZOOM;
+	const double c = std::cos(_angle*M_PI/180.0), s = std::sin(_angle*M_PI/180.0);
+	bvh::Ray ray;
+	ray.origin    = Vertex(c*x - s*z, y, s*x + c*z);
+	ray.direction = Vertex(s, 0.0, -c);
+	const bvh::Hit hit = bvh::intersect(gasket.mesh.getBvh(), ray);
+	if (hit.triangle == -1)
+	{
+		mtl::log::info("No triangle under the cursor");
+	}
+	else
+	{
+		mtl::log::info("Triangle", hit.triangle, "at", hit.distance, "barycentric", 1.0 - hit.u - hit.v, hit.u, hit.v);
+	}
 }
 
 void GLDisplay::wheelEvent(QWheelEvent* event)
@@ -1,12 +1,37 @@
 #include <cstdlib>
 #include <iostream>
+#include <algorithm>
 
 #include <QFileDialog>
+#include <QMessageBox>
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "gldisplay.h"
 
+#define LEVELS_OF_DETAIL 6 //!< How many coarser versions of an OFF mesh can be displayed, see Key_Minus and Key_Plus.
+#define GASKET_DEPTH     8 //!< The depth of the gaskets generated by Key_G (2D) and Key_T (3D).
+
+namespace
+{
+	/**
+	 * @brief Load the OFF file \p fname into the displayed mesh, warning the user when it can't be read.
+	 * @param[in] parent The window of the warning.
+	 * @param[in] fname  The name of the OFF file.
+	 */
+	void loadOff(QWidget* parent, const std::string& fname)
+	{
+		try
+		{
+			GLDisplay::gasket.mesh.loadMeshFromOff(fname);
+		}
+		catch(std::runtime_error& error)
+		{
+			QMessageBox::warning(parent, "Load Mesh", error.what());
+		}
+	}
+}
+
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent),
                                           ui(new Ui::MainWindow)
 {
@@ -29,14 +54,64 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
 		case Qt::Key_Escape:
 			close();
 			break;
+		case Qt::Key_Plus:
+			this->ui->widget->makeCurrent();
+			GLDisplay::gasket.switchLevelOfDetail(-1);
+			this->ui->widget->updateGL();
+			break;
+		case Qt::Key_Minus:
+			this->ui->widget->makeCurrent();
+			GLDisplay::gasket.switchLevelOfDetail(1);
+			this->ui->widget->updateGL();
+			break;
+		case Qt::Key_G:
+		case Qt::Key_T:
+			Mesh::resetStatistics();
+			this->ui->ReloadButton->setEnabled(false);
+			this->switchCheckBoxes(false);
+			this->ui->widget->reset();
+			this->ui->saveOff->setEnabled(true);
+			this->ui->widget->makeCurrent();
+			GLDisplay::gasket.generate(GASKET_DEPTH, event->key() == Qt::Key_T);
+			this->showStatistics();
+			this->ui->widget->updateGL();
+			break;
 		default:
 			QMainWindow::keyPressEvent(event);
     }
 }
 
+void MainWindow::showStatistics(void)
+{
+	stats::Report report = Mesh::getStatistics();
+	std::cout << stats::format(report);
+	if (!stats::enabled())
+	{
+		return;
+	}
+	// The stages may be nested (the quality inside the refinement), so they aren't summed.
+	QString stages;
+	for(uint32_t i=0;i<stats::TIMERS_NUMBER;++i)
+	{
+		if (report.calls[i] != 0)
+		{
+			stages += QString("%1 %2s  ").arg(stats::name(static_cast<stats::Timer_e>(i)).c_str()).arg(report.seconds[i], 0, 'f', 3);
+		}
+	}
+	uint64_t insertions = std::max<uint64_t>(1, report.counters[stats::INSERTIONS]);
+	uint64_t locations  = std::max<uint64_t>(1, report.counters[stats::LOCATIONS]);
+	QString  message    = QString("%1| %2 insertions, %3 flips/insertion, %4 visits/location, %5 in-circle tests")
+		.arg(stages)
+		.arg(report.counters[stats::INSERTIONS])
+		.arg(double(report.counters[stats::FLIPS])/insertions, 0, 'f', 2)
+		.arg(double(report.counters[stats::LOCATION_VISITS])/locations, 0, 'f', 2)
+		.arg(report.counters[stats::IN_CIRCLE]);
+	this->ui->statusBar->showMessage(message);
+}
+
 void MainWindow::switchCheckBoxes(bool value)
 {
-	this->ui->CheckCells->setEnabled(false);
+	this->ui->CheckCells->setEnabled(value);
 	this->ui->CheckCenters->setEnabled(value);
 	this->ui->CheckCircles->setEnabled(false);
 	this->ui->CheckCurve->setEnabled(value);
@@ -52,6 +127,7 @@ void MainWindow::on_actionPTS_curve_triggered()
 	std::string str = file.toStdString();
     if (str != "")
     {
+		Mesh::resetStatistics();
 		this->ui->ReloadButton->setEnabled(true);
 		this->ui->widget->reset();
 		this->switchCheckBoxes(true);
@@ -59,6 +135,26 @@ void MainWindow::on_actionPTS_curve_triggered()
         GLDisplay::gasket.mesh.load2DTriangulationFromPts(str);
         GLDisplay::gasket.mesh.Crust();
 		GLDisplay::gasket.config.type = CURVE;
+		this->showStatistics();
+		this->loaded = std::move(str);
+    }
+}
+
+void MainWindow::on_actionPTS_nn_curve_triggered()
+{
+    QString file = QFileDialog::getOpenFileName(this, "Load Curve", QDir::currentPath(), "Curve Files (*.pts *.tri)");
+	std::string str = file.toStdString();
+    if (str != "")
+    {
+		Mesh::resetStatistics();
+		this->ui->ReloadButton->setEnabled(true);
+		this->ui->widget->reset();
+		this->switchCheckBoxes(true);
+		this->ui->saveOff->setEnabled(false);
+        GLDisplay::gasket.mesh.load2DTriangulationFromPts(str);
+        GLDisplay::gasket.mesh.NNCrust();
+		GLDisplay::gasket.config.type = NN_CURVE;
+		this->showStatistics();
 		this->loaded = std::move(str);
     }
 }
@@ -69,11 +165,14 @@ void MainWindow::on_actionPTS_triangulation_triggered()
 	std::string str = file.toStdString();
     if (str != "")
     {
+		Mesh::resetStatistics();
 		this->ui->ReloadButton->setEnabled(true);
 		this->switchCheckBoxes(false);
+		this->ui->CheckCells->setEnabled(true);
 		this->ui->widget->reset();
 		this->ui->saveOff->setEnabled(true);
         GLDisplay::gasket.mesh.load2DTriangulationFromPts(str);
+		this->showStatistics();
 		this->loaded = std::move(str);
 		GLDisplay::gasket.config.type = TRIANGULATION;
     }
@@ -85,21 +184,28 @@ void MainWindow::on_actionOFF_mesh_triggered()
 	std::string str = file.toStdString();
     if (str != "")
     {
+		Mesh::resetStatistics();
 		this->ui->ReloadButton->setEnabled(true);
 		this->switchCheckBoxes(false);
 		this->ui->widget->reset();
 		this->ui->saveOff->setEnabled(false);
-        GLDisplay::gasket.mesh.loadMeshFromOff(str);
+        loadOff(this, str);
+		this->ui->widget->makeCurrent();
+		GLDisplay::gasket.resetLevelsOfDetail(LEVELS_OF_DETAIL);
 		GLDisplay::gasket.config.type = MESH;
+		this->showStatistics();
 		this->loaded = std::move(str);
     }
 }
 
 void MainWindow::on_ReloadButton_released()
 {
+	Mesh::resetStatistics();
     if (GLDisplay::gasket.config.type == MESH)
 	{
-        GLDisplay::gasket.mesh.loadMeshFromOff(this->loaded);
+        loadOff(this, this->loaded);
+		this->ui->widget->makeCurrent();
+		GLDisplay::gasket.resetLevelsOfDetail(LEVELS_OF_DETAIL);
 	}
 	else if (GLDisplay::gasket.config.type == TRIANGULATION)
 	{
@@ -110,10 +216,16 @@ void MainWindow::on_ReloadButton_released()
         GLDisplay::gasket.mesh.load2DTriangulationFromPts(this->loaded);
         GLDisplay::gasket.mesh.Crust();
 	}
+	else if (GLDisplay::gasket.config.type == NN_CURVE)
+	{
+        GLDisplay::gasket.mesh.load2DTriangulationFromPts(this->loaded);
+        GLDisplay::gasket.mesh.NNCrust();
+	}
 	else if (GLDisplay::gasket.config.type == CONSTRAINTS)
 	{
 		GLDisplay::gasket.mesh.loadConstraints(this->loaded);
 	}
+	this->showStatistics();
 	this->ui->widget->updateGL();
 }
 
@@ -186,6 +298,19 @@ void MainWindow::on_CheckPoints_stateChanged(int arg1)
 	this->ui->widget->updateGL();
 }
 
+void MainWindow::on_CheckCells_stateChanged(int arg1)
+{
+	if (arg1 == Qt::Unchecked)
+	{
+		GLDisplay::gasket.config.cells = false;
+	}
+	else
+	{
+		GLDisplay::gasket.config.cells = true;
+	}
+	this->ui->widget->updateGL();
+}
+
 void MainWindow::on_CheckCircles_stateChanged(int arg1)
 {
 	if (arg1 == Qt::Unchecked)
@@ -205,12 +330,14 @@ void MainWindow::on_action2D_Constraint_Triangulation_triggered()
 	std::string str = file.toStdString();
     if (str != "")
     {
+		Mesh::resetStatistics();
 		this->ui->ReloadButton->setEnabled(true);
 		this->switchCheckBoxes(false);
 		this->ui->widget->reset();
 		this->ui->saveOff->setEnabled(false);
         GLDisplay::gasket.mesh.loadConstraints(str);
 		GLDisplay::gasket.config.type = CONSTRAINTS;
+		this->showStatistics();
 		this->loaded = std::move(str);
     }
 }
@@ -7,6 +7,9 @@
 #include <queue>
 #include <stack>
 #include <exception>
+#include <chrono>
+#include <limits>
+#include <numeric>
 
 #include "Mesh.hpp"
 #include "logs.hpp"
@@ -14,6 +17,11 @@
 // plugins
 #include "OffLoader.hpp"
 #include "neighbors.hpp"
+#include "parallel.hpp"
+#include "spatial_sort.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "indexed_predicats.hpp"
 
 
 // ## PARTIE TP1 ##############################################################################################
@@ -27,24 +35,79 @@ void Mesh::empty(void)
 	this->triangles = std::move(bar);
 	this->borders.clear();
 	this->constraints.clear();
+	this->constrained.clear();
 	this->indexBeforeVoronoi = 0;
+	this->touch();
 	mtl::log::info("Remove everything from the mesh");
 }
 void Mesh::loadMeshFromOff(const std::string& fname)
 {
+	STATS_TIME(LOAD_OFF);
+	TRACE_SCOPE("load off");
 	this->empty();
 	try
 	{
 		OffLoader::load(this->vertices, this->triangles, fname);
 	}
-	catch(std::runtime_error& exception)
+	catch(std::runtime_error&)
 	{
-		// Do something usefull here, like displaying an error message.
 		this->empty();
+		throw;
 	}
+	this->touch();
+}
+void Mesh::loadGasket(uint32_t depth, bool tetrahedral)
+{
+	STATS_TIME(GASKET);
+	TRACE_SCOPE("gasket");
+	this->empty();
+	sierpinski::generate(depth, tetrahedral, this->vertices, this->triangles);
+	this->touch();
+}
+void Mesh::loadClustered(const outofcore::Store& store, uint32_t resolution)
+{
+	STATS_TIME(CLUSTER);
+	TRACE_SCOPE("cluster");
+	this->empty();
+	outofcore::cluster(store, resolution, this->vertices, this->triangles);
+	this->touch();
+}
+codec::Report Mesh::dumpCompressed(const std::string& fname, uint32_t bits) const
+{
+	STATS_TIME(ENCODE);
+	TRACE_SCOPE("encode");
+	std::ofstream out(fname, std::ios::binary);
+	if (!out.is_open())
+	{
+		throw std::runtime_error("Unable to open " + fname);
+	}
+	return codec::encode(this->vertices, this->triangles, out, bits);
+}
+void Mesh::loadCompressed(const std::string& fname)
+{
+	STATS_TIME(DECODE);
+	TRACE_SCOPE("decode");
+	this->empty();
+	std::ifstream in(fname, std::ios::binary);
+	if (!in.is_open())
+	{
+		throw std::runtime_error("Unable to open " + fname);
+	}
+	try
+	{
+		codec::decode(in, this->vertices, this->triangles);
+	}
+	catch(std::runtime_error&)
+	{
+		this->empty();
+		throw;
+	}
+	this->touch();
 }
 void Mesh::dumpToOff(const std::string& fname) const
 {
+	STATS_TIME(DUMP_OFF);
+	TRACE_SCOPE("dump off");
 	OffLoader::dump(this->vertices, this->triangles, fname);
 }
 VertexContainer& Mesh::getVertices(void)
@@ -87,6 +150,181 @@ const Curve_c& Mesh::getConstraints(void) const
 {
 	return this->constraints;
 }
+quality::Report Mesh::computeQuality(uint32_t bins, uint32_t k) const
+{
+	STATS_TIME(QUALITY);
+	TRACE_SCOPE("quality");
+	return quality::analyze(this->vertices, this->triangles, bins, k);
+}
+validation::Report Mesh::validate(bool planar) const
+{
+	STATS_TIME(VALIDATE);
+	TRACE_SCOPE("validate");
+	return validation::check(this->vertices, this->triangles, this->constrained, planar);
+}
+components::Report Mesh::analyzeComponents(void) const
+{
+	STATS_TIME(COMPONENTS);
+	TRACE_SCOPE("components");
+	return components::analyze(this->vertices, this->triangles);
+}
+adjacency::Vertices Mesh::buildVertexAdjacency(void) const
+{
+	STATS_TIME(ADJACENCY);
+	TRACE_SCOPE("adjacency");
+	return adjacency::build(this->vertices, this->triangles);
+}
+laplacian::Matrix Mesh::buildLaplacian(const adjacency::Vertices& adjacency) const
+{
+	STATS_TIME(LAPLACIAN);
+	TRACE_SCOPE("laplacian");
+	return laplacian::build(this->vertices, this->triangles, adjacency);
+}
+laplacian::Curvatures Mesh::computeCurvatures(void) const
+{
+	STATS_TIME(CURVATURES);
+	TRACE_SCOPE("curvatures");
+	adjacency::Vertices adjacency = this->buildVertexAdjacency();
+	laplacian::Matrix   matrix    = this->buildLaplacian(adjacency);
+	return laplacian::curvatures(this->vertices, this->triangles, adjacency, matrix);
+}
+void Mesh::simplify(uint32_t targetFaces)
+{
+	STATS_TIME(SIMPLIFY);
+	TRACE_SCOPE("simplify");
+	uint32_t before    = this->triangles.size();
+	uint32_t collapses = simplify::collapse(this->vertices, this->triangles, targetFaces);
+	this->borders.clear();
+	this->curve.clear();
+	this->constraints.clear();
+	this->constrained.clear();
+	this->indexBeforeVoronoi = 0;
+	this->touch();
+	mtl::log::info("Mesh::simplify(),", collapses, "collapses,", before, "-->", this->triangles.size(), "triangles");
+}
+std::vector<Mesh> Mesh::levelsOfDetail(uint32_t levels, double ratio) const
+{
+	std::vector<Mesh> chain;
+	chain.reserve(levels);
+	const Mesh* previous = this;
+	for(uint32_t i=0;i<levels;++i)
+	{
+		Mesh next(*previous);
+		next.simplify(previous->triangles.size()*ratio);
+		if (next.triangles.size() == previous->triangles.size())
+		{
+			break;
+		}
+		chain.push_back(std::move(next));
+		previous = &chain.back();
+	}
+	return chain;
+}
+double Mesh::smooth(uint32_t iterations, double lambda, double mu, bool fixedBorder)
+{
+	STATS_TIME(SMOOTH);
+	TRACE_SCOPE("smooth");
+	adjacency::Vertices adjacency = this->buildVertexAdjacency();
+	auto     start = std::chrono::steady_clock::now();
+	uint64_t moves = smooth::taubin(this->vertices, adjacency, iterations, lambda, mu, fixedBorder);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	this->touch();
+	double throughput = (elapsed.count() > 0.0) ? moves/elapsed.count() : 0.0;
+	mtl::log::info("Mesh::smooth(),", iterations, "iterations,", moves, "moves,", throughput, "vertex moves/s");
+	return throughput;
+}
+const voronoi::Diagram& Mesh::getVoronoi(void)
+{
+	if (this->diagram.offsets.empty() || this->diagram.generation != this->generation)
+	{
+		STATS_TIME(VORONOI);
+		TRACE_SCOPE("voronoi");
+		this->diagram            = voronoi::build(this->vertices, this->triangles);
+		this->diagram.generation = this->generation;
+	}
+	return this->diagram;
+}
+const normals::Normals& Mesh::getNormals(normals::Weighting_e weighting)
+{
+	if (this->cachedNormals.vertices.empty() || this->cachedNormals.generation != this->generation || this->cachedNormals.weighting != weighting)
+	{
+		STATS_TIME(NORMALS);
+		TRACE_SCOPE("normals");
+		if (!this->changesLost && !this->cachedNormals.vertices.empty() && this->cachedNormals.weighting == weighting)
+		{
+			normals::update(this->vertices, this->triangles, this->changes, this->cachedNormals);
+		}
+		else
+		{
+			this->cachedNormals = normals::build(this->vertices, this->triangles, weighting);
+		}
+		this->cachedNormals.generation = this->generation;
+		this->changes.clear();
+		this->changesLost = false;
+	}
+	return this->cachedNormals;
+}
+const kdtree::Tree& Mesh::getKdTree(void)
+{
+	if (this->tree.nodes.empty() || this->tree.generation != this->generation)
+	{
+		STATS_TIME(KDTREE);
+		TRACE_SCOPE("kd-tree");
+		this->tree            = kdtree::build(this->vertices);
+		this->tree.generation = this->generation;
+	}
+	return this->tree;
+}
+const bvh::Tree& Mesh::getBvh(void)
+{
+	if (this->hierarchy.nodes.empty() || this->hierarchy.generation != this->generation)
+	{
+		STATS_TIME(BVH);
+		TRACE_SCOPE("bvh");
+		this->hierarchy            = bvh::build(this->vertices, this->triangles);
+		this->hierarchy.generation = this->generation;
+	}
+	return this->hierarchy;
+}
+void Mesh::touch(void)
+{
+	++this->generation;
+	this->changes.clear();
+	this->changesLost = true;
+}
+void Mesh::logChange(IndexFace_t f)
+{
+	if (this->changesLost)
+	{
+		return;
+	}
+	// Beyond the number of triangles, computing everything again is cheaper.
+	if (this->changes.size() < this->triangles.size())
+	{
+		this->changes.push_back(f);
+	}
+	else
+	{
+		this->changes.clear();
+		this->changesLost = true;
+	}
+}
+stats::Report Mesh::getStatistics(void)
+{
+	return stats::collect();
+}
+void Mesh::resetStatistics(void)
+{
+	stats::reset();
+}
+void Mesh::startTrace(const std::string& fname)
+{
+	trace::start(fname);
+}
+void Mesh::stopTrace(void)
+{
+	trace::stop();
+}
 // ############################################################################################################
 
 // ## PARTIE TP2 ##############################################################################################
@@ -106,6 +344,46 @@ Mesh::vertex_iterator Mesh::endV(void)
 {
 	return vertex_iterator(&this->vertices, this->vertices.size());
 }
+Mesh::const_triangle_iterator Mesh::beginT(void) const
+{
+	return const_triangle_iterator(&this->triangles, 0);
+}
+Mesh::const_triangle_iterator Mesh::endT(void) const
+{
+	return const_triangle_iterator(&this->triangles, this->triangles.size());
+}
+Mesh::const_vertex_iterator Mesh::beginV(void) const
+{
+	return const_vertex_iterator(&this->vertices, 0);
+}
+Mesh::const_vertex_iterator Mesh::endV(void) const
+{
+	return const_vertex_iterator(&this->vertices, this->vertices.size());
+}
+MeshRange<TopoTriangle> Mesh::rangeT(void)
+{
+	return MeshRange<TopoTriangle>(this->beginT(), this->endT());
+}
+MeshRange<const TopoTriangle> Mesh::rangeT(void) const
+{
+	return MeshRange<const TopoTriangle>(this->beginT(), this->endT());
+}
+MeshRange<Vertex> Mesh::rangeV(void)
+{
+	return MeshRange<Vertex>(this->beginV(), this->endV());
+}
+MeshRange<const Vertex> Mesh::rangeV(void) const
+{
+	return MeshRange<const Vertex>(this->beginV(), this->endV());
+}
+Mesh::triangle_sentinel Mesh::sentinelT(void) const
+{
+	return triangle_sentinel(&this->triangles);
+}
+Mesh::vertex_sentinel Mesh::sentinelV(void) const
+{
+	return vertex_sentinel(&this->vertices);
+}
 Mesh::vertex_circulator Mesh::beginRV(IndexVertex_t center)
 {
 	return vertex_circulator(&this->vertices, &this->triangles, center);
@@ -139,10 +417,26 @@ namespace
 		}
 		return result;
 	}
-	//! @brief Check if there is enough vertex to make the first triangle.
-	inline bool enoughPointsForFirstTriangle(uint32_t nb)
+	//! @brief Relative squared distance under which 2 vertices are considered as the same one.
+	const double DUPLICATE_EPSILON = 1e-20;
+	//! @brief The squared distance between \b a and \b b in the xy plane.
+	inline VertexType squaredDistance2D(const Vertex& a, const Vertex& b)
 	{
-		return nb == 3;
+		VertexType dx = a.x() - b.x();
+		VertexType dy = a.y() - b.y();
+		return dx*dx + dy*dy;
+	}
+	//! @brief Check if \b p is inside the counterclockwise triangle \b ids, or on its border, whatever the rounding errors.
+	inline bool isInsideExactly(const Vertex* coords, const IndexVertex_t* ids, const Vertex& p)
+	{
+		for(uint32_t i=0;i<3;++i)
+		{
+			if (indexed::exactOrientation2D(coords, ids[(i+1)%3], ids[(i+2)%3], p) < 0)
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 	/**
 	 * @brief Get every neighbors indexes from \b t1 and \b t2.
@@ -171,11 +465,48 @@ namespace
 
 void Mesh::createInitialTriangle(void)
 {
-	const IndexVertex_t t[3] = {0, 1, 2};
-	this->triangles.push_back(std::vector<IndexVertex_t>(t, t+3));
-	for(IndexVertex_t i=0;i<3;++i)
+	// The first vertices may be aligned : nothing is built until the last one isn't, which is then
+	// linked to every previous one, sorted along their line.
+	const Vertex*       coords = this->vertices.data();
+	const IndexVertex_t apex   = this->vertices.size() - 1;
+	IndexVertex_t       second = 1;
+	while(second < apex && squaredDistance2D(coords[0], coords[second]) == 0.0)
+	{
+		++second;
+	}
+	if (second == apex || indexed::exactOrientation2D(coords, 0, second, coords[apex]) == 0)
+	{
+		return;
+	}
+	const VertexType dx = coords[second].x() - coords[0].x();
+	const VertexType dy = coords[second].y() - coords[0].y();
+	auto along = [&](IndexVertex_t i){return (coords[i].x() - coords[0].x())*dx + (coords[i].y() - coords[0].y())*dy;};
+	std::vector<IndexVertex_t> line(apex);
+	std::iota(line.begin(), line.end(), 0);
+	std::sort(line.begin(), line.end(), [&](IndexVertex_t a, IndexVertex_t b){return along(a) < along(b);});
+	// A vertex given twice stays out, like in insertVertexIntoTriangulation().
+	line.erase(std::unique(line.begin(), line.end(), [&](IndexVertex_t a, IndexVertex_t b){return squaredDistance2D(coords[a], coords[b]) == 0.0;}), line.end());
+	if (indexed::exactOrientation2D(coords, line[0], line[1], coords[apex]) < 0)
+	{
+		std::reverse(line.begin(), line.end());
+	}
+	for(uint32_t i=0;i+1<line.size();++i)
+	{
+		this->triangles.push_back(TopoTriangle(line[i], line[i+1], apex));
+		if (i > 0)
+		{
+			this->triangles[i].addNeighbor(i-1, {apex, line[i]});
+			this->triangles[i-1].addNeighbor(i, {line[i], apex});
+		}
+		this->vertices[line[i]].face(i);
+	}
+	this->vertices[line.back()].face(line.size()-2);
+	this->vertices[apex].face(0);
+	// The border goes clockwise.
+	line.push_back(apex);
+	for(IndexVertex_t i : line)
 	{
-		this->borders.push_front(t[i]);
+		this->borders.push_front(i);
 	}
 }
 Ptriangle3D Mesh::buildPtriangle3D(TopoTriangle& t)
@@ -189,16 +520,20 @@ Ptriangle3D Mesh::buildPtriangle3D(TopoTriangle& t)
 IndexFace_t Mesh::isInOneTriangle(const Vertex& v)
 {
 #ifndef SEARCH_WITH_DISTANCE
-	IndexFace_t i = 0;
-	for(auto triangle : this->triangles)
+	STATS_COUNT(LOCATIONS, 1);
+	STATS_COUNT(LINEAR_SCANS, 1);
+	const Vertex* coords = this->vertices.data();
+	IndexFace_t   i      = 0;
+	for(const TopoTriangle& triangle : this->triangles)
 	{
-		Ptriangle3D tmp = this->buildPtriangle3D(triangle);
-		if (isInThisTriangle(v, tmp))
+		if (isInsideExactly(coords, triangle.beginVertice(), v))
 		{
+			STATS_COUNT(LOCATION_VISITS, i+1);
 			return i;
 		}
 		++i;
 	}
+	STATS_COUNT(LOCATION_VISITS, i);
 	return -1;
 #else // It doesn't work, don't even use it
 	IndexFace_t index    = rand()%(this->triangles.size());
@@ -236,33 +571,65 @@ IndexFace_t Mesh::isInOneTriangle(const Vertex& v)
 	return -1;
 #endif
 }
+IndexFace_t Mesh::walkToTriangle(const Vertex& v, IndexFace_t start)
+{
+	const Vertex* coords  = this->vertices.data();
+	IndexFace_t   current = start;
+	for(uint32_t step=0;step<this->triangles.size();++step)
+	{
+		const TopoTriangle&  triangle = this->triangles[current];
+		const IndexVertex_t* ids      = triangle.beginVertice();
+		IndexFace_t          next     = current;
+		// Starting with a different edge each step avoids cycling.
+		for(uint32_t j=0;j<3 && next == current;++j)
+		{
+			uint32_t i = (step+j)%3;
+			if (indexed::exactOrientation2D(coords, ids[(i+1)%3], ids[(i+2)%3], v) < 0)
+			{
+				next = *(triangle.getNeighbors()+i);
+			}
+		}
+		if (next == current || next == -1) // Inside, or outside of the convex border.
+		{
+			STATS_COUNT(LOCATIONS, 1);
+			STATS_COUNT(LOCATION_VISITS, step+1);
+			return next;
+		}
+		current = next;
+	}
+	// The scan counts this location by itself.
+	STATS_COUNT(LOCATION_VISITS, this->triangles.size());
+	return this->isInOneTriangle(v);
+}
 IndexFace_t Mesh::localDelaunay(IndexFace_t tr_id)
 {
-	const TopoTriangle& triangle = this->triangles.at(tr_id);
+	const TopoTriangle&  triangle = this->triangles[tr_id];
+	const IndexVertex_t* ids      = triangle.beginVertice();
+	const Vertex*        coords   = this->vertices.data();
 	for(uint32_t i=0;i<3;++i)
 	{
 		IndexFace_t id = *(triangle.getNeighbors()+i);
 		if (id != -1)
 		{
 			TopoTriangle::Edge  edge  = triangle.getCommonEdge(id);
-			const Vertex& p = this->vertices.at(*triangle.beginVertice());
-			const Vertex& q = this->vertices.at(*(triangle.beginVertice()+1));
-			const Vertex& r = this->vertices.at(*(triangle.beginVertice()+2));
-			IndexVertex_t indexOpposite = this->triangles.at(id).getVertexOutsideOf(edge);
-			if (indexOpposite != -1)
-			{
-				const Vertex& s = this->vertices.at(this->triangles.at(id).getVertexOutsideOf(edge));
-				if (isInSurroundingCircle(p, q, r, s))
-				{
-					return id;
-				}
+			if (this->isConstrained(edge.a, edge.b))
+			{
+				continue;
+			}
+			IndexVertex_t indexOpposite = this->triangles[id].getVertexOutsideOf(edge);
+			// Exact and strict, so cocircular points are never flipped back and forth.
+			if (indexOpposite != -1 && indexed::exactInCircle(coords, ids[0], ids[1], ids[2], indexOpposite) > 0)
+			{
+				return id;
 			}
 		}
 	}
 	return -1;
 }
-void Mesh::incrementalDelaunay(const std::vector<IndexFace_t>& newTriangles)
+uint32_t Mesh::incrementalDelaunay(const std::vector<IndexFace_t>& newTriangles)
 {
+	TRACE_SCOPE("flip cascade");
+	uint32_t                flips = 0;
 	std::queue<IndexFace_t> queue;
 	for(auto elt : newTriangles)
 	{
@@ -285,6 +652,7 @@ void Mesh::incrementalDelaunay(const std::vector<IndexFace_t>& newTriangles)
 				queue.push(TFlip.getOppositeNeighborOf(TFlip.getAdjVertexClock(iflip)));
 				queue.push(TFlip.getOppositeNeighborOf(TFlip.getAdjVertexTrigo(iflip)));
 				this->flip(current, toFlipWith);
+				++flips;
 			}
 		}
 	}
@@ -292,6 +660,9 @@ void Mesh::incrementalDelaunay(const std::vector<IndexFace_t>& newTriangles)
 	{
 		
 	}
+	STATS_COUNT(FLIPS, flips);
+	TRACE_VALUE("flips", flips);
+	return flips;
 }
 void Mesh::manageNeighborInside(const std::vector<IndexFace_t> &news, std::vector<IndexFace_t>& concerned)
 {
@@ -300,9 +671,11 @@ void Mesh::manageNeighborInside(const std::vector<IndexFace_t> &news, std::vecto
 		concerned.push_back(tmp);
 	}
 	neighbor::MapEdges map;
-	for(auto index : concerned)
+	for(auto it=concerned.begin();it!=concerned.end();++it)
 	{
-		if (index == -1)
+		IndexFace_t index = *it;
+		// A triangle beside both split faces is listed twice, it would become its own neighbor.
+		if (index == -1 || std::find(concerned.begin(), it, index) != it)
 		{
 			continue;
 		}
@@ -329,20 +702,13 @@ void Mesh::insertPointIntoTriangle(Vertex& v, IndexFace_t indexCurrentFace, Inde
 		TopoTriangle  tmp(v_index, p3, *it);
 		
 		news.push_back(faceIndex);
+		// Each corner of the split triangle gets the new one built from it.
+		this->vertices.at(*it).face(faceIndex);
 		if (i+1 == max_i) // We write over an existing triangle
 		{
 			v.face(indexCurrentFace);
-			for(IndexVertex_t pt=0;pt<3;++pt)
-			{
-				Vertex& vertex = this->vertices.at(*(dying.beginVertice()+pt));
-				if (vertex.face() == indexCurrentFace &&
-					!(std::find(tmp.beginVertice(), tmp.endVertice(), vertex.face()) == tmp.endVertice()))
-				{
-					vertex.face(this->triangles.size()-1);
-					break;
-				}
-			}
 			this->triangles.at(indexCurrentFace) = std::move(tmp);
+			this->logChange(indexCurrentFace);
 		}
 		else // We just create a new triangle
 		{
@@ -353,7 +719,76 @@ void Mesh::insertPointIntoTriangle(Vertex& v, IndexFace_t indexCurrentFace, Inde
 	}
 	
 	this->manageNeighborInside(news, concerned);
-	this->incrementalDelaunay(concerned);
+	uint32_t flips = this->incrementalDelaunay(concerned);
+	STATS_COUNT(INSERTIONS, 1);
+	STATS_COUNT(CAVITY_TRIANGLES, 1 + flips);
+}
+void Mesh::insertPointOnEdge(Vertex& v, const TopoTriangle::Edge& edge, IndexVertex_t v_index, IndexFace_t face)
+{
+	++this->generation;
+	IndexFace_t   f1 = (face != -1) ? face : this->findThisFace(edge.a, edge.b);
+	IndexVertex_t a  = edge.a;
+	IndexVertex_t b  = edge.b;
+	if (this->triangles.at(f1).getAdjVertexTrigo(a) != b)
+	{
+		std::swap(a, b);
+	}
+	IndexVertex_t c  = this->triangles.at(f1).getVertexOutsideOf(edge);
+	IndexFace_t   f2 = this->triangles.at(f1).getOppositeNeighborOf(c);
+	std::vector<IndexFace_t> concerned;
+	std::vector<IndexFace_t> news;
+	for(IndexFace_t f : {f1, f2})
+	{
+		if (f == -1)
+		{
+			continue;
+		}
+		const IndexFace_t* n = this->triangles.at(f).getNeighbors();
+		for(uint32_t i=0;i<3;++i)
+		{
+			if (n[i] != f1 && n[i] != f2)
+			{
+				concerned.push_back(n[i]);
+			}
+		}
+	}
+	// a-->b-->c becomes a-->v-->c and v-->b-->c, same for the other side b-->a-->d.
+	news.push_back(f1);
+	news.push_back(this->triangles.size());
+	this->triangles.at(f1) = TopoTriangle(a, v_index, c);
+	this->triangles.push_back(TopoTriangle(v_index, b, c));
+	this->logChange(f1);
+	v.face(f1);
+	this->vertices.at(v_index).face(f1);
+	this->vertices.at(a).face(f1);
+	this->vertices.at(c).face(f1);
+	this->vertices.at(b).face(news.back());
+	if (f2 != -1)
+	{
+		IndexVertex_t d = this->triangles.at(f2).getVertexOutsideOf(edge);
+		news.push_back(f2);
+		news.push_back(this->triangles.size());
+		this->triangles.at(f2) = TopoTriangle(b, v_index, d);
+		this->triangles.push_back(TopoTriangle(v_index, a, d));
+		this->logChange(f2);
+		this->vertices.at(d).face(f2);
+	}
+	else // The edge was on the border, v goes between a and b.
+	{
+		for(auto it=this->borders.begin();it!=this->borders.end();++it)
+		{
+			auto next = (std::next(it) == this->borders.end()) ? this->borders.begin() : std::next(it);
+			if ((*it == a && *next == b) || (*it == b && *next == a))
+			{
+				this->borders.insert(std::next(it), v_index);
+				break;
+			}
+		}
+	}
+	this->manageNeighborInside(news, concerned);
+	uint32_t flips = this->incrementalDelaunay(concerned);
+	STATS_COUNT(INSERTIONS, 1);
+	STATS_COUNT(CAVITY_TRIANGLES, ((f2 != -1) ? 2 : 1) + flips);
 }
 IndexFace_t Mesh::findThisFace(IndexVertex_t a, IndexVertex_t b) const
 {
@@ -406,12 +841,11 @@ void Mesh::insertPointOutside(Vertex& ins, IndexVertex_t index)
 	std::vector<uint32_t>    usages(this->borders.size(), 0);
 	std::vector<IndexFace_t> newTriangles;
 	
+	const Vertex* coords = this->vertices.data();
 	for(auto it=this->borders.begin();it!=this->borders.end();++it)
 	{
-		Vertex        current = this->vertices.at(*it);
 		IndexVertex_t next_id = (std::next(it) == this->borders.end()) ? *this->borders.begin() : *std::next(it);
-		Vertex        next    = this->vertices.at(next_id);
-		if (isWellOriented(current, next, ins))
+		if (indexed::exactOrientation2D(coords, *it, next_id, ins) > 0)
 		{
 			if (iFirst == -1)
 				iFirst = (int32_t)i;
@@ -433,42 +867,111 @@ void Mesh::insertPointOutside(Vertex& ins, IndexVertex_t index)
 	}
 	this->updateBorder(index, usages, iFirst);
 	this->updateNeighborsOutside(newTriangles, index);
-	std::vector<IndexFace_t> concerned;
+	// The edges between two new triangles are checked too, the fan from the outside may not be Delaunay.
+	std::vector<IndexFace_t> concerned(newTriangles);
 	for(auto ind : newTriangles)
 	{
 		concerned.push_back(this->triangles.at(ind).getOppositeNeighborOf(index));
 	}
-	this->incrementalDelaunay(concerned);
+	// Outside, no triangle is replaced before the flips.
+	uint32_t flips = this->incrementalDelaunay(concerned);
+	STATS_COUNT(INSERTIONS, 1);
+	STATS_COUNT(CAVITY_TRIANGLES, flips);
 }
-void Mesh::insertVertexIntoTriangulation(Vertex& v, IndexVertex_t index)
+void Mesh::insertVertexIntoTriangulation(Vertex& v, IndexVertex_t index, IndexFace_t hint)
 {
+	++this->generation;
 	this->vertices.push_back(v);
-	if (enoughPointsForFirstTriangle(this->vertices.size()))
+	// The stored vertex is the one inserted, so the flips keep its face up to date.
+	Vertex& inserted = this->vertices.at(index);
+	if (this->triangles.empty())
 	{
-		createInitialTriangle();
+		if (this->vertices.size() >= 3)
+		{
+			this->createInitialTriangle();
+		}
 	}
-	else if (this->vertices.size() > 3)
+	else
 	{
-		IndexFace_t indexTriangle = isInOneTriangle(v);
-		if (indexTriangle != -1)
+		IndexFace_t indexTriangle = (hint != -1) ? this->walkToTriangle(inserted, hint) : isInOneTriangle(inserted);
+		if (indexTriangle == -1)
 		{
-			this->insertPointIntoTriangle(v, indexTriangle, index);
+			this->insertPointOutside(inserted, index);
 		}
 		else
 		{
-			this->insertPointOutside(v, index);
+			// A vertex on an edge splits this edge, splitting the triangle would leave a flat one.
+			const Vertex*        coords  = this->vertices.data();
+			const IndexVertex_t* ids     = this->triangles.at(indexTriangle).beginVertice();
+			uint32_t             aligned = 0;
+			uint32_t             edge    = 0;
+			for(uint32_t i=0;i<3;++i)
+			{
+				if (indexed::exactOrientation2D(coords, ids[(i+1)%3], ids[(i+2)%3], inserted) == 0)
+				{
+					++aligned;
+					edge = i;
+				}
+			}
+			if (aligned == 0)
+			{
+				this->insertPointIntoTriangle(inserted, indexTriangle, index);
+			}
+			else if (aligned == 1)
+			{
+				this->insertPointOnEdge(inserted, {ids[(edge+1)%3], ids[(edge+2)%3]}, index, indexTriangle);
+			}
+			else
+			{
+				mtl::log::warning("Mesh::insertVertexIntoTriangulation(), the vertex", index, "is already there, it stays out of the triangles");
+			}
+		}
+	}
+	v.face(inserted.face());
+}
+void Mesh::insertVerticesIntoTriangulation(const VertexContainer& batch)
+{
+	TRACE_SCOPE("insert batch");
+	TRACE_VALUE("vertices", batch.size());
+	this->vertices.reserve(this->vertices.size() + batch.size());
+	IndexFace_t hint = this->triangles.empty() ? -1 : 0;
+	for(auto i : spatial::hilbertOrder(batch))
+	{
+		Vertex      v     = batch.at(i);
+		IndexFace_t found = (hint != -1) ? this->walkToTriangle(v, hint) : -1;
+		if (found != -1 && this->isAlreadyInserted(v, found))
+		{
+			continue;
 		}
+		this->insertVertexIntoTriangulation(v, this->vertices.size(), (found != -1) ? found : hint);
+		hint = v.face();
 	}
 }
+bool Mesh::isAlreadyInserted(const Vertex& v, IndexFace_t face) const
+{
+	const IndexVertex_t* ids = this->triangles.at(face).beginVertice();
+	for(uint32_t i=0;i<3;++i)
+	{
+		const Vertex& corner = this->vertices.at(ids[i]);
+		const Vertex& next   = this->vertices.at(ids[(i+1)%3]);
+		if (squaredDistance2D(v, corner) <= DUPLICATE_EPSILON*squaredDistance2D(next, corner))
+		{
+			return true;
+		}
+	}
+	return false;
+}
 void Mesh::readVerticesFromPts(InputFile& file, uint32_t nb)
 {
-	uint32_t i = 0;
-	while(i < nb)
+	// Each location starts from the previous vertex, the files are often sorted.
+	IndexFace_t hint = -1;
+	for(uint32_t i=0;i<nb;++i)
 	{
 		std::vector<VertexType> vertex = file.readFromLine<VertexType>(2);
 		Vertex v(vertex.at(0), vertex.at(1), 0.0f);
-		insertVertexIntoTriangulation(v, i++);
-	}	
+		insertVertexIntoTriangulation(v, i, hint);
+		hint = v.face();
+	}
 }
 void Mesh::loadVertices(InputFile& file)
 {
@@ -478,6 +981,8 @@ void Mesh::loadVertices(InputFile& file)
 }
 void Mesh::load2DTriangulationFromPts(const std::string& fname)
 {
+	STATS_TIME(LOAD_PTS);
+	TRACE_SCOPE("load pts");
 	this->empty();
 	InputFile file(fname);
 	try
@@ -495,24 +1000,31 @@ void Mesh::load2DTriangulationFromPts(const std::string& fname)
 }
 void Mesh::flip(IndexFace_t f1, IndexFace_t f2)
 {
+	++this->generation;
 	TopoTriangle&            old_f1    = this->triangles.at(f1);
 	TopoTriangle&            old_f2    = this->triangles.at(f2);
 	IndexVertex_t            unique_f1 = old_f1.getOppositeVertexOf(f2);
 	IndexVertex_t            unique_f2 = old_f2.getOppositeVertexOf(f1);
-	std::vector<IndexFace_t> concerned = collectNeighbors(old_f1, old_f2);
-
-	Vertex& changed_f2 = this->vertices.at(old_f2.getAdjVertexTrigo(unique_f2));
-	if (changed_f2.face() == f1)
+	TopoTriangle::Edge       common    = old_f1.getCommonEdge(f2);
+	if (this->isConstrained(common.a, common.b))
 	{
-		changed_f2.face(f2);
-	}
-	Vertex& changed_f1 = this->vertices.at(old_f1.getAdjVertexTrigo(unique_f1));
-	if (changed_f1.face() == f2)
-	{
-		changed_f1.face(f1);
+		mtl::log::warning("Mesh::flip(), refusing to flip the constrained edge", common.a, common.b);
+		return;
 	}
+	std::vector<IndexFace_t> concerned = collectNeighbors(old_f1, old_f2);
+	// A vertex of degree 3 makes the same triangle appear twice, it would be linked to itself.
+	std::sort(concerned.begin(), concerned.end());
+	concerned.erase(std::unique(concerned.begin(), concerned.end()), concerned.end());
+
+	// Each vertex of the pair gets the new triangle it stays in, none keeps a face it left.
+	this->vertices.at(unique_f1).face(f1);
+	this->vertices.at(old_f1.getAdjVertexTrigo(unique_f1)).face(f1);
+	this->vertices.at(unique_f2).face(f2);
+	this->vertices.at(old_f2.getAdjVertexTrigo(unique_f2)).face(f2);
 	this->triangles.at(f1) = TopoTriangle(unique_f1, old_f1.getAdjVertexTrigo(unique_f1), unique_f2);
 	this->triangles.at(f2) = TopoTriangle(unique_f2, old_f2.getAdjVertexTrigo(unique_f2), unique_f1);
+	this->logChange(f1);
+	this->logChange(f2);
 	
 	neighbor::MapEdges map;
 	for(uint32_t i=0;i<concerned.size();++i)
@@ -533,74 +1045,304 @@ namespace
 {
 	/**
 	 * @brief Detects edges without any voronoi centers as extremity.
-	 * @param mesh The mesh where it gonna insert the edges.
-	 * @param t    The triangle to parse.
+	 * @param[in]  limit The index of the first voronoi center.
+	 * @param[in]  t     The triangle to parse.
+	 * @param[out] curve The container where it gonna insert the edges.
 	 */
-	void addEdgesOf(Mesh& mesh, TopoTriangle& t)
+	void addEdgesOf(IndexVertex_t limit, const TopoTriangle& t, Curve_c& curve)
 	{
 		const IndexVertex_t* begin = t.beginVertice();
-		bool p0 = begin[0] < mesh.getIndexBeforeVoronoi();
-		bool p1 = begin[1] < mesh.getIndexBeforeVoronoi();
-		bool p2 = begin[2] < mesh.getIndexBeforeVoronoi();
+		bool p0 = begin[0] < limit;
+		bool p1 = begin[1] < limit;
+		bool p2 = begin[2] < limit;
 		if (p0 && p1)
 		{
 			TopoTriangle::Edge edge = {begin[0], begin[1]};
-			mesh.getCurve().push_back(edge);
+			curve.push_back(edge);
 		}
 		if (p0 && p2)
 		{
 			TopoTriangle::Edge edge = {begin[0], begin[2]};
-			mesh.getCurve().push_back(edge);
+			curve.push_back(edge);
 		}
 		if (p2 && p1)
 		{
 			TopoTriangle::Edge edge = {begin[2], begin[1]};
-			mesh.getCurve().push_back(edge);
+			curve.push_back(edge);
+		}
+	}
+	/**
+	 * @brief Compute the centers of the surrounding circles of n triangles in 2D, with SoA buffers.
+	 * @param[in]  n      The number of triangles.
+	 * @param[in]  coords The 6 coordinates arrays ax, ay, bx, by, cx, cy.
+	 * @param[out] ox     The x coordinates of the centers.
+	 * @param[out] oy     The y coordinates of the centers.
+	 */
+	void centersSurroundingCircles2D(int32_t n, const VertexType* const coords[6], VertexType* ox, VertexType* oy)
+	{
+		const VertexType* ax = coords[0];
+		const VertexType* ay = coords[1];
+		const VertexType* bx = coords[2];
+		const VertexType* by = coords[3];
+		const VertexType* cx = coords[4];
+		const VertexType* cy = coords[5];
+		#pragma omp parallel for simd schedule(static)
+		for(int32_t i=0;i<n;++i)
+		{
+			VertexType abx = bx[i] - ax[i];
+			VertexType aby = by[i] - ay[i];
+			VertexType acx = cx[i] - ax[i];
+			VertexType acy = cy[i] - ay[i];
+			VertexType ab2 = abx*abx + aby*aby;
+			VertexType ac2 = acx*acx + acy*acy;
+			VertexType d   = 0.5/(abx*acy - aby*acx);
+			ox[i] = ax[i] + (acy*ab2 - aby*ac2)*d;
+			oy[i] = ay[i] + (abx*ac2 - acx*ab2)*d;
 		}
 	}
 }
 
 void Mesh::Crust(void)
 {
+	STATS_TIME(CRUST);
+	TRACE_SCOPE("crust");
 	mtl::log::info("Processing Crust algorithm");
-	std::vector<Vertex> vertexes;
-	vertexes.reserve(this->triangles.size());
+	const int32_t nb = this->triangles.size();
 	this->indexBeforeVoronoi = this->vertices.size();
-	for(auto it=this->beginT();it!=this->endT();++it)
+	VertexContainer vertexes;
 	{
-		Vertex tmp = centerSurroundingCircle2D(this->buildPtriangle3D(*it));
-		vertexes.push_back(tmp);
+		TRACE_SCOPE("crust circumcenters");
+		// Gather the coordinates as SoA buffers, so the centers are computed in a single vectorized pass.
+		std::vector<VertexType> buffers(8*nb);
+		VertexType* coords[6];
+		for(uint32_t k=0;k<6;++k)
+		{
+			coords[k] = buffers.data() + k*nb;
+		}
+		#pragma omp parallel
+		{
+			TRACE_SCOPE("crust gather worker");
+			#pragma omp for schedule(static)
+			for(int32_t i=0;i<nb;++i)
+			{
+				const IndexVertex_t* ids = this->triangles[i].beginVertice();
+				for(uint32_t k=0;k<3;++k)
+				{
+					coords[2*k][i]   = this->vertices[ids[k]].x();
+					coords[2*k+1][i] = this->vertices[ids[k]].y();
+				}
+			}
+		}
+		VertexType* ox = buffers.data() + 6*nb;
+		VertexType* oy = buffers.data() + 7*nb;
+		centersSurroundingCircles2D(nb, coords, ox, oy);
+		vertexes.reserve(nb);
+		for(int32_t i=0;i<nb;++i)
+		{
+			vertexes.push_back(Vertex(ox[i], oy[i], 0.0));
+		}
 	}
 	mtl::log::info("---- voronois [OK]");
-	for(auto pt : vertexes)
 	{
-		pt.z(0.0);
-		this->insertVertexIntoTriangulation(pt, this->vertices.size());
+		TRACE_SCOPE("crust insertions");
+		this->insertVerticesIntoTriangulation(vertexes);
 	}
 	mtl::log::info("---- insertions [OK]");
+	TRACE_SCOPE("crust edges");
+	// Every thread fills its own buffer, merged in order so the result is the same as a sequential run.
+	const int32_t            nbTriangles = this->triangles.size();
+	const IndexVertex_t      limit       = this->indexBeforeVoronoi;
+	std::vector<Curve_c>     curves(parallel::maxThreads());
+	#pragma omp parallel
+	{
+		TRACE_SCOPE("crust edges worker");
+		#pragma omp for schedule(static)
+		for(int32_t i=0;i<nbTriangles;++i)
+		{
+			addEdgesOf(limit, this->triangles[i], curves[parallel::threadIndex()]);
+		}
+	}
 	this->curve.clear();
-	for(auto it=this->beginT();it!=this->endT();++it)
+	for(Curve_c& part : curves)
 	{
-		TopoTriangle t = *it;
-		addEdgesOf(*this, t);
+		this->curve.splice(this->curve.end(), part);
 	}
 	mtl::log::info("Crust done");
 }
+
+namespace
+{
+	/**
+	 * @brief Find the closest vertex to \b p among \b candidates.
+	 * @param[in] vertices   Every vertices of the mesh.
+	 * @param[in] p          The vertex to look around.
+	 * @param[in] candidates The range of candidates, [first, second[.
+	 * @param[in] away       If not -1, only candidates which makes an angle wider than 90 degrees
+	 *                       with p --> away are considered.
+	 * @return The closest candidate, -1 if there is none.
+	 */
+	IndexVertex_t closestNeighbor(const VertexContainer& vertices, IndexVertex_t p,
+	                              std::pair<const IndexVertex_t*, const IndexVertex_t*> candidates, IndexVertex_t away)
+	{
+		const Vertex& vp       = vertices[p];
+		IndexVertex_t best     = -1;
+		VertexType    distance = std::numeric_limits<VertexType>::max();
+		for(const IndexVertex_t* it=candidates.first;it!=candidates.second;++it)
+		{
+			const Vertex& vq = vertices[*it];
+			if (away != -1)
+			{
+				const Vertex& va = vertices[away];
+				if ((vq.x()-vp.x())*(va.x()-vp.x()) + (vq.y()-vp.y())*(va.y()-vp.y()) >= 0.0)
+				{
+					continue;
+				}
+			}
+			VertexType current = squaredDistance2D(vp, vq);
+			if (current < distance)
+			{
+				distance = current;
+				best     = *it;
+			}
+		}
+		return best;
+	}
+}
+
+void Mesh::NNCrust(void)
+{
+	STATS_TIME(NN_CRUST);
+	TRACE_SCOPE("nn-crust");
+	mtl::log::info("Processing NN-Crust algorithm");
+	const int32_t nb = this->vertices.size();
+	this->indexBeforeVoronoi = nb;
+	// The Delaunay neighbors of each vertex, stored contiguously (an edge may appear twice).
+	std::vector<uint32_t> offsets(nb+1, 0);
+	for(const TopoTriangle& t : this->triangles)
+	{
+		std::for_each(t.beginVertice(), t.endVertice(), [&offsets](IndexVertex_t id){offsets[id+1] += 2;});
+	}
+	std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+	std::vector<IndexVertex_t> adjacents(offsets.back());
+	std::vector<uint32_t>      filled(offsets.begin(), offsets.end()-1);
+	for(const TopoTriangle& t : this->triangles)
+	{
+		const IndexVertex_t* ids = t.beginVertice();
+		for(uint32_t i=0;i<3;++i)
+		{
+			adjacents[filled[ids[i]]++] = ids[(i+1)%3];
+			adjacents[filled[ids[i]]++] = ids[(i+2)%3];
+		}
+	}
+	// Each sample is linked to its nearest neighbor, and to the nearest one on its other side.
+	std::vector<IndexVertex_t> nearest(nb, -1);
+	std::vector<IndexVertex_t> halfNearest(nb, -1);
+	#pragma omp parallel for schedule(dynamic, 256)
+	for(int32_t p=0;p<nb;++p)
+	{
+		auto range     = std::make_pair(adjacents.data()+offsets[p], adjacents.data()+offsets[p+1]);
+		nearest[p]     = closestNeighbor(this->vertices, p, range, -1);
+		halfNearest[p] = (nearest[p] != -1) ? closestNeighbor(this->vertices, p, range, nearest[p]) : -1;
+	}
+	this->curve.clear();
+	for(int32_t p=0;p<nb;++p)
+	{
+		for(IndexVertex_t q : {nearest[p], halfNearest[p]})
+		{
+			// An edge chosen by both extremities is only kept once.
+			if (q != -1 && (p < q || (nearest[q] != p && halfNearest[q] != p)))
+			{
+				TopoTriangle::Edge edge = {p, q};
+				this->curve.push_back(edge);
+			}
+		}
+	}
+	mtl::log::info("NN-Crust done");
+}
 // ############################################################################################################
 
 // ## TP PARTIE V #############################################################################################
+namespace
+{
+	/**
+	 * @brief Get every triangle around \b v, turning both ways from its face, so a vertex of the border
+	 * gets all of them too.
+	 * @return The triangles, none if \b v has no face.
+	 */
+	std::vector<IndexFace_t> trianglesAround(const VertexContainer& vertices, const TriangleContainer& triangles, IndexVertex_t v)
+	{
+		std::vector<IndexFace_t> around;
+		const IndexFace_t        start   = vertices.at(v).face();
+		IndexFace_t              current = start;
+		while(current != -1)
+		{
+			around.push_back(current);
+			current = triangles.at(current).getAdjTriangleTrigo(v);
+			if (current == start)
+			{
+				return around;
+			}
+		}
+		// The border stopped the turn, the other side starts from the face again.
+		current = (start != -1) ? triangles.at(start).getOppositeNeighborOf(triangles.at(start).getAdjVertexClock(v)) : -1;
+		while(current != -1)
+		{
+			around.push_back(current);
+			current = triangles.at(current).getOppositeNeighborOf(triangles.at(current).getAdjVertexClock(v));
+		}
+		return around;
+	}
+	//! @brief Get a triangle with the edge \b edge, found around \b edge.a, -1 if there is none.
+	IndexFace_t faceWithEdge(const VertexContainer& vertices, const TriangleContainer& triangles, const TopoTriangle::Edge& edge)
+	{
+		for(IndexFace_t f : trianglesAround(vertices, triangles, edge.a))
+		{
+			if (triangles[f].findVertexIndex(edge.b) != -1)
+			{
+				return f;
+			}
+		}
+		return -1;
+	}
+	/**
+	 * @brief Check if \b segment is missing from the triangulation, or if the vertex in front of it, on
+	 * either side, is inside its diametral circle. A segment with a vertex left out is never encroached.
+	 */
+	bool isEncroachedOrMissing(const VertexContainer& vertices, const TriangleContainer& triangles, const TopoTriangle::Edge& segment)
+	{
+		if (vertices.at(segment.a).face() == -1 || vertices.at(segment.b).face() == -1)
+		{
+			return false;
+		}
+		bool found = false;
+		for(IndexFace_t f : trianglesAround(vertices, triangles, segment.a))
+		{
+			if (triangles[f].findVertexIndex(segment.b) != -1)
+			{
+				found = true;
+				IndexVertex_t opposite = triangles[f].getVertexOutsideOf(segment);
+				if (indexed::isInCircleOfDiametral(vertices.data(), segment.a, segment.b, vertices[opposite]))
+				{
+					return true;
+				}
+			}
+		}
+		return !found;
+	}
+}
 Vertex Mesh::centerOfEdge(const TopoTriangle::Edge& edge)
 {
 	const Vertex& v1 = this->vertices.at(edge.a);
 	const Vertex& v2 = this->vertices.at(edge.b);
-	return (v2 - v1)/2.0;
+	return (v1 + v2)/2.0;
 }
 std::list<IndexFace_t> Mesh::collectPoorQualityTriangles(double threshold)
 {
 	std::list<IndexFace_t> poor;
+	quality::Report        report = this->computeQuality();
 	for(int32_t i=0;i<(int32_t)this->triangles.size();++i)
 	{
-		if (isPoorQuality(this->buildPtriangle3D(this->triangles.at(i)), threshold))
+		if (report.minAngle[i] < threshold)
 		{
 			poor.push_back(i);
 		}
@@ -612,7 +1354,7 @@ Curve_c Mesh::collectEncroacheds(Curve_c& notEncroached)
 	Curve_c result;
 	for(auto segment : this->constraints)
 	{
-		if (this->findThisFace(segment.a, segment.b) == -1)
+		if (isEncroachedOrMissing(this->vertices, this->triangles, segment))
 		{
 			result.push_back(segment);
 		}
@@ -625,11 +1367,10 @@ Curve_c Mesh::collectEncroacheds(Curve_c& notEncroached)
 }
 bool Mesh::encroachSegment(const Vertex& v, Curve_c& segments, TopoTriangle::Edge& edge)
 {
+	const Vertex* coords = this->vertices.data();
 	for(auto it=segments.begin();it!=segments.end();++it)
 	{
-		const Vertex& a = this->vertices.at(it->a);
-		const Vertex& b = this->vertices.at(it->b);
-		if (isInCircleOfDiametral(a, b, v))
+		if (indexed::isInCircleOfDiametral(coords, it->a, it->b, v))
 		{
 			edge.a = it->a;
 			edge.b = it->b;
@@ -639,6 +1380,177 @@ bool Mesh::encroachSegment(const Vertex& v, Curve_c& segments, TopoTriangle::Edg
 	}
 	return false;
 }
+bool Mesh::isConstrained(IndexVertex_t a, IndexVertex_t b) const
+{
+	if (this->constrained.empty())
+	{
+		return false;
+	}
+	return this->constrained.find(TopoTriangle::Edge({a, b})) != this->constrained.end();
+}
+IndexFace_t Mesh::findCrossedFace(IndexVertex_t a, IndexVertex_t b, IndexVertex_t& right, IndexVertex_t& left) const
+{
+	const Vertex* coords = this->vertices.data();
+	const Vertex& va     = this->vertices.at(a);
+	const Vertex& vb     = this->vertices.at(b);
+	// Only the triangles around a can be crossed first, they're found from its face.
+	for(IndexFace_t i : trianglesAround(this->vertices, this->triangles, a))
+	{
+		const TopoTriangle& t  = this->triangles.at(i);
+		IndexVertex_t       p  = t.getAdjVertexTrigo(a);
+		IndexVertex_t       q  = t.getAdjVertexTrigo(p);
+		int32_t             op = indexed::exactOrientation2D(coords, a, b, this->vertices.at(p));
+		int32_t             oq = indexed::exactOrientation2D(coords, a, b, this->vertices.at(q));
+		for(IndexVertex_t aligned : {(op == 0) ? p : -1, (oq == 0) ? q : -1})
+		{
+			double along = (aligned != -1) ? (this->vertices.at(aligned) - va).dot(vb - va) : 0.0;
+			if (along > 0.0 && along < (vb - va).dot(vb - va))
+			{
+				right = left = aligned;
+				return -1;
+			}
+		}
+		if (op < 0 && oq > 0)
+		{
+			right = p;
+			left  = q;
+			return i;
+		}
+	}
+	right = left = -1;
+	return -1;
+}
+void Mesh::triangulatePseudoPolygon(const std::vector<IndexVertex_t>& polygon, IndexVertex_t a, IndexVertex_t b, TriangleContainer& out) const
+{
+	if (polygon.empty())
+	{
+		return;
+	}
+	const Vertex* coords = this->vertices.data();
+	uint32_t      ic     = 0;
+	for(uint32_t i=1;i<polygon.size();++i)
+	{
+		if (indexed::isInSurroundingCircle(coords, a, b, polygon[ic], polygon[i]))
+		{
+			ic = i;
+		}
+	}
+	IndexVertex_t c = polygon.at(ic);
+	this->triangulatePseudoPolygon(std::vector<IndexVertex_t>(polygon.begin(), polygon.begin()+ic), a, c, out);
+	this->triangulatePseudoPolygon(std::vector<IndexVertex_t>(polygon.begin()+ic+1, polygon.end()), c, b, out);
+	out.push_back(TopoTriangle(a, b, c));
+}
+void Mesh::insertConstraint(const TopoTriangle::Edge& segment)
+{
+	++this->generation;
+	if (segment.a == segment.b)
+	{
+		return;
+	}
+	if (this->findThisFace(segment.a, segment.b) != -1)
+	{
+		this->constrained.insert(TopoTriangle::Edge(segment));
+		return;
+	}
+	IndexVertex_t right   = -1;
+	IndexVertex_t left    = -1;
+	IndexFace_t   current = this->findCrossedFace(segment.a, segment.b, right, left);
+	if (current == -1)
+	{
+		if (right == -1)
+		{
+			mtl::log::error("Mesh::insertConstraint(), cannot find where", segment.a, segment.b, "starts");
+			return;
+		}
+		// A vertex linked to a lies on the segment.
+		this->constrained.insert(TopoTriangle::Edge({segment.a, right}));
+		this->insertConstraint({right, segment.b});
+		return;
+	}
+	// Walk along the segment, collecting the crossed triangles and the 2 pseudo-polygons.
+	IndexVertex_t              end = segment.b;
+	std::vector<IndexFace_t>   crossed(1, current);
+	std::vector<IndexVertex_t> upper(1, left);
+	std::vector<IndexVertex_t> lower(1, right);
+	while(true)
+	{
+		const TopoTriangle& t    = this->triangles.at(current);
+		IndexFace_t         next = t.getOppositeNeighborOf(t.getVertexOutsideOf({right, left}));
+		if (next == -1)
+		{
+			mtl::log::error("Mesh::insertConstraint(), the segment", segment.a, segment.b, "goes outside");
+			return;
+		}
+		crossed.push_back(next);
+		IndexVertex_t s = this->triangles.at(next).getVertexOutsideOf({right, left});
+		if (s == end)
+		{
+			break;
+		}
+		double side = indexed::orientation2D(this->vertices.data(), segment.a, segment.b, s);
+		if (side > 0.0)
+		{
+			upper.push_back(s);
+			left = s;
+		}
+		else if (side < 0.0)
+		{
+			lower.push_back(s);
+			right = s;
+		}
+		else // s lies on the segment, the rest is done after.
+		{
+			end = s;
+			break;
+		}
+		current = next;
+	}
+	// Retriangulate each side, reusing the indexes of the crossed triangles.
+	TriangleContainer created;
+	created.reserve(crossed.size());
+	this->triangulatePseudoPolygon(upper, segment.a, end, created);
+	std::reverse(lower.begin(), lower.end());
+	this->triangulatePseudoPolygon(lower, end, segment.a, created);
+	std::vector<IndexFace_t> concerned;
+	for(auto index : crossed)
+	{
+		const IndexFace_t* n = this->triangles.at(index).getNeighbors();
+		for(uint32_t i=0;i<3;++i)
+		{
+			if (n[i] != -1 && std::find(crossed.begin(), crossed.end(), n[i]) == crossed.end())
+			{
+				concerned.push_back(n[i]);
+			}
+		}
+	}
+	for(uint32_t i=0;i<crossed.size();++i)
+	{
+		this->triangles.at(crossed.at(i)) = std::move(created.at(i));
+		this->logChange(crossed.at(i));
+		for(auto it=this->triangles.at(crossed.at(i)).beginVertice();it!=this->triangles.at(crossed.at(i)).endVertice();++it)
+		{
+			this->vertices.at(*it).face(crossed.at(i));
+		}
+		concerned.push_back(crossed.at(i));
+	}
+	std::sort(concerned.begin(), concerned.end());
+	concerned.erase(std::unique(concerned.begin(), concerned.end()), concerned.end());
+	neighbor::MapEdges map;
+	for(auto index : concerned)
+	{
+		TopoTriangle& triangle = this->triangles.at(index);
+		for(uint32_t j=0;j<3;++j)
+		{
+			TopoTriangle::Edge edge = {*(triangle.beginVertice()+j), *(triangle.beginVertice()+(j+1)%3)};
+			neighbor::insert(map, edge, index, this->triangles);
+		}
+	}
+	this->constrained.insert(TopoTriangle::Edge({segment.a, end}));
+	if (end != segment.b)
+	{
+		this->insertConstraint({end, segment.b});
+	}
+}
 /*
 function Ruppert(points,segments,threshold):
     T := DelaunayTriangulation(points);
@@ -660,6 +1572,8 @@ end Ruppert.
 */
 void Mesh::refineDelaunay(double threshold)
 {
+	STATS_TIME(REFINE);
+	TRACE_SCOPE("ruppert");
 	mtl::log::info("Starting Ruppert's algorithm");
 	mtl::log::info("Collecting poor quality triangles", mtl::log::hold_on());
 	std::list<IndexFace_t> Qtriangles = this->collectPoorQualityTriangles(threshold);
@@ -669,17 +1583,65 @@ void Mesh::refineDelaunay(double threshold)
 	Curve_c Qencroach = this->collectEncroacheds(notEncroached);
 	mtl::log::info("(", Qencroach.size(), "found )");
 	
+	// Every triangle an insertion builds has the new vertex as a corner : only these can be new poor ones.
+	auto collectAround = [&](IndexVertex_t v)
+	{
+		for(IndexFace_t f : trianglesAround(this->vertices, this->triangles, v))
+		{
+			if (isPoorQuality(this->buildPtriangle3D(this->triangles[f]), threshold))
+			{
+				Qtriangles.push_back(f);
+			}
+		}
+	};
 	mtl::log::info("Starting main loop ...", mtl::log::hold_on());
 	while(!Qtriangles.empty() || !Qencroach.empty())
 	{
+		TRACE_SCOPE("ruppert iteration");
+		TRACE_VALUE("poor triangles", Qtriangles.size());
+		TRACE_VALUE("encroached segments", Qencroach.size());
 		if (!Qencroach.empty())
 		{
-			TopoTriangle::Edge edge = Qencroach.front();
-			Vertex v                = this->centerOfEdge(edge);
-			this->insertVertexIntoTriangulation(v, this->vertices.size());
+			TopoTriangle::Edge edge     = Qencroach.front();
+			Vertex             v        = this->centerOfEdge(edge);
+			IndexVertex_t      middle   = this->vertices.size();
+			bool               wasFixed = this->constrained.erase(TopoTriangle::Edge(edge)) != 0;
+			IndexFace_t        face     = faceWithEdge(this->vertices, this->triangles, edge);
+			if (face != -1)
+			{
+				this->vertices.push_back(v);
+				this->insertPointOnEdge(v, edge, middle, face);
+			}
+			else
+			{
+				this->insertVertexIntoTriangulation(v, middle, this->vertices.at(edge.a).face());
+			}
 			Qencroach.pop_front();
+			collectAround(middle);
+			for(const TopoTriangle::Edge& half : {TopoTriangle::Edge{edge.a, middle}, TopoTriangle::Edge{middle, edge.b}})
+			{
+				if (wasFixed)
+				{
+					// The sub-segments take the place of the splitted one.
+					this->insertConstraint(half);
+				}
+				// A vertex already there may encroach a sub-segment, and a missing one is split again.
+				if (isEncroachedOrMissing(this->vertices, this->triangles, half))
+				{
+					Qencroach.push_back(half);
+				}
+				else
+				{
+					notEncroached.push_back(half);
+				}
+			}
 		}
-		else if (!Qtriangles.empty())
+		else if (!isPoorQuality(this->buildPtriangle3D(this->triangles.at(Qtriangles.front())), threshold))
+		{
+			// The triangle was rewritten since it was queued.
+			Qtriangles.pop_front();
+		}
+		else
 		{
 			TopoTriangle& triangle = this->triangles.at(Qtriangles.front());
 			Vertex        voronoi  = centerSurroundingCircle2D(this->buildPtriangle3D(triangle));
@@ -690,27 +1652,48 @@ void Mesh::refineDelaunay(double threshold)
 			}
 			else
 			{
-				this->insertVertexIntoTriangulation(voronoi, this->vertices.size());
+				IndexVertex_t inserted = this->vertices.size();
+				this->insertVertexIntoTriangulation(voronoi, inserted, Qtriangles.front());
 				Qtriangles.pop_front();
+				collectAround(inserted);
 			}
 		}
 	}
 	mtl::log::info("Done");
+	mtl::log::info("Smallest angle :", mtl::log::defer([this](){return this->computeQuality().smallestAngle;}), "degrees");
 }
-void Mesh::loadConstraints(const std::string& fname)
+void Mesh::loadConstraints(const std::string& fname, ConstraintMode_e mode)
 {
 	this->empty();
 	InputFile file(fname);
 	try
 	{
 		mtl::log::info("Reading", fname, "for a refined Delaunay");
-		this->loadVertices(file);
-		uint32_t i = 0;
-		while(i++ < this->vertices.size())
 		{
-			std::vector<IndexVertex_t> vector = file.readFromLine<IndexVertex_t>(2);
-			TopoTriangle::Edge edge = {vector.at(0), vector.at(1)};
-			this->constraints.push_back(edge);
+			TRACE_SCOPE("read constraints");
+			this->loadVertices(file);
+			uint32_t           i = 0;
+			ConstrainedEdges_c read; // Both ways, to keep the first of the repeated segments.
+			while(i++ < this->vertices.size())
+			{
+				std::vector<IndexVertex_t> vector = file.readFromLine<IndexVertex_t>(2);
+				TopoTriangle::Edge edge = {vector.at(0), vector.at(1)};
+				if (read.insert(edge).second)
+				{
+					this->constraints.push_back(edge);
+				}
+			}
+		}
+		if (mode == INSERT_SEGMENTS)
+		{
+			STATS_TIME(CONSTRAINTS);
+			TRACE_SCOPE("insert constraints");
+			mtl::log::info("Inserting", this->constraints.size(), "constraint segments", mtl::log::hold_on());
+			for(auto segment : this->constraints)
+			{
+				this->insertConstraint(segment);
+			}
+			mtl::log::info("Done");
 		}
 		this->refineDelaunay(22.0);
 	}
@@ -125,6 +125,12 @@ TopoTriangle& TopoTriangle::removeNeighbor(IndexFace_t i)
 	return *this;
 }
 
+TopoTriangle& TopoTriangle::replaceNeighbor(IndexFace_t old, IndexFace_t neighbor)
+{
+	std::replace(this->neighbors, this->neighbors+3, old, neighbor);
+	return *this;
+}
+
 const IndexFace_t* TopoTriangle::getNeighbors(void) const
 {
 	return this->neighbors;
@@ -1,5 +1,4 @@
 #include <cstdint>
-#include <iostream>
 #include <exception>
 #include <list>
 #include <vector>
@@ -7,6 +6,7 @@
 #include "neighbors.hpp"
 #include "file_io.hpp"
 #include "OffLoader.hpp"
+#include "trace.hpp"
 #include "logs.hpp"
 
 
@@ -42,6 +42,8 @@ namespace
 	 */
 	void readOffVertices(InputFile& file, std::vector<Vertex>& v, uint32_t nb)
 	{
+		TRACE_SCOPE("parse off vertices");
+		TRACE_VALUE("vertices", nb);
 		uint32_t vertexIndex = 0;
 		while(vertexIndex < nb)
 		{
@@ -61,6 +63,8 @@ namespace
 	 */
 	void readOffTriangles(InputFile& file, std::vector<Vertex>& v, std::vector<TopoTriangle>& t, uint32_t nb)
 	{
+		TRACE_SCOPE("parse off triangles and adjacency");
+		TRACE_VALUE("triangles", nb);
 		neighbor::MapEdges         map;
 		uint32_t                   faceIndex = 0;
 		std::vector<IndexVertex_t> indexes(3, 0);
@@ -71,9 +75,9 @@ namespace
 			t.push_back(indexes);
 			for(uint32_t i=0;i<indexes.size();++i)
 			{
-				if (v.at(i).face() == -1)
+				if (v.at(indexes.at(i)).face() == -1)
 				{
-					v.at(i).face(faceIndex);
+					v.at(indexes.at(i)).face(faceIndex);
 				}
 				TopoTriangle::Edge key = {indexes.at(i), indexes.at((i+1 == indexes.size()) ? 0 : i+1)};
 				neighbor::insert(map, key, faceIndex, t);
@@ -86,17 +90,16 @@ namespace
 
 void OffLoader::load(VertexContainer& vertices, TriangleContainer& triangles, const std::string& fname)
 {
-	InputFile file(fname);
 	try
 	{
+		InputFile  file(fname);
 		Header_vec header = readOffHeader(file, vertices, triangles);
 		readOffVertices (file, vertices, header.at(VERTEX_NUMBER_INDEX));
 		readOffTriangles(file, vertices, triangles, header.at(FACE_NUMBER_INDEX));
 	}
-	catch(std::string& eof)
+	catch(std::string& error)
 	{
-		std::cerr << eof << std::endl;
-		throw std::runtime_error("Error while parsing the OFF file");
+		throw std::runtime_error("Error while parsing " + fname + " : " + error);
 	}
 	mtl::log::info("Succesfully load", fname);
 }
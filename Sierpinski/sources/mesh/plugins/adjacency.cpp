@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <numeric>
+
+#include "adjacency.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	/**
+	 * @brief Get the position of \p v inside \p t.
+	 * @return A value between [0, 2], 3 if \p v isn't a vertex of \p t.
+	 */
+	inline uint32_t localIndex(const TopoTriangle& t, IndexVertex_t v)
+	{
+		return std::find(t.beginVertice(), t.endVertice(), v) - t.beginVertice();
+	}
+	/**
+	 * @brief Get the triangle after (\p step == 1) or before (\p step == 2) \p f around \p v, counter-clockwise.
+	 * @return -1 if there is none (border), -2 if the neighbors are broken.
+	 */
+	inline IndexFace_t around(const TriangleContainer& triangles, IndexFace_t f, IndexVertex_t v, uint32_t step)
+	{
+		uint32_t local = localIndex(triangles[f], v);
+		if (local == 3)
+		{
+			return -2;
+		}
+		IndexFace_t next = triangles[f].getNeighbors()[(local+step)%3];
+		return (next < -1 || next >= static_cast<IndexFace_t>(triangles.size())) ? -2 : next;
+	}
+
+	/**
+	 * @brief Sort the \p size triangles of \p fan around \p v, counter-clockwise, starting from the border one.
+	 * @param[in,out] fan     The triangles around \p v, left as they are if they can't be sorted.
+	 * @param[in,out] ordered A buffer for the sorted triangles.
+	 * @return INTERIOR, BORDER or NON_MANIFOLD.
+	 */
+	adjacency::Kind_e sortFan(const TriangleContainer& triangles, IndexVertex_t v, IndexFace_t* fan, uint32_t size, std::vector<IndexFace_t>& ordered)
+	{
+		// Backward to the border first, if there is one : at most size steps.
+		IndexFace_t start  = fan[0];
+		bool        border = false;
+		uint32_t    steps  = 0;
+		for(IndexFace_t f=fan[0];steps<size;++steps)
+		{
+			IndexFace_t previous = around(triangles, f, v, 2);
+			if (previous == -2)
+			{
+				return adjacency::NON_MANIFOLD;
+			}
+			if (previous == -1)
+			{
+				start  = f;
+				border = true;
+				break;
+			}
+			if (previous == fan[0])
+			{
+				break;
+			}
+			f = previous;
+		}
+		if (steps == size)
+		{
+			return adjacency::NON_MANIFOLD;
+		}
+		ordered.clear();
+		IndexFace_t f = start;
+		do
+		{
+			ordered.push_back(f);
+			f = around(triangles, f, v, 1);
+		} while(f >= 0 && f != start && ordered.size() <= size);
+		// Every triangle of a single fan is met once, else some are in another fan.
+		if (ordered.size() != size || f == -2 || (f == -1) != border)
+		{
+			return adjacency::NON_MANIFOLD;
+		}
+		std::copy(ordered.begin(), ordered.end(), fan);
+		return border ? adjacency::BORDER : adjacency::INTERIOR;
+	}
+
+	/**
+	 * @brief Collect the vertices linked to \p v by the triangles of \p fan, sorted by index.
+	 */
+	void scatteredRing(const TriangleContainer& triangles, IndexVertex_t v, const IndexFace_t* fan, uint32_t size, std::vector<IndexVertex_t>& ring)
+	{
+		ring.clear();
+		for(uint32_t i=0;i<size;++i)
+		{
+			for(auto it=triangles[fan[i]].beginVertice();it!=triangles[fan[i]].endVertice();++it)
+			{
+				if (*it != v)
+				{
+					ring.push_back(*it);
+				}
+			}
+		}
+		std::sort(ring.begin(), ring.end());
+		ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+	}
+}
+
+adjacency::Vertices adjacency::build(const VertexContainer& vertices, const TriangleContainer& triangles)
+{
+	Vertices adjacency;
+	const int32_t nbT = triangles.size();
+	const int32_t nbV = vertices.size();
+	// Every triangle into the bucket of its vertices, by increasing index.
+	adjacency.triangleOffsets.assign(nbV+1, 0);
+	for(int32_t f=0;f<nbT;++f)
+	{
+		for(auto it=triangles[f].beginVertice();it!=triangles[f].endVertice();++it)
+		{
+			++adjacency.triangleOffsets[*it+1];
+		}
+	}
+	std::partial_sum(adjacency.triangleOffsets.begin(), adjacency.triangleOffsets.end(), adjacency.triangleOffsets.begin());
+	adjacency.triangles.resize(adjacency.triangleOffsets.back());
+	std::vector<uint32_t> cursors(adjacency.triangleOffsets.begin(), adjacency.triangleOffsets.end()-1);
+	for(int32_t f=0;f<nbT;++f)
+	{
+		for(auto it=triangles[f].beginVertice();it!=triangles[f].endVertice();++it)
+		{
+			adjacency.triangles[cursors[*it]++] = f;
+		}
+	}
+	// Then each bucket is sorted around its vertex, which gives the size of its one-ring.
+	adjacency.kinds.assign(nbV, ISOLATED);
+	adjacency.vertexOffsets.assign(nbV+1, 0);
+	#pragma omp parallel
+	{
+		std::vector<IndexFace_t>   ordered;
+		std::vector<IndexVertex_t> ring;
+		#pragma omp for schedule(dynamic, 256)
+		for(int32_t v=0;v<nbV;++v)
+		{
+			const uint32_t begin = adjacency.triangleOffsets[v];
+			const uint32_t size  = adjacency.triangleOffsets[v+1] - begin;
+			if (size == 0)
+			{
+				continue;
+			}
+			Kind_e kind = sortFan(triangles, v, &adjacency.triangles[begin], size, ordered);
+			adjacency.kinds[v] = kind;
+			if (kind == NON_MANIFOLD)
+			{
+				scatteredRing(triangles, v, &adjacency.triangles[begin], size, ring);
+			}
+			adjacency.vertexOffsets[v+1] = (kind == INTERIOR) ? size : (kind == BORDER) ? size+1 : ring.size();
+		}
+	}
+	std::partial_sum(adjacency.vertexOffsets.begin(), adjacency.vertexOffsets.end(), adjacency.vertexOffsets.begin());
+	adjacency.vertices.resize(adjacency.vertexOffsets.back());
+	#pragma omp parallel
+	{
+		std::vector<IndexVertex_t> ring;
+		#pragma omp for schedule(dynamic, 256)
+		for(int32_t v=0;v<nbV;++v)
+		{
+			const IndexFace_t* fan  = adjacency.triangles.data() + adjacency.triangleOffsets[v];
+			const uint32_t     size = adjacency.triangleOffsets[v+1] - adjacency.triangleOffsets[v];
+			IndexVertex_t*     out  = adjacency.vertices.data() + adjacency.vertexOffsets[v];
+			switch(adjacency.kinds[v])
+			{
+				case INTERIOR:
+				case BORDER:
+					for(uint32_t i=0;i<size;++i)
+					{
+						const IndexVertex_t* ids = triangles[fan[i]].beginVertice();
+						out[i] = ids[(localIndex(triangles[fan[i]], v)+1)%3];
+					}
+					if (adjacency.kinds[v] == BORDER)
+					{
+						const IndexVertex_t* ids = triangles[fan[size-1]].beginVertice();
+						out[size] = ids[(localIndex(triangles[fan[size-1]], v)+2)%3];
+					}
+					break;
+				case NON_MANIFOLD:
+					scatteredRing(triangles, v, fan, size, ring);
+					std::copy(ring.begin(), ring.end(), out);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	return adjacency;
+}
@@ -0,0 +1,562 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "bvh.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	const uint32_t   BINS     = 16;   //!< The number of bins of the centroids, per axis.
+	const uint32_t   MAX_LEAF = 16;   //!< The number of triangles above which a node is always split.
+	const uint32_t   TASK     = 4096; //!< The smallest range split by another thread.
+	const uint32_t   STACK    = 64;   //!< The depth of the traversal stacks.
+	const VertexType HUGE_T   = std::numeric_limits<VertexType>::max();
+	//! Widens the boxes a bit, so the rounding of the slabs doesn't miss a triangle touching a box.
+	const VertexType ROBUST   = 1.0 + 4.0*std::numeric_limits<VertexType>::epsilon();
+
+	//! @brief A box, as it is grown by the build.
+	struct Box_t final
+	{
+		VertexType low[3]  = { HUGE_T,  HUGE_T,  HUGE_T};
+		VertexType high[3] = {-HUGE_T, -HUGE_T, -HUGE_T};
+
+		inline void grow(const VertexType* p)
+		{
+			for(uint32_t a=0;a<3;++a)
+			{
+				this->low[a]  = std::min(this->low[a],  p[a]);
+				this->high[a] = std::max(this->high[a], p[a]);
+			}
+		}
+		inline void grow(const Box_t& other)
+		{
+			for(uint32_t a=0;a<3;++a)
+			{
+				this->low[a]  = std::min(this->low[a],  other.low[a]);
+				this->high[a] = std::max(this->high[a], other.high[a]);
+			}
+		}
+		//! @brief Get the half surface of the box, 0 for an empty one.
+		inline VertexType area(void) const
+		{
+			if (this->low[0] > this->high[0])
+			{
+				return 0.0;
+			}
+			VertexType x = this->high[0]-this->low[0], y = this->high[1]-this->low[1], z = this->high[2]-this->low[2];
+			return x*y + y*z + z*x;
+		}
+	};
+
+	//! @brief What every task of the build shares.
+	struct Builder_t final
+	{
+		bvh::Tree&              tree;
+		std::vector<Box_t>      boxes;     //!< The box of each triangle.
+		std::vector<VertexType> centroids; //!< The x y z of the center of each box.
+		uint32_t                next;      //!< The first free node.
+	};
+
+	/**
+	 * @brief Make the node \p node over the triangles [\p begin, \p end[, then its children, the big ones as OpenMP tasks.
+	 * @param[in] depth The depth of \p node, a node as deep as the traversal stacks is a leaf.
+	 */
+	void split(Builder_t& builder, uint32_t node, uint32_t begin, uint32_t end, uint32_t depth)
+	{
+		std::vector<IndexFace_t>& indexes = builder.tree.indexes;
+		Box_t box, centers;
+		for(uint32_t i=begin;i<end;++i)
+		{
+			box.grow(builder.boxes[indexes[i]]);
+			centers.grow(&builder.centroids[3*indexes[i]]);
+		}
+		bvh::Node& n = builder.tree.nodes[node];
+		std::copy(box.low,  box.low  + 3, n.low);
+		std::copy(box.high, box.high + 3, n.high);
+		n.offset = begin;
+		n.count  = end - begin;
+		if (n.count <= bvh::LEAF || depth + 1 == STACK)
+		{
+			return;
+		}
+		// The cost of each split between 2 bins, relative to the cost of testing a triangle.
+		VertexType best  = HUGE_T;
+		int32_t    axis  = -1;
+		uint32_t   plane = 0;
+		for(int32_t a=0;a<3;++a)
+		{
+			const VertexType extent = centers.high[a] - centers.low[a];
+			if (extent <= 0.0)
+			{
+				continue;
+			}
+			const VertexType scale = BINS/extent;
+			Box_t    bins[BINS];
+			uint32_t counts[BINS] = {0};
+			for(uint32_t i=begin;i<end;++i)
+			{
+				uint32_t b = std::min<uint32_t>(BINS-1, (builder.centroids[3*indexes[i]+a] - centers.low[a])*scale);
+				bins[b].grow(builder.boxes[indexes[i]]);
+				++counts[b];
+			}
+			VertexType rightAreas[BINS];
+			Box_t      right;
+			for(uint32_t b=BINS-1;b>0;--b)
+			{
+				right.grow(bins[b]);
+				rightAreas[b] = right.area();
+			}
+			Box_t    left;
+			uint32_t nbLeft = 0;
+			for(uint32_t b=1;b<BINS;++b)
+			{
+				left.grow(bins[b-1]);
+				nbLeft += counts[b-1];
+				const VertexType cost = left.area()*nbLeft + rightAreas[b]*(n.count - nbLeft);
+				if (cost < best)
+				{
+					best  = cost;
+					axis  = a;
+					plane = b;
+				}
+			}
+		}
+		// A traversal step costs about a triangle test.
+		const VertexType area = box.area();
+		best = (area > 0.0) ? 1.0 + best/area : HUGE_T;
+		uint32_t middle = begin;
+		if (axis != -1)
+		{
+			if (best >= n.count && n.count <= MAX_LEAF)
+			{
+				return;
+			}
+			const VertexType low   = centers.low[axis];
+			const VertexType scale = BINS/(centers.high[axis] - low);
+			middle = std::partition(indexes.begin() + begin, indexes.begin() + end, [&](IndexFace_t f){
+				return std::min<uint32_t>(BINS-1, (builder.centroids[3*f+axis] - low)*scale) < plane;
+			}) - indexes.begin();
+		}
+		else if (n.count <= MAX_LEAF)
+		{
+			return;
+		}
+		if (middle == begin || middle == end)
+		{
+			// Every centroid is at the same place : any half is as good as another one.
+			middle = (begin + end)/2;
+		}
+		uint32_t child;
+		#pragma omp atomic capture
+		{
+			child = builder.next;
+			builder.next += 2;
+		}
+		n.offset = child;
+		n.count  = 0;
+		#pragma omp task shared(builder) if(end - begin > TASK)
+		split(builder, child, begin, middle, depth+1);
+		split(builder, child+1, middle, end, depth+1);
+		#pragma omp taskwait
+	}
+
+	/**
+	 * @struct Shear_t
+	 * @brief A ray, as seen by the watertight test : the axes are permuted so its main one is z, then the
+	 * space is sheared so the ray goes along z from the origin.
+	 */
+	struct Shear_t final
+	{
+		uint32_t   kx, ky, kz; //!< The axes which become x, y and z.
+		VertexType sx, sy, sz; //!< The shear.
+	};
+
+	Shear_t shear(VertexType dx, VertexType dy, VertexType dz)
+	{
+		const VertexType d[3] = {dx, dy, dz};
+		Shear_t s;
+		s.kz = (std::fabs(dx) > std::fabs(dy)) ? ((std::fabs(dx) > std::fabs(dz)) ? 0 : 2) : ((std::fabs(dy) > std::fabs(dz)) ? 1 : 2);
+		s.kx = (s.kz+1)%3;
+		s.ky = (s.kx+1)%3;
+		if (d[s.kz] < 0.0)
+		{
+			// Keeps the winding of the triangles, so the sign of the determinant tells the side.
+			std::swap(s.kx, s.ky);
+		}
+		s.sx = d[s.kx]/d[s.kz];
+		s.sy = d[s.ky]/d[s.kz];
+		s.sz = 1.0/d[s.kz];
+		return s;
+	}
+
+	//! @brief std::min() and std::max() by value, which become a single instruction in the simd loops.
+	inline VertexType lower(VertexType a, VertexType b)
+	{
+		return (a < b) ? a : b;
+	}
+	inline VertexType upper(VertexType a, VertexType b)
+	{
+		return (a > b) ? a : b;
+	}
+
+	/**
+	 * @brief The watertight test of a ray (by its origin \p o and its shear \p s) against the triangle \p c.
+	 * An edge going exactly through the ray makes a 0, accepted by both triangles sharing it.
+	 * @param[inout] far The farthest t, replaced by the one of the hit.
+	 * @return true if the triangle is hit between \p near and \p far.
+	 */
+	inline bool hitTriangle(const VertexType* c, const VertexType* o, const Shear_t& s, VertexType near, VertexType& far, VertexType& u, VertexType& v)
+	{
+		VertexType p[3][3];
+		for(uint32_t i=0;i<3;++i)
+		{
+			const VertexType a[3] = {c[3*i]-o[0], c[3*i+1]-o[1], c[3*i+2]-o[2]};
+			p[i][0] = a[s.kx] - s.sx*a[s.kz];
+			p[i][1] = a[s.ky] - s.sy*a[s.kz];
+			p[i][2] = s.sz*a[s.kz];
+		}
+		const VertexType ea = p[2][0]*p[1][1] - p[2][1]*p[1][0];
+		const VertexType eb = p[0][0]*p[2][1] - p[0][1]*p[2][0];
+		const VertexType ec = p[1][0]*p[0][1] - p[1][1]*p[0][0];
+		if ((ea < 0.0 || eb < 0.0 || ec < 0.0) && (ea > 0.0 || eb > 0.0 || ec > 0.0))
+		{
+			return false;
+		}
+		const VertexType det = ea + eb + ec;
+		if (det == 0.0)
+		{
+			return false;
+		}
+		const VertexType t = (ea*p[0][2] + eb*p[1][2] + ec*p[2][2])/det;
+		if (!(t >= near && t < far))
+		{
+			return false;
+		}
+		far = t;
+		u   = eb/det;
+		v   = ec/det;
+		return true;
+	}
+
+	/**
+	 * @brief Test a ray against every triangle of the leaf \p node.
+	 * @param[inout] far The farthest t, replaced by the one of the closest hit.
+	 * @param[inout] hit The closest hit, only its triangle, u and v are set.
+	 */
+	inline void hitLeaf(const bvh::Tree& tree, const bvh::Node& node, const VertexType* o, const Shear_t& s, VertexType near, VertexType& far, bvh::Hit& hit)
+	{
+		for(uint32_t i=node.offset;i<node.offset+node.count;++i)
+		{
+			if (hitTriangle(&tree.corners[9*i], o, s, near, far, hit.u, hit.v))
+			{
+				hit.triangle = tree.indexes[i];
+			}
+		}
+	}
+
+	/**
+	 * @brief The same test as hitTriangle(), for every ray of \p packet against the triangle \p c at once.
+	 * Only the distances are kept : SSE2 has no masked store, and GCC turns "x = hit ? y : x" into a
+	 * conditional one, so the loop wouldn't be vectorized with more.
+	 * @param[in]    shears The shear of each ray as a matrix, shears[r][a][l] being the entry a of the row r for
+	 *                      the ray l. A row only has 1 or 2 entries which aren't 0, so the rounding is the same.
+	 * @param[inout] far    The farthest t of each ray, replaced by the one of its hit.
+	 */
+	inline void hitTriangle(const VertexType* c, const bvh::Packet& packet, const VertexType (&shears)[3][3][bvh::PACKET], VertexType* far)
+	{
+		#pragma omp simd
+		for(uint32_t l=0;l<bvh::PACKET;++l)
+		{
+			// Written out, so every lane runs the same instructions.
+			const VertexType ax = c[0]-packet.ox[l], ay = c[1]-packet.oy[l], az = c[2]-packet.oz[l];
+			const VertexType bx = c[3]-packet.ox[l], by = c[4]-packet.oy[l], bz = c[5]-packet.oz[l];
+			const VertexType cx = c[6]-packet.ox[l], cy = c[7]-packet.oy[l], cz = c[8]-packet.oz[l];
+			const VertexType sa = ax*shears[0][0][l] + ay*shears[0][1][l] + az*shears[0][2][l];
+			const VertexType sb = bx*shears[0][0][l] + by*shears[0][1][l] + bz*shears[0][2][l];
+			const VertexType sc = cx*shears[0][0][l] + cy*shears[0][1][l] + cz*shears[0][2][l];
+			const VertexType ta = ax*shears[1][0][l] + ay*shears[1][1][l] + az*shears[1][2][l];
+			const VertexType tb = bx*shears[1][0][l] + by*shears[1][1][l] + bz*shears[1][2][l];
+			const VertexType tc = cx*shears[1][0][l] + cy*shears[1][1][l] + cz*shears[1][2][l];
+			const VertexType za = ax*shears[2][0][l] + ay*shears[2][1][l] + az*shears[2][2][l];
+			const VertexType zb = bx*shears[2][0][l] + by*shears[2][1][l] + bz*shears[2][2][l];
+			const VertexType zc = cx*shears[2][0][l] + cy*shears[2][1][l] + cz*shears[2][2][l];
+			const VertexType ea  = sc*tb - tc*sb;
+			const VertexType eb  = sa*tc - ta*sc;
+			const VertexType ec  = sb*ta - tb*sa;
+			const VertexType det = ea + eb + ec;
+			// Infinite or NaN for a det 0, which is discarded below.
+			const VertexType t   = (ea*za + eb*zb + ec*zc)/det;
+			const VertexType lowest  = lower(lower(ea, eb), ec);
+			const VertexType highest = upper(upper(ea, eb), ec);
+			VertexType       closest = (lowest >= 0.0) ? t : ((highest <= 0.0) ? t : HUGE_T);
+			closest = (det != 0.0)          ? closest : HUGE_T;
+			closest = (t >= packet.near[l]) ? closest : HUGE_T;
+			far[l] = lower(closest, far[l]);
+		}
+	}
+
+	/**
+	 * @brief Get the t where a ray enters \p node, or HUGE_T if it misses it.
+	 * @param[in] inv The inverse of the direction, infinite for a 0. A ray along a face computes 0*infinity,
+	 * a NaN which is always the first operand of lower() and upper(), so it is ignored.
+	 */
+	inline VertexType hitBox(const bvh::Node& node, const VertexType* o, const VertexType* inv, VertexType near, VertexType far)
+	{
+		for(uint32_t a=0;a<3;++a)
+		{
+			const bool negative = inv[a] < 0.0;
+			near = upper(((negative ? node.high[a] : node.low[a])  - o[a])*inv[a], near);
+			far  = lower(((negative ? node.low[a]  : node.high[a]) - o[a])*inv[a]*ROBUST, far);
+		}
+		return (near <= far) ? near : HUGE_T;
+	}
+
+	/**
+	 * @brief Test every ray of \p packet against \p node at once.
+	 * @return The smallest t where an active ray enters it, HUGE_T if none does.
+	 */
+	inline VertexType hitBox(const bvh::Node& node, const bvh::Packet& packet, const VertexType (&inv)[3][bvh::PACKET], const VertexType* far)
+	{
+		VertexType closest = HUGE_T;
+		#pragma omp simd reduction(min:closest)
+		for(uint32_t l=0;l<bvh::PACKET;++l)
+		{
+			const bool nx = inv[0][l] < 0.0, ny = inv[1][l] < 0.0, nz = inv[2][l] < 0.0;
+			VertexType enter = packet.near[l], leave = far[l];
+			enter = upper(((nx ? node.high[0] : node.low[0]) - packet.ox[l])*inv[0][l], enter);
+			enter = upper(((ny ? node.high[1] : node.low[1]) - packet.oy[l])*inv[1][l], enter);
+			enter = upper(((nz ? node.high[2] : node.low[2]) - packet.oz[l])*inv[2][l], enter);
+			leave = lower(((nx ? node.low[0] : node.high[0]) - packet.ox[l])*inv[0][l]*ROBUST, leave);
+			leave = lower(((ny ? node.low[1] : node.high[1]) - packet.oy[l])*inv[1][l]*ROBUST, leave);
+			leave = lower(((nz ? node.low[2] : node.high[2]) - packet.oz[l])*inv[2][l]*ROBUST, leave);
+			closest = lower((enter <= leave) ? enter : HUGE_T, closest);
+		}
+		return closest;
+	}
+}
+
+bvh::Tree bvh::build(const VertexContainer& vertices, const TriangleContainer& triangles)
+{
+	Tree          tree;
+	const int32_t nbT = triangles.size();
+	Builder_t     builder = {tree, std::vector<Box_t>(nbT), std::vector<VertexType>(3*nbT), 1};
+	#pragma omp parallel for schedule(static)
+	for(int32_t f=0;f<nbT;++f)
+	{
+		for(const IndexVertex_t* v=triangles[f].beginVertice();v!=triangles[f].endVertice();++v)
+		{
+			const VertexType p[3] = {vertices[*v].x(), vertices[*v].y(), vertices[*v].z()};
+			builder.boxes[f].grow(p);
+		}
+		for(uint32_t a=0;a<3;++a)
+		{
+			builder.centroids[3*f+a] = (builder.boxes[f].low[a] + builder.boxes[f].high[a])/2.0;
+		}
+	}
+	// A leaf has at least a triangle, so there is at most 2*nbT - 1 nodes.
+	tree.nodes.resize(std::max(1, 2*nbT - 1));
+	tree.indexes.resize(nbT);
+	std::iota(tree.indexes.begin(), tree.indexes.end(), 0);
+	#pragma omp parallel
+	{
+		#pragma omp single
+		split(builder, 0, 0, nbT, 0);
+	}
+	tree.nodes.resize(builder.next);
+	tree.corners.resize(9*static_cast<size_t>(nbT));
+	#pragma omp parallel for schedule(static)
+	for(int32_t i=0;i<nbT;++i)
+	{
+		const TopoTriangle& t = triangles[tree.indexes[i]];
+		for(uint32_t c=0;c<3;++c)
+		{
+			const Vertex& v = vertices[t.beginVertice()[c]];
+			tree.corners[9*i+3*c]   = v.x();
+			tree.corners[9*i+3*c+1] = v.y();
+			tree.corners[9*i+3*c+2] = v.z();
+		}
+	}
+	return tree;
+}
+
+bvh::Hit bvh::intersect(const Tree& tree, const Ray& ray)
+{
+	Hit              hit;
+	const VertexType o[3]   = {ray.origin.x(), ray.origin.y(), ray.origin.z()};
+	const VertexType inv[3] = {1.0/ray.direction.x(), 1.0/ray.direction.y(), 1.0/ray.direction.z()};
+	const Shear_t    s      = shear(ray.direction.x(), ray.direction.y(), ray.direction.z());
+	VertexType       far    = ray.far;
+	if (hitBox(tree.nodes[0], o, inv, ray.near, far) == HUGE_T)
+	{
+		return hit;
+	}
+	uint32_t stack[STACK];
+	uint32_t top  = 0;
+	uint32_t node = 0;
+	while(true)
+	{
+		const Node& n = tree.nodes[node];
+		if (n.count > 0)
+		{
+			hitLeaf(tree, n, o, s, ray.near, far, hit);
+		}
+		else
+		{
+			// The closest child first, the other one may be skipped once a hit is found.
+			VertexType first  = hitBox(tree.nodes[n.offset],   o, inv, ray.near, far);
+			VertexType second = hitBox(tree.nodes[n.offset+1], o, inv, ray.near, far);
+			uint32_t   near   = n.offset, other = n.offset+1;
+			if (second < first)
+			{
+				std::swap(first, second);
+				std::swap(near, other);
+			}
+			if (first != HUGE_T)
+			{
+				if (second != HUGE_T)
+				{
+					stack[top++] = other;
+				}
+				node = near;
+				continue;
+			}
+		}
+		if (top == 0)
+		{
+			break;
+		}
+		node = stack[--top];
+	}
+	if (hit.triangle != -1)
+	{
+		hit.distance = far;
+	}
+	return hit;
+}
+
+void bvh::intersect(const Tree& tree, const Packet& packet, Hit* hits)
+{
+	// Every array is lane by lane, for the simd loops.
+	VertexType  inv[3][PACKET];
+	VertexType  shears[3][3][PACKET];
+	VertexType  far[PACKET];
+	uint32_t    found[PACKET]; // The leaf of the closest hit of each ray.
+	for(uint32_t l=0;l<PACKET;++l)
+	{
+		const Shear_t s = shear(packet.dx[l], packet.dy[l], packet.dz[l]);
+		for(uint32_t r=0;r<3;++r)
+		{
+			shears[r][0][l] = shears[r][1][l] = shears[r][2][l] = 0.0;
+		}
+		shears[0][s.kx][l] = 1.0;
+		shears[0][s.kz][l] = -s.sx;
+		shears[1][s.ky][l] = 1.0;
+		shears[1][s.kz][l] = -s.sy;
+		shears[2][s.kz][l] = s.sz;
+		inv[0][l]   = 1.0/packet.dx[l];
+		inv[1][l]   = 1.0/packet.dy[l];
+		inv[2][l]   = 1.0/packet.dz[l];
+		far[l]      = packet.far[l];
+		found[l]    = 0;
+	}
+	uint32_t stack[STACK];
+	uint32_t top  = 0;
+	uint32_t node = 0;
+	bool     more = hitBox(tree.nodes[0], packet, inv, far) != HUGE_T;
+	while(more)
+	{
+		const Node& n = tree.nodes[node];
+		if (n.count > 0)
+		{
+			VertexType before[PACKET];
+			std::copy(far, far + PACKET, before);
+			for(uint32_t i=n.offset;i<n.offset+n.count;++i)
+			{
+				hitTriangle(&tree.corners[9*i], packet, shears, far);
+			}
+			for(uint32_t l=0;l<PACKET;++l)
+			{
+				found[l] = (far[l] < before[l]) ? node : found[l];
+			}
+		}
+		else
+		{
+			VertexType first  = hitBox(tree.nodes[n.offset],   packet, inv, far);
+			VertexType second = hitBox(tree.nodes[n.offset+1], packet, inv, far);
+			uint32_t   near   = n.offset, other = n.offset+1;
+			if (second < first)
+			{
+				std::swap(first, second);
+				std::swap(near, other);
+			}
+			if (first != HUGE_T)
+			{
+				if (second != HUGE_T)
+				{
+					stack[top++] = other;
+				}
+				node = near;
+				continue;
+			}
+		}
+		if (top == 0)
+		{
+			break;
+		}
+		node = stack[--top];
+	}
+	for(uint32_t l=0;l<PACKET;++l)
+	{
+		hits[l] = Hit();
+		if (far[l] < packet.far[l])
+		{
+			// Only the leaf of the closest hit is tested again, with the same arithmetic as the lanes.
+			const VertexType o[3] = {packet.ox[l], packet.oy[l], packet.oz[l]};
+			VertexType       t    = HUGE_T;
+			hitLeaf(tree, tree.nodes[found[l]], o, shear(packet.dx[l], packet.dy[l], packet.dz[l]), packet.near[l], t, hits[l]);
+			hits[l].distance = far[l];
+		}
+	}
+}
+
+std::vector<bvh::Hit> bvh::intersect(const Tree& tree, const std::vector<Ray>& rays)
+{
+	std::vector<Hit> hits(rays.size());
+	const int32_t    nbPackets = (rays.size() + PACKET - 1)/PACKET;
+	#pragma omp parallel for schedule(dynamic, 16)
+	for(int32_t p=0;p<nbPackets;++p)
+	{
+		Packet packet;
+		Hit    result[PACKET];
+		for(uint32_t l=0;l<PACKET;++l)
+		{
+			const size_t r = static_cast<size_t>(p)*PACKET + l;
+			if (r < rays.size())
+			{
+				packet.ox[l]   = rays[r].origin.x();
+				packet.oy[l]   = rays[r].origin.y();
+				packet.oz[l]   = rays[r].origin.z();
+				packet.dx[l]   = rays[r].direction.x();
+				packet.dy[l]   = rays[r].direction.y();
+				packet.dz[l]   = rays[r].direction.z();
+				packet.near[l] = rays[r].near;
+				packet.far[l]  = rays[r].far;
+			}
+			else // Disabled.
+			{
+				packet.ox[l] = packet.oy[l] = packet.oz[l] = 0.0;
+				packet.dx[l] = packet.dy[l] = packet.dz[l] = 1.0;
+				packet.near[l] = 1.0;
+				packet.far[l]  = 0.0;
+			}
+		}
+		intersect(tree, packet, result);
+		for(uint32_t l=0;l<PACKET && static_cast<size_t>(p)*PACKET + l<rays.size();++l)
+		{
+			hits[static_cast<size_t>(p)*PACKET + l] = result[l];
+		}
+	}
+	return hits;
+}
@@ -0,0 +1,1087 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "codec.hpp"
+#include "components.hpp"
+#include "trace.hpp"
+
+
+namespace
+{
+	const char     MAGIC[4]  = {'M', 'S', 'H', 'Z'};
+	const uint8_t  VERSION   = 1;
+	const size_t   BUFFER    = 1u << 16; //!< The bytes written or read at once.
+	const uint32_t TOP       = 1u << 24; //!< Under this, the range coder has a byte to shift out.
+	const uint32_t BOTTOM    = 1u << 16; //!< The smallest range, and so the biggest total of a Model_t.
+	const uint32_t INCREMENT = 24;       //!< What a symbol adds to its frequency each time it is coded.
+
+	//! @brief How the third vertex of a triangle is reached, see codec.hpp.
+	typedef enum {
+		C, L, E, R, S, M,
+		H,            //!< A C whose vertex is the virtual one of a hole.
+		SYMBOLS_NUMBER
+	} Symbol_e;
+
+	/**
+	 * @class RangeEncoder_t
+	 * @brief A carryless range coder (Subbotin) : the bytes are written as soon as they can't change anymore.
+	 */
+	class RangeEncoder_t final
+	{
+		public:
+			explicit RangeEncoder_t(std::ostream& out) : out(out), low(0), range(0xFFFFFFFFu), written(0)
+			{
+				this->buffer.reserve(BUFFER);
+			}
+			//! @brief Code the symbol which is [\p cumulated, \p cumulated + \p frequency[ among \p total.
+			inline void encode(uint32_t cumulated, uint32_t frequency, uint32_t total)
+			{
+				this->range /= total;
+				this->low   += cumulated*this->range;
+				this->range *= frequency;
+				while((this->low ^ (this->low + this->range)) < TOP || (this->range < BOTTOM && ((this->range = -this->low & (BOTTOM-1)), true)))
+				{
+					this->put(this->low >> 24);
+					this->low   <<= 8;
+					this->range <<= 8;
+				}
+			}
+			//! @brief Code the \p nb lowest bits of \p value, all as likely.
+			inline void bits(uint32_t value, uint32_t nb)
+			{
+				for(;nb>16;nb-=16)
+				{
+					this->encode((value >> (nb-16)) & 0xFFFF, 1, BOTTOM);
+				}
+				this->encode(value & ((1u << nb) - 1), 1, 1u << nb);
+			}
+			//! @brief Write what remains. @return The bytes written.
+			uint64_t close(void)
+			{
+				for(uint32_t i=0;i<4;++i)
+				{
+					this->put(this->low >> 24);
+					this->low <<= 8;
+				}
+				this->flush();
+				return this->written;
+			}
+
+		private:
+			std::ostream&        out;
+			uint32_t             low;
+			uint32_t             range;
+			uint64_t             written;
+			std::vector<uint8_t> buffer;
+
+			inline void put(uint32_t byte)
+			{
+				this->buffer.push_back(byte);
+				if (this->buffer.size() == BUFFER)
+				{
+					this->flush();
+				}
+			}
+			void flush(void)
+			{
+				this->out.write(reinterpret_cast<const char*>(this->buffer.data()), this->buffer.size());
+				this->written += this->buffer.size();
+				this->buffer.clear();
+				if (!this->out.good())
+				{
+					throw std::runtime_error("Unable to write the compressed mesh");
+				}
+			}
+	};
+
+	/**
+	 * @class RangeDecoder_t
+	 * @brief The decoder of RangeEncoder_t, which reads its stream by chunks.
+	 */
+	class RangeDecoder_t final
+	{
+		public:
+			explicit RangeDecoder_t(std::istream& in) : in(in), low(0), range(0xFFFFFFFFu), code(0), buffer(BUFFER), position(0), size(0)
+			{
+				for(uint32_t i=0;i<4;++i)
+				{
+					this->code = (this->code << 8) | this->get();
+				}
+			}
+			//! @brief Get the cumulated frequency of the next symbol among \p total.
+			inline uint32_t frequency(uint32_t total)
+			{
+				this->range /= total;
+				const uint32_t value = (this->code - this->low)/this->range;
+				if (value >= total)
+				{
+					throw std::runtime_error("Corrupted compressed mesh");
+				}
+				return value;
+			}
+			//! @brief Remove the symbol found by frequency(), which is [\p cumulated, \p cumulated + \p frequency[.
+			inline void decode(uint32_t cumulated, uint32_t frequency)
+			{
+				this->low   += cumulated*this->range;
+				this->range *= frequency;
+				while((this->low ^ (this->low + this->range)) < TOP || (this->range < BOTTOM && ((this->range = -this->low & (BOTTOM-1)), true)))
+				{
+					this->code    = (this->code << 8) | this->get();
+					this->low   <<= 8;
+					this->range <<= 8;
+				}
+			}
+			inline uint32_t bits(uint32_t nb)
+			{
+				uint32_t value = 0;
+				for(;nb>16;nb-=16)
+				{
+					const uint32_t part = this->frequency(BOTTOM);
+					this->decode(part, 1);
+					value = (value << 16) | part;
+				}
+				const uint32_t part = this->frequency(1u << nb);
+				this->decode(part, 1);
+				return (value << nb) | part;
+			}
+
+		private:
+			std::istream&     in;
+			uint32_t          low;
+			uint32_t          range;
+			uint32_t          code;
+			std::vector<char> buffer;
+			size_t            position;
+			size_t            size;
+
+			inline uint32_t get(void)
+			{
+				if (this->position == this->size)
+				{
+					this->in.read(this->buffer.data(), BUFFER);
+					this->size     = this->in.gcount();
+					this->position = 0;
+					if (this->size == 0)
+					{
+						// The encoder shifts out as many bytes as the decoder shifts in, the stream was cut.
+						throw std::runtime_error("Truncated compressed mesh");
+					}
+				}
+				return static_cast<uint8_t>(this->buffer[this->position++]);
+			}
+	};
+
+	/**
+	 * @class Model_t
+	 * @brief The adaptive frequencies of some symbols : the more a symbol is coded, the less it costs.
+	 */
+	class Model_t final
+	{
+		public:
+			explicit Model_t(uint32_t size) : counts(size, 1), total(size) {}
+			//! @return The bits it has cost.
+			double encode(RangeEncoder_t& coder, uint32_t symbol)
+			{
+				uint32_t cumulated = 0;
+				for(uint32_t s=0;s<symbol;++s)
+				{
+					cumulated += this->counts[s];
+				}
+				const double cost = std::log2(static_cast<double>(this->total)/this->counts[symbol]);
+				coder.encode(cumulated, this->counts[symbol], this->total);
+				this->update(symbol);
+				return cost;
+			}
+			uint32_t decode(RangeDecoder_t& coder)
+			{
+				const uint32_t value     = coder.frequency(this->total);
+				uint32_t       symbol    = 0;
+				uint32_t       cumulated = 0;
+				while(cumulated + this->counts[symbol] <= value)
+				{
+					cumulated += this->counts[symbol++];
+				}
+				coder.decode(cumulated, this->counts[symbol]);
+				this->update(symbol);
+				return symbol;
+			}
+
+		private:
+			std::vector<uint32_t> counts;
+			uint32_t              total;
+
+			inline void update(uint32_t symbol)
+			{
+				this->counts[symbol] += INCREMENT;
+				this->total          += INCREMENT;
+				if (this->total > BOTTOM)
+				{
+					this->total = 0;
+					for(uint32_t& count : this->counts)
+					{
+						count        = (count + 1)/2;
+						this->total += count;
+					}
+				}
+			}
+	};
+
+	//! @brief Get the number of bits of \p value, 0 for 0.
+	inline uint32_t length(uint32_t value)
+	{
+		uint32_t nb = 0;
+		for(;value!=0;value>>=1)
+		{
+			++nb;
+		}
+		return nb;
+	}
+	//! @brief Code \p value by its number of bits, through \p lengths, then its bits but the highest. @return The bits it has cost.
+	double encodeNumber(RangeEncoder_t& coder, Model_t& lengths, uint32_t value)
+	{
+		const uint32_t nb   = length(value);
+		double         cost = lengths.encode(coder, nb);
+		if (nb > 1)
+		{
+			coder.bits(value, nb-1);
+			cost += nb-1;
+		}
+		return cost;
+	}
+	uint32_t decodeNumber(RangeDecoder_t& coder, Model_t& lengths)
+	{
+		const uint32_t nb = lengths.decode(coder);
+		return (nb <= 1) ? nb : ((1u << (nb-1)) | coder.bits(nb-1));
+	}
+	inline uint32_t zigzag(int32_t value)
+	{
+		return (value >= 0) ? 2*static_cast<uint32_t>(value) : 2*static_cast<uint32_t>(-(value+1)) + 1;
+	}
+	inline int32_t unzigzag(uint32_t value)
+	{
+		return (value & 1) ? -static_cast<int32_t>(value >> 1) - 1 : static_cast<int32_t>(value >> 1);
+	}
+
+	/**
+	 * @brief Predict the position of the vertex reached across the edge a->b of the triangle (a, b, o),
+	 * by the parallelogram. A null position is a virtual vertex : the prediction uses what is left.
+	 */
+	inline void predict(const int32_t* a, const int32_t* b, const int32_t* o, const int32_t* last, int32_t highest, int32_t out[3])
+	{
+		for(uint32_t i=0;i<3;++i)
+		{
+			const int32_t value = (a && b && o) ? a[i] + b[i] - o[i] : (a && b) ? (a[i] + b[i])/2 : a ? a[i] : b ? b[i] : last[i];
+			out[i] = std::min(highest, std::max(0, value));
+		}
+	}
+
+	//! @brief A vertex of a loop, with the edge to the next one.
+	struct Node_t final
+	{
+		IndexVertex_t vertex;
+		int32_t       next;
+		int32_t       prev;
+		IndexFace_t   face;     //!< The visited triangle of the edge.
+		uint32_t      slot;     //!< The edge inside this triangle, the index of its opposite vertex.
+		IndexVertex_t opposite; //!< The third vertex of this triangle.
+		bool          stacked;  //!< true if it is the gate of a loop waiting on the stack.
+	};
+
+	/**
+	 * @class Loops_t
+	 * @brief The loops of edges between the visited triangles and the others, oriented like the visited ones.
+	 * The current loop is gone through from its gate edge, the other ones wait on a stack.
+	 * The encoder and the decoder make the same moves, so they always agree on the gate.
+	 */
+	class Loops_t final
+	{
+		public:
+			std::vector<Node_t>  nodes;
+			std::vector<int32_t> stack; //!< The gates of the waiting loops.
+			int32_t              gate;  //!< The node of the current edge, which goes to the next node.
+
+			//! @param[in] edges The node of each edge of each triangle to keep up to date, nullptr for none.
+			explicit Loops_t(std::vector<int32_t>* edges) : gate(-1), edges(edges) {}
+
+			//! @brief Start a component by the triangle \p face (v0, v1, v2).
+			void start(IndexVertex_t v0, IndexVertex_t v1, IndexVertex_t v2, IndexFace_t face)
+			{
+				const int32_t n0 = this->create(v0, face, 2, v2);
+				const int32_t n1 = this->create(v1, face, 0, v0);
+				const int32_t n2 = this->create(v2, face, 1, v1);
+				this->chain(n0, n1);
+				this->chain(n1, n2);
+				this->chain(n2, n0);
+				this->gate = n0;
+			}
+			/**
+			 * @brief The triangle \p face of the new vertex \p v : a->b becomes a->v->b, and the gate goes on v->b.
+			 * @param[in] slotAV The slot of the edge a->v inside \p face.
+			 * @param[in] slotVB The slot of the edge v->b inside \p face.
+			 */
+			void c(IndexVertex_t v, IndexFace_t face, uint32_t slotAV, uint32_t slotVB)
+			{
+				const int32_t g  = this->gate;
+				const int32_t nb = this->nodes[g].next;
+				const int32_t x  = this->create(v, face, slotVB, this->nodes[g].vertex);
+				this->set(g, face, slotAV, this->nodes[nb].vertex);
+				this->chain(g, x);
+				this->chain(x, nb);
+				this->gate = x;
+			}
+			//! @brief The triangle \p face over a->b and b->v : a->b->v becomes a->v.
+			void r(IndexFace_t face, uint32_t slotAV)
+			{
+				const int32_t g  = this->gate;
+				const int32_t nb = this->nodes[g].next;
+				this->set(g, face, slotAV, this->nodes[nb].vertex);
+				this->chain(g, this->nodes[nb].next);
+				this->release(nb);
+			}
+			//! @brief The triangle \p face over v->a and a->b : v->a->b becomes v->b.
+			void l(IndexFace_t face, uint32_t slotVB)
+			{
+				const int32_t g = this->gate;
+				const int32_t p = this->nodes[g].prev;
+				this->set(p, face, slotVB, this->nodes[g].vertex);
+				this->chain(p, this->nodes[g].next);
+				this->release(g);
+				this->gate = p;
+			}
+			/**
+			 * @brief The triangle closing the current loop a->b->v.
+			 * @return false if there isn't any loop left, true if the next one is on the gate.
+			 */
+			bool e(void)
+			{
+				const int32_t g  = this->gate;
+				const int32_t nb = this->nodes[g].next;
+				this->release(this->nodes[nb].next);
+				this->release(nb);
+				this->release(g);
+				if (this->stack.empty())
+				{
+					this->gate = -1;
+					return false;
+				}
+				this->gate = this->stack.back();
+				this->stack.pop_back();
+				this->nodes[this->gate].stacked = false;
+				return true;
+			}
+			/**
+			 * @brief The triangle \p face of a vertex \p y already on a loop, after b along the current one (S) or on
+			 * the waiting loop \p position (M) : a->b ... y->w becomes a->v->w (a copy of y) and y->b. So the current
+			 * loop is split in two (S), the first one waiting on the stack, or merged with the other one (M).
+			 * @param[in] position The index of the other loop inside the stack, -1 for S.
+			 */
+			void splice(int32_t y, int32_t position, IndexFace_t face, uint32_t slotAV, uint32_t slotVB)
+			{
+				const int32_t g  = this->gate;
+				const int32_t nb = this->nodes[g].next;
+				const int32_t w  = this->nodes[y].next;
+				const Node_t  old = this->nodes[y];
+				const int32_t x  = this->create(old.vertex, old.face, old.slot, old.opposite);
+				this->set(g, face, slotAV, this->nodes[nb].vertex);
+				this->set(y, face, slotVB, this->nodes[g].vertex);
+				this->chain(g, x);
+				this->chain(x, w);
+				this->chain(y, nb);
+				if (position == -1)
+				{
+					this->stack.push_back(g);
+					this->nodes[g].stacked = true;
+				}
+				else
+				{
+					this->nodes[this->stack[position]].stacked = false;
+					this->stack.erase(this->stack.begin() + position);
+				}
+				this->gate = y;
+			}
+			//! @brief Get the node \p steps after \p node, -1 if \p stop is met before.
+			int32_t advance(int32_t node, uint32_t steps, int32_t stop) const
+			{
+				for(uint32_t i=0;i<steps && node!=-1;++i)
+				{
+					node = this->nodes[node].next;
+					node = (node == stop) ? -1 : node;
+				}
+				return node;
+			}
+
+		private:
+			std::vector<int32_t>  freed;
+			std::vector<int32_t>* edges;
+
+			int32_t create(IndexVertex_t vertex, IndexFace_t face, uint32_t slot, IndexVertex_t opposite)
+			{
+				int32_t n = this->nodes.size();
+				if (this->freed.empty())
+				{
+					this->nodes.push_back(Node_t());
+				}
+				else
+				{
+					n = this->freed.back();
+					this->freed.pop_back();
+				}
+				this->nodes[n].vertex  = vertex;
+				this->nodes[n].stacked = false;
+				this->set(n, face, slot, opposite);
+				return n;
+			}
+			inline void set(int32_t n, IndexFace_t face, uint32_t slot, IndexVertex_t opposite)
+			{
+				this->nodes[n].face     = face;
+				this->nodes[n].slot     = slot;
+				this->nodes[n].opposite = opposite;
+				if (this->edges)
+				{
+					(*this->edges)[3*static_cast<size_t>(face) + slot] = n;
+				}
+			}
+			inline void chain(int32_t from, int32_t to)
+			{
+				this->nodes[from].next = to;
+				this->nodes[to].prev   = from;
+			}
+			inline void release(int32_t n)
+			{
+				this->freed.push_back(n);
+			}
+	};
+
+	//! @brief The fixed size part of the stream, before the range coded one.
+	struct Header_t final
+	{
+		char       magic[4];
+		uint8_t    version;
+		uint8_t    bits;
+		uint32_t   nbVertices;
+		uint32_t   nbTriangles;
+		uint32_t   nbComponents;
+		uint32_t   nbHoles;    //!< The virtual vertices.
+		uint32_t   nbBorders;  //!< The border edges, so the virtual triangles.
+		uint32_t   nbIsolated; //!< The vertices without any triangle, coded after the components.
+		VertexType low[3];     //!< The corner of the grid.
+		VertexType step;       //!< The side of a cell of the grid.
+	};
+
+	//! @brief The models of the stream, the same on both sides.
+	struct Models_t final
+	{
+		std::vector<Model_t> symbols;    //!< In the context of the previous symbol, the last one for the beginning.
+		Model_t              offsets;
+		Model_t              positions;
+		std::vector<Model_t> residuals;  //!< One per coordinate.
+		Models_t(void) : symbols(SYMBOLS_NUMBER + 1, Model_t(SYMBOLS_NUMBER)), offsets(33), positions(33), residuals(3, Model_t(33)) {}
+	};
+
+	/**
+	 * @class Encoder_t
+	 * @brief Goes through a mesh, its holes closed, and codes each triangle.
+	 */
+	class Encoder_t final
+	{
+		public:
+			Encoder_t(const VertexContainer& vertices, const TriangleContainer& triangles, RangeEncoder_t& coder, Header_t& header, codec::Report& report)
+			: coder(coder), header(header), report(report), nbVertices(vertices.size()), loops(&edges), previous(SYMBOLS_NUMBER)
+			{
+				const int32_t highest = (1 << header.bits) - 1;
+				this->positions.resize(3*vertices.size());
+				for(uint32_t v=0;v<vertices.size();++v)
+				{
+					const VertexType p[3] = {vertices[v].x(), vertices[v].y(), vertices[v].z()};
+					for(uint32_t i=0;i<3;++i)
+					{
+						const int32_t q = std::lround((p[i] - header.low[i])/header.step);
+						this->positions[3*v+i] = std::min(highest, std::max(0, q));
+					}
+				}
+				this->corners.resize(3*triangles.size());
+				this->neighbors.resize(3*triangles.size());
+				for(uint32_t t=0;t<triangles.size();++t)
+				{
+					std::copy(triangles[t].beginVertice(), triangles[t].beginVertice() + 3, &this->corners[3*t]);
+					std::copy(triangles[t].getNeighbors(), triangles[t].getNeighbors() + 3, &this->neighbors[3*t]);
+				}
+				this->closeHoles();
+				this->visited.assign(this->nbVertices + header.nbHoles, false);
+				this->processed.assign(this->corners.size()/3, false);
+				this->edges.assign(this->corners.size(), -1);
+				this->last[0] = this->last[1] = this->last[2] = 0;
+			}
+			void run(void)
+			{
+				const IndexFace_t nbReal = this->corners.size()/3 - this->header.nbBorders;
+				for(IndexFace_t seed=0;seed<nbReal;++seed)
+				{
+					if (!this->processed[seed])
+					{
+						++this->header.nbComponents;
+						this->component(seed);
+					}
+				}
+				for(IndexVertex_t v=0;v<this->nbVertices;++v)
+				{
+					if (!this->visited[v])
+					{
+						++this->header.nbIsolated;
+						this->vertex(v, nullptr, nullptr, nullptr);
+					}
+				}
+			}
+
+		private:
+			RangeEncoder_t&            coder;
+			Header_t&                  header;
+			codec::Report&             report;
+			IndexVertex_t              nbVertices; //!< The real ones, the virtual ones come after.
+			std::vector<int32_t>       positions;  //!< The quantized coordinates of the real vertices.
+			std::vector<IndexVertex_t> corners;    //!< The 3 vertices of each triangle, the virtual ones after the real ones.
+			std::vector<IndexFace_t>   neighbors;  //!< The 3 neighbors of each triangle.
+			std::vector<bool>          visited;
+			std::vector<bool>          processed;
+			std::vector<int32_t>       edges;      //!< The node of each edge on a loop.
+			Loops_t                    loops;
+			Models_t                   models;
+			uint32_t                   previous;   //!< The previous symbol.
+			int32_t                    last[3];    //!< The previous real vertex coded.
+
+			inline const int32_t* position(IndexVertex_t v) const
+			{
+				return (v < this->nbVertices) ? &this->positions[3*v] : nullptr;
+			}
+
+			/**
+			 * @brief Close every border loop by a fan of virtual triangles around a virtual vertex.
+			 * A manifold vertex has at most one border edge going out of it, so the loops are followed from it.
+			 */
+			void closeHoles(void)
+			{
+				std::vector<int64_t> out(this->nbVertices, -1);
+				const size_t         nbCorners = this->corners.size();
+				for(size_t c=0;c<nbCorners;++c)
+				{
+					if (this->neighbors[c] == -1)
+					{
+						out[this->corners[c - c%3 + (c%3+1)%3]] = c;
+					}
+				}
+				for(size_t start=0;start<nbCorners;++start)
+				{
+					if (this->neighbors[start] != -1)
+					{
+						continue;
+					}
+					const IndexVertex_t hole  = this->nbVertices + this->header.nbHoles++;
+					const IndexFace_t   first = this->corners.size()/3;
+					size_t              c     = start;
+					do
+					{
+						// The border edge u->w of the triangle c/3 gets the virtual triangle (w, u, hole).
+						const IndexFace_t   t = this->corners.size()/3;
+						const IndexVertex_t u = this->corners[c - c%3 + (c%3+1)%3];
+						const IndexVertex_t w = this->corners[c - c%3 + (c%3+2)%3];
+						this->corners.insert(this->corners.end(), {w, u, hole});
+						this->neighbors.insert(this->neighbors.end(), {t-1, t+1, static_cast<IndexFace_t>(c/3)});
+						this->neighbors[c] = t;
+						++this->header.nbBorders;
+						out[u] = -1;
+						c = (out[w] == -1) ? start : out[w];
+					}
+					while(c != start);
+					// The fan is closed between its last and its first triangles.
+					const IndexFace_t end = this->corners.size()/3 - 1;
+					this->neighbors[3*end + 1]   = first;
+					this->neighbors[3*first + 0] = end;
+				}
+			}
+
+			//! @brief Code the coordinates of the real vertex \p v, predicted from a, b and o (nullptr for the previous vertex).
+			void vertex(IndexVertex_t v, const int32_t* a, const int32_t* b, const int32_t* o)
+			{
+				const int32_t* p = this->position(v);
+				int32_t        predicted[3];
+				if (a == nullptr && b == nullptr)
+				{
+					std::copy(this->last, this->last + 3, predicted);
+				}
+				else
+				{
+					predict(a, b, o, this->last, (1 << this->header.bits) - 1, predicted);
+				}
+				for(uint32_t i=0;i<3;++i)
+				{
+					this->report.geometry += encodeNumber(this->coder, this->models.residuals[i], zigzag(p[i] - predicted[i]));
+				}
+				std::copy(p, p + 3, this->last);
+				this->visited[v] = true;
+			}
+			void symbol(Symbol_e s)
+			{
+				this->report.connectivity += this->models.symbols[this->previous].encode(this->coder, s);
+				this->previous = s;
+			}
+
+			void component(IndexFace_t seed)
+			{
+				const IndexVertex_t* ids = &this->corners[3*seed];
+				this->processed[seed] = true;
+				this->previous        = SYMBOLS_NUMBER;
+				for(uint32_t i=0;i<3;++i)
+				{
+					this->vertex(ids[i], nullptr, nullptr, nullptr);
+				}
+				this->loops.start(ids[0], ids[1], ids[2], seed);
+				while(this->step());
+			}
+
+			//! @brief Find the node of \p v whose free side holds the triangle \p face, by turning around \p v until a visited triangle.
+			int32_t occurrence(IndexVertex_t v, IndexFace_t face) const
+			{
+				while(true)
+				{
+					const IndexVertex_t* ids  = &this->corners[3*face];
+					const uint32_t       at   = std::find(ids, ids + 3, v) - ids;
+					if (at == 3)
+					{
+						throw std::invalid_argument("The triangles aren't consistently oriented");
+					}
+					const IndexFace_t    next = this->neighbors[3*face + (at+2)%3]; // Across v->x.
+					if (this->processed[next])
+					{
+						// The edge x->v of the visited triangle goes to the node of v.
+						const IndexVertex_t* around = &this->corners[3*next];
+						const uint32_t       there  = std::find(around, around + 3, v) - around;
+						return this->loops.nodes[this->edges[3*next + (there+1)%3]].next;
+					}
+					face = next;
+				}
+			}
+
+			//! @brief Code the triangle across the gate. @return false once the component is done.
+			bool step(void)
+			{
+				const int32_t       g    = this->loops.gate;
+				const Node_t&       gate = this->loops.nodes[g];
+				const int32_t       nb   = gate.next;
+				const IndexVertex_t a    = gate.vertex;
+				const IndexVertex_t b    = this->loops.nodes[nb].vertex;
+				const IndexFace_t   face = this->neighbors[3*gate.face + gate.slot];
+				const IndexVertex_t* ids = &this->corners[3*face];
+				uint32_t j = 0;
+				while(j < 3 && !(ids[(j+1)%3] == b && ids[(j+2)%3] == a))
+				{
+					++j;
+				}
+				if (j == 3)
+				{
+					throw std::invalid_argument("The triangles aren't consistently oriented");
+				}
+				const IndexVertex_t v      = ids[j];
+				const uint32_t      slotAV = (j+1)%3, slotVB = (j+2)%3;
+				this->processed[face] = true;
+				if (!this->visited[v])
+				{
+					if (v < this->nbVertices)
+					{
+						this->symbol(C);
+						this->vertex(v, this->position(a), this->position(b), this->position(gate.opposite));
+					}
+					else
+					{
+						this->symbol(H);
+						this->visited[v] = true;
+					}
+					this->loops.c(v, face, slotAV, slotVB);
+					return true;
+				}
+				const bool right = this->processed[this->neighbors[3*face + slotVB]];
+				const bool left  = this->processed[this->neighbors[3*face + slotAV]];
+				if (right && left)
+				{
+					this->symbol(E);
+					return this->loops.e();
+				}
+				if (right)
+				{
+					this->symbol(R);
+					this->loops.r(face, slotAV);
+					return true;
+				}
+				if (left)
+				{
+					this->symbol(L);
+					this->loops.l(face, slotVB);
+					return true;
+				}
+				const int32_t y     = this->occurrence(v, face);
+				uint32_t      steps = 0;
+				int32_t       node  = nb;
+				while(node != y && node != g)
+				{
+					node = this->loops.nodes[node].next;
+					++steps;
+				}
+				if (node == y)
+				{
+					this->symbol(S);
+					this->report.connectivity += encodeNumber(this->coder, this->models.offsets, steps);
+					this->loops.splice(y, -1, face, slotAV, slotVB);
+					return true;
+				}
+				// y is on a waiting loop : its position is counted from the gate of this loop.
+				for(steps=0, node=y;!this->loops.nodes[node].stacked;node=this->loops.nodes[node].next)
+				{
+					++steps;
+				}
+				const uint32_t position = std::find(this->loops.stack.begin(), this->loops.stack.end(), node) - this->loops.stack.begin();
+				const uint32_t size     = this->loops.nodes.size();
+				uint32_t       loop     = 0;
+				for(int32_t n=node;(n=this->loops.nodes[n].next)!=node && loop<size;++loop);
+				this->symbol(M);
+				this->report.connectivity += encodeNumber(this->coder, this->models.positions, this->loops.stack.size() - 1 - position);
+				this->report.connectivity += encodeNumber(this->coder, this->models.offsets, (loop + 1 - steps)%(loop + 1));
+				++this->report.handles;
+				this->loops.splice(y, position, face, slotAV, slotVB);
+				return true;
+			}
+	};
+
+	/**
+	 * @class Decoder_t
+	 * @brief Makes the moves of Encoder_t from its symbols, and builds the triangles and their neighbors on the way.
+	 */
+	class Decoder_t final
+	{
+		public:
+			Decoder_t(RangeDecoder_t& coder, const Header_t& header) : coder(coder), header(header), loops(nullptr),
+			                                                          nbReal(0), nbHoles(0), previous(SYMBOLS_NUMBER)
+			{
+				// Only reserved, positions grows with the vertices : a corrupted header may ask for gigabytes.
+				try
+				{
+					const size_t nbTriangles = static_cast<size_t>(header.nbTriangles) + header.nbBorders;
+					this->corners.reserve(3*nbTriangles);
+					this->neighbors.reserve(3*nbTriangles);
+					this->positions.reserve(3*static_cast<size_t>(header.nbVertices));
+				}
+				catch(const std::bad_alloc&)
+				{
+					throw std::runtime_error("Corrupted compressed mesh");
+				}
+				this->last[0] = this->last[1] = this->last[2] = 0;
+			}
+			void run(VertexContainer& vertices, TriangleContainer& triangles)
+			{
+				for(uint32_t c=0;c<this->header.nbComponents;++c)
+				{
+					this->component();
+				}
+				for(uint32_t i=0;i<this->header.nbIsolated;++i)
+				{
+					this->vertex(nullptr, nullptr, nullptr);
+				}
+				if (this->nbReal != this->header.nbVertices || this->nbHoles != this->header.nbHoles ||
+				    this->corners.size() != 3*(static_cast<size_t>(this->header.nbTriangles) + this->header.nbBorders))
+				{
+					throw std::runtime_error("Corrupted compressed mesh");
+				}
+				this->build(vertices, triangles);
+			}
+
+		private:
+			RangeDecoder_t&            coder;
+			const Header_t&            header;
+			Loops_t                    loops;
+			Models_t                   models;
+			std::vector<IndexVertex_t> corners;   //!< The real vertices from 0, the virtual ones from -2 downward.
+			std::vector<IndexFace_t>   neighbors;
+			std::vector<int32_t>       positions;
+			uint32_t                   nbReal;
+			uint32_t                   nbHoles;
+			uint32_t                   previous;
+			int32_t                    last[3];
+
+			inline const int32_t* position(IndexVertex_t v) const
+			{
+				return (v >= 0) ? &this->positions[3*static_cast<size_t>(v)] : nullptr;
+			}
+			IndexVertex_t vertex(const int32_t* a, const int32_t* b, const int32_t* o)
+			{
+				if (this->nbReal == this->header.nbVertices)
+				{
+					throw std::runtime_error("Corrupted compressed mesh");
+				}
+				int32_t predicted[3];
+				if (a == nullptr && b == nullptr)
+				{
+					std::copy(this->last, this->last + 3, predicted);
+				}
+				else
+				{
+					predict(a, b, o, this->last, (1 << this->header.bits) - 1, predicted);
+				}
+				// a, b and o point into positions, which only grows once they're read.
+				this->positions.resize(this->positions.size() + 3);
+				int32_t* p = &this->positions[3*static_cast<size_t>(this->nbReal)];
+				for(uint32_t i=0;i<3;++i)
+				{
+					const int64_t value = static_cast<int64_t>(predicted[i]) + unzigzag(decodeNumber(this->coder, this->models.residuals[i]));
+					if (value < 0 || value >= (INT64_C(1) << this->header.bits))
+					{
+						throw std::runtime_error("Corrupted compressed mesh");
+					}
+					p[i] = value;
+				}
+				std::copy(p, p + 3, this->last);
+				return this->nbReal++;
+			}
+			//! @brief Add the triangle (v0, v1, v2) and get its index.
+			IndexFace_t triangle(IndexVertex_t v0, IndexVertex_t v1, IndexVertex_t v2)
+			{
+				if (this->corners.size() >= 3*(static_cast<size_t>(this->header.nbTriangles) + this->header.nbBorders))
+				{
+					throw std::runtime_error("Corrupted compressed mesh");
+				}
+				this->corners.insert(this->corners.end(), {v0, v1, v2});
+				this->neighbors.insert(this->neighbors.end(), {-1, -1, -1});
+				return this->corners.size()/3 - 1;
+			}
+			inline void link(IndexFace_t f1, uint32_t s1, IndexFace_t f2, uint32_t s2)
+			{
+				this->neighbors[3*static_cast<size_t>(f1) + s1] = f2;
+				this->neighbors[3*static_cast<size_t>(f2) + s2] = f1;
+			}
+
+			void component(void)
+			{
+				this->previous = SYMBOLS_NUMBER;
+				IndexVertex_t ids[3];
+				for(IndexVertex_t& id : ids)
+				{
+					id = this->vertex(nullptr, nullptr, nullptr);
+				}
+				this->loops.start(ids[0], ids[1], ids[2], this->triangle(ids[0], ids[1], ids[2]));
+				while(this->step());
+			}
+
+			//! @brief Decode the triangle across the gate, as (b, a, v). @return false once the component is done.
+			bool step(void)
+			{
+				const int32_t       g    = this->loops.gate;
+				const Node_t        gate = this->loops.nodes[g];
+				const int32_t       nb   = gate.next;
+				const Node_t        next = this->loops.nodes[nb];
+				const Symbol_e      s    = static_cast<Symbol_e>(this->models.symbols[this->previous].decode(this->coder));
+				this->previous = s;
+				IndexVertex_t v  = -1;
+				int32_t       y  = -1;
+				int32_t       at = -1;
+				switch(s)
+				{
+					case C:
+						v = this->vertex(this->position(gate.vertex), this->position(next.vertex), this->position(gate.opposite));
+						break;
+					case H:
+						v = -2 - static_cast<IndexVertex_t>(this->nbHoles++);
+						break;
+					case R:
+					case E:
+						v = this->loops.nodes[next.next].vertex;
+						break;
+					case L:
+						v = this->loops.nodes[gate.prev].vertex;
+						break;
+					case S:
+						y = this->loops.advance(nb, decodeNumber(this->coder, this->models.offsets), g);
+						break;
+					case M:
+					{
+						const uint32_t depth = decodeNumber(this->coder, this->models.positions);
+						if (depth >= this->loops.stack.size())
+						{
+							throw std::runtime_error("Corrupted compressed mesh");
+						}
+						const uint32_t offset = decodeNumber(this->coder, this->models.offsets);
+						if (offset >= this->loops.nodes.size())
+						{
+							throw std::runtime_error("Corrupted compressed mesh");
+						}
+						at = this->loops.stack.size() - 1 - depth;
+						y  = this->loops.advance(this->loops.stack[at], offset, -1);
+						break;
+					}
+					default:
+						throw std::runtime_error("Corrupted compressed mesh");
+				}
+				if (s == S || s == M)
+				{
+					if (y == -1 || y == nb)
+					{
+						throw std::runtime_error("Corrupted compressed mesh");
+					}
+					v = this->loops.nodes[y].vertex;
+				}
+				const IndexFace_t face = this->triangle(next.vertex, gate.vertex, v);
+				this->link(face, 2, gate.face, gate.slot);
+				switch(s)
+				{
+					case C:
+					case H:
+						this->loops.c(v, face, 0, 1);
+						return true;
+					case R:
+						this->link(face, 1, next.face, next.slot);
+						this->loops.r(face, 0);
+						return true;
+					case L:
+					{
+						const Node_t& p = this->loops.nodes[gate.prev];
+						this->link(face, 0, p.face, p.slot);
+						this->loops.l(face, 1);
+						return true;
+					}
+					case E:
+					{
+						const Node_t& p = this->loops.nodes[gate.prev];
+						if (gate.prev != next.next)
+						{
+							throw std::runtime_error("Corrupted compressed mesh");
+						}
+						this->link(face, 1, next.face, next.slot);
+						this->link(face, 0, p.face, p.slot);
+						return this->loops.e();
+					}
+					default:
+						this->loops.splice(y, at, face, 0, 1);
+						return true;
+				}
+			}
+
+			//! @brief Remove the virtual vertices and triangles, and build the Mesh containers.
+			void build(VertexContainer& vertices, TriangleContainer& triangles)
+			{
+				TRACE_SCOPE("build");
+				vertices.resize(this->nbReal);
+				for(uint32_t v=0;v<this->nbReal;++v)
+				{
+					const int32_t* p = &this->positions[3*static_cast<size_t>(v)];
+					vertices[v] = Vertex(this->header.low[0] + p[0]*this->header.step, this->header.low[1] + p[1]*this->header.step,
+					                     this->header.low[2] + p[2]*this->header.step);
+				}
+				const size_t             nbTriangles = this->corners.size()/3;
+				std::vector<IndexFace_t> renumber(nbTriangles, -1);
+				IndexFace_t              nb = 0;
+				for(size_t t=0;t<nbTriangles;++t)
+				{
+					const IndexVertex_t* ids = &this->corners[3*t];
+					renumber[t] = (ids[0] >= 0 && ids[1] >= 0 && ids[2] >= 0) ? nb++ : -1;
+				}
+				triangles.clear();
+				triangles.reserve(nb);
+				for(size_t t=0;t<nbTriangles;++t)
+				{
+					if (renumber[t] == -1)
+					{
+						continue;
+					}
+					const IndexVertex_t* ids = &this->corners[3*t];
+					triangles.push_back(TopoTriangle(ids[0], ids[1], ids[2]));
+					for(uint32_t i=0;i<3;++i)
+					{
+						const IndexFace_t n = this->neighbors[3*t + i];
+						if (n != -1 && renumber[n] != -1)
+						{
+							triangles.back().addNeighbor(renumber[n], {ids[(i+1)%3], ids[(i+2)%3]});
+						}
+						if (vertices[ids[i]].face() == -1)
+						{
+							vertices[ids[i]].face(renumber[t]);
+						}
+					}
+				}
+			}
+	};
+}
+
+codec::Report codec::encode(const VertexContainer& vertices, const TriangleContainer& triangles, std::ostream& out, uint32_t bits)
+{
+	if (bits == 0 || bits > MAX_BITS)
+	{
+		throw std::invalid_argument("The quantization needs between 1 and " + std::to_string(MAX_BITS) + " bits");
+	}
+	if (!components::manifold(components::analyze(vertices, triangles)))
+	{
+		throw std::invalid_argument("Only a manifold mesh can be compressed");
+	}
+	Header_t header;
+	std::memset(&header, 0, sizeof(header));
+	std::copy(MAGIC, MAGIC + 4, header.magic);
+	header.version     = VERSION;
+	header.bits        = bits;
+	header.nbVertices  = vertices.size();
+	header.nbTriangles = triangles.size();
+	VertexType high[3];
+	std::fill(header.low, header.low + 3,  std::numeric_limits<VertexType>::max());
+	std::fill(high,       high + 3,       -std::numeric_limits<VertexType>::max());
+	for(const Vertex& v : vertices)
+	{
+		const VertexType p[3] = {v.x(), v.y(), v.z()};
+		for(uint32_t i=0;i<3;++i)
+		{
+			header.low[i] = std::min(header.low[i], p[i]);
+			high[i]       = std::max(high[i],       p[i]);
+		}
+	}
+	VertexType extent = 0.0;
+	for(uint32_t i=0;i<3 && !vertices.empty();++i)
+	{
+		extent = std::max(extent, high[i] - header.low[i]);
+	}
+	header.step = (extent > 0.0) ? extent/((1u << bits) - 1) : 1.0;
+	// The counts of the header are only known once coded : the stream goes into a buffer first.
+	std::stringstream  payload(std::ios::in | std::ios::out | std::ios::binary);
+	Report             report = Report();
+	RangeEncoder_t     coder(payload);
+	{
+		TRACE_SCOPE("edgebreaker");
+		Encoder_t encoder(vertices, triangles, coder, header, report);
+		encoder.run();
+	}
+	const uint64_t size = coder.close();
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out << payload.rdbuf();
+	if (!out.good())
+	{
+		throw std::runtime_error("Unable to write the compressed mesh");
+	}
+	report.bytes      = sizeof(header) + size;
+	report.components = header.nbComponents;
+	report.holes      = header.nbHoles;
+	return report;
+}
+
+void codec::decode(std::istream& in, VertexContainer& vertices, TriangleContainer& triangles)
+{
+	Header_t header;
+	in.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (in.gcount() != sizeof(header) || !std::equal(MAGIC, MAGIC + 4, header.magic))
+	{
+		throw std::runtime_error("Not a compressed mesh");
+	}
+	if (header.version != VERSION || header.bits == 0 || header.bits > MAX_BITS)
+	{
+		throw std::runtime_error("Unknown version of compressed mesh");
+	}
+	RangeDecoder_t coder(in);
+	Decoder_t      decoder(coder, header);
+	decoder.run(vertices, triangles);
+}
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <utility>
+
+#include "components.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	typedef std::pair<IndexVertex_t, IndexVertex_t> Edge_t;
+
+	/**
+	 * @class UnionFind_t
+	 * @brief A union-find which can be shared by every thread without lock : a root only becomes a child
+	 * by a compare and swap of its own parent, and always under the smaller root, so no cycle can appear.
+	 * The paths are halved on the way by benign compare and swaps, which may fail.
+	 */
+	class UnionFind_t final
+	{
+		public:
+			/**
+			 * @param[in] size   The number of elements.
+			 * @param[in] joined true for every element to be its own set, false for none to be in any set before touch().
+			 */
+			UnionFind_t(int32_t size, bool joined) : parents(new std::atomic<int32_t>[size])
+			{
+				#pragma omp parallel for schedule(static)
+				for(int32_t i=0;i<size;++i)
+				{
+					this->parents[i].store(joined ? i : -1, std::memory_order_relaxed);
+				}
+			}
+			//! @brief Put \p x in its own set, if it isn't in one yet.
+			inline void touch(int32_t x)
+			{
+				int32_t none = -1;
+				this->parents[x].compare_exchange_strong(none, x, std::memory_order_relaxed);
+			}
+			inline int32_t find(int32_t x)
+			{
+				int32_t parent = this->parents[x].load(std::memory_order_relaxed);
+				while(parent != x)
+				{
+					const int32_t grandParent = this->parents[parent].load(std::memory_order_relaxed);
+					if (grandParent != parent)
+					{
+						this->parents[x].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+					}
+					x      = grandParent;
+					parent = this->parents[x].load(std::memory_order_relaxed);
+				}
+				return x;
+			}
+			/**
+			 * @brief Join the sets of \p a and \p b.
+			 * @return true if they were different.
+			 */
+			bool unite(int32_t a, int32_t b)
+			{
+				while(true)
+				{
+					a = this->find(a);
+					b = this->find(b);
+					if (a == b)
+					{
+						return false;
+					}
+					int32_t high = std::max(a, b);
+					// Fails if another thread has given a parent to this root meanwhile, then both are searched again.
+					if (this->parents[high].compare_exchange_strong(high, std::min(a, b), std::memory_order_relaxed))
+					{
+						return true;
+					}
+				}
+			}
+			//! @brief Get the parent of \p x, -1 if it isn't in any set.
+			inline int32_t parent(int32_t x) const
+			{
+				return this->parents[x].load(std::memory_order_relaxed);
+			}
+
+		private:
+			std::unique_ptr<std::atomic<int32_t>[]> parents;
+	};
+
+	/**
+	 * @brief Count the triangles met by turning around \p v from \p start across its edge \p first (a slot of \p start),
+	 * until a border or back to \p start.
+	 * @return The number of triangles met, \p start excluded, and if \p start has been reached again.
+	 * The number is over \p limit if the triangles don't make a fan (a neighbor which doesn't link back).
+	 */
+	std::pair<uint32_t, bool> turn(const TriangleContainer& triangles, IndexVertex_t v, IndexFace_t start, uint32_t first, uint32_t limit)
+	{
+		IndexFace_t previous = start;
+		IndexFace_t current  = triangles[start].getNeighbors()[first];
+		uint32_t    met      = 0;
+		while(current != -1 && current != start)
+		{
+			const TopoTriangle& t = triangles[current];
+			const int32_t       i = t.findVertexIndex(v);
+			const IndexFace_t*  n = t.getNeighbors();
+			if (i == -1 || ++met > limit)
+			{
+				return std::make_pair(limit + 1, false);
+			}
+			IndexFace_t next = (n[(i+1)%3] == previous) ? n[(i+2)%3] : (n[(i+2)%3] == previous) ? n[(i+1)%3] : -2;
+			if (next == -2)
+			{
+				return std::make_pair(limit + 1, false);
+			}
+			previous = current;
+			current  = next;
+		}
+		return std::make_pair(met, current == start);
+	}
+}
+
+components::Report components::analyze(const VertexContainer& vertices, const TriangleContainer& triangles)
+{
+	const int32_t nbTriangles = triangles.size();
+	const int32_t nbVertices  = vertices.size();
+	Report        report      = Report();
+	UnionFind_t   faces(nbTriangles, true);
+	UnionFind_t   borders(nbVertices, false);
+	std::unique_ptr<std::atomic<uint32_t>[]> corners(new std::atomic<uint32_t>[nbVertices]);
+	#pragma omp parallel for schedule(static)
+	for(int32_t v=0;v<nbVertices;++v)
+	{
+		corners[v].store(0, std::memory_order_relaxed);
+	}
+	// The non manifold edges are rare : each thread keeps them, and they are only made unique at the end.
+	std::vector<std::vector<Edge_t>> broken(parallel::maxThreads());
+	uint64_t                         borderEdges = 0;
+	#pragma omp parallel for schedule(static) reduction(+:borderEdges)
+	for(int32_t f=0;f<nbTriangles;++f)
+	{
+		const TopoTriangle&  t         = triangles[f];
+		const IndexVertex_t* ids       = t.beginVertice();
+		const IndexFace_t*   neighbors = t.getNeighbors();
+		for(uint32_t i=0;i<3;++i)
+		{
+			corners[ids[i]].fetch_add(1, std::memory_order_relaxed);
+			const IndexVertex_t a = ids[(i+1)%3], b = ids[(i+2)%3];
+			const IndexFace_t   n = neighbors[i];
+			if (n == -1)
+			{
+				++borderEdges;
+				borders.touch(a);
+				borders.touch(b);
+				borders.unite(a, b);
+			}
+			else if (n < 0 || n >= nbTriangles || triangles[n].getOppositeVertexOf(f) == -1)
+			{
+				broken[parallel::threadIndex()].push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+				if (n >= 0 && n < nbTriangles)
+				{
+					faces.unite(f, n);
+				}
+			}
+			else if (n > f)
+			{
+				faces.unite(f, n);
+			}
+		}
+	}
+	report.borderEdges = borderEdges;
+	std::vector<Edge_t> edges;
+	for(const std::vector<Edge_t>& partial : broken)
+	{
+		edges.insert(edges.end(), partial.begin(), partial.end());
+	}
+	std::sort(edges.begin(), edges.end());
+	report.nonManifoldEdges = std::unique(edges.begin(), edges.end()) - edges.begin();
+	// The triangles of a manifold vertex are a single fan, met by turning around it from its face.
+	uint64_t nonManifold = 0, isolated = 0, loops = 0;
+	#pragma omp parallel for schedule(static) reduction(+:nonManifold, isolated, loops)
+	for(int32_t v=0;v<nbVertices;++v)
+	{
+		const uint32_t    around = corners[v].load(std::memory_order_relaxed);
+		const IndexFace_t start  = vertices[v].face();
+		loops += (borders.parent(v) == v) ? 1 : 0;
+		if (around == 0)
+		{
+			++isolated;
+			continue;
+		}
+		const int32_t i = (start >= 0 && start < nbTriangles) ? triangles[start].findVertexIndex(v) : -1;
+		if (i == -1)
+		{
+			++nonManifold;
+			continue;
+		}
+		std::pair<uint32_t, bool> fan = turn(triangles, v, start, (i+1)%3, around);
+		uint32_t                  met = 1 + fan.first;
+		if (!fan.second && met <= around)
+		{
+			met += turn(triangles, v, start, (i+2)%3, around).first;
+		}
+		nonManifold += (met != around) ? 1 : 0;
+	}
+	report.nonManifoldVertices = nonManifold;
+	report.isolatedVertices    = isolated;
+	report.boundaryLoops       = loops;
+	// A root is the smallest triangle of its component, so it is numbered before any other triangle of it.
+	report.labels.resize(nbTriangles);
+	#pragma omp parallel for schedule(static)
+	for(int32_t f=0;f<nbTriangles;++f)
+	{
+		report.labels[f] = faces.find(f);
+	}
+	uint32_t nbComponents = 0;
+	for(int32_t f=0;f<nbTriangles;++f)
+	{
+		report.labels[f] = (report.labels[f] == static_cast<uint32_t>(f)) ? nbComponents++ : report.labels[report.labels[f]];
+	}
+	report.offsets.assign(nbComponents + 1, 0);
+	for(uint32_t label : report.labels)
+	{
+		++report.offsets[label + 1];
+	}
+	std::partial_sum(report.offsets.begin(), report.offsets.end(), report.offsets.begin());
+	report.triangles.resize(nbTriangles);
+	std::vector<uint32_t> next(report.offsets.begin(), report.offsets.end() - 1);
+	for(int32_t f=0;f<nbTriangles;++f)
+	{
+		report.triangles[next[report.labels[f]]++] = f;
+	}
+	return report;
+}
+
+bool components::manifold(const Report& report)
+{
+	return report.nonManifoldEdges == 0 && report.nonManifoldVertices == 0;
+}
+
+std::string components::format(const Report& report)
+{
+	std::ostringstream out;
+	out << count(report) << " component(s)";
+	if (count(report) > 0)
+	{
+		uint32_t biggest = 0;
+		for(uint32_t c=0;c<count(report);++c)
+		{
+			biggest = std::max(biggest, report.offsets[c+1] - report.offsets[c]);
+		}
+		out << " (biggest " << biggest << " triangles)";
+	}
+	out << ", " << report.boundaryLoops << " boundary loop(s) of " << report.borderEdges << " edges, "
+	    << report.nonManifoldEdges << " non manifold edge(s), " << report.nonManifoldVertices << " non manifold vertices, "
+	    << report.isolatedVertices << " isolated vertices" << (manifold(report) ? " : manifold" : " : NOT MANIFOLD");
+	return out.str();
+}
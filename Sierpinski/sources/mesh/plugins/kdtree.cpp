@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "kdtree.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	const uint32_t TASK = 4096; //!< The smallest range split by another thread.
+
+	typedef std::pair<VertexType, IndexVertex_t> Candidate_t; //!< A squared distance and its vertex.
+
+	inline VertexType coordinate(const Vertex& v, int32_t axis)
+	{
+		return (axis == 0) ? v.x() : (axis == 1) ? v.y() : v.z();
+	}
+	inline VertexType distance2(const VertexType* a, const Vertex& b)
+	{
+		VertexType dx = a[0]-b.x(), dy = a[1]-b.y(), dz = a[2]-b.z();
+		return dx*dx + dy*dy + dz*dz;
+	}
+
+	/**
+	 * @brief Split the range [\p begin, \p end[ of the node \p node at the median of its biggest extent,
+	 * then its children, the big ones as OpenMP tasks.
+	 */
+	void split(kdtree::Tree& tree, const VertexContainer& vertices, uint32_t node, uint32_t begin, uint32_t end)
+	{
+		if (end - begin <= kdtree::LEAF)
+		{
+			tree.nodes[node] = {0.0, -1};
+			return;
+		}
+		VertexType low[3]  = { std::numeric_limits<VertexType>::max(),  std::numeric_limits<VertexType>::max(),  std::numeric_limits<VertexType>::max()};
+		VertexType high[3] = {-std::numeric_limits<VertexType>::max(), -std::numeric_limits<VertexType>::max(), -std::numeric_limits<VertexType>::max()};
+		for(uint32_t i=begin;i<end;++i)
+		{
+			for(int32_t axis=0;axis<3;++axis)
+			{
+				VertexType c = coordinate(vertices[tree.indexes[i]], axis);
+				low[axis]  = std::min(low[axis], c);
+				high[axis] = std::max(high[axis], c);
+			}
+		}
+		int32_t axis = 0;
+		for(int32_t a=1;a<3;++a)
+		{
+			if (high[a] - low[a] > high[axis] - low[axis])
+			{
+				axis = a;
+			}
+		}
+		const uint32_t middle = (begin + end)/2;
+		std::nth_element(tree.indexes.begin() + begin, tree.indexes.begin() + middle, tree.indexes.begin() + end,
+		                 [&](IndexVertex_t a, IndexVertex_t b){return coordinate(vertices[a], axis) < coordinate(vertices[b], axis);});
+		tree.nodes[node] = {coordinate(vertices[tree.indexes[middle]], axis), axis};
+		#pragma omp task shared(tree, vertices) if(end - begin > TASK)
+		split(tree, vertices, 2*node+1, begin, middle);
+		split(tree, vertices, 2*node+2, middle, end);
+		#pragma omp taskwait
+	}
+
+	/**
+	 * @brief The \p k nearest vertices found so far, sorted by distance.
+	 */
+	void nearestIn(const kdtree::Tree& tree, uint32_t node, uint32_t begin, uint32_t end, const Vertex& point, uint32_t k, std::vector<Candidate_t>& best)
+	{
+		const kdtree::Node& n = tree.nodes[node];
+		if (n.axis == -1)
+		{
+			for(uint32_t i=begin;i<end;++i)
+			{
+				VertexType d = distance2(&tree.points[3*i], point);
+				if (best.size() < k || d < best.back().first)
+				{
+					if (best.size() == k)
+					{
+						best.pop_back();
+					}
+					best.insert(std::upper_bound(best.begin(), best.end(), Candidate_t(d, tree.indexes[i])), Candidate_t(d, tree.indexes[i]));
+				}
+			}
+			return;
+		}
+		const uint32_t   middle = (begin + end)/2;
+		const VertexType diff   = coordinate(point, n.axis) - n.split;
+		if (diff < 0.0)
+		{
+			nearestIn(tree, 2*node+1, begin, middle, point, k, best);
+			if (best.size() < k || diff*diff < best.back().first)
+			{
+				nearestIn(tree, 2*node+2, middle, end, point, k, best);
+			}
+		}
+		else
+		{
+			nearestIn(tree, 2*node+2, middle, end, point, k, best);
+			if (best.size() < k || diff*diff < best.back().first)
+			{
+				nearestIn(tree, 2*node+1, begin, middle, point, k, best);
+			}
+		}
+	}
+
+	//! @brief Append every vertex at a squared distance of \p radius2 or less of \p point to \p out.
+	void radiusIn(const kdtree::Tree& tree, uint32_t node, uint32_t begin, uint32_t end, const Vertex& point, VertexType radius2, std::vector<IndexVertex_t>& out)
+	{
+		const kdtree::Node& n = tree.nodes[node];
+		if (n.axis == -1)
+		{
+			for(uint32_t i=begin;i<end;++i)
+			{
+				if (distance2(&tree.points[3*i], point) <= radius2)
+				{
+					out.push_back(tree.indexes[i]);
+				}
+			}
+			return;
+		}
+		const uint32_t   middle = (begin + end)/2;
+		const VertexType diff   = coordinate(point, n.axis) - n.split;
+		if (diff <= 0.0 || diff*diff <= radius2)
+		{
+			radiusIn(tree, 2*node+1, begin, middle, point, radius2, out);
+		}
+		if (diff >= 0.0 || diff*diff <= radius2)
+		{
+			radiusIn(tree, 2*node+2, middle, end, point, radius2, out);
+		}
+	}
+}
+
+kdtree::Tree kdtree::build(const VertexContainer& vertices)
+{
+	Tree tree;
+	const uint32_t nb = vertices.size();
+	// The depth where every range fits in a leaf, since the ranges are halved.
+	uint32_t depth = 0;
+	while((nb + (1u << depth) - 1) >> depth > LEAF)
+	{
+		++depth;
+	}
+	tree.nodes.resize((2u << depth) - 1);
+	tree.indexes.resize(nb);
+	std::iota(tree.indexes.begin(), tree.indexes.end(), 0);
+	#pragma omp parallel
+	{
+		#pragma omp single
+		split(tree, vertices, 0, 0, nb);
+	}
+	tree.points.resize(3*nb);
+	#pragma omp parallel for schedule(static)
+	for(uint32_t i=0;i<nb;++i)
+	{
+		const Vertex& v = vertices[tree.indexes[i]];
+		tree.points[3*i]   = v.x();
+		tree.points[3*i+1] = v.y();
+		tree.points[3*i+2] = v.z();
+	}
+	return tree;
+}
+
+std::vector<IndexVertex_t> kdtree::nearest(const Tree& tree, const Vertex& point, uint32_t k)
+{
+	std::vector<Candidate_t> best;
+	best.reserve(k+1);
+	if (k > 0)
+	{
+		nearestIn(tree, 0, 0, tree.indexes.size(), point, k, best);
+	}
+	std::vector<IndexVertex_t> result(best.size());
+	std::transform(best.begin(), best.end(), result.begin(), [](const Candidate_t& c){return c.second;});
+	return result;
+}
+
+std::vector<IndexVertex_t> kdtree::nearest(const Tree& tree, const VertexContainer& points, uint32_t k)
+{
+	const int32_t              nb = points.size();
+	std::vector<IndexVertex_t> result(static_cast<size_t>(nb)*k, -1);
+	if (k == 0)
+	{
+		return result;
+	}
+	#pragma omp parallel
+	{
+		std::vector<Candidate_t> best;
+		best.reserve(k+1);
+		#pragma omp for schedule(dynamic, 64)
+		for(int32_t q=0;q<nb;++q)
+		{
+			best.clear();
+			nearestIn(tree, 0, 0, tree.indexes.size(), points[q], k, best);
+			for(uint32_t i=0;i<best.size();++i)
+			{
+				result[static_cast<size_t>(q)*k + i] = best[i].second;
+			}
+		}
+	}
+	return result;
+}
+
+std::vector<IndexVertex_t> kdtree::withinRadius(const Tree& tree, const Vertex& point, VertexType radius)
+{
+	std::vector<IndexVertex_t> result;
+	radiusIn(tree, 0, 0, tree.indexes.size(), point, radius*radius, result);
+	return result;
+}
+
+kdtree::Neighborhoods kdtree::withinRadius(const Tree& tree, const VertexContainer& points, VertexType radius)
+{
+	Neighborhoods neighborhoods;
+	const int32_t nb = points.size();
+	neighborhoods.offsets.assign(nb+1, 0);
+	// The static schedule gives each thread a contiguous range, in the order of the threads,
+	// so their answers are put back together in the order of the queries.
+	std::vector<std::vector<IndexVertex_t>> partials(parallel::maxThreads());
+	#pragma omp parallel for schedule(static)
+	for(int32_t q=0;q<nb;++q)
+	{
+		std::vector<IndexVertex_t>& partial = partials[parallel::threadIndex()];
+		const size_t                before  = partial.size();
+		radiusIn(tree, 0, 0, tree.indexes.size(), points[q], radius*radius, partial);
+		neighborhoods.offsets[q+1] = partial.size() - before;
+	}
+	std::partial_sum(neighborhoods.offsets.begin(), neighborhoods.offsets.end(), neighborhoods.offsets.begin());
+	neighborhoods.indexes.reserve(neighborhoods.offsets.back());
+	for(const std::vector<IndexVertex_t>& partial : partials)
+	{
+		neighborhoods.indexes.insert(neighborhoods.indexes.end(), partial.begin(), partial.end());
+	}
+	return neighborhoods;
+}
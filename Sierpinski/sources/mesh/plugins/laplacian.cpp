@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+
+#include "laplacian.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	/**
+	 * @brief Get the position of \p v inside \p t.
+	 * @return A value between [0, 2].
+	 */
+	inline uint32_t localIndex(const TopoTriangle& t, IndexVertex_t v)
+	{
+		return std::find(t.beginVertice(), t.endVertice(), v) - t.beginVertice();
+	}
+	/**
+	 * @brief Set \p o as an opposite vertex of the entry \p e, if it has room for it.
+	 * An edge shared by more than 2 triangles (non-manifold) only keeps the first 2.
+	 */
+	inline void addOpposite(laplacian::Matrix& matrix, uint32_t e, IndexVertex_t o)
+	{
+		if (matrix.opposites[2*e] == -1)
+		{
+			matrix.opposites[2*e] = o;
+		}
+		else if (matrix.opposites[2*e+1] == -1)
+		{
+			matrix.opposites[2*e+1] = o;
+		}
+	}
+	/**
+	 * @brief Get the cotangent of the angle at \p o of the triangle \p v, \p w, \p o.
+	 * @return 0 if there is no \p o, or if the triangle is flat.
+	 */
+	inline VertexType cotangent(const Vertex* p, IndexVertex_t v, IndexVertex_t w, IndexVertex_t o)
+	{
+		if (o == -1)
+		{
+			return 0.0;
+		}
+		VertexType ux = p[v].x()-p[o].x(), uy = p[v].y()-p[o].y(), uz = p[v].z()-p[o].z();
+		VertexType tx = p[w].x()-p[o].x(), ty = p[w].y()-p[o].y(), tz = p[w].z()-p[o].z();
+		VertexType cx = uy*tz - uz*ty;
+		VertexType cy = uz*tx - ux*tz;
+		VertexType cz = ux*ty - uy*tx;
+		VertexType sine = std::sqrt(cx*cx + cy*cy + cz*cz);
+		return (sine > 0.0) ? (ux*tx + uy*ty + uz*tz)/sine : 0.0;
+	}
+}
+
+laplacian::Matrix laplacian::build(const VertexContainer& vertices, const TriangleContainer& triangles, const adjacency::Vertices& adjacency)
+{
+	Matrix matrix;
+	const int32_t nbV = vertices.size();
+	// Each row is the one-ring of its vertex, with its diagonal in front.
+	matrix.offsets.resize(nbV+1);
+	#pragma omp parallel for schedule(static)
+	for(int32_t v=0;v<=nbV;++v)
+	{
+		matrix.offsets[v] = adjacency.vertexOffsets[v] + v;
+	}
+	matrix.columns.resize(matrix.offsets.back());
+	matrix.opposites.assign(2*matrix.offsets.back(), -1);
+	matrix.values.resize(matrix.offsets.back());
+	#pragma omp parallel for schedule(dynamic, 256)
+	for(int32_t v=0;v<nbV;++v)
+	{
+		const uint32_t row = matrix.offsets[v];
+		const uint32_t end = matrix.offsets[v+1];
+		matrix.columns[row] = v;
+		std::copy(adjacency.vertices.begin() + adjacency.vertexOffsets[v], adjacency.vertices.begin() + adjacency.vertexOffsets[v+1],
+		          matrix.columns.begin() + row + 1);
+		auto entry = [&](IndexVertex_t w) -> uint32_t {
+			return std::find(matrix.columns.begin() + row + 1, matrix.columns.begin() + end, w) - matrix.columns.begin();
+		};
+		// In each triangle around v, the edge to a vertex is opposite to the other one.
+		for(uint32_t i=adjacency.triangleOffsets[v];i<adjacency.triangleOffsets[v+1];++i)
+		{
+			const TopoTriangle&  t     = triangles[adjacency.triangles[i]];
+			const IndexVertex_t* ids   = t.beginVertice();
+			const uint32_t       local = localIndex(t, v);
+			const IndexVertex_t  a     = ids[(local+1)%3];
+			const IndexVertex_t  b     = ids[(local+2)%3];
+			addOpposite(matrix, entry(a), b);
+			addOpposite(matrix, entry(b), a);
+		}
+	}
+	update(vertices, matrix);
+	return matrix;
+}
+
+void laplacian::update(const VertexContainer& vertices, Matrix& matrix)
+{
+	const int32_t        nbV       = matrix.offsets.size() - 1;
+	const Vertex*        p         = vertices.data();
+	const IndexVertex_t* columns   = matrix.columns.data();
+	const IndexVertex_t* opposites = matrix.opposites.data();
+	VertexType*          values    = matrix.values.data();
+	#pragma omp parallel for schedule(static)
+	for(int32_t v=0;v<nbV;++v)
+	{
+		VertexType sum = 0.0;
+		for(uint32_t e=matrix.offsets[v]+1;e<matrix.offsets[v+1];++e)
+		{
+			values[e] = (cotangent(p, v, columns[e], opposites[2*e]) + cotangent(p, v, columns[e], opposites[2*e+1]))/2.0;
+			sum      += values[e];
+		}
+		values[matrix.offsets[v]] = -sum;
+	}
+}
+
+laplacian::Curvatures laplacian::curvatures(const VertexContainer& vertices, const TriangleContainer& triangles, const adjacency::Vertices& adjacency, const Matrix& matrix)
+{
+	Curvatures curvatures;
+	const int32_t nbV = vertices.size();
+	curvatures.mean.assign(nbV, 0.0);
+	curvatures.gaussian.assign(nbV, 0.0);
+	curvatures.areas.assign(nbV, 0.0);
+	#pragma omp parallel for schedule(dynamic, 256)
+	for(int32_t v=0;v<nbV;++v)
+	{
+		if (adjacency.kinds[v] != adjacency::INTERIOR && adjacency.kinds[v] != adjacency::BORDER)
+		{
+			continue;
+		}
+		const Vertex& p = vertices[v];
+		// The mixed voronoi area, the sum of the angles and the normal, from the triangles around v.
+		VertexType area = 0.0, angles = 0.0, nx = 0.0, ny = 0.0, nz = 0.0;
+		for(uint32_t i=adjacency.triangleOffsets[v];i<adjacency.triangleOffsets[v+1];++i)
+		{
+			const TopoTriangle&  t     = triangles[adjacency.triangles[i]];
+			const IndexVertex_t* ids   = t.beginVertice();
+			const uint32_t       local = localIndex(t, v);
+			const Vertex&        q     = vertices[ids[(local+1)%3]];
+			const Vertex&        r     = vertices[ids[(local+2)%3]];
+			VertexType pqx = q.x()-p.x(), pqy = q.y()-p.y(), pqz = q.z()-p.z();
+			VertexType prx = r.x()-p.x(), pry = r.y()-p.y(), prz = r.z()-p.z();
+			VertexType qrx = r.x()-q.x(), qry = r.y()-q.y(), qrz = r.z()-q.z();
+			VertexType cx  = pqy*prz - pqz*pry;
+			VertexType cy  = pqz*prx - pqx*prz;
+			VertexType cz  = pqx*pry - pqy*prx;
+			VertexType twiceArea = std::sqrt(cx*cx + cy*cy + cz*cz);
+			if (twiceArea == 0.0)
+			{
+				continue;
+			}
+			VertexType atP =  pqx*prx + pqy*pry + pqz*prz;
+			VertexType atQ = -pqx*qrx - pqy*qry - pqz*qrz;
+			VertexType atR =  prx*qrx + pry*qry + prz*qrz;
+			if (atP >= 0.0 && atQ >= 0.0 && atR >= 0.0)
+			{
+				VertexType pq2 = pqx*pqx + pqy*pqy + pqz*pqz;
+				VertexType pr2 = prx*prx + pry*pry + prz*prz;
+				area += (pr2*atQ + pq2*atR)/(8.0*twiceArea);
+			}
+			else // An obtuse triangle, its voronoi region goes out of it.
+			{
+				area += (atP < 0.0) ? twiceArea/4.0 : twiceArea/8.0;
+			}
+			angles += std::atan2(twiceArea, atP);
+			nx += cx;
+			ny += cy;
+			nz += cz;
+		}
+		if (area == 0.0)
+		{
+			continue;
+		}
+		// The mean curvature normal is (L*p)(v)/area = -2*H*n.
+		VertexType lx = 0.0, ly = 0.0, lz = 0.0;
+		for(uint32_t e=matrix.offsets[v]+1;e<matrix.offsets[v+1];++e)
+		{
+			const Vertex& w = vertices[matrix.columns[e]];
+			lx += matrix.values[e]*(w.x() - p.x());
+			ly += matrix.values[e]*(w.y() - p.y());
+			lz += matrix.values[e]*(w.z() - p.z());
+		}
+		VertexType length = std::sqrt(nx*nx + ny*ny + nz*nz);
+		curvatures.areas[v]    = area;
+		curvatures.mean[v]     = (length > 0.0) ? -(lx*nx + ly*ny + lz*nz)/(2.0*area*length) : 0.0;
+		curvatures.gaussian[v] = (((adjacency.kinds[v] == adjacency::INTERIOR) ? 2.0*M_PI : M_PI) - angles)/area;
+	}
+	return curvatures;
+}
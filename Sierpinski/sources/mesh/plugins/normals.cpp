@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cmath>
+
+#include "normals.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	/**
+	 * @brief Compute the unit normal of the triangle \p c, and the weight of each of its corners.
+	 * @param[in]  v      The vertices.
+	 * @param[in]  c      The 3 vertices of the triangle, counter-clockwise.
+	 * @param[in]  angle  true to weight by the angles, false by the area.
+	 * @param[out] normal The 3 coordinates of the normal.
+	 * @param[out] weight The 3 weights.
+	 */
+	inline void faceNormal(const Vertex* v, const IndexVertex_t* c, bool angle, VertexType* normal, VertexType* weight)
+	{
+		const Vertex& a = v[c[0]];
+		const Vertex& b = v[c[1]];
+		const Vertex& d = v[c[2]];
+		VertexType abx = b.x()-a.x(), aby = b.y()-a.y(), abz = b.z()-a.z();
+		VertexType adx = d.x()-a.x(), ady = d.y()-a.y(), adz = d.z()-a.z();
+		VertexType nx  = aby*adz - abz*ady;
+		VertexType ny  = abz*adx - abx*adz;
+		VertexType nz  = abx*ady - aby*adx;
+		VertexType length  = std::sqrt(nx*nx + ny*ny + nz*nz);
+		VertexType inverse = (length > 0.0) ? 1.0/length : 0.0;
+		normal[0] = nx*inverse;
+		normal[1] = ny*inverse;
+		normal[2] = nz*inverse;
+		if (angle)
+		{
+			// Every corner shares the same cross product norm, only the dot products differ.
+			VertexType bdx = d.x()-b.x(), bdy = d.y()-b.y(), bdz = d.z()-b.z();
+			weight[0] = std::atan2(length,  abx*adx + aby*ady + abz*adz);
+			weight[1] = std::atan2(length, -abx*bdx - aby*bdy - abz*bdz);
+			weight[2] = M_PI - weight[0] - weight[1];
+		}
+		else
+		{
+			weight[0] = weight[1] = weight[2] = length/2.0;
+		}
+	}
+
+	/**
+	 * @brief Add (\p sign = 1) or remove (\p sign = -1) the contributions of the triangle \p f to its vertices.
+	 */
+	inline void accumulate(normals::Normals& normals, IndexFace_t f, VertexType sign)
+	{
+		for(uint32_t i=0;i<3;++i)
+		{
+			VertexType*       sum    = &normals.sums[3*normals.corners[3*f+i]];
+			const VertexType  weight = sign*normals.weights[3*f+i];
+			const VertexType* normal = &normals.faces[3*f];
+			sum[0] += weight*normal[0];
+			sum[1] += weight*normal[1];
+			sum[2] += weight*normal[2];
+		}
+	}
+
+	//! @brief Get the normal of the vertex \p v from its sum.
+	inline void normalize(normals::Normals& normals, IndexVertex_t v)
+	{
+		const VertexType* sum     = &normals.sums[3*v];
+		VertexType        length  = std::sqrt(sum[0]*sum[0] + sum[1]*sum[1] + sum[2]*sum[2]);
+		VertexType        inverse = (length > 0.0) ? 1.0/length : 0.0;
+		normals.vertices[3*v]   = sum[0]*inverse;
+		normals.vertices[3*v+1] = sum[1]*inverse;
+		normals.vertices[3*v+2] = sum[2]*inverse;
+	}
+}
+
+normals::Normals normals::build(const VertexContainer& vertices, const TriangleContainer& triangles, Weighting_e weighting)
+{
+	Normals normals;
+	const int32_t nbT = triangles.size();
+	const int32_t nbV = vertices.size();
+	normals.weighting = weighting;
+	normals.corners.resize(3*nbT);
+	normals.faces.resize(3*nbT);
+	normals.weights.resize(3*nbT);
+	normals.sums.assign(3*nbV, 0.0);
+	normals.vertices.resize(3*nbV);
+	// The indexes first, so the loop over the triangles only reads flat arrays.
+	IndexVertex_t* corners = normals.corners.data();
+	#pragma omp parallel for schedule(static)
+	for(int32_t f=0;f<nbT;++f)
+	{
+		std::copy(triangles[f].beginVertice(), triangles[f].endVertice(), corners + 3*f);
+	}
+	const Vertex* coords  = vertices.data();
+	const bool    angle   = weighting == ANGLE;
+	VertexType*   faces   = normals.faces.data();
+	VertexType*   weights = normals.weights.data();
+	#pragma omp parallel for simd schedule(static)
+	for(int32_t f=0;f<nbT;++f)
+	{
+		faceNormal(coords, corners + 3*f, angle, faces + 3*f, weights + 3*f);
+	}
+	// Sequential, the vertices are shared between the triangles.
+	for(int32_t f=0;f<nbT;++f)
+	{
+		accumulate(normals, f, 1.0);
+	}
+	#pragma omp parallel for schedule(static)
+	for(int32_t v=0;v<nbV;++v)
+	{
+		normalize(normals, v);
+	}
+	return normals;
+}
+
+void normals::update(const VertexContainer& vertices, const TriangleContainer& triangles, const std::vector<IndexFace_t>& changed, Normals& normals)
+{
+	const int32_t previous = normals.corners.size()/3;
+	const int32_t nbT      = triangles.size();
+	const int32_t nbV      = vertices.size();
+	// The rewritten triangles, then the new ones.
+	std::vector<IndexFace_t> faces;
+	faces.reserve(changed.size() + std::max(0, nbT - previous));
+	for(IndexFace_t f : changed)
+	{
+		if (f >= 0 && f < previous)
+		{
+			faces.push_back(f);
+		}
+	}
+	std::sort(faces.begin(), faces.end());
+	faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+	const int32_t nbChanged = faces.size();
+	for(IndexFace_t f=previous;f<nbT;++f)
+	{
+		faces.push_back(f);
+	}
+	std::vector<IndexVertex_t> touched;
+	touched.reserve(6*faces.size());
+	for(int32_t i=0;i<nbChanged;++i)
+	{
+		accumulate(normals, faces[i], -1.0);
+		touched.insert(touched.end(), &normals.corners[3*faces[i]], &normals.corners[3*faces[i]] + 3);
+	}
+	normals.corners.resize(3*nbT);
+	normals.faces.resize(3*nbT);
+	normals.weights.resize(3*nbT);
+	normals.sums.resize(3*nbV, 0.0);
+	normals.vertices.resize(3*nbV, 0.0);
+	const int32_t nbFaces = faces.size();
+	const bool    angle   = normals.weighting == ANGLE;
+	#pragma omp parallel for schedule(static)
+	for(int32_t i=0;i<nbFaces;++i)
+	{
+		IndexVertex_t* corners = &normals.corners[3*faces[i]];
+		std::copy(triangles[faces[i]].beginVertice(), triangles[faces[i]].endVertice(), corners);
+		faceNormal(vertices.data(), corners, angle, &normals.faces[3*faces[i]], &normals.weights[3*faces[i]]);
+	}
+	for(IndexFace_t f : faces)
+	{
+		accumulate(normals, f, 1.0);
+		touched.insert(touched.end(), &normals.corners[3*f], &normals.corners[3*f] + 3);
+	}
+	std::sort(touched.begin(), touched.end());
+	touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+	const int32_t nbTouched = touched.size();
+	#pragma omp parallel for schedule(static)
+	for(int32_t i=0;i<nbTouched;++i)
+	{
+		normalize(normals, touched[i]);
+	}
+}
@@ -0,0 +1,1007 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "outofcore.hpp"
+#include "simplify.hpp"
+#include "trace.hpp"
+#include "logs.hpp"
+
+
+namespace
+{
+	const size_t   CHUNK  = 1u << 20; //!< The most bytes read at once from an OFF file.
+	const size_t   LINE   = 1u << 12; //!< The least bytes read at once from an OFF file.
+	const size_t   FANIN  = 64;       //!< The most runs merged at once by a Sorter_t.
+	const size_t   BLOCK  = 1u << 16; //!< The least bytes read at once from each run being merged.
+	const size_t   WINDOW = 160;      //!< About the bytes of a triangle inside a Window, its vertices and the scratch included.
+	const uint64_t GAP    = 64;       //!< Vertices closer than this in the file are read by a single read, with the ones between.
+	const uint64_t SPAN   = 4096;     //!< The most vertices read by a single read.
+
+	//! @brief The x y z of a vertex or of a normal, as it is in the files.
+	struct Point_t final
+	{
+		VertexType x[3];
+	};
+	//! @brief The 3 vertices or the 3 neighbors of a triangle, as it is in the files.
+	struct Triple_t final
+	{
+		int32_t v[3];
+	};
+	/**
+	 * @brief An edge of a triangle, the other side of the slot of the vertex opposite to it.
+	 * Sorting them brings the 2 triangles of each edge next to each other.
+	 */
+	struct HalfEdge_t final
+	{
+		IndexVertex_t low, high; //!< The ends, low < high.
+		uint64_t      slot;      //!< 3*triangle + the position of the opposite vertex.
+		bool operator<(const HalfEdge_t& other) const
+		{
+			return (this->low != other.low) ? this->low < other.low : (this->high != other.high) ? this->high < other.high : this->slot < other.slot;
+		}
+	};
+	//! @brief A neighbor to write in a slot of the neighbors file.
+	struct Link_t final
+	{
+		uint64_t    slot;
+		IndexFace_t neighbor;
+		bool operator<(const Link_t& other) const {return this->slot < other.slot;}
+	};
+	//! @brief A part of the normal of a vertex.
+	struct Contribution_t final
+	{
+		IndexVertex_t vertex;
+		VertexType    n[3];
+		bool operator<(const Contribution_t& other) const {return this->vertex < other.vertex;}
+	};
+
+	/**
+	 * @class Writer_t
+	 * @brief A file of records of T, written through a buffer.
+	 */
+	template<typename T>
+	class Writer_t final
+	{
+		public:
+			Writer_t(const std::string& fname, size_t memory) : fname(fname), file(fname, std::ios::binary | std::ios::trunc),
+			                                                    capacity(std::max<size_t>(1, memory/sizeof(T)))
+			{
+				if (!this->file.good())
+				{
+					throw std::runtime_error("Unable to write " + fname);
+				}
+				this->buffer.reserve(this->capacity);
+			}
+			inline void push(const T& record)
+			{
+				this->buffer.push_back(record);
+				if (this->buffer.size() == this->capacity)
+				{
+					this->flush();
+				}
+			}
+			//! @brief Write what remains, nothing can be pushed after.
+			void close(void)
+			{
+				this->flush();
+				this->file.close();
+			}
+
+		private:
+			std::string    fname;
+			std::ofstream  file;
+			size_t         capacity; //!< The number of records of the buffer.
+			std::vector<T> buffer;
+
+			void flush(void)
+			{
+				this->file.write(reinterpret_cast<const char*>(this->buffer.data()), this->buffer.size()*sizeof(T));
+				this->buffer.clear();
+				if (!this->file.good())
+				{
+					throw std::runtime_error("Unable to write " + this->fname);
+				}
+			}
+	};
+
+	/**
+	 * @class Reader_t
+	 * @brief A file of records of T, read through a buffer, or by ranges.
+	 */
+	template<typename T>
+	class Reader_t final
+	{
+		public:
+			Reader_t(const std::string& fname, size_t memory) : fname(fname), file(fname, std::ios::binary),
+			                                                    capacity(std::max<size_t>(1, memory/sizeof(T))), position(0)
+			{
+				if (!this->file.good())
+				{
+					throw std::runtime_error("Unable to read " + fname);
+				}
+			}
+			//! @brief Get the next record, false at the end of the file.
+			inline bool next(T& record)
+			{
+				if (this->position == this->buffer.size())
+				{
+					this->buffer.resize(this->capacity);
+					this->file.read(reinterpret_cast<char*>(this->buffer.data()), this->capacity*sizeof(T));
+					this->buffer.resize(this->file.gcount()/sizeof(T));
+					this->position = 0;
+					if (this->buffer.empty())
+					{
+						return false;
+					}
+				}
+				record = this->buffer[this->position++];
+				return true;
+			}
+			//! @brief Read the records [\p first, \p first + \p count[ into \p out.
+			void read(uint64_t first, uint64_t count, T* out)
+			{
+				this->file.clear();
+				this->file.seekg(first*sizeof(T));
+				this->file.read(reinterpret_cast<char*>(out), count*sizeof(T));
+				if (static_cast<uint64_t>(this->file.gcount()) != count*sizeof(T))
+				{
+					throw std::runtime_error("Unable to read " + this->fname);
+				}
+			}
+
+		private:
+			std::string    fname;
+			std::ifstream  file;
+			size_t         capacity; //!< The number of records of the buffer.
+			std::vector<T> buffer;
+			size_t         position; //!< The next record of the buffer.
+	};
+
+	/**
+	 * @class Sorter_t
+	 * @brief An external sort : the records are sorted by runs which fit in the memory, each run written
+	 * into its own file, then the runs are merged. Nothing is written if every record fits in the memory.
+	 * Too many runs to merge at once are merged by passes, each one merging groups of them into longer runs.
+	 */
+	template<typename T>
+	class Sorter_t final
+	{
+		public:
+			Sorter_t(const std::string& prefix, size_t memory) : prefix(prefix), memory(memory),
+			                                                     capacity(std::max<size_t>(1, memory/sizeof(T))),
+			                                                     fanIn(std::max<size_t>(2, std::min<size_t>(FANIN, memory/(2*BLOCK)))), created(0)
+			{
+				this->buffer.reserve(this->capacity);
+			}
+			~Sorter_t(void)
+			{
+				this->removeRuns();
+			}
+			inline void push(const T& record)
+			{
+				this->buffer.push_back(record);
+				if (this->buffer.size() == this->capacity)
+				{
+					this->spill();
+				}
+			}
+			/**
+			 * @brief Call \p visit over every record, in increasing order.
+			 */
+			template<typename Visit>
+			void merge(Visit visit)
+			{
+				if (this->runs.empty())
+				{
+					std::sort(this->buffer.begin(), this->buffer.end());
+					std::for_each(this->buffer.begin(), this->buffer.end(), visit);
+					return;
+				}
+				if (!this->buffer.empty())
+				{
+					this->spill();
+				}
+				std::vector<T>().swap(this->buffer);
+				while(this->runs.size() > this->fanIn)
+				{
+					// Half of the memory for the runs read, the other half for the longer run written.
+					TRACE_SCOPE("merge pass");
+					std::vector<std::string> longer;
+					for(size_t first=0;first<this->runs.size();first+=this->fanIn)
+					{
+						longer.push_back(this->name());
+						Writer_t<T> run(longer.back(), this->memory/2);
+						this->mergeRuns(first, std::min(first + this->fanIn, this->runs.size()), this->memory/2, [&](const T& record){run.push(record);});
+						run.close();
+					}
+					this->removeRuns();
+					this->runs.swap(longer);
+				}
+				this->mergeRuns(0, this->runs.size(), this->memory, visit);
+			}
+
+		private:
+			std::string              prefix;
+			size_t                   memory;
+			size_t                   capacity; //!< The number of records of a run.
+			size_t                   fanIn;    //!< The most runs merged at once, each one read by BLOCK bytes at least.
+			uint32_t                 created;  //!< The number of run files created, to name the next one.
+			std::vector<T>           buffer;   //!< The run being filled.
+			std::vector<std::string> runs;     //!< The files of the sorted runs.
+
+			inline std::string name(void)
+			{
+				return this->prefix + ".run" + std::to_string(this->created++);
+			}
+			void removeRuns(void)
+			{
+				for(const std::string& run : this->runs)
+				{
+					std::remove(run.c_str());
+				}
+				this->runs.clear();
+			}
+			/**
+			 * @brief Call \p visit over every record of the runs [\p first, \p last[, in increasing order,
+			 * their buffers sharing \p memory bytes.
+			 */
+			template<typename Visit>
+			void mergeRuns(size_t first, size_t last, size_t memory, Visit visit)
+			{
+				typedef std::pair<T, uint32_t> Head_t; // The smallest record left of a run, and this run.
+				auto later = [](const Head_t& a, const Head_t& b){return b.first < a.first;};
+				std::priority_queue<Head_t, std::vector<Head_t>, decltype(later)> heads(later);
+				std::vector<std::unique_ptr<Reader_t<T>>> readers;
+				for(size_t r=first;r<last;++r)
+				{
+					readers.emplace_back(new Reader_t<T>(this->runs[r], memory/(last - first)));
+					T record;
+					if (readers.back()->next(record))
+					{
+						heads.push(Head_t(record, readers.size()-1));
+					}
+				}
+				while(!heads.empty())
+				{
+					Head_t head = heads.top();
+					heads.pop();
+					visit(head.first);
+					if (readers[head.second]->next(head.first))
+					{
+						heads.push(head);
+					}
+				}
+			}
+			void spill(void)
+			{
+				TRACE_SCOPE("sort run");
+				std::sort(this->buffer.begin(), this->buffer.end());
+				this->runs.push_back(this->name());
+				Writer_t<T> run(this->runs.back(), this->buffer.size()*sizeof(T));
+				for(const T& record : this->buffer)
+				{
+					run.push(record);
+				}
+				run.close();
+				this->buffer.clear();
+			}
+	};
+
+	/**
+	 * @class Parser_t
+	 * @brief Reads a text file line by line, a chunk of bytes at once, whatever its size.
+	 */
+	class Parser_t final
+	{
+		public:
+			Parser_t(const std::string& fname, size_t chunk) : fname(fname), file(fname, std::ios::binary), chunk(chunk),
+			                                                   buffer(chunk + 1), begin(0), end(0)
+			{
+				if (!this->file.good())
+				{
+					throw std::runtime_error("Unable to read " + fname);
+				}
+			}
+			/**
+			 * @brief Get the next line which isn't empty once its comment is removed.
+			 * @return The line, 0 terminated, valid until the next call.
+			 * @throw std::runtime_error At the end of the file.
+			 */
+			char* line(void)
+			{
+				while(true)
+				{
+					char* first   = &this->buffer[this->begin];
+					char* newline = static_cast<char*>(std::memchr(first, '\n', this->end - this->begin));
+					if (newline == nullptr)
+					{
+						if (!this->refill())
+						{
+							if (this->begin == this->end)
+							{
+								throw std::runtime_error("Prematured end of " + this->fname);
+							}
+							// The last line, without its end of line.
+							this->buffer[this->end++] = '\n';
+						}
+						continue;
+					}
+					*newline    = '\0';
+					this->begin = newline - this->buffer.data() + 1;
+					char* comment = std::strchr(first, '#');
+					if (comment != nullptr)
+					{
+						*comment = '\0';
+					}
+					first += std::strspn(first, " \t\r");
+					if (*first != '\0')
+					{
+						return first;
+					}
+				}
+			}
+
+			//! @brief Give the memory back, once every line needed is read.
+			void close(void)
+			{
+				this->file.close();
+				std::vector<char>().swap(this->buffer);
+				this->begin = this->end = 0;
+			}
+
+		private:
+			std::string       fname;
+			std::ifstream     file;
+			size_t            chunk;  //!< The bytes read at once.
+			std::vector<char> buffer; //!< One more byte than what is read, for the last end of line.
+			size_t            begin;  //!< The beginning of the next line.
+			size_t            end;    //!< The end of what has been read.
+
+			//! @brief Keep the current line, and read a new chunk after it. @return false at the end of the file.
+			bool refill(void)
+			{
+				std::copy(this->buffer.begin() + this->begin, this->buffer.begin() + this->end, this->buffer.begin());
+				this->end  -= this->begin;
+				this->begin = 0;
+				if (this->end + this->chunk + 1 > this->buffer.size())
+				{
+					// A line longer than a chunk.
+					this->buffer.resize(this->end + this->chunk + 1);
+				}
+				this->file.read(&this->buffer[this->end], this->chunk);
+				this->end += this->file.gcount();
+				return this->file.gcount() > 0;
+			}
+	};
+
+	//! @brief Read a number of \p line, and move after it.
+	template<typename Number>
+	Number parse(char*& line, const std::string& fname)
+	{
+		char*  next  = line;
+		double value = std::strtod(line, &next);
+		if (next == line)
+		{
+			throw std::runtime_error("Invalid number in " + fname);
+		}
+		line = next;
+		return static_cast<Number>(value);
+	}
+
+	inline void cross(const VertexType* a, const VertexType* b, const VertexType* c, VertexType n[3])
+	{
+		VertexType abx = b[0]-a[0], aby = b[1]-a[1], abz = b[2]-a[2];
+		VertexType acx = c[0]-a[0], acy = c[1]-a[1], acz = c[2]-a[2];
+		n[0] = aby*acz - abz*acy;
+		n[1] = abz*acx - abx*acz;
+		n[2] = abx*acy - aby*acx;
+	}
+	inline VertexType distance(const VertexType* a, const VertexType* b)
+	{
+		VertexType dx = b[0]-a[0], dy = b[1]-a[1], dz = b[2]-a[2];
+		return std::sqrt(dx*dx + dy*dy + dz*dz);
+	}
+
+	/**
+	 * @brief Read the triangles of \p fname, write them into the Store, and sort their edges.
+	 */
+	void readTriangles(Parser_t& parser, const std::string& fname, uint64_t nb, outofcore::Store& store, Sorter_t<HalfEdge_t>& edges)
+	{
+		TRACE_SCOPE("stream off triangles");
+		Writer_t<Triple_t>         triangles(store.prefix + ".triangles", store.memory/8);
+		std::vector<IndexVertex_t> polygon;
+		for(uint64_t f=0;f<nb;++f)
+		{
+			char*          line = parser.line();
+			const uint32_t size = parse<uint32_t>(line, fname);
+			polygon.resize(size);
+			for(uint32_t i=0;i<size;++i)
+			{
+				polygon[i] = parse<IndexVertex_t>(line, fname);
+				if (polygon[i] < 0 || static_cast<uint64_t>(polygon[i]) >= store.nbVertices)
+				{
+					throw std::runtime_error("Invalid vertex index in " + fname);
+				}
+			}
+			// A fan of triangles around the first vertex.
+			for(uint32_t i=1;i+1<size;++i)
+			{
+				const Triple_t t = {{polygon[0], polygon[i], polygon[i+1]}};
+				triangles.push(t);
+				for(uint32_t j=0;j<3;++j)
+				{
+					const IndexVertex_t a = t.v[j], b = t.v[(j+1)%3];
+					edges.push({std::min(a, b), std::max(a, b), 3*store.nbTriangles + (j+2)%3});
+				}
+				++store.nbTriangles;
+			}
+		}
+		triangles.close();
+		if (store.nbTriangles > static_cast<uint64_t>(std::numeric_limits<IndexFace_t>::max()))
+		{
+			throw std::runtime_error("Too many triangles in " + fname);
+		}
+	}
+
+	/**
+	 * @brief Write the neighbors file of \p store, from its sorted edges : the 2 half edges of a same edge
+	 * are linked, then the links are sorted by slot, so the file is written in order.
+	 */
+	void link(outofcore::Store& store, Sorter_t<HalfEdge_t>& edges)
+	{
+		TRACE_SCOPE("external adjacency");
+		Sorter_t<Link_t>      links(store.prefix + ".links", store.memory/2);
+		HalfEdge_t            current = {-1, -1, 0};
+		std::vector<uint64_t> slots;
+		auto flush = [&](void){
+			if (slots.size() == 1)
+			{
+				++store.borders;
+			}
+			else if (slots.size() == 2 && slots[0]/3 != slots[1]/3)
+			{
+				links.push({slots[0], static_cast<IndexFace_t>(slots[1]/3)});
+				links.push({slots[1], static_cast<IndexFace_t>(slots[0]/3)});
+			}
+			else if (slots.size() > 2)
+			{
+				++store.nonManifold;
+			}
+			slots.clear();
+		};
+		edges.merge([&](const HalfEdge_t& e){
+			if (e.low != current.low || e.high != current.high)
+			{
+				flush();
+				current = e;
+			}
+			slots.push_back(e.slot);
+		});
+		flush();
+		Writer_t<IndexFace_t> neighbors(store.prefix + ".neighbors", store.memory/8);
+		uint64_t              next = 0;
+		links.merge([&](const Link_t& l){
+			for(;next<l.slot;++next)
+			{
+				neighbors.push(-1);
+			}
+			neighbors.push(l.neighbor);
+			++next;
+		});
+		for(;next<3*store.nbTriangles;++next)
+		{
+			neighbors.push(-1);
+		}
+		neighbors.close();
+	}
+
+	/**
+	 * @brief Find the neighbors of the triangles of a clustering. The clusters may join more than 2 triangles
+	 * on an edge : the triangles going one way are paired with the ones going the other way, in order.
+	 * A surplus going the same way only comes from a border of the input, the first one stays a border and
+	 * the others are removed, so every edge is a border or between 2 triangles of opposite directions.
+	 * @param[inout] kept      The triangles.
+	 * @param[out]   neighbors The neighbor opposite to each corner, -1 for none.
+	 * @return The number of triangles removed.
+	 */
+	uint64_t linkTriangles(std::vector<Triple_t>& kept, std::vector<IndexFace_t>& neighbors)
+	{
+		uint64_t removed = 0;
+		do
+		{
+			std::vector<HalfEdge_t> edges;
+			edges.reserve(3*kept.size());
+			for(uint64_t f=0;f<kept.size();++f)
+			{
+				for(uint32_t i=0;i<3;++i)
+				{
+					const IndexVertex_t a = kept[f].v[i], b = kept[f].v[(i+1)%3];
+					edges.push_back({std::min(a, b), std::max(a, b), 3*f + (i+2)%3});
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			neighbors.assign(3*kept.size(), -1);
+			std::vector<bool>     extra(kept.size(), false);
+			std::vector<uint64_t> ways[2]; // The slots going from low to high, and the ones going from high to low.
+			for(size_t i=0, j=0;i<edges.size();i=j)
+			{
+				ways[0].clear();
+				ways[1].clear();
+				for(j=i;j<edges.size() && edges[j].low == edges[i].low && edges[j].high == edges[i].high;++j)
+				{
+					const uint64_t s = edges[j].slot;
+					ways[(kept[s/3].v[(s%3 + 1)%3] == edges[j].low) ? 0 : 1].push_back(s);
+				}
+				const size_t pairs = std::min(ways[0].size(), ways[1].size());
+				for(size_t k=0;k<pairs;++k)
+				{
+					neighbors[ways[0][k]] = ways[1][k]/3;
+					neighbors[ways[1][k]] = ways[0][k]/3;
+				}
+				const std::vector<uint64_t>& surplus = (ways[0].size() > pairs) ? ways[0] : ways[1];
+				for(size_t k=pairs+1;k<surplus.size();++k)
+				{
+					extra[surplus[k]/3] = true;
+				}
+			}
+			const size_t before = kept.size();
+			size_t       nb     = 0;
+			for(size_t f=0;f<before;++f)
+			{
+				if (!extra[f])
+				{
+					kept[nb++] = kept[f];
+				}
+			}
+			kept.resize(nb);
+			removed += before - nb;
+			if (nb == before)
+			{
+				return removed;
+			}
+		}
+		while(true);
+	}
+
+	/**
+	 * @brief Give a vertex to each fan of triangles around a cluster : a cluster whose triangles only touch
+	 * by it (a pinched vertex) becomes a vertex per fan, so every vertex can be turned around.
+	 * @param[inout] kept      The triangles, their clusters replaced by the new vertices.
+	 * @param[in]    neighbors The neighbor opposite to each corner, -1 for none.
+	 * @return The cluster of each new vertex.
+	 */
+	std::vector<uint32_t> splitFans(std::vector<Triple_t>& kept, const std::vector<IndexFace_t>& neighbors)
+	{
+		// The corners of a same fan are joined through the 2 edges they touch.
+		std::vector<uint64_t> parents(3*kept.size());
+		std::iota(parents.begin(), parents.end(), 0);
+		auto root = [&](uint64_t c){
+			while(parents[c] != c)
+			{
+				c = parents[c] = parents[parents[c]];
+			}
+			return c;
+		};
+		for(uint64_t c=0;c<parents.size();++c)
+		{
+			const IndexVertex_t v = kept[c/3].v[c%3];
+			for(uint32_t side : {1u, 2u})
+			{
+				const IndexFace_t g = neighbors[3*(c/3) + (c%3 + side)%3];
+				if (g != -1)
+				{
+					const uint64_t other = 3*g + (std::find(kept[g].v, kept[g].v + 3, v) - kept[g].v);
+					parents[root(c)] = root(other);
+				}
+			}
+		}
+		std::vector<int32_t>  ids(parents.size(), -1);
+		std::vector<uint32_t> origins;
+		for(uint64_t c=0;c<parents.size();++c)
+		{
+			int32_t& id = ids[root(c)];
+			if (id == -1)
+			{
+				id = origins.size();
+				origins.push_back(kept[c/3].v[c%3]);
+			}
+			kept[c/3].v[c%3] = id;
+		}
+		return origins;
+	}
+}
+
+
+outofcore::Store outofcore::convert(const std::string& fname, const std::string& prefix, size_t memory)
+{
+	TRACE_SCOPE("convert off");
+	Store store;
+	store.prefix = prefix;
+	store.memory = memory;
+	std::fill(store.low,  store.low  + 3,  std::numeric_limits<VertexType>::max());
+	std::fill(store.high, store.high + 3, -std::numeric_limits<VertexType>::max());
+	try
+	{
+		// The parser, the buffer of the file being written and the edges share the memory while reading,
+		// then the edges and their links share it.
+		Sorter_t<HalfEdge_t> edges(prefix + ".edges", memory/2);
+		Parser_t             parser(fname, std::max(LINE, std::min(CHUNK, memory/8)));
+		char*                line = parser.line();
+		if (std::strncmp(line, "OFF", 3) != 0)
+		{
+			throw std::runtime_error("No OFF header in " + fname);
+		}
+		line += 3;
+		if (*(line + std::strspn(line, " \t\r")) == '\0')
+		{
+			line = parser.line();
+		}
+		store.nbVertices        = parse<uint64_t>(line, fname);
+		const uint64_t nbFaces  = parse<uint64_t>(line, fname);
+		if (store.nbVertices > static_cast<uint64_t>(std::numeric_limits<IndexVertex_t>::max()))
+		{
+			throw std::runtime_error("Too many vertices in " + fname);
+		}
+		{
+			TRACE_SCOPE("stream off vertices");
+			Writer_t<Point_t> vertices(prefix + ".vertices", memory/8);
+			for(uint64_t v=0;v<store.nbVertices;++v)
+			{
+				Point_t p;
+				line = parser.line();
+				for(uint32_t a=0;a<3;++a)
+				{
+					p.x[a]        = parse<VertexType>(line, fname);
+					store.low[a]  = std::min(store.low[a],  p.x[a]);
+					store.high[a] = std::max(store.high[a], p.x[a]);
+				}
+				vertices.push(p);
+			}
+			vertices.close();
+		}
+		readTriangles(parser, fname, nbFaces, store, edges);
+		parser.close();
+		link(store, edges);
+	}
+	catch(...)
+	{
+		discard(store);
+		throw;
+	}
+	mtl::log::info("Succesfully convert", fname, "with", store.nbVertices, "vertices and", store.nbTriangles, "triangles");
+	return store;
+}
+
+void outofcore::discard(const Store& store)
+{
+	for(const char* extension : {".vertices", ".triangles", ".neighbors", ".normals"})
+	{
+		std::remove((store.prefix + extension).c_str());
+	}
+}
+
+void outofcore::forEachWindow(const Store& store, const std::function<void(const Window&)>& pass)
+{
+	const uint64_t     size = std::max<uint64_t>(1, store.memory/WINDOW);
+	Reader_t<Triple_t> triangles(store.prefix + ".triangles", 0);
+	Reader_t<Triple_t> neighbors(store.prefix + ".neighbors", 0);
+	Reader_t<Point_t>  vertices (store.prefix + ".vertices",  0);
+	Window               window;
+	std::vector<Triple_t> raw;
+	std::vector<Point_t>  span;
+	for(window.begin=0;window.begin<store.nbTriangles;window.begin+=size)
+	{
+		TRACE_SCOPE("window");
+		window.size = std::min(size, store.nbTriangles - window.begin);
+		raw.resize(window.size);
+		triangles.read(window.begin, window.size, raw.data());
+		window.neighbors.resize(3*window.size);
+		neighbors.read(window.begin, window.size, reinterpret_cast<Triple_t*>(window.neighbors.data()));
+		window.ids.resize(3*window.size);
+		std::copy(&raw[0].v[0], &raw[0].v[0] + 3*window.size, window.ids.begin());
+		std::sort(window.ids.begin(), window.ids.end());
+		window.ids.erase(std::unique(window.ids.begin(), window.ids.end()), window.ids.end());
+		// The close vertices are read at once, the ones between them skipped.
+		window.points.resize(3*window.ids.size());
+		for(size_t i=0;i<window.ids.size();)
+		{
+			const uint64_t first = window.ids[i];
+			size_t         j     = i+1;
+			while(j < window.ids.size() && static_cast<uint64_t>(window.ids[j] - window.ids[j-1]) <= GAP && window.ids[j] - first < SPAN)
+			{
+				++j;
+			}
+			span.resize(window.ids[j-1] - first + 1);
+			vertices.read(first, span.size(), span.data());
+			for(;i<j;++i)
+			{
+				const Point_t& p = span[window.ids[i] - first];
+				std::copy(p.x, p.x + 3, &window.points[3*i]);
+			}
+		}
+		window.corners.resize(3*window.size);
+		for(uint32_t k=0;k<3*window.size;++k)
+		{
+			window.corners[k] = std::lower_bound(window.ids.begin(), window.ids.end(), raw[k/3].v[k%3]) - window.ids.begin();
+		}
+		pass(window);
+	}
+}
+
+outofcore::Statistics outofcore::statistics(const Store& store)
+{
+	TRACE_SCOPE("out of core statistics");
+	Statistics s = {store.nbVertices, store.nbTriangles, store.borders, store.nonManifold, 0, 0.0,
+	                std::numeric_limits<VertexType>::max(), 0.0, 0.0};
+	uint64_t edges = 0;
+	forEachWindow(store, [&](const Window& w){
+		for(uint32_t t=0;t<w.size;++t)
+		{
+			const VertexType* p[3] = {&w.points[3*w.corners[3*t]], &w.points[3*w.corners[3*t+1]], &w.points[3*w.corners[3*t+2]]};
+			VertexType n[3];
+			cross(p[0], p[1], p[2], n);
+			const VertexType area = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2])/2.0;
+			s.area        += area;
+			s.degenerated += (area == 0.0) ? 1 : 0;
+			for(uint32_t i=0;i<3;++i)
+			{
+				// An edge between 2 triangles is measured by the first one.
+				const IndexFace_t other = w.neighbors[3*t + (i+2)%3];
+				if (other == -1 || static_cast<uint64_t>(other) > w.begin + t)
+				{
+					const VertexType length = distance(p[i], p[(i+1)%3]);
+					s.shortest = std::min(s.shortest, length);
+					s.longest  = std::max(s.longest,  length);
+					s.mean    += length;
+					++edges;
+				}
+			}
+		}
+	});
+	s.mean     = (edges > 0) ? s.mean/edges : 0.0;
+	s.shortest = (edges > 0) ? s.shortest   : 0.0;
+	return s;
+}
+
+void outofcore::computeNormals(const Store& store)
+{
+	TRACE_SCOPE("out of core normals");
+	Sorter_t<Contribution_t> contributions(store.prefix + ".contributions", store.memory/2);
+	std::vector<VertexType>  sums;
+	forEachWindow(store, [&](const Window& w){
+		// Summed inside the window first, so a vertex is sorted once per window instead of once per triangle.
+		sums.assign(w.points.size(), 0.0);
+		for(uint32_t t=0;t<w.size;++t)
+		{
+			const uint32_t* c = &w.corners[3*t];
+			VertexType n[3];
+			cross(&w.points[3*c[0]], &w.points[3*c[1]], &w.points[3*c[2]], n);
+			for(uint32_t i=0;i<3;++i)
+			{
+				sums[3*c[i]]   += n[0];
+				sums[3*c[i]+1] += n[1];
+				sums[3*c[i]+2] += n[2];
+			}
+		}
+		for(uint32_t v=0;v<w.ids.size();++v)
+		{
+			contributions.push({w.ids[v], {sums[3*v], sums[3*v+1], sums[3*v+2]}});
+		}
+	});
+	Writer_t<Point_t> normals(store.prefix + ".normals", store.memory/8);
+	Point_t           current = {{0.0, 0.0, 0.0}};
+	IndexVertex_t     next    = 0;
+	auto write = [&](void){
+		const VertexType length = std::sqrt(current.x[0]*current.x[0] + current.x[1]*current.x[1] + current.x[2]*current.x[2]);
+		for(uint32_t a=0;a<3 && length>0.0;++a)
+		{
+			current.x[a] /= length;
+		}
+		normals.push(current);
+		current = {{0.0, 0.0, 0.0}};
+		++next;
+	};
+	contributions.merge([&](const Contribution_t& c){
+		while(next < c.vertex)
+		{
+			write();
+		}
+		for(uint32_t a=0;a<3;++a)
+		{
+			current.x[a] += c.n[a];
+		}
+	});
+	while(static_cast<uint64_t>(next) < store.nbVertices)
+	{
+		write();
+	}
+	normals.close();
+}
+
+uint32_t outofcore::resolutionFor(const Statistics& statistics, const Store& store, uint32_t targetFaces)
+{
+	// A cell of side h holds about a vertex of the result, which has about 2 triangles per vertex.
+	const VertexType side   = std::sqrt(2.0*statistics.area/std::max(1u, targetFaces));
+	VertexType       extent = 0.0;
+	for(uint32_t a=0;a<3;++a)
+	{
+		extent = std::max(extent, store.high[a] - store.low[a]);
+	}
+	return (side > 0.0) ? std::max(1.0, std::min(1048576.0, std::ceil(extent/side))) : 1;
+}
+
+void outofcore::cluster(const Store& store, uint32_t resolution, VertexContainer& vertices, TriangleContainer& triangles)
+{
+	TRACE_SCOPE("vertex clustering");
+	VertexType extent = 0.0;
+	for(uint32_t a=0;a<3;++a)
+	{
+		extent = std::max(extent, store.high[a] - store.low[a]);
+	}
+	const VertexType side = (extent > 0.0) ? extent/std::max(1u, resolution) : 1.0;
+	uint64_t         dims[3];
+	for(uint32_t a=0;a<3;++a)
+	{
+		dims[a] = std::max<uint64_t>(1, std::ceil((store.high[a] - store.low[a])/side));
+	}
+	// Every cell touched by the surface, with the quadric of its triangles and the sum of its vertices.
+	std::unordered_map<uint64_t, uint32_t> indexes;
+	std::vector<uint64_t>                  cells;
+	std::vector<simplify::Quadric>         quadrics;
+	std::vector<VertexType>                sums;
+	std::vector<Triple_t>                  kept;
+	std::vector<uint32_t>                  local;
+	forEachWindow(store, [&](const Window& w){
+		local.resize(w.ids.size());
+		for(uint32_t v=0;v<w.ids.size();++v)
+		{
+			const VertexType* p    = &w.points[3*v];
+			uint64_t          cell = 0;
+			for(uint32_t a=0;a<3;++a)
+			{
+				cell = cell*dims[a] + std::min<uint64_t>(dims[a]-1, (p[a] - store.low[a])/side);
+			}
+			auto inserted = indexes.insert(std::make_pair(cell, cells.size()));
+			if (inserted.second)
+			{
+				cells.push_back(cell);
+				quadrics.push_back(simplify::Quadric());
+				sums.insert(sums.end(), 4, 0.0);
+			}
+			local[v] = inserted.first->second;
+			VertexType* sum = &sums[4*local[v]];
+			sum[0] += p[0]; sum[1] += p[1]; sum[2] += p[2]; sum[3] += 1.0;
+		}
+		for(uint32_t t=0;t<w.size;++t)
+		{
+			const uint32_t*   c = &w.corners[3*t];
+			const VertexType* a = &w.points[3*c[0]];
+			VertexType n[3];
+			cross(a, &w.points[3*c[1]], &w.points[3*c[2]], n);
+			const VertexType length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+			if (length > 0.0)
+			{
+				n[0] /= length; n[1] /= length; n[2] /= length;
+				const simplify::Quadric plane(n[0], n[1], n[2], -(n[0]*a[0] + n[1]*a[1] + n[2]*a[2]), length/2.0);
+				for(uint32_t i=0;i<3;++i)
+				{
+					quadrics[local[c[i]]] += plane;
+				}
+			}
+			const Triple_t t3 = {{static_cast<int32_t>(local[c[0]]), static_cast<int32_t>(local[c[1]]), static_cast<int32_t>(local[c[2]])}};
+			if (t3.v[0] != t3.v[1] && t3.v[1] != t3.v[2] && t3.v[2] != t3.v[0])
+			{
+				// The smallest first, with the same orientation, so the copies are next to each other once sorted.
+				const uint32_t first = std::min_element(t3.v, t3.v + 3) - t3.v;
+				kept.push_back({{t3.v[first], t3.v[(first+1)%3], t3.v[(first+2)%3]}});
+			}
+		}
+	});
+	auto less = [](const Triple_t& a, const Triple_t& b){return std::lexicographical_compare(a.v, a.v + 3, b.v, b.v + 3);};
+	auto same = [](const Triple_t& a, const Triple_t& b){return std::equal(a.v, a.v + 3, b.v);};
+	std::sort(kept.begin(), kept.end(), less);
+	// The copies of a triangle going one way cancel the ones going the other way, the rest is kept : the
+	// clustering keeps the border of the surface, so a closed input stays closed. Each copy is kept, even
+	// several of a same triangle, so its edges still have as many triangles going each way.
+	std::vector<Triple_t> merged;
+	for(size_t i=0, j=0;i<kept.size();i=j)
+	{
+		for(j=i;j<kept.size() && same(kept[j], kept[i]);++j);
+		const Triple_t reversed = {{kept[i].v[0], kept[i].v[2], kept[i].v[1]}};
+		auto           range    = std::equal_range(kept.begin(), kept.end(), reversed, less);
+		for(ptrdiff_t n=(j - i) - (range.second - range.first);n>0;--n)
+		{
+			merged.push_back(kept[i]);
+		}
+	}
+	kept = std::move(merged);
+	std::vector<IndexFace_t> neighbors;
+	const uint64_t           removed  = linkTriangles(kept, neighbors);
+	std::vector<uint32_t>    origins  = splitFans(kept, neighbors);
+	std::vector<Vertex>      positions(cells.size());
+	std::vector<bool>        placed(cells.size(), false);
+	vertices.assign(origins.size(), Vertex());
+	for(uint32_t v=0;v<origins.size();++v)
+	{
+		const uint32_t c = origins[v];
+		if (!placed[c])
+		{
+			const VertexType* sum = &sums[4*c];
+			Vertex            best;
+			positions[c] = Vertex(sum[0]/sum[3], sum[1]/sum[3], sum[2]/sum[3]);
+			placed[c]    = true;
+			if (quadrics[c].minimum(best))
+			{
+				// The minimum is only kept inside its cell, with half a cell of margin.
+				uint64_t   rest           = cells[c];
+				bool       inside         = true;
+				VertexType coordinates[3] = {best.x(), best.y(), best.z()};
+				for(int32_t a=2;a>=0;--a)
+				{
+					const VertexType low = store.low[a] + (rest%dims[a])*side;
+					inside = inside && coordinates[a] >= low - side/2.0 && coordinates[a] <= low + 1.5*side;
+					rest  /= dims[a];
+				}
+				positions[c] = inside ? best : positions[c];
+			}
+		}
+		vertices[v] = positions[c];
+	}
+	triangles.clear();
+	triangles.reserve(kept.size());
+	for(const Triple_t& t : kept)
+	{
+		const IndexFace_t f = triangles.size();
+		triangles.push_back(TopoTriangle(t.v[0], t.v[1], t.v[2]));
+		for(uint32_t i=0;i<3;++i)
+		{
+			if (vertices[t.v[i]].face() == -1)
+			{
+				vertices[t.v[i]].face(f);
+			}
+			triangles[f].addNeighbor(neighbors[3*f + (i+2)%3], {t.v[i], t.v[(i+1)%3]});
+		}
+	}
+	mtl::log::info("Clustered", store.nbTriangles, "triangles into", triangles.size(), "on", cells.size(), "cells,", removed, "removed from the non manifold edges,", origins.size(), "vertices");
+}
+
+void outofcore::dump(const Store& store, const std::string& fname)
+{
+	TRACE_SCOPE("out of core dump");
+	std::ofstream file(fname);
+	if (!file.good())
+	{
+		throw std::runtime_error("Unable to write " + fname);
+	}
+	file << "OFF" << std::endl << store.nbVertices << " " << store.nbTriangles << " 0" << std::endl;
+	char               line[128];
+	Reader_t<Point_t>  vertices(store.prefix + ".vertices", store.memory/2);
+	Point_t            p;
+	while(vertices.next(p))
+	{
+		std::snprintf(line, sizeof(line), "%.17g %.17g %.17g\n", p.x[0], p.x[1], p.x[2]);
+		file << line;
+	}
+	Reader_t<Triple_t> triangles(store.prefix + ".triangles", store.memory/2);
+	Triple_t           t;
+	while(triangles.next(t))
+	{
+		std::snprintf(line, sizeof(line), "3 %d %d %d\n", t.v[0], t.v[1], t.v[2]);
+		file << line;
+	}
+	file.close();
+	if (file.fail())
+	{
+		throw std::runtime_error("Unable to write " + fname);
+	}
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "quality.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	const VertexType DEGREES = 180.0/M_PI; //!< To convert radians into degrees.
+
+	/**
+	 * @brief Fill \p histogram with \p values, the bins are counted by each thread then summed.
+	 * @param[in]    values    The values to count.
+	 * @param[inout] histogram The histogram, with its bounds and bins already set.
+	 */
+	void fill(const std::vector<VertexType>& values, quality::Histogram& histogram)
+	{
+		const int32_t  nb    = values.size();
+		const uint32_t bins  = histogram.counts.size();
+		const VertexType low = histogram.low;
+		const VertexType per = bins/(histogram.high - histogram.low);
+		std::vector<std::vector<uint32_t>> counts(parallel::maxThreads(), std::vector<uint32_t>(bins, 0));
+		#pragma omp parallel for schedule(static)
+		for(int32_t i=0;i<nb;++i)
+		{
+			VertexType bin = std::max(VertexType(0.0), std::min(VertexType(bins - 1), (values[i] - low)*per));
+			++counts[parallel::threadIndex()][static_cast<uint32_t>(bin)];
+		}
+		for(const std::vector<uint32_t>& part : counts)
+		{
+			std::transform(part.begin(), part.end(), histogram.counts.begin(), histogram.counts.begin(), std::plus<uint32_t>());
+		}
+	}
+}
+
+quality::Report quality::analyze(const VertexContainer& vertices, const TriangleContainer& triangles, uint32_t bins, uint32_t k)
+{
+	const int32_t nb = triangles.size();
+	// The corners as SoA buffers : ax, ay, az, bx, by, bz, cx, cy, cz.
+	std::vector<VertexType> buffers(9*nb);
+	VertexType* coords[9];
+	for(uint32_t i=0;i<9;++i)
+	{
+		coords[i] = buffers.data() + i*nb;
+	}
+	#pragma omp parallel for schedule(static)
+	for(int32_t f=0;f<nb;++f)
+	{
+		const IndexVertex_t* ids = triangles[f].beginVertice();
+		for(uint32_t i=0;i<3;++i)
+		{
+			const Vertex& v = vertices[ids[i]];
+			coords[3*i][f]   = v.x();
+			coords[3*i+1][f] = v.y();
+			coords[3*i+2][f] = v.z();
+		}
+	}
+	Report report;
+	report.minAngle.resize(nb);
+	report.maxAngle.resize(nb);
+	report.radiusEdge.resize(nb);
+	report.area.resize(nb);
+	report.aspect.resize(nb);
+	const VertexType *ax = coords[0], *ay = coords[1], *az = coords[2];
+	const VertexType *bx = coords[3], *by = coords[4], *bz = coords[5];
+	const VertexType *cx = coords[6], *cy = coords[7], *cz = coords[8];
+	VertexType *minAngle = report.minAngle.data(), *maxAngle = report.maxAngle.data();
+	VertexType *radiusEdge = report.radiusEdge.data(), *area = report.area.data(), *aspect = report.aspect.data();
+	#pragma omp parallel for simd schedule(static)
+	for(int32_t f=0;f<nb;++f)
+	{
+		VertexType abx = bx[f]-ax[f], aby = by[f]-ay[f], abz = bz[f]-az[f];
+		VertexType acx = cx[f]-ax[f], acy = cy[f]-ay[f], acz = cz[f]-az[f];
+		VertexType bcx = cx[f]-bx[f], bcy = cy[f]-by[f], bcz = cz[f]-bz[f];
+		VertexType nx  = aby*acz - abz*acy;
+		VertexType ny  = abz*acx - abx*acz;
+		VertexType nz  = abx*acy - aby*acx;
+		VertexType twiceArea = std::sqrt(nx*nx + ny*ny + nz*nz);
+		VertexType lab = abx*abx + aby*aby + abz*abz;
+		VertexType lac = acx*acx + acy*acy + acz*acz;
+		VertexType lbc = bcx*bcx + bcy*bcy + bcz*bcz;
+		// Every corner shares the same cross product norm, only the dot products differ.
+		VertexType angleA = std::atan2(twiceArea,  abx*acx + aby*acy + abz*acz);
+		VertexType angleB = std::atan2(twiceArea, -abx*bcx - aby*bcy - abz*bcz);
+		VertexType angleC = M_PI - angleA - angleB;
+		VertexType shortest  = std::sqrt(std::min(lab, std::min(lac, lbc)));
+		VertexType longest   = std::sqrt(std::max(lab, std::max(lac, lbc)));
+		VertexType perimeter = std::sqrt(lab) + std::sqrt(lac) + std::sqrt(lbc);
+		minAngle[f]   = std::min(angleA, std::min(angleB, angleC))*DEGREES;
+		maxAngle[f]   = std::max(angleA, std::max(angleB, angleC))*DEGREES;
+		area[f]       = twiceArea/2.0;
+		radiusEdge[f] = std::sqrt(lab*lac*lbc)/(2.0*twiceArea*shortest);
+		aspect[f]     = longest*perimeter/(2.0*std::sqrt(3.0)*twiceArea);
+	}
+	report.minAngles = {0.0,  60.0, std::vector<uint32_t>(bins, 0)};
+	report.maxAngles = {60.0, 180.0, std::vector<uint32_t>(bins, 0)};
+	fill(report.minAngle, report.minAngles);
+	fill(report.maxAngle, report.maxAngles);
+	report.smallestAngle = (nb > 0) ? *std::min_element(report.minAngle.begin(), report.minAngle.end()) : 0.0;
+	report.largestAngle  = (nb > 0) ? *std::max_element(report.maxAngle.begin(), report.maxAngle.end()) : 0.0;
+	report.worst.resize(nb);
+	for(int32_t f=0;f<nb;++f)
+	{
+		report.worst[f] = f;
+	}
+	k = std::min(k, static_cast<uint32_t>(nb));
+	std::partial_sort(report.worst.begin(), report.worst.begin()+k, report.worst.end(), [&report](IndexFace_t a, IndexFace_t b){
+		return report.minAngle[a] < report.minAngle[b];
+	});
+	report.worst.resize(k);
+	return report;
+}
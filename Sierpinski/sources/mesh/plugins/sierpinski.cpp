@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "sierpinski.hpp"
+
+
+namespace
+{
+	const uint32_t TASK = 5; //!< The smallest remaining depth whose subtrees are given to other threads.
+
+	//! @brief The faces of a tetrahedron, the one opposite to each corner, seen from outside.
+	const uint32_t FACES[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+	//! @brief What every node of the generation shares.
+	struct Generator_t final
+	{
+		VertexContainer&      vertices;
+		TriangleContainer&    triangles;
+		uint32_t              depth;
+		uint32_t              corners;   //!< 3 in 2D, 4 in 3D, which is also the number of children.
+		uint32_t              midpoints; //!< The vertices created by a node, one per edge : 3 in 2D, 6 in 3D.
+		std::vector<uint64_t> powers;    //!< corners^k, for k in [0, depth].
+	};
+
+	//! @brief A node of the tree, its corners.
+	struct Node_t final
+	{
+		IndexVertex_t ids[4];
+		VertexType    points[4][3];
+	};
+
+	//! @brief Get the number of nodes of the tree above \p level : 1 + B + ... + B^(level-1).
+	inline uint64_t above(const Generator_t& g, uint32_t level)
+	{
+		return (g.powers[level] - 1)/(g.corners - 1);
+	}
+
+	/**
+	 * @brief Get a triangle of the leaf which keeps the corner \p corner of the node \p node of \p level,
+	 * the one reached by always going down into the child of this corner.
+	 */
+	inline IndexFace_t faceOf(const Generator_t& g, uint32_t level, uint64_t node, uint32_t corner)
+	{
+		const uint32_t remaining = g.depth - level;
+		const uint64_t leaf      = node*g.powers[remaining] + corner*above(g, remaining);
+		return (g.corners == 3) ? leaf : 4*leaf + (corner+1)%4;
+	}
+
+	inline void write(Generator_t& g, IndexVertex_t id, const VertexType* p, IndexFace_t face)
+	{
+		g.vertices[id] = Vertex(p[0], p[1], p[2]);
+		g.vertices[id].face(face);
+	}
+
+	/**
+	 * @brief Write the midpoints created by the node \p node of \p level, then its subtrees, the big ones as OpenMP tasks.
+	 * A node of the last level is a leaf : it writes its triangle, or the 4 faces of its tetrahedron.
+	 */
+	void emit(Generator_t& g, uint32_t level, uint64_t node, const Node_t& n)
+	{
+		if (level == g.depth)
+		{
+			if (g.corners == 3)
+			{
+				g.triangles[node] = TopoTriangle(n.ids[0], n.ids[1], n.ids[2]);
+				return;
+			}
+			for(uint32_t f=0;f<4;++f)
+			{
+				const uint32_t* c = FACES[f];
+				TopoTriangle&   t = g.triangles[4*node + f];
+				t = TopoTriangle(n.ids[c[0]], n.ids[c[1]], n.ids[c[2]]);
+				// The edge opposite to the corner c[i] is shared with the face opposite to this corner.
+				t.addNeighbor(4*node + c[0], {n.ids[c[1]], n.ids[c[2]]});
+				t.addNeighbor(4*node + c[1], {n.ids[c[2]], n.ids[c[0]]});
+				t.addNeighbor(4*node + c[2], {n.ids[c[0]], n.ids[c[1]]});
+			}
+			return;
+		}
+		Node_t   children[4];
+		uint64_t id = g.corners + g.midpoints*(above(g, level) + node);
+		for(uint32_t a=0;a<g.corners;++a)
+		{
+			children[a].ids[a] = n.ids[a];
+			std::copy(n.points[a], n.points[a] + 3, children[a].points[a]);
+			for(uint32_t b=a+1;b<g.corners;++b, ++id)
+			{
+				VertexType* p = children[a].points[b];
+				for(uint32_t i=0;i<3;++i)
+				{
+					p[i] = 0.5*(n.points[a][i] + n.points[b][i]);
+				}
+				children[a].ids[b] = children[b].ids[a] = id;
+				std::copy(p, p + 3, children[b].points[a]);
+				// The midpoint is the corner b of the child a.
+				write(g, id, p, faceOf(g, level+1, node*g.corners + a, b));
+			}
+		}
+		for(uint32_t a=0;a<g.corners;++a)
+		{
+			#pragma omp task shared(g, children) if(g.depth - level > TASK)
+			emit(g, level+1, node*g.corners + a, children[a]);
+		}
+		#pragma omp taskwait
+	}
+}
+
+uint64_t sierpinski::nbVertices(uint32_t depth, bool tetrahedral)
+{
+	uint64_t nb = tetrahedral ? 4 : 3;
+	for(uint32_t k=0;k<depth;++k)
+	{
+		// The corners are split into their copies, the ones on a same edge sharing a vertex.
+		nb = tetrahedral ? 4*nb - 6 : 3*nb - 3;
+	}
+	return nb;
+}
+
+uint64_t sierpinski::nbTriangles(uint32_t depth, bool tetrahedral)
+{
+	uint64_t nb = tetrahedral ? 4 : 1;
+	for(uint32_t k=0;k<depth;++k)
+	{
+		nb *= tetrahedral ? 4 : 3;
+	}
+	return nb;
+}
+
+void sierpinski::generate(uint32_t depth, bool tetrahedral, VertexContainer& vertices, TriangleContainer& triangles)
+{
+	if (depth > (tetrahedral ? MAX_DEPTH_3D : MAX_DEPTH_2D))
+	{
+		throw std::invalid_argument("Sierpinski gasket too deep for the indexes");
+	}
+	Generator_t g = {vertices, triangles, depth, tetrahedral ? 4u : 3u, tetrahedral ? 6u : 3u, std::vector<uint64_t>(depth+1, 1)};
+	for(uint32_t k=1;k<=depth;++k)
+	{
+		g.powers[k] = g.powers[k-1]*g.corners;
+	}
+	vertices.assign(nbVertices(depth, tetrahedral), Vertex());
+	triangles.assign(nbTriangles(depth, tetrahedral), TopoTriangle(0, 0, 0));
+	Node_t root;
+	if (tetrahedral)
+	{
+		// A regular tetrahedron, positively oriented so FACES are seen counter clockwise from outside.
+		const VertexType r = 1.0/std::sqrt(3.0);
+		const VertexType points[4][3] = {{r, r, r}, {r, -r, -r}, {-r, -r, r}, {-r, r, -r}};
+		std::copy(&points[0][0], &points[0][0] + 12, &root.points[0][0]);
+	}
+	else
+	{
+		const VertexType h = std::sqrt(3.0)/2.0;
+		const VertexType points[3][3] = {{-h, -0.5, 0.0}, {h, -0.5, 0.0}, {0.0, 1.0, 0.0}};
+		std::copy(&points[0][0], &points[0][0] + 9, &root.points[0][0]);
+	}
+	for(uint32_t c=0;c<g.corners;++c)
+	{
+		root.ids[c] = c;
+		write(g, c, root.points[c], faceOf(g, 0, 0, c));
+	}
+	#pragma omp parallel
+	{
+		#pragma omp single
+		emit(g, 0, 0, root);
+	}
+}
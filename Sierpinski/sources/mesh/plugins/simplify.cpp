@@ -0,0 +1,638 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include "simplify.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	const VertexType INFINITE_COST = std::numeric_limits<VertexType>::infinity();
+	const VertexType BORDER_WEIGHT = 1000.0; //!< How much the planes along the borders count, to keep them in place.
+	const uint32_t   MAX_DEGREE    = 1024;   //!< Beyond this, the neighborhood of a vertex is considered broken.
+
+	using simplify::Quadric;
+
+	/**
+	 * @brief Compute (\p b - \p a) x (\p c - \p a) into \p n.
+	 */
+	inline void normal(const Vertex& a, const Vertex& b, const Vertex& c, VertexType n[3])
+	{
+		VertexType abx = b.x()-a.x(), aby = b.y()-a.y(), abz = b.z()-a.z();
+		VertexType acx = c.x()-a.x(), acy = c.y()-a.y(), acz = c.z()-a.z();
+		n[0] = aby*acz - abz*acy;
+		n[1] = abz*acx - abx*acz;
+		n[2] = abx*acy - aby*acx;
+	}
+
+	/**
+	 * @brief Get the position of \p v inside \p t.
+	 * @return A value between [0, 2], -1 if \p v isn't a vertex of \p t.
+	 */
+	inline int32_t slot(const TopoTriangle& t, IndexVertex_t v)
+	{
+		const IndexVertex_t* ids = t.beginVertice();
+		return (ids[0] == v) ? 0 : (ids[1] == v) ? 1 : (ids[2] == v) ? 2 : -1;
+	}
+	inline bool contains(const TopoTriangle& t, IndexVertex_t v)
+	{
+		return slot(t, v) != -1;
+	}
+
+	/**
+	 * @class IndexedHeap
+	 * @brief A binary min heap of indexes, which knows where each index is, so its cost
+	 * can be changed, or the index removed, in O(log n).
+	 */
+	class IndexedHeap final
+	{
+		public:
+			/**
+			 * @brief Build the heap, in O(n), with every index which has a finite cost.
+			 * @param[in] costs The cost of each index.
+			 */
+			void build(const std::vector<VertexType>& costs)
+			{
+				this->costs = costs;
+				this->heap.clear();
+				this->positions.assign(costs.size(), -1);
+				for(uint32_t i=0;i<costs.size();++i)
+				{
+					if (costs[i] != INFINITE_COST)
+					{
+						this->positions[i] = this->heap.size();
+						this->heap.push_back(i);
+					}
+				}
+				for(int32_t i=this->heap.size()/2-1;i>=0;--i)
+				{
+					this->down(i);
+				}
+			}
+			inline bool     empty(void) const {return this->heap.empty();}
+			inline uint32_t top(void)   const {return this->heap.front();}
+			/**
+			 * @brief Insert \p id, or move it, with its new \p cost. An infinite cost removes it.
+			 */
+			void update(uint32_t id, VertexType cost)
+			{
+				if (cost == INFINITE_COST)
+				{
+					this->remove(id);
+					return;
+				}
+				this->costs[id] = cost;
+				if (this->positions[id] == -1)
+				{
+					this->positions[id] = this->heap.size();
+					this->heap.push_back(id);
+				}
+				this->down(this->positions[id]);
+				this->up(this->positions[id]);
+			}
+			/**
+			 * @brief Remove \p id from the heap, if it is inside.
+			 */
+			void remove(uint32_t id)
+			{
+				int32_t position = this->positions[id];
+				if (position == -1)
+				{
+					return;
+				}
+				this->swap(position, this->heap.size()-1);
+				this->heap.pop_back();
+				this->positions[id] = -1;
+				if (static_cast<uint32_t>(position) < this->heap.size())
+				{
+					this->down(position);
+					this->up(position);
+				}
+			}
+
+		private:
+			std::vector<VertexType> costs;     //!< The cost of each index.
+			std::vector<uint32_t>   heap;      //!< The indexes, as a binary heap.
+			std::vector<int32_t>    positions; //!< Where each index is inside heap, -1 if it isn't.
+
+			void swap(uint32_t i, uint32_t j)
+			{
+				std::swap(this->heap[i], this->heap[j]);
+				this->positions[this->heap[i]] = i;
+				this->positions[this->heap[j]] = j;
+			}
+			void up(uint32_t i)
+			{
+				while(i > 0 && this->costs[this->heap[i]] < this->costs[this->heap[(i-1)/2]])
+				{
+					this->swap(i, (i-1)/2);
+					i = (i-1)/2;
+				}
+			}
+			void down(uint32_t i)
+			{
+				const uint32_t nb = this->heap.size();
+				while(2*i+1 < nb)
+				{
+					uint32_t child = 2*i+1;
+					if (child+1 < nb && this->costs[this->heap[child+1]] < this->costs[this->heap[child]])
+					{
+						++child;
+					}
+					if (!(this->costs[this->heap[child]] < this->costs[this->heap[i]]))
+					{
+						break;
+					}
+					this->swap(i, child);
+					i = child;
+				}
+			}
+	};
+
+	//! @brief The neighborhood of a vertex.
+	struct Ring final
+	{
+		std::vector<IndexFace_t>   faces;  //!< The triangles around it.
+		std::vector<IndexVertex_t> linked; //!< The vertices linked to it, sorted.
+		bool                       open;   //!< true if it is on a border.
+	};
+
+	//! @brief The best collapse known for a vertex.
+	struct Candidate final
+	{
+		IndexVertex_t target   = -1;            //!< The vertex it collapses into.
+		Vertex        position;                 //!< Where the merged vertex goes.
+		VertexType    cost     = INFINITE_COST; //!< The error added by the collapse.
+	};
+
+	//! @brief The buffers of a thread while it looks for collapses, kept to avoid allocations.
+	struct Scratch final
+	{
+		Ring                       v;          //!< The neighborhood of the collapsed vertex.
+		Ring                       u;          //!< The neighborhood of the target.
+		Ring                       x;          //!< The neighborhood of a third vertex of the edge.
+		std::vector<Candidate>     candidates; //!< Every collapse of a vertex.
+		std::vector<IndexVertex_t> opposites;  //!< The third vertices of the edge.
+		std::vector<IndexVertex_t> common;     //!< The vertices linked to both ends of the edge.
+	};
+
+	/**
+	 * @class Collapser
+	 * @brief Holds the state of a simplification : the quadrics, the removed elements and the heap.
+	 */
+	class Collapser final
+	{
+		public:
+			Collapser(VertexContainer& vertices, TriangleContainer& triangles) : vertices(vertices), triangles(triangles),
+				quadrics(vertices.size()), candidates(vertices.size()), removedV(vertices.size(), 0), removedF(triangles.size(), 0),
+				nbFaces(triangles.size()), scratches(parallel::maxThreads())
+			{
+				// The loaders don't always give a face to every vertex.
+				for(uint32_t f=0;f<triangles.size();++f)
+				{
+					for(auto it=triangles[f].beginVertice();it!=triangles[f].endVertice();++it)
+					{
+						vertices[*it].face(f);
+					}
+				}
+				this->computeQuadrics();
+				const int32_t nb = vertices.size();
+				std::vector<VertexType> costs(nb);
+				#pragma omp parallel for schedule(dynamic, 256)
+				for(int32_t v=0;v<nb;++v)
+				{
+					this->candidates[v] = this->evaluate(v, false);
+					costs[v]            = this->candidates[v].cost;
+				}
+				this->heap.build(costs);
+			}
+			/**
+			 * @brief Collapse the cheapest edges until \p targetFaces is reached, or nothing can be collapsed.
+			 * @return The number of collapses.
+			 */
+			uint32_t run(uint32_t targetFaces)
+			{
+				uint32_t collapses = 0;
+				Ring     around;
+				while(this->nbFaces > targetFaces && !this->heap.empty())
+				{
+					IndexVertex_t    v = this->heap.top();
+					const Candidate& c = this->candidates[v];
+					// The costs inside the heap are lower bounds : the candidate is only checked once at the top,
+					// and replaced by the cheapest valid one if it is wrong, which costs at least as much.
+					if (!this->ring(v, around) || !this->valid(v, around, c.target, c.position))
+					{
+						this->candidates[v] = this->evaluate(v, true);
+						this->heap.update(v, this->candidates[v].cost);
+						continue;
+					}
+					this->collapse(v, around, c.target, c.position);
+					++collapses;
+				}
+				return collapses;
+			}
+			/**
+			 * @brief Remove the collapsed vertices and triangles from the containers, and update the indexes.
+			 */
+			void compact(void)
+			{
+				std::vector<IndexVertex_t> newV(this->vertices.size(), -1);
+				std::vector<IndexFace_t>   newF(this->triangles.size(), -1);
+				IndexVertex_t nbV = 0;
+				IndexFace_t   nbF = 0;
+				for(uint32_t v=0;v<newV.size();++v)
+				{
+					newV[v] = (this->removedV[v]) ? -1 : nbV++;
+				}
+				for(uint32_t f=0;f<newF.size();++f)
+				{
+					newF[f] = (this->removedF[f]) ? -1 : nbF++;
+				}
+				VertexContainer vertices;
+				vertices.reserve(nbV);
+				for(uint32_t v=0;v<newV.size();++v)
+				{
+					if (newV[v] != -1)
+					{
+						IndexFace_t face = this->vertices[v].face();
+						vertices.push_back(this->vertices[v]);
+						vertices.back().face((face == -1) ? -1 : newF[face]);
+					}
+				}
+				TriangleContainer triangles;
+				triangles.reserve(nbF);
+				for(uint32_t f=0;f<newF.size();++f)
+				{
+					if (newF[f] == -1)
+					{
+						continue;
+					}
+					const TopoTriangle&  old = this->triangles[f];
+					const IndexVertex_t* ids = old.beginVertice();
+					IndexVertex_t a = newV[ids[0]], b = newV[ids[1]], c = newV[ids[2]];
+					triangles.push_back(TopoTriangle(a, b, c));
+					const TopoTriangle::Edge edges[3] = {{b, c}, {c, a}, {a, b}};
+					for(uint32_t i=0;i<3;++i)
+					{
+						IndexFace_t neighbor = old.getNeighbors()[i];
+						triangles.back().addNeighbor((neighbor == -1) ? -1 : newF[neighbor], edges[i]);
+					}
+				}
+				this->vertices  = std::move(vertices);
+				this->triangles = std::move(triangles);
+			}
+
+		private:
+			VertexContainer&             vertices;
+			TriangleContainer&           triangles;
+			std::vector<Quadric>         quadrics;   //!< The quadric of each vertex.
+			std::vector<Candidate>       candidates; //!< The best collapse of each vertex.
+			std::vector<uint8_t>         removedV;   //!< 1 for the collapsed vertices.
+			std::vector<uint8_t>         removedF;   //!< 1 for the removed triangles.
+			uint32_t                     nbFaces;    //!< The number of triangles left.
+			IndexedHeap                  heap;       //!< The vertices, the cheapest collapse first.
+			mutable std::vector<Scratch> scratches;  //!< The buffers of each thread.
+
+			/**
+			 * @brief Collect the triangles around \p v, walking through the neighbors on both sides,
+			 * then the vertices linked to it. It doesn't depend on the orientation of the triangles.
+			 * @param[in]  v      The vertex.
+			 * @param[out] around Its neighborhood.
+			 * @return false if the neighborhood of \p v isn't a disk or a half disk.
+			 */
+			bool ring(IndexVertex_t v, Ring& around) const
+			{
+				around.faces.clear();
+				around.linked.clear();
+				around.open = false;
+				IndexFace_t start = this->vertices[v].face();
+				if (start == -1)
+				{
+					return false;
+				}
+				around.faces.push_back(start);
+				for(uint32_t side=0;side<2 && (side == 0 || around.open);++side)
+				{
+					IndexFace_t   f       = start;
+					uint32_t      i       = slot(this->triangles[f], v);
+					IndexVertex_t entered = this->triangles[f].beginVertice()[(i+1+side)%3];
+					while(true)
+					{
+						const TopoTriangle& t = this->triangles[f];
+						uint32_t      e     = slot(t, entered);
+						IndexVertex_t other = t.beginVertice()[3 - e - slot(t, v)];
+						IndexFace_t   next  = t.getNeighbors()[e];
+						if (next == -1)
+						{
+							around.open = true;
+							break;
+						}
+						if (next == start)
+						{
+							if (side == 1)
+							{
+								return false;
+							}
+							break;
+						}
+						if (around.faces.size() > MAX_DEGREE || !contains(this->triangles[next], v) || !contains(this->triangles[next], other))
+						{
+							return false;
+						}
+						around.faces.push_back(next);
+						f       = next;
+						entered = other;
+					}
+				}
+				for(IndexFace_t f : around.faces)
+				{
+					std::copy_if(this->triangles[f].beginVertice(), this->triangles[f].endVertice(), std::back_inserter(around.linked),
+					             [v](IndexVertex_t w){return w != v;});
+				}
+				std::sort(around.linked.begin(), around.linked.end());
+				around.linked.erase(std::unique(around.linked.begin(), around.linked.end()), around.linked.end());
+				// A vertex linked twice is an edge the fan goes through twice, a disk has one more vertex on a border.
+				return around.linked.size() == around.faces.size() + (around.open ? 1 : 0);
+			}
+			/**
+			 * @brief Sum the planes of the triangles around each vertex, and the ones along its borders.
+			 */
+			void computeQuadrics(void)
+			{
+				const int32_t nbT = this->triangles.size();
+				const int32_t nbV = this->vertices.size();
+				std::vector<Quadric> planes(nbT);
+				#pragma omp parallel for schedule(static)
+				for(int32_t f=0;f<nbT;++f)
+				{
+					const IndexVertex_t* ids = this->triangles[f].beginVertice();
+					const Vertex& a = this->vertices[ids[0]];
+					VertexType n[3];
+					normal(a, this->vertices[ids[1]], this->vertices[ids[2]], n);
+					VertexType length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+					if (length > 0.0)
+					{
+						n[0] /= length; n[1] /= length; n[2] /= length;
+						planes[f] = Quadric(n[0], n[1], n[2], -(n[0]*a.x() + n[1]*a.y() + n[2]*a.z()), length/2.0);
+					}
+				}
+				#pragma omp parallel for schedule(dynamic, 256)
+				for(int32_t v=0;v<nbV;++v)
+				{
+					Ring around;
+					this->ring(v, around);
+					for(IndexFace_t f : around.faces)
+					{
+						this->quadrics[v] += planes[f];
+						if (around.open)
+						{
+							this->addBorders(v, f);
+						}
+					}
+				}
+			}
+			/**
+			 * @brief Add to the quadric of \p v the planes orthogonal to \p f along its borders which touch \p v.
+			 */
+			void addBorders(IndexVertex_t v, IndexFace_t f)
+			{
+				const TopoTriangle&  t   = this->triangles[f];
+				const IndexVertex_t* ids = t.beginVertice();
+				VertexType n[3];
+				normal(this->vertices[ids[0]], this->vertices[ids[1]], this->vertices[ids[2]], n);
+				for(uint32_t i=0;i<3;++i)
+				{
+					if (t.getNeighbors()[i] != -1 || ids[i] == v)
+					{
+						continue;
+					}
+					const Vertex& a = this->vertices[ids[(i+1)%3]];
+					const Vertex& b = this->vertices[ids[(i+2)%3]];
+					VertexType ex = b.x()-a.x(), ey = b.y()-a.y(), ez = b.z()-a.z();
+					VertexType m[3] = {ey*n[2] - ez*n[1], ez*n[0] - ex*n[2], ex*n[1] - ey*n[0]};
+					VertexType length = std::sqrt(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+					if (length > 0.0)
+					{
+						m[0] /= length; m[1] /= length; m[2] /= length;
+						VertexType weight = BORDER_WEIGHT*(ex*ex + ey*ey + ez*ez);
+						this->quadrics[v] += Quadric(m[0], m[1], m[2], -(m[0]*a.x() + m[1]*a.y() + m[2]*a.z()), weight);
+					}
+				}
+			}
+			/**
+			 * @brief Find the cheapest collapse of \p v into one of its neighbors.
+			 * @param[in] v       The vertex to collapse.
+			 * @param[in] checked true to only keep a valid collapse, false to keep the cheapest one.
+			 * @return The candidate, with an infinite cost if there is none.
+			 */
+			Candidate evaluate(IndexVertex_t v, bool checked) const
+			{
+				Candidate none;
+				Scratch&  scratch = this->scratches[parallel::threadIndex()];
+				Ring&     around  = scratch.v;
+				if (this->removedV[v] || !this->ring(v, around))
+				{
+					return none;
+				}
+				// Every collapse is measured, then the cheapest ones are checked, until a valid one.
+				std::vector<Candidate>& all = scratch.candidates;
+				all.clear();
+				for(IndexVertex_t w : around.linked)
+				{
+					Candidate c;
+					Quadric   q = this->quadrics[v] + this->quadrics[w];
+					if (!q.minimum(c.position))
+					{
+						// Keep the best of the ends and the middle.
+						const Vertex& a = this->vertices[v];
+						const Vertex& b = this->vertices[w];
+						Vertex middle((a.x()+b.x())/2.0, (a.y()+b.y())/2.0, (a.z()+b.z())/2.0);
+						c.position = b;
+						if (q.error(a) < q.error(c.position))
+						{
+							c.position = a;
+						}
+						if (q.error(middle) < q.error(c.position))
+						{
+							c.position = middle;
+						}
+					}
+					c.target = w;
+					c.cost   = q.error(c.position);
+					all.push_back(c);
+				}
+				std::sort(all.begin(), all.end(), [](const Candidate& a, const Candidate& b){return a.cost < b.cost;});
+				for(const Candidate& c : all)
+				{
+					if (!checked || this->valid(v, around, c.target, c.position))
+					{
+						return c;
+					}
+				}
+				return none;
+			}
+			/**
+			 * @brief Check if collapsing \p v, with the neighborhood \p ringV, into \p u, moved to \p p,
+			 * keeps a manifold mesh without folds.
+			 */
+			bool valid(IndexVertex_t v, const Ring& ringV, IndexVertex_t u, const Vertex& p) const
+			{
+				Scratch& scratch = this->scratches[parallel::threadIndex()];
+				Ring&    ringU   = scratch.u;
+				Ring&    ringX   = scratch.x;
+				if (!this->ring(u, ringU))
+				{
+					return false;
+				}
+				// The triangles of the edge, and their third vertices.
+				std::vector<IndexVertex_t>& opposites = scratch.opposites;
+				opposites.clear();
+				for(IndexFace_t f : ringV.faces)
+				{
+					const TopoTriangle& t = this->triangles[f];
+					if (contains(t, u))
+					{
+						opposites.push_back(t.beginVertice()[3 - slot(t, v) - slot(t, u)]);
+					}
+				}
+				// An inner edge between two borders would pinch the mesh.
+				if (opposites.empty() || (opposites.size() == 1) != (ringV.open && ringU.open))
+				{
+					return false;
+				}
+				// Link condition : the only vertices linked to both are the third vertices of the edge.
+				std::vector<IndexVertex_t>& common = scratch.common;
+				common.clear();
+				std::set_intersection(ringV.linked.begin(), ringV.linked.end(), ringU.linked.begin(), ringU.linked.end(), std::back_inserter(common));
+				std::sort(opposites.begin(), opposites.end());
+				if (common != opposites)
+				{
+					return false;
+				}
+				// The edge between the third vertices is linked to both when each end only has 3 triangles :
+				// the last triangle of v would become the last one of u, turned the other way.
+				if (!ringV.open && !ringU.open && ringV.faces.size() == 3 && ringU.faces.size() == 3)
+				{
+					return false;
+				}
+				// The third vertices mustn't lose all their triangles but two (or one on a border).
+				for(IndexVertex_t x : opposites)
+				{
+					if (!this->ring(x, ringX) || ringX.faces.size() <= (ringX.open ? 1u : 3u))
+					{
+						return false;
+					}
+				}
+				// No triangle may be flipped by the move.
+				const Ring* rings[2] = {&ringV, &ringU};
+				for(const Ring* around : rings)
+				{
+					for(IndexFace_t f : around->faces)
+					{
+						const IndexVertex_t* ids = this->triangles[f].beginVertice();
+						if (std::find(ids, ids+3, v) != ids+3 && std::find(ids, ids+3, u) != ids+3)
+						{
+							continue;
+						}
+						const Vertex* corners[3];
+						for(uint32_t i=0;i<3;++i)
+						{
+							corners[i] = (ids[i] == v || ids[i] == u) ? &p : &this->vertices[ids[i]];
+						}
+						VertexType before[3], after[3];
+						normal(this->vertices[ids[0]], this->vertices[ids[1]], this->vertices[ids[2]], before);
+						normal(*corners[0], *corners[1], *corners[2], after);
+						if (before[0]*after[0] + before[1]*after[1] + before[2]*after[2] <= 0.0)
+						{
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+			/**
+			 * @brief Collapse \p v, with the neighborhood \p ringV, into \p u, moved to \p p : the triangles
+			 * of the edge are removed, their neighbors linked together, and the other triangles of \p v use \p u instead.
+			 */
+			void collapse(IndexVertex_t v, const Ring& ringV, IndexVertex_t u, const Vertex& p)
+			{
+				IndexFace_t kept = -1;
+				for(IndexFace_t r : ringV.faces)
+				{
+					const TopoTriangle& t = this->triangles[r];
+					if (!contains(t, u))
+					{
+						kept = r;
+						continue;
+					}
+					// a is across v-x, b across u-x : once v is on u, they share u-x.
+					IndexVertex_t x = t.beginVertice()[3 - slot(t, v) - slot(t, u)];
+					IndexFace_t   a = t.getNeighbors()[slot(t, u)];
+					IndexFace_t   b = t.getNeighbors()[slot(t, v)];
+					if (a != -1)
+					{
+						this->triangles[a].replaceNeighbor(r, b);
+					}
+					if (b != -1)
+					{
+						this->triangles[b].replaceNeighbor(r, a);
+					}
+					if (this->vertices[x].face() == r)
+					{
+						this->vertices[x].face((a != -1) ? a : b);
+					}
+					if (this->vertices[u].face() == r)
+					{
+						this->vertices[u].face((a != -1) ? a : b);
+					}
+					this->removedF[r] = 1;
+					--this->nbFaces;
+				}
+				for(IndexFace_t f : ringV.faces)
+				{
+					if (this->removedF[f])
+					{
+						continue;
+					}
+					const TopoTriangle& t = this->triangles[f];
+					IndexVertex_t ids[3];
+					std::replace_copy(t.beginVertice(), t.endVertice(), ids, v, u);
+					TopoTriangle moved(ids[0], ids[1], ids[2]);
+					moved.copyNeighbors(t);
+					this->triangles[f] = std::move(moved);
+				}
+				if (kept != -1)
+				{
+					this->vertices[u].face(kept);
+				}
+				this->vertices[u].x(p.x()).y(p.y()).z(p.z());
+				this->vertices[v].face(-1);
+				this->quadrics[u] += this->quadrics[v];
+				this->removedV[v] = 1;
+				this->heap.remove(v);
+				// Every collapse involving u, or around it, changed.
+				Ring ringU;
+				this->ring(u, ringU);
+				ringU.linked.push_back(u);
+				for(IndexVertex_t w : ringU.linked)
+				{
+					this->candidates[w] = this->evaluate(w, false);
+					this->heap.update(w, this->candidates[w].cost);
+				}
+			}
+	};
+}
+
+uint32_t simplify::collapse(VertexContainer& vertices, TriangleContainer& triangles, uint32_t targetFaces)
+{
+	if (triangles.size() <= targetFaces)
+	{
+		return 0;
+	}
+	Collapser collapser(vertices, triangles);
+	uint32_t collapses = collapser.run(targetFaces);
+	collapser.compact();
+	return collapses;
+}
@@ -0,0 +1,95 @@
+#include <vector>
+#include <utility>
+
+#include "smooth.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	//! @brief The coordinates of every vertex, one array per axis.
+	struct Coordinates final
+	{
+		std::vector<double> x;
+		std::vector<double> y;
+		std::vector<double> z;
+	};
+
+	/**
+	 * @brief Move every vertex of \p from by \p factor toward the centroid of its neighbors, into \p to.
+	 * @param[in] moving 1 for the vertices which move, 0 for the others (copied as they are).
+	 */
+	void step(const adjacency::Vertices& adjacency, const std::vector<uint8_t>& moving, double factor, const Coordinates& from, Coordinates& to)
+	{
+		const int32_t        nbV     = moving.size();
+		const uint32_t*      offsets = adjacency.vertexOffsets.data();
+		const IndexVertex_t* ring    = adjacency.vertices.data();
+		const double*        x       = from.x.data();
+		const double*        y       = from.y.data();
+		const double*        z       = from.z.data();
+		double*              toX     = to.x.data();
+		double*              toY     = to.y.data();
+		double*              toZ     = to.z.data();
+		#pragma omp parallel for schedule(static)
+		for(int32_t v=0;v<nbV;++v)
+		{
+			if (!moving[v])
+			{
+				toX[v] = x[v];
+				toY[v] = y[v];
+				toZ[v] = z[v];
+				continue;
+			}
+			double sx = 0.0, sy = 0.0, sz = 0.0;
+			for(uint32_t i=offsets[v];i<offsets[v+1];++i)
+			{
+				sx += x[ring[i]];
+				sy += y[ring[i]];
+				sz += z[ring[i]];
+			}
+			const double n = offsets[v+1] - offsets[v];
+			toX[v] = x[v] + factor*(sx/n - x[v]);
+			toY[v] = y[v] + factor*(sy/n - y[v]);
+			toZ[v] = z[v] + factor*(sz/n - z[v]);
+		}
+	}
+}
+
+uint64_t smooth::taubin(VertexContainer& vertices, const adjacency::Vertices& adjacency, uint32_t iterations, double lambda, double mu, bool fixedBorder)
+{
+	const int32_t nbV = vertices.size();
+	Coordinates buffers[2];
+	for(Coordinates& buffer : buffers)
+	{
+		buffer.x.resize(nbV);
+		buffer.y.resize(nbV);
+		buffer.z.resize(nbV);
+	}
+	std::vector<uint8_t> moving(nbV);
+	uint64_t             nbMoving = 0;
+	#pragma omp parallel for schedule(static) reduction(+:nbMoving)
+	for(int32_t v=0;v<nbV;++v)
+	{
+		buffers[0].x[v] = vertices[v].x();
+		buffers[0].y[v] = vertices[v].y();
+		buffers[0].z[v] = vertices[v].z();
+		uint8_t kind = adjacency.kinds[v];
+		moving[v]    = kind == adjacency::INTERIOR || (!fixedBorder && kind != adjacency::ISOLATED);
+		nbMoving    += moving[v];
+	}
+	Coordinates* from = &buffers[0];
+	Coordinates* to   = &buffers[1];
+	for(uint32_t i=0;i<iterations;++i)
+	{
+		step(adjacency, moving, lambda, *from, *to);
+		std::swap(from, to);
+		step(adjacency, moving, mu, *from, *to);
+		std::swap(from, to);
+	}
+	#pragma omp parallel for schedule(static)
+	for(int32_t v=0;v<nbV;++v)
+	{
+		vertices[v].x(from->x[v]).y(from->y[v]).z(from->z[v]);
+	}
+	return 2*nbMoving*iterations;
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "spatial_sort.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	const uint32_t HILBERT_SIDE = 1u << 16; //!< The number of cells on each side of the curve.
+	
+	/**
+	 * @brief Quantize \p value from [\p min, \p min + \p extent] into [0, HILBERT_SIDE[.
+	 * @param[in] value  The value to quantize.
+	 * @param[in] min    The lowest value possible.
+	 * @param[in] extent The length of the range, 0 allowed.
+	 * @return The quantized value.
+	 */
+	uint32_t quantize(VertexType value, VertexType min, VertexType extent)
+	{
+		if (extent <= 0.0)
+		{
+			return 0;
+		}
+		uint32_t cell = static_cast<uint32_t>((value - min)/extent*(HILBERT_SIDE - 1));
+		return std::min(cell, HILBERT_SIDE - 1);
+	}
+}
+
+uint64_t spatial::hilbertIndex(uint32_t x, uint32_t y)
+{
+	uint64_t d = 0;
+	for(uint32_t s=HILBERT_SIDE/2;s>0;s/=2)
+	{
+		uint32_t rx = (x & s) > 0;
+		uint32_t ry = (y & s) > 0;
+		d += static_cast<uint64_t>(s)*s*((3*rx)^ry);
+		if (ry == 0) // Rotate the quadrant.
+		{
+			if (rx == 1)
+			{
+				x = HILBERT_SIDE-1 - x;
+				y = HILBERT_SIDE-1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+std::vector<uint32_t> spatial::hilbertOrder(const VertexContainer& vertices)
+{
+	VertexType xmin = std::numeric_limits<VertexType>::max();
+	VertexType ymin = std::numeric_limits<VertexType>::max();
+	VertexType xmax = std::numeric_limits<VertexType>::lowest();
+	VertexType ymax = std::numeric_limits<VertexType>::lowest();
+	for(const Vertex& v : vertices)
+	{
+		xmin = std::min(xmin, v.x());
+		xmax = std::max(xmax, v.x());
+		ymin = std::min(ymin, v.y());
+		ymax = std::max(ymax, v.y());
+	}
+	const int32_t nb = vertices.size();
+	std::vector<std::pair<uint64_t, uint32_t>> keys(nb);
+	#pragma omp parallel for schedule(static)
+	for(int32_t i=0;i<nb;++i)
+	{
+		const Vertex& v = vertices[i];
+		keys[i] = std::make_pair(hilbertIndex(quantize(v.x(), xmin, xmax - xmin), quantize(v.y(), ymin, ymax - ymin)), i);
+	}
+	std::sort(keys.begin(), keys.end());
+	std::vector<uint32_t> order(nb);
+	for(int32_t i=0;i<nb;++i)
+	{
+		order[i] = keys[i].second;
+	}
+	return order;
+}
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "stats.hpp"
+
+
+thread_local stats::Slots stats::local;
+
+namespace
+{
+	const char* const COUNTER_NAMES[stats::COUNTERS_NUMBER] = {
+		"orientation2D", "isWellOriented", "isInThisTriangle", "isInSurroundingCircle", "isInCircleOfDiametral",
+		"isPoorQuality", "locations", "location visits", "linear scans", "insertions", "flips", "cavity triangles"
+	};
+	const char* const TIMER_NAMES[stats::TIMERS_NUMBER] = {
+		"load pts", "crust", "nn-crust", "constraints", "refine", "load off", "dump off", "simplify", "quality", "voronoi",
+		"validate", "adjacency", "smooth", "normals", "laplacian", "curvatures", "kd-tree", "bvh", "gasket", "cluster", "components", "encode", "decode"
+	};
+
+	/**
+	 * @brief The slots of every living thread, and what the ended ones counted.
+	 * It's only reached through registry(), so it exists before the first enroll() and after the last thread.
+	 */
+	struct Registry final
+	{
+		std::mutex                 mutex;
+		std::vector<stats::Slots*> slots;
+		stats::Report              retired = stats::Report();
+	};
+	Registry& registry(void)
+	{
+		static Registry* instance = new Registry(); // Never destroyed, the threads may end after main().
+		return *instance;
+	}
+
+	/**
+	 * @brief Add the slots \p from to \p report.
+	 * @param[in] restarted true to only keep their largest values since the last restartLargest().
+	 */
+	void accumulate(stats::Report& report, const stats::Slots& from, bool restarted = false)
+	{
+		for(uint32_t i=0;i<stats::COUNTERS_NUMBER;++i)
+		{
+			uint64_t largest    = from.largest[i].load(std::memory_order_relaxed);
+			report.counters[i] += from.counters[i].load(std::memory_order_relaxed);
+			report.largest[i]   = std::max(report.largest[i], restarted ? largest : std::max(largest, from.kept[i].load(std::memory_order_relaxed)));
+		}
+		for(uint32_t i=0;i<stats::TIMERS_NUMBER;++i)
+		{
+			report.seconds[i] += from.nanoseconds[i].load(std::memory_order_relaxed)*1e-9;
+			report.calls[i]   += from.calls[i].load(std::memory_order_relaxed);
+		}
+	}
+	void clear(stats::Slots& slots)
+	{
+		for(uint32_t i=0;i<stats::COUNTERS_NUMBER;++i)
+		{
+			slots.counters[i].store(0, std::memory_order_relaxed);
+			slots.largest[i].store(0, std::memory_order_relaxed);
+			slots.kept[i].store(0, std::memory_order_relaxed);
+		}
+		for(uint32_t i=0;i<stats::TIMERS_NUMBER;++i)
+		{
+			slots.nanoseconds[i].store(0, std::memory_order_relaxed);
+			slots.calls[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @brief Keeps what a thread counted once it ends, and forgets its slots.
+	 */
+	struct Leaver final
+	{
+		~Leaver(void)
+		{
+			Registry&                   r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			accumulate(r.retired, stats::local);
+			r.slots.erase(std::remove(r.slots.begin(), r.slots.end(), &stats::local), r.slots.end());
+		}
+	};
+
+	//! @brief The ratio \p a / \p b, 0 if \p b is 0.
+	double ratio(uint64_t a, uint64_t b)
+	{
+		return (b == 0) ? 0.0 : static_cast<double>(a)/b;
+	}
+}
+
+std::string stats::name(Counter_e counter)
+{
+	return COUNTER_NAMES[counter];
+}
+
+std::string stats::name(Timer_e timer)
+{
+	return TIMER_NAMES[timer];
+}
+
+void stats::enroll(void)
+{
+	static thread_local Leaver leaver;
+	(void)leaver;
+	Registry&                   r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	r.slots.push_back(&local);
+	local.enrolled = true;
+}
+
+stats::Report stats::collect(void)
+{
+	Registry&                   r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	Report report = r.retired;
+	for(const Slots* slots : r.slots)
+	{
+		accumulate(report, *slots);
+	}
+	return report;
+}
+
+stats::Report stats::thisThread(void)
+{
+	Report report = Report();
+	accumulate(report, local, true);
+	return report;
+}
+
+void stats::restartLargest(void)
+{
+	for(uint32_t i=0;i<COUNTERS_NUMBER;++i)
+	{
+		uint64_t largest = local.largest[i].load(std::memory_order_relaxed);
+		local.kept[i].store(std::max(largest, local.kept[i].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+		local.largest[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void stats::reset(void)
+{
+	Registry&                   r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	r.retired = Report();
+	for(Slots* slots : r.slots)
+	{
+		clear(*slots);
+	}
+}
+
+stats::Report stats::difference(const Report& after, const Report& before)
+{
+	Report report = after;
+	for(uint32_t i=0;i<COUNTERS_NUMBER;++i)
+	{
+		report.counters[i] -= before.counters[i];
+	}
+	for(uint32_t i=0;i<TIMERS_NUMBER;++i)
+	{
+		report.seconds[i] -= before.seconds[i];
+		report.calls[i]   -= before.calls[i];
+	}
+	return report;
+}
+
+std::string stats::format(const Report& report)
+{
+	if (!enabled())
+	{
+		return "Statistics compiled out, define MESH_STATS to get them\n";
+	}
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(4);
+	for(uint32_t i=0;i<TIMERS_NUMBER;++i)
+	{
+		if (report.calls[i] != 0)
+		{
+			out << std::setw(22) << name(static_cast<Timer_e>(i)) << " : " << report.seconds[i] << "s (" << report.calls[i] << " run(s))\n";
+		}
+	}
+	for(uint32_t i=0;i<COUNTERS_NUMBER;++i)
+	{
+		if (report.counters[i] != 0)
+		{
+			out << std::setw(22) << name(static_cast<Counter_e>(i)) << " : " << report.counters[i] << '\n';
+		}
+	}
+	out << std::setprecision(2);
+	if (report.counters[LOCATIONS] != 0)
+	{
+		out << std::setw(22) << "visits per location" << " : " << ratio(report.counters[LOCATION_VISITS], report.counters[LOCATIONS])
+		    << " (longest " << report.largest[LOCATION_VISITS] << ")\n";
+	}
+	if (report.counters[INSERTIONS] != 0)
+	{
+		out << std::setw(22) << "flips per insertion" << " : " << ratio(report.counters[FLIPS], report.counters[INSERTIONS])
+		    << " (most " << report.largest[FLIPS] << ")\n"
+		    << std::setw(22) << "cavity size" << " : " << ratio(report.counters[CAVITY_TRIANGLES], report.counters[INSERTIONS])
+		    << " (largest " << report.largest[CAVITY_TRIANGLES] << ")\n";
+	}
+	return out.str();
+}
@@ -0,0 +1,206 @@
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "trace.hpp"
+
+
+std::atomic<bool> trace::recording(false);
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	//! @brief An event of the timeline, its times are in nanoseconds since start().
+	struct Event final
+	{
+		const char* name;
+		int64_t     begin;
+		int64_t     duration; //!< -1 while it's unfinished.
+		const char* keys[2];
+		int64_t     values[2];
+	};
+
+	//! @brief The events of a thread : only this thread writes them, until stop().
+	struct Buffer final
+	{
+		uint32_t              track;   //!< The thread number inside the timeline.
+		std::vector<Event>    events;
+		std::vector<int32_t>  opened;  //!< The unfinished events, the innermost last.
+	};
+
+	/**
+	 * @brief The buffers of every thread which recorded something, kept after the end of their thread.
+	 * It's only reached through registry(), so it exists before the first event and after the last thread.
+	 */
+	struct Registry final
+	{
+		std::mutex                           mutex;
+		std::vector<std::shared_ptr<Buffer>> buffers;
+		std::string                          fname;
+		Clock::time_point                    origin;
+	};
+	Registry& registry(void)
+	{
+		static Registry* instance = new Registry(); // Never destroyed, the threads may end after main().
+		return *instance;
+	}
+
+	//! @brief Get the buffer of the calling thread, created on its first event.
+	Buffer& local(void)
+	{
+		static thread_local std::shared_ptr<Buffer> buffer;
+		if (!buffer)
+		{
+			Registry&                   r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			buffer        = std::make_shared<Buffer>();
+			buffer->track = r.buffers.size();
+			buffer->events.reserve(1024);
+			r.buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+	int64_t now(void)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - registry().origin).count();
+	}
+
+	//! @brief Write \p ns nanoseconds as microseconds, the unit of the format.
+	void writeMicroseconds(std::ofstream& file, int64_t ns)
+	{
+		file << ns/1000 << '.' << static_cast<char>('0' + (ns/100)%10) << static_cast<char>('0' + (ns/10)%10) << static_cast<char>('0' + ns%10);
+	}
+
+	//! @brief Write \p text as the content of a JSON string, like a file name given as an event name.
+	void writeEscaped(std::ofstream& file, const char* text)
+	{
+		static const char HEX[] = "0123456789abcdef";
+		for(const char* c=text;*c!='\0';++c)
+		{
+			unsigned char u = static_cast<unsigned char>(*c);
+			if (u == '"' || u == '\\')
+			{
+				file << '\\' << *c;
+			}
+			else if (u < 0x20)
+			{
+				file << "\\u00" << HEX[u >> 4] << HEX[u & 0xF];
+			}
+			else
+			{
+				file << *c;
+			}
+		}
+	}
+}
+
+void trace::start(const std::string& fname)
+{
+	Registry&                   r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	for(std::shared_ptr<Buffer>& buffer : r.buffers)
+	{
+		buffer->events.clear();
+		buffer->opened.clear();
+	}
+	r.fname  = fname;
+	r.origin = Clock::now();
+	recording.store(true);
+}
+
+void trace::stop(void)
+{
+	if (!recording.exchange(false))
+	{
+		return;
+	}
+	Registry&                   r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	std::ofstream file(r.fname.c_str());
+	if (!file.good())
+	{
+		throw std::runtime_error("Unable to write the trace " + r.fname);
+	}
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	bool first = true;
+	for(const std::shared_ptr<Buffer>& buffer : r.buffers)
+	{
+		file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->track
+		     << ", \"args\": {\"name\": \"thread " << buffer->track << "\"}}";
+		first = false;
+		for(const Event& event : buffer->events)
+		{
+			if (event.duration < 0)
+			{
+				continue;
+			}
+			file << ",\n{\"name\": \"";
+			writeEscaped(file, event.name);
+			file << "\", \"cat\": \"mesh\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->track << ", \"ts\": ";
+			writeMicroseconds(file, event.begin);
+			file << ", \"dur\": ";
+			writeMicroseconds(file, event.duration);
+			if (event.keys[0] != nullptr)
+			{
+				file << ", \"args\": {\"";
+				writeEscaped(file, event.keys[0]);
+				file << "\": " << event.values[0];
+				if (event.keys[1] != nullptr)
+				{
+					file << ", \"";
+					writeEscaped(file, event.keys[1]);
+					file << "\": " << event.values[1];
+				}
+				file << "}";
+			}
+			file << "}";
+		}
+	}
+	file << "\n]}\n";
+}
+
+int32_t trace::open(const char* name)
+{
+	Buffer& buffer = local();
+	int32_t index  = buffer.events.size();
+	buffer.events.push_back({name, now(), -1, {nullptr, nullptr}, {0, 0}});
+	buffer.opened.push_back(index);
+	return index;
+}
+
+void trace::close(int32_t index)
+{
+	Buffer& buffer = local();
+	// start() may have cleared the buffer since this event began.
+	if (buffer.opened.empty() || buffer.opened.back() != index)
+	{
+		return;
+	}
+	Event& event   = buffer.events[index];
+	event.duration = now() - event.begin;
+	buffer.opened.pop_back();
+}
+
+void trace::value(const char* key, int64_t value)
+{
+	Buffer& buffer = local();
+	if (buffer.opened.empty())
+	{
+		return;
+	}
+	Event& event = buffer.events[buffer.opened.back()];
+	for(uint32_t i=0;i<2;++i)
+	{
+		if (event.keys[i] == nullptr || event.keys[i] == key)
+		{
+			event.keys[i]   = key;
+			event.values[i] = value;
+			return;
+		}
+	}
+}
@@ -0,0 +1,190 @@
+#include <sstream>
+
+#include "validation.hpp"
+#include "parallel.hpp"
+#include "predicats.hpp"
+
+
+namespace
+{
+	const char* const PROBLEM_NAMES[validation::PROBLEMS_NUMBER] = {
+		"bad indexes", "asymmetric neighbors", "common edges", "windings", "face hints", "clockwise", "not Delaunay"
+	};
+
+	//! @brief What a single thread found, in the order of its indexes.
+	struct Partial final
+	{
+		uint64_t             counts[validation::PROBLEMS_NUMBER];
+		std::vector<int32_t> examples[validation::PROBLEMS_NUMBER];
+	};
+
+	void found(Partial& partial, validation::Problem_e problem, int32_t index)
+	{
+		++partial.counts[problem];
+		if (partial.examples[problem].size() < validation::EXAMPLES)
+		{
+			partial.examples[problem].push_back(index);
+		}
+	}
+
+	//! @brief Check that \p t only refers to existing vertices and triangles.
+	bool indexesInRange(const TopoTriangle& t, IndexFace_t f, int32_t nbVertices, int32_t nbTriangles)
+	{
+		const IndexVertex_t* ids       = t.beginVertice();
+		const IndexFace_t*   neighbors = t.getNeighbors();
+		for(uint32_t i=0;i<3;++i)
+		{
+			if (ids[i] < 0 || ids[i] >= nbVertices || ids[i] == ids[(i+1)%3])
+			{
+				return false;
+			}
+			if (neighbors[i] < -1 || neighbors[i] >= nbTriangles || neighbors[i] == f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Check the triangle \p f against each of its neighbors.
+	 * The pairs are only checked from their smallest index, so each problem is counted once.
+	 */
+	void checkTriangle(const VertexContainer& vertices, const TriangleContainer& triangles, const ConstrainedEdges_c& constrained,
+	                   bool planar, IndexFace_t f, Partial& partial)
+	{
+		const TopoTriangle& t = triangles[f];
+		if (!indexesInRange(t, f, vertices.size(), triangles.size()))
+		{
+			found(partial, validation::BAD_INDEX, f);
+			return;
+		}
+		const IndexVertex_t* ids = t.beginVertice();
+		bool counterclockwise    = true;
+		if (planar && exactOrientation2D(vertices[ids[0]], vertices[ids[1]], vertices[ids[2]]) <= 0)
+		{
+			found(partial, validation::CLOCKWISE, f);
+			counterclockwise = false;
+		}
+		const IndexFace_t* neighbors = t.getNeighbors();
+		for(uint32_t i=0;i<3;++i)
+		{
+			IndexFace_t n = neighbors[i];
+			if (n == -1)
+			{
+				continue;
+			}
+			const TopoTriangle& other = triangles[n];
+			if (other.getOppositeVertexOf(f) == -1)
+			{
+				found(partial, validation::ASYMMETRIC, f);
+				continue;
+			}
+			if (n < f)
+			{
+				continue;
+			}
+			TopoTriangle::Edge mine   = t.getCommonEdge(n);
+			TopoTriangle::Edge theirs = other.getCommonEdge(f);
+			if (mine.a == theirs.a && mine.b == theirs.b)
+			{
+				found(partial, validation::WINDING, f);
+				continue;
+			}
+			if (mine.a != theirs.b || mine.b != theirs.a)
+			{
+				found(partial, validation::COMMON_EDGE, f);
+				continue;
+			}
+			if (!planar || !counterclockwise || constrained.find(mine) != constrained.end())
+			{
+				continue;
+			}
+			IndexVertex_t opposite = other.getOppositeVertexOf(f);
+			if (exactInCircle(vertices[ids[0]], vertices[ids[1]], vertices[ids[2]], vertices[opposite]) > 0)
+			{
+				found(partial, validation::NOT_DELAUNAY, f);
+			}
+		}
+	}
+}
+
+validation::Report validation::check(const VertexContainer& vertices, const TriangleContainer& triangles, const ConstrainedEdges_c& constrained, bool planar)
+{
+	const int32_t nbTriangles = triangles.size();
+	const int32_t nbVertices  = vertices.size();
+	// The static schedule gives each thread a contiguous range, in the order of the threads.
+	std::vector<Partial> partials(parallel::maxThreads(), Partial());
+	#pragma omp parallel for schedule(static)
+	for(int32_t f=0;f<nbTriangles;++f)
+	{
+		checkTriangle(vertices, triangles, constrained, planar, f, partials[parallel::threadIndex()]);
+	}
+	#pragma omp parallel for schedule(static)
+	for(int32_t v=0;v<nbVertices;++v)
+	{
+		IndexFace_t f = vertices[v].face();
+		if (f != -1 && (f < -1 || f >= nbTriangles || triangles[f].findVertexIndex(v) == -1))
+		{
+			found(partials[parallel::threadIndex()], FACE_HINT, v);
+		}
+	}
+	Report report = Report();
+	report.vertices  = nbVertices;
+	report.triangles = nbTriangles;
+	report.planar    = planar;
+	for(const Partial& partial : partials)
+	{
+		for(uint32_t i=0;i<PROBLEMS_NUMBER;++i)
+		{
+			report.counts[i] += partial.counts[i];
+			for(uint32_t j=0;j<partial.examples[i].size() && report.examples[i].size() < EXAMPLES;++j)
+			{
+				report.examples[i].push_back(partial.examples[i][j]);
+			}
+		}
+	}
+	return report;
+}
+
+bool validation::valid(const Report& report)
+{
+	for(uint32_t i=0;i<PROBLEMS_NUMBER;++i)
+	{
+		if (report.counts[i] != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+std::string validation::name(Problem_e problem)
+{
+	return PROBLEM_NAMES[problem];
+}
+
+std::string validation::format(const Report& report)
+{
+	std::ostringstream out;
+	out << report.triangles << " triangles, " << report.vertices << " vertices" << (report.planar ? "" : " (topology only)");
+	if (valid(report))
+	{
+		out << " : valid\n";
+		return out.str();
+	}
+	out << " : INVALID\n";
+	for(uint32_t i=0;i<PROBLEMS_NUMBER;++i)
+	{
+		if (report.counts[i] != 0)
+		{
+			out << "    " << name(static_cast<Problem_e>(i)) << " : " << report.counts[i] << " (";
+			for(uint32_t j=0;j<report.examples[i].size();++j)
+			{
+				out << ((j == 0) ? "" : " ") << report.examples[i][j];
+			}
+			out << ((report.counts[i] > report.examples[i].size()) ? " ...)\n" : ")\n");
+		}
+	}
+	return out.str();
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "voronoi.hpp"
+#include "predicats.hpp"
+#include "parallel.hpp"
+
+
+namespace
+{
+	/**
+	 * @brief Get the position of \p v inside \p t.
+	 * @param[in] t The triangle.
+	 * @param[in] v The vertex index to look for.
+	 * @return A value between [0, 2].
+	 */
+	inline uint32_t localIndex(const TopoTriangle& t, IndexVertex_t v)
+	{
+		return std::find(t.beginVertice(), t.endVertice(), v) - t.beginVertice();
+	}
+	/**
+	 * @brief Get the next triangle around \p v, counter-clockwise.
+	 * @return -1 if there is none (border).
+	 */
+	inline IndexFace_t nextAround(const TriangleContainer& triangles, IndexFace_t f, IndexVertex_t v)
+	{
+		return triangles[f].getNeighbors()[(localIndex(triangles[f], v)+1)%3];
+	}
+	/**
+	 * @brief Get the previous triangle around \p v, clockwise.
+	 * @return -1 if there is none (border).
+	 */
+	inline IndexFace_t previousAround(const TriangleContainer& triangles, IndexFace_t f, IndexVertex_t v)
+	{
+		return triangles[f].getNeighbors()[(localIndex(triangles[f], v)+2)%3];
+	}
+}
+
+voronoi::Diagram voronoi::build(const VertexContainer& vertices, const TriangleContainer& triangles)
+{
+	Diagram diagram;
+	const int32_t nbT = triangles.size();
+	const int32_t nbV = vertices.size();
+	diagram.centers.resize(nbT);
+	#pragma omp parallel for schedule(static)
+	for(int32_t f=0;f<nbT;++f)
+	{
+		const IndexVertex_t* ids = triangles[f].beginVertice();
+		Ptriangle3D t(vertices[ids[0]], vertices[ids[1]], vertices[ids[2]]);
+		diagram.centers[f] = centerSurroundingCircle2D(t);
+	}
+	// One triangle around each vertex, and how many of them.
+	std::vector<IndexFace_t> first(nbV, -1);
+	diagram.offsets.assign(nbV+1, 0);
+	for(int32_t f=0;f<nbT;++f)
+	{
+		for(auto it=triangles[f].beginVertice();it!=triangles[f].endVertice();++it)
+		{
+			first[*it] = f;
+			++diagram.offsets[*it+1];
+		}
+	}
+	std::partial_sum(diagram.offsets.begin(), diagram.offsets.end(), diagram.offsets.begin());
+	diagram.cells.resize(diagram.offsets.back());
+	diagram.closed.assign(nbV, 1);
+	std::vector<uint32_t> found(nbV, 0); // The size of each cell, 0 if its walk missed some triangles.
+	#pragma omp parallel for schedule(dynamic, 256)
+	for(int32_t v=0;v<nbV;++v)
+	{
+		if (first[v] == -1)
+		{
+			diagram.closed[v] = 0;
+			continue;
+		}
+		// On the border, the cell starts from the last triangle clockwise.
+		IndexFace_t start = first[v];
+		IndexFace_t f     = first[v];
+		do
+		{
+			IndexFace_t previous = previousAround(triangles, f, v);
+			if (previous == -1)
+			{
+				diagram.closed[v] = 0;
+				start = f;
+				break;
+			}
+			f = previous;
+		} while(f != first[v]);
+		uint32_t k = diagram.offsets[v];
+		f = start;
+		do
+		{
+			diagram.cells[k++] = f;
+			f = nextAround(triangles, f, v);
+		} while(f != -1 && f != start && k < diagram.offsets[v+1]);
+		// A single fan has to go through every triangle of v, up to the border or back to its start :
+		// otherwise (a non manifold vertex), the cell is unbounded, and left empty instead of partial.
+		if (k == diagram.offsets[v+1] && f == (diagram.closed[v] ? start : -1))
+		{
+			found[v] = k - diagram.offsets[v];
+		}
+		else
+		{
+			diagram.closed[v] = 0;
+		}
+	}
+	// Close the gaps of the emptied cells.
+	uint32_t k = 0;
+	for(int32_t v=0;v<nbV;++v)
+	{
+		const uint32_t begin = diagram.offsets[v];
+		diagram.offsets[v]   = k;
+		std::copy(diagram.cells.begin() + begin, diagram.cells.begin() + begin + found[v], diagram.cells.begin() + k);
+		k += found[v];
+	}
+	diagram.offsets[nbV] = k;
+	diagram.cells.resize(k);
+	return diagram;
+}
+
+VertexType voronoi::area(const Diagram& diagram, IndexVertex_t v)
+{
+	if (!diagram.closed[v])
+	{
+		return std::numeric_limits<VertexType>::infinity();
+	}
+	VertexType result = 0.0;
+	const uint32_t begin = diagram.offsets[v];
+	const uint32_t end   = diagram.offsets[v+1];
+	for(uint32_t i=begin;i<end;++i)
+	{
+		const Vertex& a = diagram.centers[diagram.cells[i]];
+		const Vertex& b = diagram.centers[diagram.cells[(i+1 == end) ? begin : i+1]];
+		result += a.x()*b.y() - b.x()*a.y();
+	}
+	return result/2.0;
+}
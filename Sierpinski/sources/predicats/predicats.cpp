@@ -1,5 +1,7 @@
+#include <cfloat>
 #include <cmath>
 #include "predicats.hpp"
+#include "stats.hpp"
 
 namespace
 {
@@ -53,17 +55,25 @@ namespace
 		double d_ab   = length(ab);
 		double d_ac   = length(ac);
 		double scalar = dot(ab , ac);
-		return radian2deg(scalar/(d_ab*d_ac));
+		return radian2deg(std::acos(scalar/(d_ab*d_ac)));
 	}
 }
 
 bool isWellOriented(const Pvertex3D& v1, const Pvertex3D& v2, const Pvertex3D& v3)
 {
+	STATS_COUNT(WELL_ORIENTED, 1);
 	return cross(v1-v2, v1-v3).z > 0.0;
 }
 
+double orientation2D(const Pvertex3D& v1, const Pvertex3D& v2, const Pvertex3D& v3)
+{
+	STATS_COUNT(ORIENTATION, 1);
+	return (v2.x - v1.x)*(v3.y - v1.y) - (v2.y - v1.y)*(v3.x - v1.x);
+}
+
 bool isInThisTriangle(const Pvertex3D& v, const Ptriangle3D& t)
 {
+	STATS_COUNT(IN_TRIANGLE, 1);
 	double denominator = ((t.b.y - t.c.y)*(t.a.x - t.c.x) + (t.c.x - t.b.x)*(t.a.y - t.c.y));
 	double a           = ((t.b.y - t.c.y)*(v.x - t.c.x) + (t.c.x - t.b.x)*(v.y - t.c.y))/denominator;
 	double b           = ((t.c.y - t.a.y)*(v.x - t.c.x) + (t.a.x - t.c.x)*(v.y - t.c.y))/denominator;
@@ -90,12 +100,13 @@ namespace
 	// true = (+), false = (-)
 	bool signMatrix(const Matrix3x3& mat)
 	{
-		return det(mat) <= 0.0;
+		return det(mat) < 0.0; // Strict, or cocircular points would be flipped forever.
 	}
 }
 
 bool isInSurroundingCircle(const Pvertex3D& p, const Pvertex3D& q, const Pvertex3D& r, const Pvertex3D& s)
 {
+	STATS_COUNT(IN_CIRCLE, 1);
 	double qxpx = q.x-p.x;
 	double rxpx = r.x-p.x;
 	double sxpx = s.x-p.x;
@@ -110,6 +121,146 @@ bool isInSurroundingCircle(const Pvertex3D& p, const Pvertex3D& q, const Pvertex
 	return signMatrix(matrix);
 }
 
+namespace
+{
+	const uint32_t AREA_COMPONENTS   = 12;                    //!< 6 exact products of 2 components at most.
+	const uint32_t LIFTED_COMPONENTS = 2*2*2*AREA_COMPONENTS; //!< 2 lifted coordinates, each of 2 components, times an area.
+	const uint32_t CIRCLE_COMPONENTS = 4*LIFTED_COMPONENTS;   //!< 4 lifted points.
+	
+	/**
+	 * @brief An exact value, as a sum of non overlapping doubles, the smallest first (Shewchuk's expansions).
+	 * The sign of the sum is the one of its last component. The components stay on the stack, \p N
+	 * bounds their number : each addition of a double adds one at most.
+	 */
+	template<uint32_t N>
+	struct Expansion final
+	{
+		double   components[N]; //!< The non zero components, apart from a single zero.
+		uint32_t size = 0;      //!< The number of components.
+	};
+
+	//! @brief Add \p b to \p e, exactly, in place : each component is written where one was already read.
+	template<uint32_t N>
+	void grow(Expansion<N>& e, double b)
+	{
+		double   q = b;
+		uint32_t n = 0;
+		for(uint32_t i=0;i<e.size;++i)
+		{
+			// q + component == sum + error, exactly (Knuth's two sum).
+			double component = e.components[i];
+			double sum       = q + component;
+			double virtualB  = sum - q;
+			double virtualA  = sum - virtualB;
+			double error     = (q - virtualA) + (component - virtualB);
+			if (error != 0.0)
+			{
+				e.components[n++] = error;
+			}
+			q = sum;
+		}
+		if (q != 0.0 || n == 0)
+		{
+			e.components[n++] = q;
+		}
+		e.size = n;
+	}
+	//! @brief Add \p a * \p b to \p e, exactly.
+	template<uint32_t N>
+	void growProduct(Expansion<N>& e, double a, double b)
+	{
+		double product = a*b;
+		grow(e, std::fma(a, b, -product)); // The rounding error of the product, exactly.
+		grow(e, product);
+	}
+	//! @brief Add \p factor * \p a * \p b to \p e, exactly.
+	template<uint32_t N, uint32_t M>
+	void growProduct(Expansion<N>& e, const Expansion<M>& factor, double a, double b)
+	{
+		Expansion<2> ab;
+		growProduct(ab, a, b);
+		for(uint32_t i=0;i<factor.size;++i)
+		{
+			for(uint32_t j=0;j<ab.size;++j)
+			{
+				growProduct(e, factor.components[i], ab.components[j]);
+			}
+		}
+	}
+	template<uint32_t N>
+	int32_t sign(const Expansion<N>& e)
+	{
+		double last = e.components[e.size-1];
+		return (last > 0.0) ? 1 : ((last < 0.0) ? -1 : 0);
+	}
+	//! @brief The signed area (times 2) of \b a, \b b, \b c, exactly, as a sum of products of 2 coordinates.
+	Expansion<AREA_COMPONENTS> exactArea(double ax, double ay, double bx, double by, double cx, double cy)
+	{
+		Expansion<AREA_COMPONENTS> e;
+		growProduct(e,  bx, cy);
+		growProduct(e, -bx, ay);
+		growProduct(e, -ax, cy);
+		growProduct(e, -by, cx);
+		growProduct(e,  by, ax);
+		growProduct(e,  ay, cx);
+		return e;
+	}
+	//! @brief Add \p scale * (\p x^2 + \p y^2) * \p area to \p e, exactly.
+	void growLifted(Expansion<CIRCLE_COMPONENTS>& e, double x, double y, const Expansion<AREA_COMPONENTS>& area, double scale)
+	{
+		growProduct(e, area, scale*x, x);
+		growProduct(e, area, scale*y, y);
+	}
+}
+
+int32_t exactOrientation2D(const Pvertex3D& v1, const Pvertex3D& v2, const Pvertex3D& v3)
+{
+	double left  = (v2.x - v1.x)*(v3.y - v1.y);
+	double right = (v2.y - v1.y)*(v3.x - v1.x);
+	double det   = left - right;
+	if (std::fabs(det) > ORIENT_BOUND*(std::fabs(left) + std::fabs(right)))
+	{
+		return (det > 0.0) ? 1 : -1;
+	}
+	return expandedOrientation2D(v1.x, v1.y, v2.x, v2.y, v3.x, v3.y);
+}
+
+int32_t expandedOrientation2D(double ax, double ay, double bx, double by, double cx, double cy)
+{
+	return sign(exactArea(ax, ay, bx, by, cx, cy));
+}
+
+int32_t exactInCircle(const Pvertex3D& p, const Pvertex3D& q, const Pvertex3D& r, const Pvertex3D& s)
+{
+	double pdx = p.x - s.x, pdy = p.y - s.y;
+	double qdx = q.x - s.x, qdy = q.y - s.y;
+	double rdx = r.x - s.x, rdy = r.y - s.y;
+	double plift = pdx*pdx + pdy*pdy;
+	double qlift = qdx*qdx + qdy*qdy;
+	double rlift = rdx*rdx + rdy*rdy;
+	double qr = qdx*rdy, rq = rdx*qdy;
+	double rp = rdx*pdy, pr = pdx*rdy;
+	double pq = pdx*qdy, qp = qdx*pdy;
+	double det       = plift*(qr - rq) + qlift*(rp - pr) + rlift*(pq - qp);
+	double permanent = (std::fabs(qr) + std::fabs(rq))*plift + (std::fabs(rp) + std::fabs(pr))*qlift + (std::fabs(pq) + std::fabs(qp))*rlift;
+	if (std::fabs(det) > CIRCLE_BOUND*permanent)
+	{
+		return (det > 0.0) ? 1 : -1;
+	}
+	return expandedInCircle(p.x, p.y, q.x, q.y, r.x, r.y, s.x, s.y);
+}
+
+int32_t expandedInCircle(double px, double py, double qx, double qy, double rx, double ry, double sx, double sy)
+{
+	// The 4x4 determinant of the lifted points, expanded along the lifted column.
+	Expansion<CIRCLE_COMPONENTS> e;
+	growLifted(e, px, py, exactArea(qx, qy, rx, ry, sx, sy),  1.0);
+	growLifted(e, qx, qy, exactArea(px, py, rx, ry, sx, sy), -1.0);
+	growLifted(e, rx, ry, exactArea(px, py, qx, qy, sx, sy),  1.0);
+	growLifted(e, sx, sy, exactArea(px, py, qx, qy, rx, ry), -1.0);
+	return sign(e);
+}
+
 Point_t centerSurroundingCircle2D(const Triangle_t& t)
 {
 	Pvertex3D ab    = t.b - t.a;
@@ -126,6 +277,7 @@ Point_t centerSurroundingCircle2D(const Triangle_t& t)
 
 bool isPoorQuality(const Ptriangle3D& tr, double angleThreshold)
 {
+	STATS_COUNT(POOR_QUALITY, 1);
 	return (computeAngle(tr.a, tr.b, tr.c) < angleThreshold || 
 			computeAngle(tr.b, tr.a, tr.c) < angleThreshold ||
 			computeAngle(tr.c, tr.a, tr.b) < angleThreshold);
@@ -133,9 +285,10 @@ bool isPoorQuality(const Ptriangle3D& tr, double angleThreshold)
 
 bool isInCircleOfDiametral(const Pvertex3D& a, const Pvertex3D& b, const Pvertex3D& t)
 {
-	Pvertex3D center = (b-a)/2.0;
-	double    radius = length2(center);
-	return (t.x-center.x)*(t.x-center.x) + (t.y-center.y)*(t.y-center.y) + (t.z-center.z)*(t.z-center.z) <= radius*radius;
+	STATS_COUNT(IN_DIAMETRAL, 1);
+	Pvertex3D center = (a+b)/2.0;
+	double    radius = length2(b-a)/4.0;
+	return length2(t-center) < radius;
 }
 
 Pvertex3D barycentre(const Ptriangle3D& triangle)
@@ -0,0 +1,975 @@
+/**
+ * @file main.cpp
+ * @brief Regression tests of the Mesh algorithms, over the point sets which broke them.
+ *
+ * Usage :
+ * @code
+ * SierpinskiTests
+ * @endcode
+ * Each test prints one line, and the exit code is the number of failed tests.
+ * The point sets are written into the current directory, and removed afterwards.
+ * @author MTLCRBN
+ */
+#include <array>
+#include <algorithm>
+#include <cstdio>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <functional>
+
+#include "Mesh.hpp"
+#include "logs.hpp"
+#include "generators.hpp"
+
+
+namespace
+{
+	const uint32_t SEED  = 20170101; //!< The same point sets as the benchmarks.
+	const double   ANGLE = 22.0;     //!< The smallest angle Mesh::loadConstraints() refines to.
+
+	/**
+	 * @brief Write \p points as a .pts file, and triangulate it.
+	 * @param[out] mesh   The triangulation.
+	 * @param[in]  points The points.
+	 * @param[in]  name   The name of the file, removed once loaded.
+	 */
+	void triangulate(Mesh& mesh, const VertexContainer& points, const std::string& name)
+	{
+		std::string fname = "tests_" + name + ".pts";
+		generators::writePts(points, fname);
+		try
+		{
+			mesh.load2DTriangulationFromPts(fname);
+		}
+		catch(...)
+		{
+			std::remove(fname.c_str());
+			throw;
+		}
+		std::remove(fname.c_str());
+	}
+	/**
+	 * @brief Check \p mesh, printing the problems found.
+	 * @return true if there is none.
+	 */
+	bool isValid(const Mesh& mesh, bool planar)
+	{
+		validation::Report report = mesh.validate(planar);
+		if (!validation::valid(report))
+		{
+			std::cout << validation::format(report);
+			return false;
+		}
+		return true;
+	}
+	/**
+	 * @brief Check that the face of each vertex of \p mesh contains it, apart from the ones left out.
+	 * @return true if they all do.
+	 */
+	bool hintsHoldTheirVertex(const Mesh& mesh)
+	{
+		const VertexContainer&   vertices  = mesh.getVertices();
+		const TriangleContainer& triangles = mesh.getTriangles();
+		for(uint32_t i=0;i<vertices.size();++i)
+		{
+			IndexFace_t face = vertices[i].face();
+			if (face != -1 && triangles.at(face).findVertexIndex(i) == -1)
+			{
+				std::cout << "vertex " << i << " : face " << face << " doesn't contain it" << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+	/**
+	 * @brief Write a closed sphere as an OFF file : the 2 poles, and \p rings - 1 rings of \p sectors vertices
+	 * between them. Its radius is 1, moved by \p bumps times a wave of the latitude and the longitude.
+	 */
+	void writeSphere(const std::string& fname, uint32_t rings, uint32_t sectors, double bumps)
+	{
+		std::ofstream file(fname.c_str());
+		file << std::setprecision(std::numeric_limits<VertexType>::max_digits10);
+		file << "OFF" << std::endl << 2 + (rings-1)*sectors << " " << 2*(rings-1)*sectors << " 0" << std::endl;
+		file << "0 0 " << 1.0 + bumps << std::endl;
+		for(uint32_t i=1;i<rings;++i)
+		{
+			for(uint32_t j=0;j<sectors;++j)
+			{
+				double theta  = M_PI*i/rings;
+				double phi    = 2.0*M_PI*j/sectors;
+				double radius = 1.0 + bumps*std::cos(5.0*theta)*std::cos(4.0*phi);
+				file << radius*std::sin(theta)*std::cos(phi) << " " << radius*std::sin(theta)*std::sin(phi) << " " << radius*std::cos(theta) << std::endl;
+			}
+		}
+		file << "0 0 " << -1.0 - bumps*std::cos(5.0*M_PI) << std::endl;
+		// Counterclockwise seen from the outside.
+		const uint32_t south = 1 + (rings-1)*sectors;
+		auto ring = [sectors](uint32_t i, uint32_t j){return 1 + (i-1)*sectors + j%sectors;};
+		for(uint32_t j=0;j<sectors;++j)
+		{
+			file << "3 0 " << ring(1, j) << " " << ring(1, j+1) << std::endl;
+			for(uint32_t i=1;i+1<rings;++i)
+			{
+				file << "3 " << ring(i, j) << " " << ring(i+1, j)   << " " << ring(i+1, j+1) << std::endl;
+				file << "3 " << ring(i, j) << " " << ring(i+1, j+1) << " " << ring(i, j+1)   << std::endl;
+			}
+			file << "3 " << south << " " << ring(rings-1, j+1) << " " << ring(rings-1, j) << std::endl;
+		}
+	}
+	/**
+	 * @brief Load the sphere of writeSphere() into \p mesh.
+	 */
+	void sphere(Mesh& mesh, uint32_t rings, uint32_t sectors, double bumps)
+	{
+		const std::string fname = "tests_sphere.off";
+		writeSphere(fname, rings, sectors, bumps);
+		mesh.loadMeshFromOff(fname);
+		std::remove(fname.c_str());
+	}
+	/**
+	 * @brief A triangle, then vertices inside which only split a triangle each, without any flip :
+	 * each split has to move the hint of the corner left out of the rewritten triangle.
+	 */
+	bool splitsOnly(void)
+	{
+		VertexContainer points;
+		for(const std::pair<double, double>& p : std::vector<std::pair<double, double>>{{0.0, 0.0}, {4.0, 0.0}, {0.0, 4.0}, {1.0, 1.0}, {1.5, 0.5}, {0.5, 1.5}})
+		{
+			points.push_back(Vertex(p.first, p.second, 0.0));
+		}
+		Mesh mesh;
+		triangulate(mesh, points, "splits");
+		return hintsHoldTheirVertex(mesh) && isValid(mesh, true);
+	}
+	/**
+	 * @brief Compare the read only iterators with the read/write ones, and with the sentinels,
+	 * before and after the mesh grows.
+	 */
+	bool iteratorsCompare(void)
+	{
+		Mesh mesh;
+		triangulate(mesh, generators::points(generators::UNIFORM, 100, SEED), "iterators");
+		MeshRange<TopoTriangle>       range = mesh.rangeT();
+		Mesh::const_triangle_iterator first = mesh.beginT();
+		uint32_t                      nb    = 0;
+		for(Mesh::triangle_iterator it=range.begin();it!=range.cend();++it)
+		{
+			++nb;
+		}
+		if (nb != range.size() || !(range.begin() == first) || !(first == range.begin()) || range.cend() - range.begin() != nb)
+		{
+			return false;
+		}
+		const Mesh::vertex_sentinel last   = mesh.sentinelV();
+		Mesh::vertex_iterator       end    = mesh.endV();
+		uint32_t                    before = mesh.getVertices().size();
+		if (end != last || mesh.beginV() == last)
+		{
+			return false;
+		}
+		triangulate(mesh, generators::points(generators::UNIFORM, 200, SEED), "iterators");
+		uint32_t added = 0;
+		for(Mesh::const_vertex_iterator it=end;it!=last;++it)
+		{
+			++added;
+		}
+		return added == mesh.getVertices().size() - before && !(end == last);
+	}
+	/**
+	 * @brief Two triangles which only share a vertex : its triangles make two fans, so its voronoi cell
+	 * has to be empty and unbounded, not the part of it one walk found.
+	 */
+	bool voronoiOfABowtie(void)
+	{
+		const std::string fname = "tests_bowtie.off";
+		{
+			std::ofstream out(fname.c_str());
+			out << "OFF\n5 2 0\n0 0 0\n1 -1 0\n1 1 0\n-1 1 0\n-1 -1 0\n3 0 1 2\n3 0 3 4\n";
+		}
+		Mesh mesh;
+		mesh.loadMeshFromOff(fname);
+		std::remove(fname.c_str());
+		const voronoi::Diagram& diagram = mesh.getVoronoi();
+		if (voronoi::size(diagram, 0) != 0 || diagram.closed[0])
+		{
+			std::cout << "vertex 0 : " << voronoi::size(diagram, 0) << " center(s)" << std::endl;
+			return false;
+		}
+		for(IndexVertex_t v=1;v<5;++v)
+		{
+			if (voronoi::size(diagram, v) != 1 || diagram.cells[diagram.offsets[v]] != ((v < 3) ? 0 : 1))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	/**
+	 * @brief Analyze a closed tetrahedron beside a bowtie and an isolated vertex, then a fin of 3
+	 * triangles on one edge.
+	 */
+	bool componentsOfBrokenMeshes(void)
+	{
+		auto analyze = [](const std::string& off){
+			const std::string fname = "tests_components.off";
+			{
+				std::ofstream out(fname.c_str());
+				out << off;
+			}
+			Mesh mesh;
+			mesh.loadMeshFromOff(fname);
+			std::remove(fname.c_str());
+			return mesh.analyzeComponents();
+		};
+		// The tetrahedron is 0 1 2 3, the bowtie turns around 4, and 9 is alone.
+		components::Report report = analyze("OFF\n10 6 0\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n"
+		                                    "3 0 0\n4 -1 0\n4 1 0\n2 1 0\n2 -1 0\n9 9 9\n"
+		                                    "3 0 2 1\n3 0 1 3\n3 1 2 3\n3 0 3 2\n3 4 5 6\n3 4 7 8\n");
+		const std::vector<uint32_t> offsets = {0, 4, 5, 6};
+		const std::vector<uint32_t> labels  = {0, 0, 0, 0, 1, 2};
+		if (components::count(report) != 3 || report.offsets != offsets || report.labels != labels ||
+		    report.borderEdges != 6 || report.boundaryLoops != 1 || report.nonManifoldEdges != 0 ||
+		    report.nonManifoldVertices != 1 || report.isolatedVertices != 1 || components::manifold(report))
+		{
+			std::cout << components::format(report) << std::endl;
+			return false;
+		}
+		// Without the bowtie, only the loop of the lone triangle is left.
+		report = analyze("OFF\n7 5 0\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n3 0 0\n4 -1 0\n4 1 0\n"
+		                 "3 0 2 1\n3 0 1 3\n3 1 2 3\n3 0 3 2\n3 4 5 6\n");
+		if (components::count(report) != 2 || report.boundaryLoops != 1 || report.borderEdges != 3 || !components::manifold(report))
+		{
+			std::cout << components::format(report) << std::endl;
+			return false;
+		}
+		// Three triangles on the edge 0 1 can't all link back.
+		report = analyze("OFF\n5 3 0\n0 0 0\n1 0 0\n0 1 0\n0 -1 0\n0 0 1\n3 0 1 2\n3 1 0 3\n3 0 1 4\n");
+		if (components::manifold(report) || report.nonManifoldEdges == 0)
+		{
+			std::cout << components::format(report) << std::endl;
+			return false;
+		}
+		return true;
+	}
+	/**
+	 * @brief Compare the cached normals of \p mesh with the ones computed from scratch.
+	 * @return true if they are the same, up to the rounding of the sums.
+	 */
+	bool normalsMatch(Mesh& mesh, normals::Weighting_e weighting, const std::string& step)
+	{
+		const normals::Normals& cached = mesh.getNormals(weighting);
+		const normals::Normals  fresh  = normals::build(mesh.getVertices(), mesh.getTriangles(), weighting);
+		auto same = [](const std::vector<VertexType>& a, const std::vector<VertexType>& b){
+			return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](VertexType x, VertexType y){return std::fabs(x - y) < 1e-9;});
+		};
+		if (!same(cached.faces, fresh.faces) || !same(cached.vertices, fresh.vertices))
+		{
+			std::cout << step << " : the cached normals differ" << std::endl;
+			return false;
+		}
+		return true;
+	}
+	/**
+	 * @brief Lift a triangulation into a surface, then flip its edges and insert a constraint : the normals
+	 * are only updated around them, until so many flips, or a smoothing, that they are computed again.
+	 */
+	bool normalsFollowChanges(void)
+	{
+		Mesh mesh;
+		triangulate(mesh, generators::points(generators::UNIFORM, 1000, SEED), "normals");
+		for(Vertex& v : mesh.getVertices())
+		{
+			v = Vertex(v.x(), v.y(), std::sin(v.x()/100.0)*std::cos(v.y()/70.0)*50.0);
+		}
+		mesh.touch();
+		if (!normalsMatch(mesh, normals::AREA, "lifted"))
+		{
+			return false;
+		}
+		const TriangleContainer& triangles = mesh.getTriangles();
+		const VertexContainer&   vertices  = mesh.getVertices();
+		// A neighbor of f whose flip keeps the triangulation planar, or -1.
+		auto pairOf = [&](IndexFace_t f){
+			auto side = [&vertices](IndexVertex_t a, IndexVertex_t b, IndexVertex_t c){
+				const Vertex u = vertices[b] - vertices[a], w = vertices[c] - vertices[a];
+				return u.x()*w.y() - u.y()*w.x() > 0.0;
+			};
+			for(uint32_t i=0;i<3;++i)
+			{
+				const IndexFace_t    g   = triangles[f].getNeighbors()[i];
+				const IndexVertex_t* ids = triangles[f].beginVertice();
+				if (g != -1)
+				{
+					const IndexVertex_t c = ids[i], a = ids[(i+1)%3], b = ids[(i+2)%3], d = triangles[g].getOppositeVertexOf(f);
+					if (side(c, d, a) != side(c, d, b))
+					{
+						return g;
+					}
+				}
+			}
+			return static_cast<IndexFace_t>(-1);
+		};
+		uint32_t flips = 0;
+		for(IndexFace_t f=0;f<static_cast<IndexFace_t>(triangles.size());f+=13)
+		{
+			const IndexFace_t g = pairOf(f);
+			if (g != -1)
+			{
+				mesh.flip(f, g);
+				++flips;
+			}
+		}
+		if (flips < 100 || !normalsMatch(mesh, normals::AREA, "flips") || !normalsMatch(mesh, normals::ANGLE, "other weighting"))
+		{
+			return false;
+		}
+		const IndexVertex_t far = std::max_element(mesh.getVertices().begin(), mesh.getVertices().end(),
+		                                           [](const Vertex& a, const Vertex& b){return a.x() < b.x();}) - mesh.getVertices().begin();
+		mesh.insertConstraint({0, far});
+		if (!normalsMatch(mesh, normals::ANGLE, "constraint"))
+		{
+			return false;
+		}
+		// Flipping the same edge back and forth logs more changes than triangles.
+		IndexFace_t f = triangles.size()/2;
+		while(pairOf(f) == -1)
+		{
+			++f;
+		}
+		const IndexFace_t g = pairOf(f);
+		for(uint32_t i=0;i<=triangles.size();++i)
+		{
+			mesh.flip(f, g);
+		}
+		if (!normalsMatch(mesh, normals::ANGLE, "too many flips"))
+		{
+			return false;
+		}
+		// Moving the vertices can't be followed, they are computed again.
+		mesh.smooth(2);
+		return normalsMatch(mesh, normals::ANGLE, "smoothed");
+	}
+	/**
+	 * @brief Check the laplacian of a bumpy sphere, symmetric and with rows summing to 0, and updated
+	 * as if it was built again once the vertices moved. Then the curvatures of a round one.
+	 */
+	bool laplacianOfASphere(void)
+	{
+		Mesh mesh;
+		sphere(mesh, 20, 40, 0.2);
+		const adjacency::Vertices adjacency = mesh.buildVertexAdjacency();
+		laplacian::Matrix         matrix    = mesh.buildLaplacian(adjacency);
+		auto entry = [&matrix](IndexVertex_t v, IndexVertex_t w){
+			for(uint32_t e=matrix.offsets[v];e<matrix.offsets[v+1];++e)
+			{
+				if (matrix.columns[e] == w)
+				{
+					return matrix.values[e];
+				}
+			}
+			return std::numeric_limits<VertexType>::quiet_NaN();
+		};
+		for(IndexVertex_t v=0;v+1<static_cast<IndexVertex_t>(matrix.offsets.size());++v)
+		{
+			VertexType sum = 0.0, biggest = 0.0;
+			for(uint32_t e=matrix.offsets[v];e<matrix.offsets[v+1];++e)
+			{
+				sum    += matrix.values[e];
+				biggest = std::max(biggest, std::fabs(matrix.values[e]));
+				if (!(std::fabs(matrix.values[e] - entry(matrix.columns[e], v)) < 1e-12))
+				{
+					std::cout << "entry " << v << " " << matrix.columns[e] << " : " << matrix.values[e] << " against " << entry(matrix.columns[e], v) << std::endl;
+					return false;
+				}
+			}
+			if (std::fabs(sum) > 1e-12*biggest)
+			{
+				std::cout << "row " << v << " : sum " << sum << std::endl;
+				return false;
+			}
+		}
+		for(Vertex& v : mesh.getVertices())
+		{
+			v = v*(1.0 + 0.1*v.z()*v.x());
+		}
+		laplacian::update(mesh.getVertices(), matrix);
+		const laplacian::Matrix built = mesh.buildLaplacian(adjacency);
+		for(uint32_t e=0;e<built.values.size();++e)
+		{
+			if (std::fabs(built.values[e] - matrix.values[e]) > 1e-12)
+			{
+				std::cout << "entry " << e << " : updated to " << matrix.values[e] << " against " << built.values[e] << std::endl;
+				return false;
+			}
+		}
+		// On the unit sphere both curvatures are 1, apart from the thin triangles at the poles, and the
+		// angle defects sum to 4 pi whatever the triangles.
+		Mesh round;
+		sphere(round, 30, 60, 0.0);
+		const laplacian::Curvatures curvatures = round.computeCurvatures();
+		VertexType                  total      = 0.0, worst = 0.0;
+		for(IndexVertex_t v=0;v<static_cast<IndexVertex_t>(round.getVertices().size());++v)
+		{
+			total += curvatures.gaussian[v]*curvatures.areas[v];
+			if (std::fabs(round.getVertices()[v].z()) < 0.9)
+			{
+				worst = std::max(worst, std::fabs(curvatures.mean[v] - 1.0));
+			}
+		}
+		if (worst > 0.005 || std::fabs(total - 4.0*M_PI) > 1e-9)
+		{
+			std::cout << "mean curvature off by " << worst << ", total gaussian curvature " << total << std::endl;
+			return false;
+		}
+		return true;
+	}
+	/**
+	 * @brief Triangulate \p points, check it, then run the crust over it and check it again.
+	 * @return true if both are valid, and the crust found a curve.
+	 */
+	bool triangulationThenCrust(const VertexContainer& points, const std::string& name)
+	{
+		Mesh mesh;
+		triangulate(mesh, points, name);
+		if (!isValid(mesh, true))
+		{
+			return false;
+		}
+		mesh.Crust();
+		return isValid(mesh, false) && !mesh.getCurve().empty();
+	}
+	/**
+	 * @brief Cluster a closed bumpy sphere kept on the disk, at several resolutions, then simplify it :
+	 * the merged triangles mustn't open any hole.
+	 * @return true if every result is valid, without any border.
+	 */
+	bool clusteringStaysClosed(void)
+	{
+		const std::string fname = "tests_cluster.off";
+		writeSphere(fname, 60, 120, 0.2);
+		outofcore::Store store;
+		try
+		{
+			store = outofcore::convert(fname, "tests_cluster", 1 << 20);
+		}
+		catch(...)
+		{
+			std::remove(fname.c_str());
+			throw;
+		}
+		std::remove(fname.c_str());
+		bool closed = true;
+		for(uint32_t resolution : {3, 5, 8, 13, 21, 34})
+		{
+			Mesh mesh;
+			mesh.loadClustered(store, resolution);
+			uint64_t clustered = mesh.analyzeComponents().boundaryLoops;
+			closed = closed && isValid(mesh, false);
+			mesh.simplify(mesh.getTriangles().size()/4);
+			uint64_t simplified = mesh.analyzeComponents().boundaryLoops;
+			if (clustered != 0 || simplified != 0)
+			{
+				std::cout << "resolution " << resolution << " : " << clustered << " loop(s) once clustered, " << simplified << " once simplified" << std::endl;
+				closed = false;
+			}
+			closed = closed && isValid(mesh, false);
+		}
+		outofcore::discard(store);
+		return closed;
+	}
+	/**
+	 * @brief Encode \p mesh, decode it, and compare both : each decoded vertex has to be the quantized one
+	 * of a vertex of \p mesh, and the triangles the same ones, with the same orientation.
+	 * @return true if they are the same mesh, up to the indexes.
+	 */
+	bool codecKeepsTheTopology(const Mesh& mesh, uint32_t bits)
+	{
+		std::stringstream stream;
+		codec::encode(mesh.getVertices(), mesh.getTriangles(), stream, bits);
+		VertexContainer   vertices;
+		TriangleContainer triangles;
+		codec::decode(stream, vertices, triangles);
+		const VertexContainer& original = mesh.getVertices();
+		if (vertices.size() != original.size() || triangles.size() != mesh.getTriangles().size())
+		{
+			std::cout << vertices.size() << " vertices and " << triangles.size() << " triangles decoded" << std::endl;
+			return false;
+		}
+		validation::Report report = validation::check(vertices, triangles, ConstrainedEdges_c(), false);
+		if (!validation::valid(report))
+		{
+			std::cout << validation::format(report);
+			return false;
+		}
+		// The closest vertex, within the error of the quantization, and never twice the same.
+		Vertex low  = original.front();
+		Vertex high = original.front();
+		for(const Vertex& p : original)
+		{
+			low  = Vertex(std::min(low.x(),  p.x()), std::min(low.y(),  p.y()), std::min(low.z(),  p.z()));
+			high = Vertex(std::max(high.x(), p.x()), std::max(high.y(), p.y()), std::max(high.z(), p.z()));
+		}
+		const VertexType extent = std::max({high.x() - low.x(), high.y() - low.y(), high.z() - low.z()});
+		const VertexType error = extent/(1u << bits);
+		std::vector<IndexVertex_t> toOriginal(vertices.size(), -1);
+		std::vector<bool>          used(original.size(), false);
+		for(uint32_t v=0;v<vertices.size();++v)
+		{
+			IndexVertex_t closest = -1;
+			VertexType    best    = std::numeric_limits<VertexType>::max();
+			for(uint32_t w=0;w<original.size();++w)
+			{
+				VertexType d = (vertices[v] - original[w]).length();
+				if (d < best)
+				{
+					best    = d;
+					closest = w;
+				}
+			}
+			if (best > error || used[closest])
+			{
+				std::cout << "vertex " << v << " : " << best << " from the closest one, " << error << " allowed" << std::endl;
+				return false;
+			}
+			used[closest]  = true;
+			toOriginal[v] = closest;
+		}
+		// The triangles, their smallest vertex first.
+		auto canonical = [](IndexVertex_t a, IndexVertex_t b, IndexVertex_t c){
+			std::array<IndexVertex_t, 3> t = {a, b, c};
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			return t;
+		};
+		std::vector<std::array<IndexVertex_t, 3>> before, after;
+		for(const TopoTriangle& t : mesh.getTriangles())
+		{
+			before.push_back(canonical(t.beginVertice()[0], t.beginVertice()[1], t.beginVertice()[2]));
+		}
+		for(const TopoTriangle& t : triangles)
+		{
+			after.push_back(canonical(toOriginal[t.beginVertice()[0]], toOriginal[t.beginVertice()[1]], toOriginal[t.beginVertice()[2]]));
+		}
+		std::sort(before.begin(), before.end());
+		std::sort(after.begin(), after.end());
+		if (before != after)
+		{
+			std::cout << "the decoded triangles differ" << std::endl;
+			return false;
+		}
+		return true;
+	}
+	//! @brief The codec over a closed sphere, and over a planar triangulation which has a border.
+	bool codecRoundTrips(void)
+	{
+		Mesh closed, open;
+		sphere(closed, 20, 40, 0.2);
+		triangulate(open, generators::points(generators::UNIFORM, 1000, SEED), "codec");
+		return codecKeepsTheTopology(closed, codec::DEFAULT_BITS) && codecKeepsTheTopology(open, codec::DEFAULT_BITS);
+	}
+	/**
+	 * @brief Decode every prefix of the stream of a sphere, and the stream with each byte changed in turn.
+	 * Without a checksum, a change of the grid or of a residual only moves the vertices.
+	 * @return true if codec::decode() throws std::runtime_error on every prefix, and on every change
+	 * unless it decodes as many vertices and triangles.
+	 */
+	bool codecRejectsBrokenStreams(void)
+	{
+		Mesh mesh;
+		sphere(mesh, 10, 20, 0.2);
+		std::stringstream stream;
+		codec::encode(mesh.getVertices(), mesh.getTriangles(), stream);
+		const std::string bytes = stream.str();
+		auto decodes = [&mesh](const std::string& broken){
+			std::istringstream in(broken);
+			VertexContainer    vertices;
+			TriangleContainer  triangles;
+			try
+			{
+				codec::decode(in, vertices, triangles);
+			}
+			catch(const std::runtime_error&)
+			{
+				return false;
+			}
+			if (vertices.size() != mesh.getVertices().size() || triangles.size() != mesh.getTriangles().size())
+			{
+				throw std::logic_error(std::to_string(vertices.size()) + " vertices and " + std::to_string(triangles.size()) + " triangles decoded");
+			}
+			return true;
+		};
+		for(size_t size=0;size<bytes.size();++size)
+		{
+			if (decodes(bytes.substr(0, size)))
+			{
+				std::cout << "truncated to " << size << " bytes of " << bytes.size() << " : decoded" << std::endl;
+				return false;
+			}
+		}
+		uint32_t survived = 0;
+		for(size_t i=0;i<bytes.size();++i)
+		{
+			std::string broken = bytes;
+			broken[i]          = ~broken[i];
+			survived          += decodes(broken) ? 1 : 0;
+		}
+		std::cout << survived << " of " << bytes.size() << " changed bytes decoded, only moving the vertices" << std::endl;
+		return true;
+	}
+	//! @brief The squared distance between \p a and \p b, computed like the kd-tree does.
+	VertexType distance2(const Vertex& a, const Vertex& b)
+	{
+		VertexType dx = a.x()-b.x(), dy = a.y()-b.y(), dz = a.z()-b.z();
+		return dx*dx + dy*dy + dz*dz;
+	}
+	/**
+	 * @brief Compare the k nearest and the radius queries of a kd-tree with a brute force search, over
+	 * \p nb random points in a cube, a tenth of them given twice, for k up to more than their number.
+	 * @return true if they find the same distances, and the same vertices within a radius.
+	 */
+	bool kdTreeMatchesBruteForce(uint32_t nb)
+	{
+		std::mt19937                               random(SEED);
+		std::uniform_real_distribution<VertexType> unit(-1.0, 1.0);
+		VertexContainer                            vertices;
+		for(uint32_t i=0;i<nb;++i)
+		{
+			vertices.push_back(Vertex(unit(random), unit(random), unit(random)));
+		}
+		for(uint32_t i=0;i<(nb+9)/10;++i)
+		{
+			vertices.push_back(vertices[i*7 % nb]);
+		}
+		const kdtree::Tree tree = kdtree::build(vertices);
+		VertexContainer    queries(vertices.begin(), vertices.begin() + std::min<size_t>(vertices.size(), 20));
+		for(uint32_t i=0;i<20;++i)
+		{
+			queries.push_back(Vertex(1.5*unit(random), 1.5*unit(random), 1.5*unit(random)));
+		}
+		const uint32_t n = vertices.size();
+		for(uint32_t k : {1u, 2u, 7u, n, n + 5})
+		{
+			const std::vector<IndexVertex_t> all = kdtree::nearest(tree, queries, k);
+			for(uint32_t q=0;q<queries.size();++q)
+			{
+				std::vector<VertexType> expected;
+				for(const Vertex& v : vertices)
+				{
+					expected.push_back(distance2(v, queries[q]));
+				}
+				std::sort(expected.begin(), expected.end());
+				expected.resize(std::min(k, n));
+				const std::vector<IndexVertex_t> found = kdtree::nearest(tree, queries[q], k);
+				std::vector<VertexType>          distances;
+				for(IndexVertex_t v : found)
+				{
+					distances.push_back(distance2(vertices.at(v), queries[q]));
+				}
+				std::vector<IndexVertex_t> unique(found);
+				std::sort(unique.begin(), unique.end());
+				bool batched = std::equal(found.begin(), found.end(), all.begin() + q*k) &&
+				               std::all_of(all.begin() + q*k + found.size(), all.begin() + (q+1)*k, [](IndexVertex_t v){return v == -1;});
+				if (distances != expected || std::unique(unique.begin(), unique.end()) != unique.end() || !batched)
+				{
+					std::cout << "query " << q << ", k = " << k << " : " << found.size() << " vertices found, " << expected.size() << " expected" << std::endl;
+					return false;
+				}
+			}
+		}
+		for(VertexType radius : {0.0, 0.05, 0.3, 4.0})
+		{
+			const kdtree::Neighborhoods all = kdtree::withinRadius(tree, queries, radius);
+			for(uint32_t q=0;q<queries.size();++q)
+			{
+				std::vector<IndexVertex_t> expected;
+				for(uint32_t v=0;v<n;++v)
+				{
+					if (distance2(vertices[v], queries[q]) <= radius*radius)
+					{
+						expected.push_back(v);
+					}
+				}
+				std::vector<IndexVertex_t> found = kdtree::withinRadius(tree, queries[q], radius);
+				std::vector<IndexVertex_t> batched(all.indexes.begin() + all.offsets[q], all.indexes.begin() + all.offsets[q+1]);
+				std::sort(found.begin(), found.end());
+				std::sort(batched.begin(), batched.end());
+				if (found != expected || batched != expected)
+				{
+					std::cout << "query " << q << ", radius " << radius << " : " << found.size() << " vertices found, " << expected.size() << " expected" << std::endl;
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+	//! @brief The closest hit of \p ray among every triangle of \p mesh (Möller and Trumbore), -1 if none.
+	bvh::Hit bruteForceHit(const Mesh& mesh, const bvh::Ray& ray)
+	{
+		bvh::Hit hit;
+		hit.distance = ray.far;
+		for(uint32_t f=0;f<mesh.getTriangles().size();++f)
+		{
+			const IndexVertex_t* ids = mesh.getTriangles()[f].beginVertice();
+			const Vertex&        a   = mesh.getVertices()[ids[0]];
+			Vertex e1 = mesh.getVertices()[ids[1]] - a;
+			Vertex e2 = mesh.getVertices()[ids[2]] - a;
+			Vertex p  = ray.direction.cross(e2);
+			double det = e1.dot(p);
+			if (std::fabs(det) < 1e-14)
+			{
+				continue;
+			}
+			Vertex s = ray.origin - a;
+			Vertex q = s.cross(e1);
+			double u = s.dot(p)/det;
+			double v = ray.direction.dot(q)/det;
+			double t = e2.dot(q)/det;
+			if (u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= ray.near && t <= hit.distance)
+			{
+				hit.triangle = f;
+				hit.distance = t;
+				hit.u        = u;
+				hit.v        = v;
+			}
+		}
+		return hit;
+	}
+	/**
+	 * @brief Compare the closest hits of a BVH over a bumpy sphere with a brute force loop over its triangles :
+	 * random rays from outside, rays aimed exactly at its vertices and at the middles of its edges, and misses.
+	 * @return true if every ray hits the same triangle (or one around the vertex or the edge aimed at), one by one and by packets.
+	 */
+	bool bvhMatchesBruteForce(void)
+	{
+		Mesh mesh;
+		sphere(mesh, 20, 40, 0.2);
+		const bvh::Tree&                           tree = mesh.getBvh();
+		const VertexContainer&                     vertices = mesh.getVertices();
+		std::mt19937                               random(SEED);
+		std::uniform_real_distribution<VertexType> unit(-1.0, 1.0);
+		auto around = [&](VertexType radius){
+			Vertex p;
+			do
+			{
+				p = Vertex(unit(random), unit(random), unit(random));
+			}
+			while(p.length() > 1.0 || p.length() < 0.1);
+			return p*(radius/p.length());
+		};
+		std::vector<bvh::Ray>                   rays;
+		std::vector<std::vector<IndexVertex_t>> aimed; // The vertex or the edge aimed at, which the watertight test can't miss.
+		for(uint32_t i=0;i<200;++i)
+		{
+			bvh::Ray ray;
+			ray.origin    = around(3.0);
+			ray.direction = around(0.5) - ray.origin;
+			rays.push_back(ray);
+			aimed.push_back({});
+		}
+		for(uint32_t i=0;i<vertices.size();i+=7)
+		{
+			bvh::Ray ray;
+			ray.origin    = vertices[i]*3.0 + around(0.5);
+			ray.direction = vertices[i] - ray.origin;
+			rays.push_back(ray);
+			aimed.push_back({static_cast<IndexVertex_t>(i)});
+		}
+		for(uint32_t f=0;f<mesh.getTriangles().size();f+=11)
+		{
+			const IndexVertex_t* ids = mesh.getTriangles()[f].beginVertice();
+			bvh::Ray ray;
+			Vertex   middle = (vertices[ids[0]] + vertices[ids[1]])/2.0;
+			ray.origin      = middle*3.0;
+			ray.direction   = middle - ray.origin;
+			rays.push_back(ray);
+			aimed.push_back({ids[0], ids[1]});
+		}
+		for(uint32_t i=0;i<20;++i)
+		{
+			bvh::Ray ray;
+			ray.origin    = around(3.0);
+			ray.direction = (i % 2 == 0) ? ray.origin : Vertex(-ray.origin.y(), ray.origin.x(), 0.0); // Away from, and beside the sphere.
+			ray.far       = (i % 2 == 0) ? ray.far : 1.0;
+			rays.push_back(ray);
+			aimed.push_back({});
+		}
+		const std::vector<bvh::Hit> packed = bvh::intersect(tree, rays);
+		for(uint32_t r=0;r<rays.size();++r)
+		{
+			const bvh::Hit hit      = bvh::intersect(tree, rays[r]);
+			const bvh::Hit expected = bruteForceHit(mesh, rays[r]);
+			auto           contains = [&](const bvh::Hit& h){
+				const TopoTriangle& t = mesh.getTriangles()[h.triangle];
+				return std::all_of(aimed[r].begin(), aimed[r].end(), [&t](IndexVertex_t v){return t.findVertexIndex(v) != -1;});
+			};
+			bool same = (hit.triangle != -1) == (expected.triangle != -1 || !aimed[r].empty()) && (packed[r].triangle != -1) == (hit.triangle != -1);
+			if (same && hit.triangle != -1)
+			{
+				// On an edge or a vertex, any triangle around it at the same distance is as good.
+				const VertexType reference = aimed[r].empty() ? expected.distance : 1.0;
+				same = std::fabs(hit.distance - reference) < 1e-9 && std::fabs(packed[r].distance - hit.distance) < 1e-12 &&
+				       (aimed[r].empty() ? (hit.triangle == expected.triangle && packed[r].triangle == hit.triangle) : (contains(hit) && contains(packed[r])));
+			}
+			if (!same)
+			{
+				std::cout << "ray " << r << " : triangle " << hit.triangle << " at " << hit.distance << ", packed " << packed[r].triangle
+				          << ", brute force " << expected.triangle << " at " << expected.distance << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+	/**
+	 * @brief The first vertices of a large grid, where a vertex splits an edge whose both triangles
+	 * have the same third neighbor.
+	 */
+	bool edgeSplitBesideOneTriangle(void)
+	{
+		VertexContainer points = generators::points(generators::GRID, 100000, SEED);
+		points.resize(6367);
+		Mesh mesh;
+		triangulate(mesh, points, "edge_split");
+		return isValid(mesh, true);
+	}
+	/**
+	 * @brief The first vertices are aligned, some are given twice, and the next ones fall on the
+	 * edges of the border and inside.
+	 */
+	VertexContainer collinear(void)
+	{
+		VertexContainer points;
+		for(double x : {0.0, 2.0, 1.0, 4.0, 3.0, 1.0})
+		{
+			points.push_back(Vertex(x, 0.0, 0.0));
+		}
+		for(const std::pair<double, double>& p : std::vector<std::pair<double, double>>{{2.0, 2.0}, {2.5, 0.0}, {1.0, 1.0}, {2.0, 1.0}, {2.0, 0.5}, {5.0, 0.0}, {2.0, 2.0}, {6.0, 0.0}, {2.0, -1.0}})
+		{
+			points.push_back(Vertex(p.first, p.second, 0.0));
+		}
+		return points;
+	}
+	/**
+	 * @brief Write a .ctri file of uniform points crossed by 3 long segments, between the first 6 of them.
+	 */
+	void writeLongSegments(const std::string& fname)
+	{
+		VertexContainer  points  = generators::points(generators::UNIFORM, 300, SEED);
+		const VertexType ends[6][2] = {{-0.98, -0.4}, {0.98, -0.36}, {-0.96, 0.4}, {0.94, 0.38}, {-0.9, 0.0}, {0.9, 0.02}};
+		for(uint32_t i=0;i<6;++i)
+		{
+			points[i] = Vertex(ends[i][0], ends[i][1], 0.0);
+		}
+		std::ofstream file(fname.c_str());
+		file << std::setprecision(std::numeric_limits<VertexType>::max_digits10) << points.size() << std::endl;
+		for(const Vertex& v : points)
+		{
+			file << v.x() << " " << v.y() << std::endl;
+		}
+		// As many segment lines as points, the repeated ones are ignored.
+		for(uint32_t i=0;i<points.size();++i)
+		{
+			file << 2*(i%3) << " " << 2*(i%3)+1 << std::endl;
+		}
+	}
+	/**
+	 * @brief Load the segments written by \p write with \p mode, and check that the refinement reaches
+	 * ANGLE. The number of vertices and the time are printed, to compare the modes.
+	 * @return true if every angle is at least ANGLE, and the result is valid.
+	 */
+	bool refinementReachesTheAngle(const std::function<void(const std::string&)>& write, ConstraintMode_e mode)
+	{
+		std::string fname = "tests_segments.ctri";
+		write(fname);
+		Mesh mesh;
+		auto start = std::chrono::steady_clock::now();
+		try
+		{
+			mesh.loadConstraints(fname, mode);
+		}
+		catch(...)
+		{
+			std::remove(fname.c_str());
+			throw;
+		}
+		std::remove(fname.c_str());
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		double smallest = mesh.computeQuality().smallestAngle;
+		std::cout << mesh.getVertices().size() << " vertices in " << elapsed.count() << "s, smallest angle " << smallest << std::endl;
+		return smallest >= ANGLE && isValid(mesh, true);
+	}
+
+	//! @brief A test, returning true if it passes.
+	struct Test final
+	{
+		std::string           name; //!< Printed with the result.
+		std::function<bool()> run;  //!< The test itself.
+	};
+	//! @brief Every test, in the order they are run.
+	std::vector<Test> tests(void)
+	{
+		std::vector<Test> result;
+		result.push_back({"hints after splits", splitsOnly});
+		result.push_back({"iterators and sentinels", iteratorsCompare});
+		result.push_back({"voronoi of a bowtie", voronoiOfABowtie});
+		result.push_back({"components of broken meshes", componentsOfBrokenMeshes});
+		result.push_back({"normals follow the changes", normalsFollowChanges});
+		result.push_back({"laplacian of a sphere", laplacianOfASphere});
+		result.push_back({"edge split beside one triangle", edgeSplitBesideOneTriangle});
+		result.push_back({"clustering stays closed", clusteringStaysClosed});
+		result.push_back({"codec round trips", codecRoundTrips});
+		result.push_back({"codec rejects broken streams", codecRejectsBrokenStreams});
+		result.push_back({"kd-tree of 1000 points", [](){return kdTreeMatchesBruteForce(1000);}});
+		result.push_back({"kd-tree of 5 points", [](){return kdTreeMatchesBruteForce(5);}});
+		result.push_back({"bvh of a sphere", bvhMatchesBruteForce});
+		result.push_back({"collinear then crust", [](){return triangulationThenCrust(collinear(), "collinear");}});
+		for(generators::Generator_e g : {generators::CIRCLE, generators::GRID, generators::LINE})
+		{
+			for(uint32_t nb : {1000, 10000})
+			{
+				std::string name = generators::name(g) + "_" + std::to_string(nb);
+				result.push_back({name + " then crust", [=](){return triangulationThenCrust(generators::points(g, nb, SEED), name);}});
+			}
+		}
+		auto polygon = [](const std::string& fname){generators::writePolygon(generators::points(generators::LINE, 1000, SEED), fname);};
+		for(ConstraintMode_e mode : {INSERT_SEGMENTS, SPLIT_SEGMENTS})
+		{
+			std::string name = (mode == INSERT_SEGMENTS) ? "inserted" : "split";
+			result.push_back({"long segments " + name + " then refined", [=](){return refinementReachesTheAngle(writeLongSegments, mode);}});
+			result.push_back({"line_1000 polygon " + name + " then refined", [=](){return refinementReachesTheAngle(polygon, mode);}});
+		}
+		return result;
+	}
+}
+
+int main(void)
+{
+	mtl::log::Options::ENABLE_LOG = false;
+	int failed = 0;
+	for(const Test& test : tests())
+	{
+		bool passed = false;
+		try
+		{
+			passed = test.run();
+		}
+		catch(const std::exception& e)
+		{
+			std::cout << "exception : " << e.what() << std::endl;
+		}
+		catch(...)
+		{
+			std::cout << "unknown exception" << std::endl;
+		}
+		std::cout << (passed ? "ok     " : "FAILED ") << test.name << std::endl;
+		failed += (passed) ? 0 : 1;
+	}
+	return failed;
+}